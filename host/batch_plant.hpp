@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "plant.hpp"
+
+// Structure-of-arrays version of Plant for stepping many independent runs in lockstep. Every lane has its own
+// parameters; the update is plain arithmetic over contiguous arrays so the compiler can vectorize it.
+class BatchPlant
+{
+public:
+    explicit BatchPlant(size_t lanes)
+        : ambient(lanes), heater_power(lanes), heater_capacity(lanes), air_capacity(lanes), heater_to_air(lanes),
+          air_to_ambient(lanes), sensor_tau(lanes), heater(lanes), air(lanes), sensor(lanes), sensor_alpha_(lanes),
+          power_(lanes)
+    {
+    }
+
+    size_t size() const { return air.size(); }
+
+    void set(size_t lane, const PlantParams& params)
+    {
+        ambient[lane] = params.ambient;
+        heater_power[lane] = params.heater_power;
+        heater_capacity[lane] = params.heater_capacity;
+        air_capacity[lane] = params.air_capacity;
+        heater_to_air[lane] = params.heater_to_air;
+        air_to_ambient[lane] = params.air_to_ambient;
+        sensor_tau[lane] = params.sensor_tau;
+    }
+
+    // Puts every lane at its ambient temperature and precomputes per-lane constants for sub-step `h`.
+    void reset(float h = kSubStep)
+    {
+        h_ = h;
+        for (size_t i = 0; i < size(); ++i) {
+            heater[i] = air[i] = sensor[i] = ambient[i];
+            sensor_alpha_[i] = 1.0f - std::exp(-h / sensor_tau[i]);
+        }
+    }
+
+    // Advances all lanes by `dt` seconds; adds each lane's heater energy (J) to `energy`.
+    void step(const uint8_t* heater_on, float dt, double* energy)
+    {
+        const size_t n = size();
+        const int steps = std::max(1, int(std::ceil(dt / h_)));
+        const float h = dt / steps;
+        float* __restrict heater_t = heater.data();
+        float* __restrict air_t = air.data();
+        float* __restrict sensor_t = sensor.data();
+        float* __restrict power = power_.data();
+        const float* __restrict amb = ambient.data();
+        const float* __restrict ha = heater_to_air.data();
+        const float* __restrict aa = air_to_ambient.data();
+        const float* __restrict hc = heater_capacity.data();
+        const float* __restrict ac = air_capacity.data();
+        const float* __restrict alpha = sensor_alpha_.data();
+
+        for (size_t i = 0; i < n; ++i) {
+            power[i] = heater_on[i] ? heater_power[i] : 0.0f;
+            energy[i] += power[i] * dt;
+        }
+        for (int s = 0; s < steps; ++s) {
+            for (size_t i = 0; i < n; ++i) {
+                const float to_air = ha[i] * (heater_t[i] - air_t[i]);
+                const float to_ambient = aa[i] * (air_t[i] - amb[i]);
+                heater_t[i] += h * (power[i] - to_air) / hc[i];
+                air_t[i] += h * (to_air - to_ambient) / ac[i];
+                sensor_t[i] += (air_t[i] - sensor_t[i]) * alpha[i];
+            }
+        }
+    }
+
+    static constexpr float kSubStep = 0.5f;
+
+    std::vector<float> ambient;
+    std::vector<float> heater_power;
+    std::vector<float> heater_capacity;
+    std::vector<float> air_capacity;
+    std::vector<float> heater_to_air;
+    std::vector<float> air_to_ambient;
+    std::vector<float> sensor_tau;
+
+    std::vector<float> heater;
+    std::vector<float> air;
+    std::vector<float> sensor;
+
+private:
+    float h_ = kSubStep;
+    std::vector<float> sensor_alpha_;
+    std::vector<float> power_;
+};
@@ -0,0 +1,764 @@
+// Fits candidate models to the calibration CSVs behind the firmware's conversion coefficients, with cross-validated
+// errors and bootstrap confidence intervals, and picks the cheapest model to evaluate on the ESP32 that meets an
+// accuracy target.
+//
+//   calibration_fit --thermistor CSV | --adc CSV [--target E] [--bootstrap B] [--threads N] [--seed N] [--json FILE]
+//
+// --thermistor fits temperature (C) over the corrected ADC code, from `temperature,code` rows as in
+// thermistor.calibration.csv; --adc fits the corrected code over the raw code, from `voltage,raw` rows as in
+// adc_testing.csv. Candidates are polynomials of order 1 to 5, the Beta and Steinhart-Hart equations over the
+// divider ratio (thermistor only) and cubic regression splines with 1 to 4 interior knots at data quantiles. Each
+// gets:
+//   - leave-one-out cross-validated RMS and maximum error
+//   - the 95% bootstrap confidence interval of the fitted curve, from B resamples of the points spread over the
+//     thread pool (each resample seeded from --seed and its index, so results don't depend on the thread count),
+//     and of each coefficient
+//   - the error of evaluating it in float with float coefficients, as the firmware would, over every code in range;
+//     the Beta and Steinhart-Hart logs go through the firmware's fast_log
+//   - an estimate of its cost in cycles on the ESP32's FPU
+// A model meets the target E (default 1 C or 8 codes) when its error bound, the widest confidence half-width plus
+// 1.96 times the cross-validated RMS error plus the float error, is within E; the cheapest such model is picked.
+// The firmware's current coefficients are scored on the data for comparison. --json writes every candidate with
+// its coefficients and error bounds.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "conversion.hpp"
+#include "fast_math.hpp"
+#include "thread_pool.hpp"
+
+constexpr double kKelvin = 273.15;
+constexpr double kFullScale = 1 << kAdcResolutionBits;
+// Points of the grid the confidence band is evaluated on.
+constexpr size_t kBandPoints = 200;
+
+// Rough costs in cycles on the ESP32's single-precision FPU: dependent float operations at their pipeline latency,
+// float division as the reciprocal-and-refine sequence GCC emits, fast_log (fast_math.hpp) and soft-float doubles.
+constexpr double kCyclesFloatOp = 4;
+constexpr double kCyclesFloatDiv = 30;
+constexpr double kCyclesFastLog = 50;
+constexpr double kCyclesDoubleOp = 60;
+constexpr double kCyclesBranch = 3;
+
+struct Sample
+{
+    double x;
+    double y;
+};
+
+enum class ModelKind
+{
+    Polynomial,
+    Beta,
+    SteinhartHart,
+    Spline,
+};
+
+struct ModelSpec
+{
+    ModelKind kind;
+    // Polynomial order, or interior knot count of a spline.
+    int degree;
+
+    std::string name() const
+    {
+        switch (kind) {
+        case ModelKind::Polynomial:
+            return "poly" + std::to_string(degree);
+        case ModelKind::Beta:
+            return "beta";
+        case ModelKind::SteinhartHart:
+            return "steinhart_hart";
+        case ModelKind::Spline:
+            return "spline" + std::to_string(degree);
+        }
+        return "?";
+    }
+};
+
+// The part of a model fixed by the whole data set, so every resample fits the same parameterisation: polynomials
+// and splines work in u = (x - center) / scale, which spans [-1, 1] over the data.
+struct Frame
+{
+    double center;
+    double scale;
+    std::vector<double> knots;
+};
+
+struct Fit
+{
+    ModelSpec spec;
+    Frame frame;
+    // Polynomial: powers of u. Beta and Steinhart-Hart: A, B (and C) of 1/T = A + B ln(r) + C ln(r)^3 with r the
+    // divider ratio x / (full scale - x). Spline: cubic in u, then one (u - knot)^3 term per knot.
+    std::vector<double> coefficients;
+
+    double operator()(double x) const
+    {
+        const auto& c = coefficients;
+        if (spec.kind == ModelKind::Beta || spec.kind == ModelKind::SteinhartHart) {
+            const double l = std::log(x / (kFullScale - x));
+            const double inverse = c[0] + c[1] * l + (c.size() > 2 ? c[2] * l * l * l : 0.0);
+            return 1.0 / inverse - kKelvin;
+        }
+        const double u = (x - frame.center) / frame.scale;
+        const size_t powers = spec.kind == ModelKind::Polynomial ? c.size() : 4;
+        double y = 0.0;
+        for (size_t k = powers; k-- > 0;) {
+            y = y * u + c[k];
+        }
+        for (size_t i = 0; i < frame.knots.size() && spec.kind == ModelKind::Spline; ++i) {
+            const double t = std::max(0.0, u - frame.knots[i]);
+            y += c[4 + i] * t * t * t;
+        }
+        return y;
+    }
+};
+
+// Least squares by Householder QR. `a` is n x p, row-major. Returns false if the columns are (nearly) dependent.
+static bool least_squares(std::vector<double> a, std::vector<double> b, size_t n, size_t p, std::vector<double>& x)
+{
+    if (n < p) {
+        return false;
+    }
+    double largest = 0.0;
+    for (size_t k = 0; k < p; ++k) {
+        double norm = 0.0;
+        for (size_t i = k; i < n; ++i) {
+            norm += a[i * p + k] * a[i * p + k];
+        }
+        norm = std::sqrt(norm);
+        largest = std::max(largest, norm);
+        if (norm <= 1e-10 * largest || norm == 0.0) {
+            return false;
+        }
+        const double alpha = a[k * p + k] > 0 ? -norm : norm;
+        // v = column - alpha e_k, stored in place; H = I - 2 v v^T / (v^T v).
+        a[k * p + k] -= alpha;
+        double vv = 0.0;
+        for (size_t i = k; i < n; ++i) {
+            vv += a[i * p + k] * a[i * p + k];
+        }
+        for (size_t j = k + 1; j < p; ++j) {
+            double dot = 0.0;
+            for (size_t i = k; i < n; ++i) {
+                dot += a[i * p + k] * a[i * p + j];
+            }
+            for (size_t i = k; i < n; ++i) {
+                a[i * p + j] -= 2.0 * dot / vv * a[i * p + k];
+            }
+        }
+        double dot = 0.0;
+        for (size_t i = k; i < n; ++i) {
+            dot += a[i * p + k] * b[i];
+        }
+        for (size_t i = k; i < n; ++i) {
+            b[i] -= 2.0 * dot / vv * a[i * p + k];
+        }
+        a[k * p + k] = alpha;
+    }
+    x.assign(p, 0.0);
+    for (size_t k = p; k-- > 0;) {
+        double sum = b[k];
+        for (size_t j = k + 1; j < p; ++j) {
+            sum -= a[k * p + j] * x[j];
+        }
+        x[k] = sum / a[k * p + k];
+    }
+    return true;
+}
+
+static Frame make_frame(const ModelSpec& spec, const std::vector<Sample>& samples)
+{
+    const auto [lo, hi] = std::minmax_element(samples.begin(), samples.end(),
+                                              [](const Sample& a, const Sample& b) { return a.x < b.x; });
+    Frame frame{(lo->x + hi->x) / 2.0, std::max(1e-9, (hi->x - lo->x) / 2.0), {}};
+    if (spec.kind == ModelKind::Spline) {
+        std::vector<double> u;
+        for (const auto& s : samples) {
+            u.push_back((s.x - frame.center) / frame.scale);
+        }
+        std::sort(u.begin(), u.end());
+        for (int i = 1; i <= spec.degree; ++i) {
+            frame.knots.push_back(u[u.size() * i / (spec.degree + 1)]);
+        }
+    }
+    return frame;
+}
+
+static bool fit(const ModelSpec& spec, const Frame& frame, const std::vector<Sample>& samples, Fit& result)
+{
+    result.spec = spec;
+    result.frame = frame;
+    const size_t n = samples.size();
+    std::vector<double> a;
+    std::vector<double> b;
+    size_t p = 0;
+    if (spec.kind == ModelKind::Beta || spec.kind == ModelKind::SteinhartHart) {
+        p = spec.kind == ModelKind::Beta ? 2 : 3;
+        for (const auto& s : samples) {
+            if (s.x <= 0.0 || s.x >= kFullScale) {
+                return false;
+            }
+            const double l = std::log(s.x / (kFullScale - s.x));
+            a.insert(a.end(), {1.0, l});
+            if (p == 3) {
+                a.push_back(l * l * l);
+            }
+            b.push_back(1.0 / (s.y + kKelvin));
+        }
+    } else {
+        const size_t powers = spec.kind == ModelKind::Polynomial ? spec.degree + 1 : 4;
+        p = powers + frame.knots.size();
+        for (const auto& s : samples) {
+            const double u = (s.x - frame.center) / frame.scale;
+            double power = 1.0;
+            for (size_t k = 0; k < powers; ++k) {
+                a.push_back(power);
+                power *= u;
+            }
+            for (const double knot : frame.knots) {
+                const double t = std::max(0.0, u - knot);
+                a.push_back(t * t * t);
+            }
+            b.push_back(s.y);
+        }
+    }
+    return least_squares(std::move(a), std::move(b), n, p, result.coefficients);
+}
+
+// The model as the firmware would evaluate it: float coefficients and float arithmetic, polynomials by Horner's
+// rule, splines as one cubic per segment in the offset from its start.
+class DeviceModel
+{
+public:
+    explicit DeviceModel(const Fit& fit) : fit_(fit)
+    {
+        for (const double c : fit.coefficients) {
+            coefficients_.push_back(float(c));
+        }
+        center_ = float(fit.frame.center);
+        inverse_scale_ = float(1.0 / fit.frame.scale);
+        if (fit.spec.kind != ModelKind::Spline) {
+            return;
+        }
+        // Segment i starts at starts_[i] (in u) and holds the Taylor coefficients of the spline there.
+        starts_.push_back(-INFINITY);
+        starts_.insert(starts_.end(), fit.frame.knots.begin(), fit.frame.knots.end());
+        for (size_t i = 0; i < starts_.size(); ++i) {
+            const double s = i == 0 ? 0.0 : starts_[i];
+            const auto& c = fit.coefficients;
+            double d[4] = {c[0] + s * (c[1] + s * (c[2] + s * c[3])), c[1] + s * (2 * c[2] + 3 * s * c[3]),
+                           c[2] + 3 * s * c[3], c[3]};
+            for (size_t k = 0; k < i; ++k) {
+                const double t = s - fit.frame.knots[k];
+                const double b = c[4 + k];
+                d[0] += b * t * t * t;
+                d[1] += 3 * b * t * t;
+                d[2] += 3 * b * t;
+                d[3] += b;
+            }
+            for (const double v : d) {
+                segments_.push_back(float(v));
+            }
+            segment_origins_.push_back(float(s));
+        }
+    }
+
+    float operator()(float x) const
+    {
+        const auto& c = coefficients_;
+        switch (fit_.spec.kind) {
+        case ModelKind::Beta:
+        case ModelKind::SteinhartHart: {
+            const float l = fast_log(x / (float(kFullScale) - x));
+            float inverse = c[0] + c[1] * l;
+            if (c.size() > 2) {
+                inverse += c[2] * (l * l * l);
+            }
+            return 1.0f / inverse - float(kKelvin);
+        }
+        case ModelKind::Polynomial: {
+            const float u = (x - center_) * inverse_scale_;
+            float y = c.back();
+            for (size_t k = c.size() - 1; k-- > 0;) {
+                y = y * u + c[k];
+            }
+            return y;
+        }
+        case ModelKind::Spline: {
+            const float u = (x - center_) * inverse_scale_;
+            size_t i = starts_.size() - 1;
+            while (i > 0 && u < float(starts_[i])) {
+                --i;
+            }
+            const float* d = &segments_[4 * i];
+            const float t = u - segment_origins_[i];
+            return d[0] + t * (d[1] + t * (d[2] + t * d[3]));
+        }
+        }
+        return NAN;
+    }
+
+    // Estimated cycles per evaluation, following operator().
+    double cycles() const
+    {
+        const size_t n = coefficients_.size();
+        switch (fit_.spec.kind) {
+        case ModelKind::Beta:
+        case ModelKind::SteinhartHart:
+            return 2 * kCyclesFloatDiv + kCyclesFastLog + kCyclesFloatOp * (n == 2 ? 4 : 8);
+        case ModelKind::Polynomial:
+            return kCyclesFloatOp * (2 + 2 * (n - 1));
+        case ModelKind::Spline:
+            return kCyclesFloatOp * 9 + kCyclesBranch * (starts_.size() - 1);
+        }
+        return 0.0;
+    }
+
+    // Per-segment coefficients of a spline, 4 per segment, and where each segment starts in u.
+    const std::vector<float>& segments() const { return segments_; }
+    const std::vector<float>& segment_origins() const { return segment_origins_; }
+
+private:
+    const Fit& fit_;
+    std::vector<float> coefficients_;
+    float center_ = 0.0f;
+    float inverse_scale_ = 1.0f;
+    std::vector<double> starts_;
+    std::vector<float> segments_;
+    std::vector<float> segment_origins_;
+};
+
+struct Interval
+{
+    double lo = NAN;
+    double hi = NAN;
+};
+
+struct Candidate
+{
+    ModelSpec spec;
+    Fit fit;
+    bool ok = false;
+    double rms = NAN;
+    double cv_rms = NAN;
+    double cv_max = NAN;
+    double band = NAN;
+    double float_error = NAN;
+    double cycles = NAN;
+    double bound = NAN;
+    size_t resamples = 0;
+    std::vector<Interval> coefficient_ci;
+    std::vector<float> segments;
+    std::vector<float> segment_origins;
+};
+
+static Interval percentile_interval(std::vector<double>& values)
+{
+    if (values.empty()) {
+        return {};
+    }
+    std::sort(values.begin(), values.end());
+    const auto at = [&](double q) {
+        return values[std::min(values.size() - 1, size_t(q * (values.size() - 1) + 0.5))];
+    };
+    return {at(0.025), at(0.975)};
+}
+
+static bool read_samples(const char* path, bool thermistor, std::vector<Sample>& samples)
+{
+    FILE* in = fopen(path, "r");
+    if (in == nullptr) {
+        perror(path);
+        return false;
+    }
+    char line[256];
+    while (fgets(line, sizeof(line), in) != nullptr) {
+        char* end;
+        const double first = strtod(line, &end);
+        if (end == line || *end != ',') {
+            continue;
+        }
+        char* field = end + 1;
+        const double second = strtod(field, &end);
+        if (end == field || !std::isfinite(first) || !std::isfinite(second)) {
+            continue;
+        }
+        // Thermistor rows are `temperature,corrected code`; ADC rows `voltage,raw code`, whose ideal corrected code
+        // is the code the voltage would give on a linear ADC.
+        samples.push_back(thermistor ? Sample{second, first}
+                                     : Sample{second, first * kFullScale / kAdcReferenceVoltage});
+    }
+    fclose(in);
+    return true;
+}
+
+struct Options
+{
+    const char* path = nullptr;
+    bool thermistor = true;
+    double target = NAN;
+    size_t bootstrap = 2000;
+    unsigned threads = std::thread::hardware_concurrency();
+    uint32_t seed = 1;
+    const char* json = nullptr;
+};
+
+static std::vector<ModelSpec> candidate_specs(bool thermistor)
+{
+    std::vector<ModelSpec> specs;
+    for (int order = 1; order <= 5; ++order) {
+        specs.push_back({ModelKind::Polynomial, order});
+    }
+    if (thermistor) {
+        specs.push_back({ModelKind::Beta, 0});
+        specs.push_back({ModelKind::SteinhartHart, 0});
+    }
+    for (int knots = 1; knots <= 4; ++knots) {
+        specs.push_back({ModelKind::Spline, knots});
+    }
+    return specs;
+}
+
+static void evaluate(Candidate& candidate, const std::vector<Sample>& samples, const std::vector<double>& grid)
+{
+    const Frame frame = make_frame(candidate.spec, samples);
+    if (!fit(candidate.spec, frame, samples, candidate.fit)) {
+        return;
+    }
+    candidate.ok = true;
+    double sq = 0.0;
+    for (const auto& s : samples) {
+        sq += (candidate.fit(s.x) - s.y) * (candidate.fit(s.x) - s.y);
+    }
+    candidate.rms = std::sqrt(sq / samples.size());
+
+    // Leave-one-out; a fold whose fit is degenerate counts as failing the model.
+    double cv_sq = 0.0;
+    candidate.cv_max = 0.0;
+    std::vector<Sample> rest;
+    for (size_t i = 0; i < samples.size(); ++i) {
+        rest = samples;
+        rest.erase(rest.begin() + i);
+        Fit fold;
+        if (!fit(candidate.spec, frame, rest, fold)) {
+            candidate.cv_rms = candidate.cv_max = INFINITY;
+            break;
+        }
+        const double error = fold(samples[i].x) - samples[i].y;
+        cv_sq += error * error;
+        candidate.cv_max = std::max(candidate.cv_max, std::abs(error));
+    }
+    if (std::isfinite(candidate.cv_max)) {
+        candidate.cv_rms = std::sqrt(cv_sq / samples.size());
+    }
+
+    const DeviceModel device(candidate.fit);
+    candidate.cycles = device.cycles();
+    candidate.float_error = 0.0;
+    for (double x = std::ceil(grid.front()); x <= grid.back(); x += 1.0) {
+        candidate.float_error = std::max(candidate.float_error, std::abs(double(device(float(x))) - candidate.fit(x)));
+    }
+    candidate.segments = device.segments();
+    candidate.segment_origins = device.segment_origins();
+}
+
+// Refits every candidate to B resamples of the points and turns the spread of the fitted curves and coefficients
+// into 95% percentile intervals.
+static void bootstrap(std::vector<Candidate>& candidates, const std::vector<Sample>& samples,
+                      const std::vector<double>& grid, const Options& options, ThreadPool& pool)
+{
+    const size_t b_count = options.bootstrap;
+    // curves[c][r * grid + g] and coefficients[c][r * p + k]; resamples with a degenerate fit are NaN.
+    std::vector<std::vector<double>> curves(candidates.size(), std::vector<double>(b_count * grid.size(), NAN));
+    std::vector<std::vector<double>> coefficients(candidates.size());
+    for (size_t c = 0; c < candidates.size(); ++c) {
+        coefficients[c].assign(b_count * candidates[c].fit.coefficients.size(), NAN);
+    }
+    pool.parallel_for(b_count, [&](size_t r) {
+        std::mt19937_64 rng(uint64_t(options.seed) << 32 | r);
+        std::uniform_int_distribution<size_t> pick(0, samples.size() - 1);
+        std::vector<Sample> resample(samples.size());
+        for (auto& s : resample) {
+            s = samples[pick(rng)];
+        }
+        for (size_t c = 0; c < candidates.size(); ++c) {
+            const auto& candidate = candidates[c];
+            Fit refit;
+            if (!candidate.ok || !fit(candidate.spec, candidate.fit.frame, resample, refit)) {
+                continue;
+            }
+            for (size_t g = 0; g < grid.size(); ++g) {
+                curves[c][r * grid.size() + g] = refit(grid[g]);
+            }
+            std::copy(refit.coefficients.begin(), refit.coefficients.end(),
+                      coefficients[c].begin() + r * refit.coefficients.size());
+        }
+    });
+
+    std::vector<double> values;
+    for (size_t c = 0; c < candidates.size(); ++c) {
+        auto& candidate = candidates[c];
+        if (!candidate.ok) {
+            continue;
+        }
+        candidate.resamples = 0;
+        for (size_t r = 0; r < b_count; ++r) {
+            candidate.resamples += !std::isnan(curves[c][r * grid.size()]);
+        }
+        // A model that can't be fitted to many of the resamples has a band that understates its uncertainty.
+        candidate.band = candidate.resamples >= b_count * 9 / 10 ? 0.0 : INFINITY;
+        for (size_t g = 0; g < grid.size() && std::isfinite(candidate.band); ++g) {
+            values.clear();
+            for (size_t r = 0; r < b_count; ++r) {
+                const double v = curves[c][r * grid.size() + g];
+                if (std::isfinite(v)) {
+                    values.push_back(v);
+                }
+            }
+            const Interval interval = percentile_interval(values);
+            candidate.band = std::max(candidate.band, (interval.hi - interval.lo) / 2.0);
+        }
+        const size_t p = candidate.fit.coefficients.size();
+        for (size_t k = 0; k < p; ++k) {
+            values.clear();
+            for (size_t r = 0; r < b_count; ++r) {
+                const double v = coefficients[c][r * p + k];
+                if (std::isfinite(v)) {
+                    values.push_back(v);
+                }
+            }
+            candidate.coefficient_ci.push_back(percentile_interval(values));
+        }
+    }
+}
+
+// Residuals and cost of the coefficients the firmware ships with.
+static void report_current(const std::vector<Sample>& samples, bool thermistor)
+{
+    double sq = 0.0;
+    double max = 0.0;
+    for (const auto& s : samples) {
+        const double y = thermistor ? thermistor_temperature(float(s.x)) : correct_adc(uint32_t(s.x));
+        sq += (y - s.y) * (y - s.y);
+        max = std::max(max, std::abs(y - s.y));
+    }
+    // thermistor_temperature: two float multiplies, and the double linear term with its conversions and adds.
+    // correct_adc: integer square, three conversions, five float multiplies and three adds.
+    const double cycles = thermistor ? 2 * kCyclesFloatOp + 5 * kCyclesDoubleOp : 11 * kCyclesFloatOp;
+    printf("%-15s %9.4f %9s %9s %9s %9s %7.0f  (firmware's current coefficients, not refitted)\n", "current",
+           std::sqrt(sq / samples.size()), "-", "-", "-", "-", cycles);
+}
+
+static void write_json(FILE* out, const Options& options, const std::vector<Candidate>& candidates,
+                       const std::vector<double>& grid, const Candidate* pick)
+{
+    const auto number = [out](double v) {
+        if (std::isfinite(v)) {
+            fprintf(out, "%.9g", v);
+        } else {
+            fprintf(out, "null");
+        }
+    };
+    fprintf(out, "{\n  \"data\": \"%s\",\n  \"input\": \"%s\",\n  \"output\": \"%s\",\n  \"range\": [", options.path,
+            options.thermistor ? "corrected_code" : "raw_code",
+            options.thermistor ? "temperature_c" : "corrected_code");
+    number(grid.front());
+    fprintf(out, ", ");
+    number(grid.back());
+    fprintf(out, "],\n  \"target\": ");
+    number(options.target);
+    fprintf(out, ",\n  \"bootstrap\": %zu,\n  \"seed\": %u,\n  \"pick\": ", options.bootstrap, options.seed);
+    fprintf(out, pick != nullptr ? "\"%s\"" : "null", pick != nullptr ? pick->spec.name().c_str() : "");
+    fprintf(out, ",\n  \"models\": [");
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        const auto& c = candidates[i];
+        fprintf(out, "%s\n    {\"name\": \"%s\", \"fitted\": %s", i ? "," : "", c.spec.name().c_str(),
+                c.ok ? "true" : "false");
+        if (!c.ok) {
+            fprintf(out, "}");
+            continue;
+        }
+        const std::pair<const char*, double> fields[] = {
+            {"center", c.fit.frame.center}, {"scale", c.fit.frame.scale}, {"rms", c.rms},
+            {"cv_rms", c.cv_rms},           {"cv_max", c.cv_max},         {"ci95_halfwidth", c.band},
+            {"float_error", c.float_error}, {"error_bound", c.bound},     {"cycles", c.cycles},
+        };
+        for (const auto& [name, value] : fields) {
+            fprintf(out, ", \"%s\": ", name);
+            number(value);
+        }
+        fprintf(out, ", \"resamples\": %zu", c.resamples);
+        const auto list = [&](const char* name, const auto& values) {
+            fprintf(out, ", \"%s\": [", name);
+            for (size_t k = 0; k < values.size(); ++k) {
+                fprintf(out, k ? ", " : "");
+                number(values[k]);
+            }
+            fprintf(out, "]");
+        };
+        list("knots", c.fit.frame.knots);
+        list("coefficients", c.fit.coefficients);
+        fprintf(out, ", \"coefficient_ci95\": [");
+        for (size_t k = 0; k < c.coefficient_ci.size(); ++k) {
+            fprintf(out, k ? ", [" : "[");
+            number(c.coefficient_ci[k].lo);
+            fprintf(out, ", ");
+            number(c.coefficient_ci[k].hi);
+            fprintf(out, "]");
+        }
+        fprintf(out, "]");
+        if (c.spec.kind == ModelKind::Spline) {
+            list("segment_origins", c.segment_origins);
+            list("segment_coefficients", c.segments);
+        }
+        fprintf(out, "}");
+    }
+    fprintf(out, "\n  ]\n}\n");
+}
+
+// The picked model as firmware source.
+static void print_code(const Candidate& c)
+{
+    const auto& k = c.fit.coefficients;
+    switch (c.spec.kind) {
+    case ModelKind::Polynomial:
+        printf("// u = (x - %.9gf) * %.9gf\n// y = ", c.fit.frame.center, 1.0 / c.fit.frame.scale);
+        for (size_t i = 0; i < k.size(); ++i) {
+            printf(i + 1 < k.size() ? "%.9gf + u * (" : "%.9gf", k[i]);
+        }
+        printf("%s\n", std::string(k.size() - 1, ')').c_str());
+        break;
+    case ModelKind::Beta:
+    case ModelKind::SteinhartHart:
+        printf("// l = fast_log(x / (%.0ff - x))\n// y = 1.0f / (%.9gf + %.9gf * l", kFullScale, k[0], k[1]);
+        if (k.size() > 2) {
+            printf(" + %.9gf * (l * l * l)", k[2]);
+        }
+        printf(") - 273.15f\n");
+        break;
+    case ModelKind::Spline:
+        printf("// u = (x - %.9gf) * %.9gf\n", c.fit.frame.center, 1.0 / c.fit.frame.scale);
+        for (size_t i = 0; i < c.segment_origins.size(); ++i) {
+            const float* d = &c.segments[4 * i];
+            if (i == 0) {
+                printf("// u < %.9gf: t = u", c.segment_origins.size() > 1 ? c.segment_origins[1] : INFINITY);
+            } else {
+                printf("// u >= %.9gf: t = u - (%.9gf)", c.segment_origins[i], c.segment_origins[i]);
+            }
+            printf(", y = %.9gf + t * (%.9gf + t * (%.9gf + t * %.9gf))\n", d[0], d[1], d[2], d[3]);
+        }
+        break;
+    }
+}
+
+static bool parse(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const char* arg = argv[i];
+        const char* value = argv[i + 1];
+        if (strcmp(arg, "--thermistor") == 0 || strcmp(arg, "--adc") == 0) {
+            options.path = value;
+            options.thermistor = strcmp(arg, "--thermistor") == 0;
+        } else if (strcmp(arg, "--target") == 0) {
+            options.target = strtod(value, nullptr);
+        } else if (strcmp(arg, "--bootstrap") == 0) {
+            options.bootstrap = strtoul(value, nullptr, 0);
+        } else if (strcmp(arg, "--threads") == 0) {
+            options.threads = strtoul(value, nullptr, 0);
+        } else if (strcmp(arg, "--seed") == 0) {
+            options.seed = strtoul(value, nullptr, 0);
+        } else if (strcmp(arg, "--json") == 0) {
+            options.json = value;
+        } else {
+            return false;
+        }
+    }
+    if (std::isnan(options.target)) {
+        options.target = options.thermistor ? 1.0 : 8.0;
+    }
+    return argc % 2 == 1 && options.path != nullptr && options.bootstrap > 0 && options.target > 0.0;
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parse(argc, argv, options)) {
+        fprintf(stderr,
+                "usage: %s --thermistor CSV | --adc CSV [--target E] [--bootstrap B] [--threads N] [--seed N]\n"
+                "       %*s [--json FILE]\n",
+                argv[0], int(strlen(argv[0])), "");
+        return 1;
+    }
+    std::vector<Sample> samples;
+    if (!read_samples(options.path, options.thermistor, samples)) {
+        return 1;
+    }
+    if (samples.size() < 8) {
+        fprintf(stderr, "%s: %zu points, need at least 8\n", options.path, samples.size());
+        return 1;
+    }
+    const auto [lo, hi] = std::minmax_element(samples.begin(), samples.end(),
+                                              [](const Sample& a, const Sample& b) { return a.x < b.x; });
+    std::vector<double> grid(kBandPoints);
+    for (size_t g = 0; g < grid.size(); ++g) {
+        grid[g] = lo->x + (hi->x - lo->x) * g / (grid.size() - 1);
+    }
+
+    std::vector<Candidate> candidates;
+    for (const auto& spec : candidate_specs(options.thermistor)) {
+        candidates.push_back({});
+        candidates.back().spec = spec;
+    }
+    ThreadPool pool(options.threads);
+    pool.parallel_for(candidates.size(), [&](size_t i) { evaluate(candidates[i], samples, grid); });
+    bootstrap(candidates, samples, grid, options, pool);
+
+    const char* unit = options.thermistor ? "C" : "codes";
+    printf("%zu points, %s %.1f to %.1f; target %.3g %s, %zu bootstrap resamples\n", samples.size(),
+           options.thermistor ? "corrected code" : "raw code", lo->x, hi->x, options.target, unit, options.bootstrap);
+    printf("%-15s %9s %9s %9s %9s %9s %7s\n", "model", "rms", "cv_rms", "cv_max", "ci95", "bound", "cycles");
+    report_current(samples, options.thermistor);
+    const Candidate* pick = nullptr;
+    for (auto& c : candidates) {
+        if (!c.ok) {
+            printf("%-15s not fitted (too few points or degenerate)\n", c.spec.name().c_str());
+            continue;
+        }
+        c.bound = c.band + 1.96 * c.cv_rms + c.float_error;
+        const bool meets = c.bound <= options.target;
+        if (meets && (pick == nullptr || c.cycles < pick->cycles ||
+                      (c.cycles == pick->cycles && c.cv_rms < pick->cv_rms))) {
+            pick = &c;
+        }
+        printf("%-15s %9.4f %9.4f %9.4f %9.4f %9.4f %7.0f%s\n", c.spec.name().c_str(), c.rms, c.cv_rms, c.cv_max,
+               c.band, c.bound, c.cycles, meets ? "" : "  misses target");
+    }
+    if (pick != nullptr) {
+        printf("pick: %s, error bound %.3g %s (float evaluation %.2g), about %.0f cycles\n", pick->spec.name().c_str(),
+               pick->bound, unit, pick->float_error, pick->cycles);
+        print_code(*pick);
+    } else {
+        printf("no model meets the target\n");
+    }
+
+    if (options.json != nullptr) {
+        FILE* out = fopen(options.json, "w");
+        if (out == nullptr) {
+            perror(options.json);
+            return 1;
+        }
+        write_json(out, options, candidates, grid, pick);
+        fclose(out);
+    }
+    return pick != nullptr ? 0 : 1;
+}
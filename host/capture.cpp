@@ -0,0 +1,302 @@
+// Writes and reads raw ADC capture files (capture_file.hpp). Captures keep every sample at the full 20 kS/s, which
+// CSV cannot do for sessions of hours; this tool makes them, converts CSV into them and gets samples back out.
+//
+//   capture --simulate FILE [--hours H] [--seed N]   thermistor channel of a simulated drying run
+//   capture --import CSV FILE [--rate HZ]            one column per channel; a header row names the channels
+//   capture --info FILE                              channels, span, chunks and compression
+//   capture --verify FILE [--threads N]              decode every chunk, checking CRCs, and report throughput
+//   capture --extract FILE FROM TO                   frames between two times in seconds, as CSV on stdout
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "capture_file.hpp"
+#include "dryer.hpp"
+#include "plant.hpp"
+#include "thread_pool.hpp"
+
+// Acquisition settings of the firmware; kept in step with main.cpp.
+constexpr uint32_t kAdcSampleRate = 20'000;
+constexpr uint32_t kAdcSamplesToRead = 100;
+constexpr uint8_t kThermistorChannel = 6;
+constexpr uint8_t kAdcAtten12Db = 3;
+
+static CaptureChannel make_channel(uint8_t channel, uint8_t bit_width, const char* name)
+{
+    CaptureChannel info{};
+    info.unit = 1;
+    info.channel = channel;
+    info.bit_width = bit_width;
+    info.attenuation = kAdcAtten12Db;
+    strncpy(info.name, name, sizeof(info.name) - 1);
+    return info;
+}
+
+// Runs Dryer against the plant frame by frame, keeping every sample the firmware would have averaged.
+static int simulate(const char* path, double hours, uint32_t seed)
+{
+    CaptureInfo info;
+    info.sample_rate_hz = kAdcSampleRate;
+    info.channels.push_back(make_channel(kThermistorChannel, kAdcResolutionBits, "thermistor"));
+    CaptureWriter writer;
+    if (!writer.open(path, info)) {
+        perror(path);
+        return 1;
+    }
+
+    const AdcModel adc;
+    Plant plant(PlantParams{}, seed);
+    Dryer dryer;
+    dryer.start(DryingProfile{});
+    constexpr float kFrameSeconds = float(kAdcSamplesToRead) / kAdcSampleRate;
+    const uint64_t frames = uint64_t(hours * 3600.0 * kAdcSampleRate / kAdcSamplesToRead);
+    uint16_t samples[kAdcSamplesToRead];
+    const auto start = std::chrono::steady_clock::now();
+    for (uint64_t frame = 0; frame < frames; ++frame) {
+        uint32_t sum = 0;
+        for (auto& sample : samples) {
+            sample = plant.read_sample(adc);
+            sum += sample;
+        }
+        const uint32_t now_ms = uint32_t(frame * kAdcSamplesToRead * 1000 / kAdcSampleRate);
+        const auto& status = dryer.step(sum / kAdcSamplesToRead, now_ms);
+        plant.step(status.heater_on, kFrameSeconds);
+        if (!writer.append(samples, kAdcSamplesToRead)) {
+            perror(path);
+            return 1;
+        }
+    }
+    if (!writer.close()) {
+        perror(path);
+        return 1;
+    }
+    const std::chrono::duration<double> wall = std::chrono::steady_clock::now() - start;
+    const double raw_bytes = double(writer.frame_count()) * sizeof(uint16_t);
+    fprintf(stderr, "%" PRIu64 " samples in %.1f s, %.1f MB (%.2f bits per sample, %.1fx smaller than 16-bit raw)\n",
+            writer.frame_count(), wall.count(), writer.size() / 1e6, writer.size() * 8.0 / writer.frame_count(),
+            raw_bytes / writer.size());
+    return 0;
+}
+
+static int import_csv(const char* csv, const char* path, uint32_t rate)
+{
+    FILE* in = fopen(csv, "r");
+    if (in == nullptr) {
+        perror(csv);
+        return 1;
+    }
+    CaptureInfo info;
+    info.sample_rate_hz = rate;
+    CaptureWriter writer;
+    std::vector<uint16_t> frame;
+    std::vector<std::string> names;
+    char line[4096];
+    int line_number = 0;
+    while (fgets(line, sizeof(line), in) != nullptr) {
+        ++line_number;
+        frame.clear();
+        bool numeric = true;
+        names.clear();
+        for (char* field = strtok(line, ",\r\n"); field != nullptr; field = strtok(nullptr, ",\r\n")) {
+            char* end;
+            const unsigned long value = strtoul(field, &end, 10);
+            numeric = numeric && end != field && *end == '\0' && value <= 0xffff;
+            frame.push_back(uint16_t(value));
+            names.emplace_back(field);
+        }
+        if (frame.empty()) {
+            continue;
+        }
+        if (info.channels.empty()) {
+            if (frame.size() > kCaptureMaxChannels) {
+                fprintf(stderr, "%s:%d: more than %" PRIu32 " channels\n", csv, line_number, kCaptureMaxChannels);
+                return 1;
+            }
+            for (size_t c = 0; c < frame.size(); ++c) {
+                const std::string name = numeric ? "ch" + std::to_string(c) : names[c];
+                info.channels.push_back(make_channel(uint8_t(c), 12, name.c_str()));
+            }
+            if (!writer.open(path, info)) {
+                perror(path);
+                return 1;
+            }
+            if (!numeric) {
+                continue;
+            }
+        }
+        if (!numeric || frame.size() != info.channels.size()) {
+            fprintf(stderr, "%s:%d: expected %zu sample codes\n", csv, line_number, info.channels.size());
+            return 1;
+        }
+        if (!writer.append(frame.data(), 1)) {
+            perror(path);
+            return 1;
+        }
+    }
+    fclose(in);
+    if (info.channels.empty()) {
+        fprintf(stderr, "%s: no samples\n", csv);
+        return 1;
+    }
+    if (!writer.close()) {
+        perror(path);
+        return 1;
+    }
+    fprintf(stderr, "%" PRIu64 " frames of %zu channels, %" PRIu64 " bytes\n", writer.frame_count(),
+            info.channels.size(), writer.size());
+    return 0;
+}
+
+static bool open_capture(const char* path, CaptureReader& reader)
+{
+    std::string error;
+    if (!reader.open(path, error)) {
+        fprintf(stderr, "%s: %s\n", path, error.c_str());
+        return false;
+    }
+    if (reader.index_recovered()) {
+        fprintf(stderr, "%s: no valid index (unfinished capture?), %zu chunks recovered by scanning\n", path,
+                reader.chunk_count());
+    }
+    return true;
+}
+
+static int info(const char* path)
+{
+    CaptureReader reader;
+    if (!open_capture(path, reader)) {
+        return 1;
+    }
+    const auto& info = reader.info();
+    const double raw_bytes = double(reader.frame_count()) * info.channels.size() * sizeof(uint16_t);
+    printf("%" PRIu64 " frames at %" PRIu32 " Hz (%.1f s), %zu chunks of up to %" PRIu32 " frames\n",
+           reader.frame_count(), info.sample_rate_hz, double(reader.frame_count()) / info.sample_rate_hz,
+           reader.chunk_count(), info.chunk_frames);
+    if (info.start_time_us != 0) {
+        printf("started at %.6f s since the epoch\n", info.start_time_us / 1e6);
+    }
+    printf("%zu bytes, %.1fx smaller than 16-bit raw\n", reader.size(), raw_bytes / reader.size());
+    for (const auto& channel : info.channels) {
+        printf("  %-12.12s ADC%u channel %u, %u bits, attenuation %u\n", channel.name, channel.unit, channel.channel,
+               channel.bit_width, channel.attenuation);
+    }
+    return 0;
+}
+
+static int verify(const char* path, unsigned threads)
+{
+    CaptureReader reader;
+    if (!open_capture(path, reader)) {
+        return 1;
+    }
+    ThreadPool pool(threads);
+    std::atomic<size_t> bad{0};
+    std::atomic<size_t> first_bad{SIZE_MAX};
+    const auto start = std::chrono::steady_clock::now();
+    pool.parallel_for(reader.chunk_count(), [&](size_t i) {
+        static thread_local std::vector<uint16_t> samples;
+        if (!reader.decode_chunk(i, samples)) {
+            ++bad;
+            size_t expected = first_bad.load();
+            while (i < expected && !first_bad.compare_exchange_weak(expected, i)) {
+            }
+        }
+    });
+    const std::chrono::duration<double> wall = std::chrono::steady_clock::now() - start;
+    const double samples = double(reader.frame_count()) * reader.info().channels.size();
+    printf("%zu chunks on %u threads in %.3f s: %.0f MB/s, %.0f Msamples/s\n", reader.chunk_count(), pool.size(),
+           wall.count(), reader.size() / wall.count() / 1e6, samples / wall.count() / 1e6);
+    if (bad > 0) {
+        printf("%zu corrupt chunks, first at frame %" PRIu64 "\n", bad.load(), reader.chunk(first_bad).first_frame);
+        return 1;
+    }
+    return 0;
+}
+
+static int extract(const char* path, double from, double to)
+{
+    CaptureReader reader;
+    if (!open_capture(path, reader)) {
+        return 1;
+    }
+    const auto& info = reader.info();
+    const uint64_t first = reader.frame_at(from);
+    const uint64_t end = std::max(first, reader.frame_at(to));
+    printf("time_s");
+    for (const auto& channel : info.channels) {
+        printf(",%.12s", channel.name);
+    }
+    printf("\n");
+    constexpr size_t kBatchFrames = 4096;
+    std::vector<uint16_t> samples(kBatchFrames * info.channels.size());
+    for (uint64_t frame = first; frame < end; frame += kBatchFrames) {
+        const size_t count = std::min<uint64_t>(kBatchFrames, end - frame);
+        if (!reader.read(frame, count, samples.data())) {
+            fprintf(stderr, "%s: corrupt chunk at frame %" PRIu64 "\n", path, frame);
+            return 1;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            printf("%.6f", double(frame + i) / info.sample_rate_hz);
+            for (size_t c = 0; c < info.channels.size(); ++c) {
+                printf(",%u", samples[i * info.channels.size() + c]);
+            }
+            printf("\n");
+        }
+    }
+    return 0;
+}
+
+static int usage(const char* argv0)
+{
+    fprintf(stderr,
+            "usage: %s --simulate FILE [--hours H] [--seed N]\n"
+            "       %s --import CSV FILE [--rate HZ]\n"
+            "       %s --info FILE\n"
+            "       %s --verify FILE [--threads N]\n"
+            "       %s --extract FILE FROM TO\n",
+            argv0, argv0, argv0, argv0, argv0);
+    return 1;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3) {
+        return usage(argv[0]);
+    }
+    const char* mode = argv[1];
+    if (strcmp(mode, "--simulate") == 0 && argc % 2 == 1) {
+        double hours = 1.0;
+        uint32_t seed = 1;
+        for (int i = 3; i + 1 < argc; i += 2) {
+            if (strcmp(argv[i], "--hours") == 0) {
+                hours = strtod(argv[i + 1], nullptr);
+            } else if (strcmp(argv[i], "--seed") == 0) {
+                seed = strtoul(argv[i + 1], nullptr, 0);
+            } else {
+                return usage(argv[0]);
+            }
+        }
+        return hours > 0.0 ? simulate(argv[2], hours, seed) : usage(argv[0]);
+    }
+    if (strcmp(mode, "--import") == 0 && (argc == 4 || (argc == 6 && strcmp(argv[4], "--rate") == 0))) {
+        const uint32_t rate = argc == 6 ? strtoul(argv[5], nullptr, 0) : kAdcSampleRate;
+        return rate > 0 ? import_csv(argv[2], argv[3], rate) : usage(argv[0]);
+    }
+    if (strcmp(mode, "--info") == 0 && argc == 3) {
+        return info(argv[2]);
+    }
+    if (strcmp(mode, "--verify") == 0 && (argc == 3 || (argc == 5 && strcmp(argv[3], "--threads") == 0))) {
+        return verify(argv[2], argc == 5 ? strtoul(argv[4], nullptr, 0) : std::thread::hardware_concurrency());
+    }
+    if (strcmp(mode, "--extract") == 0 && argc == 5) {
+        return extract(argv[2], strtod(argv[3], nullptr), strtod(argv[4], nullptr));
+    }
+    return usage(argv[0]);
+}
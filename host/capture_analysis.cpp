@@ -0,0 +1,735 @@
+// Offline analysis of raw ADC captures (capture_file.hpp): block statistics, noise spectra, the firmware's
+// measurement filter and a comparison of conversion paths, over hours of samples.
+//
+//   capture_analysis FILE [--threads T] [--block S] [--nfft N] [--channel C] [--cutoff HZ]... [--csv PREFIX]
+//                    [--json FILE] [--scaling]
+//
+// Chunks are the unit of work: each pool task decodes one chunk and folds it into partial results for the blocks
+// and spectrum segments starting in it, and the partials are merged in chunk order, so the output does not depend
+// on the thread count. The conversion and filter kernels are the firmware's own:
+//   - blocks of S seconds (default 1, the firmware's control period) get count, mean, standard deviation, min and
+//     max of every channel
+//   - spectra are Welch averages of Hann-windowed, mean-removed segments of N samples, in codes^2/Hz
+//   - for the thermistor channel C, each block compares the temperature the firmware would act on (the integer
+//     average of the block's first frame of 100 samples, through convert_reading) and the conversion of the block's
+//     integer mean against the mean of every sample converted on its own
+//   - the firmware frame temperatures, one per block, go through the controller's low-pass at each --cutoff (the
+//     firmware's default if none is given) and are scored against that per-sample reference
+// --csv writes PREFIX_blocks.csv, PREFIX_spectrum.csv and PREFIX_filters.csv; --json a summary. --scaling reports
+// throughput for 1, 2, 4... threads up to T instead.
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <numbers>
+#include <string>
+#include <vector>
+
+#include "capture_file.hpp"
+#include "conversion.hpp"
+#include "heater_controller.hpp"
+#include "thread_pool.hpp"
+
+// Samples the firmware averages per frame; kept in step with main.cpp.
+constexpr uint32_t kAdcSamplesToRead = 100;
+// Spectra are summarised as the RMS noise above this frequency, clear of the thermal signal.
+constexpr double kNoiseBandHz = 10.0;
+
+struct Options
+{
+    const char* path = nullptr;
+    unsigned threads = std::thread::hardware_concurrency();
+    double block_s = 1.0;
+    uint32_t nfft = 4096;
+    uint32_t channel = 0;
+    std::vector<float> cutoffs;
+    const char* csv = nullptr;
+    const char* json = nullptr;
+    bool scaling = false;
+};
+
+// Exact integer moments, so partials merge without rounding in any order.
+struct ChannelStats
+{
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t sum_sq = 0;
+    uint16_t min = UINT16_MAX;
+    uint16_t max = 0;
+
+    void merge(const ChannelStats& other)
+    {
+        count += other.count;
+        sum += other.sum;
+        sum_sq += other.sum_sq;
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+    }
+
+    double mean() const { return count ? double(sum) / count : NAN; }
+
+    double stddev() const
+    {
+        return count > 1 ? std::sqrt(std::max(0.0, (sum_sq - double(sum) * sum / count) / (count - 1))) : NAN;
+    }
+};
+
+struct Block
+{
+    std::vector<ChannelStats> channels;
+    // Thermistor channel: the samples of the block's first frame the firmware would accept, and the sum of every
+    // valid sample's own temperature.
+    uint32_t frame_sum = 0;
+    uint32_t frame_count = 0;
+    double temperature_sum = 0.0;
+    uint64_t temperature_count = 0;
+
+    void merge(const Block& other)
+    {
+        channels.resize(std::max(channels.size(), other.channels.size()));
+        for (size_t c = 0; c < other.channels.size(); ++c) {
+            channels[c].merge(other.channels[c]);
+        }
+        frame_sum += other.frame_sum;
+        frame_count += other.frame_count;
+        temperature_sum += other.temperature_sum;
+        temperature_count += other.temperature_count;
+    }
+};
+
+struct ChunkResult
+{
+    bool ok = false;
+    uint64_t first_block = 0;
+    std::vector<Block> blocks;
+    // One-sided power per channel, summed over the segments starting in the chunk.
+    std::vector<std::vector<double>> power;
+    uint32_t segments = 0;
+};
+
+// FFT of real input of one power-of-two size, computed as a complex FFT of half the size over the even and odd
+// samples and then split into the N / 2 + 1 non-negative frequency bins.
+class RealFft
+{
+public:
+    explicit RealFft(uint32_t size) : half_(size / 2), twiddles_(size / 2 + 1), reversed_(size / 2), z_(size / 2)
+    {
+        for (uint32_t k = 0; k <= half_; ++k) {
+            twiddles_[k] = std::polar(1.0, -2.0 * std::numbers::pi * k / size);
+        }
+        const int bits = std::countr_zero(half_);
+        for (uint32_t i = 0; i < half_; ++i) {
+            uint32_t r = 0;
+            for (int b = 0; b < bits; ++b) {
+                r |= ((i >> b) & 1) << (bits - 1 - b);
+            }
+            reversed_[i] = r;
+        }
+    }
+
+    // `out` must hold N / 2 + 1 bins. Not reentrant; give every thread its own instance.
+    void transform(const double* in, std::complex<double>* out)
+    {
+        for (uint32_t i = 0; i < half_; ++i) {
+            z_[reversed_[i]] = {in[2 * i], in[2 * i + 1]};
+        }
+        // The half-size transform uses every other twiddle of the full size.
+        for (uint32_t len = 2; len <= half_; len *= 2) {
+            const uint32_t stride = 2 * half_ / len;
+            for (uint32_t start = 0; start < half_; start += len) {
+                for (uint32_t k = 0; k < len / 2; ++k) {
+                    const auto t = multiply(twiddles_[k * stride], z_[start + k + len / 2]);
+                    z_[start + k + len / 2] = z_[start + k] - t;
+                    z_[start + k] += t;
+                }
+            }
+        }
+        for (uint32_t k = 0; k <= half_; ++k) {
+            const auto a = z_[k % half_];
+            const auto b = std::conj(z_[(half_ - k) % half_]);
+            const auto even = 0.5 * (a + b);
+            const auto difference = a - b;
+            const std::complex<double> odd(0.5 * difference.imag(), -0.5 * difference.real());
+            out[k] = even + multiply(twiddles_[k], odd);
+        }
+    }
+
+private:
+    // Plain complex product; operator* checks for infinities and NaNs through a library call.
+    static std::complex<double> multiply(std::complex<double> a, std::complex<double> b)
+    {
+        return {a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real()};
+    }
+
+    uint32_t half_;
+    std::vector<std::complex<double>> twiddles_;
+    std::vector<uint32_t> reversed_;
+    std::vector<std::complex<double>> z_;
+};
+
+struct Analysis
+{
+    const CaptureReader& reader;
+    const Options& options;
+    uint64_t block_frames;
+    std::vector<double> window;
+    // Temperature of every code of the thermistor channel, empty if its width doesn't match the calibration.
+    std::vector<double> temperature;
+    uint32_t max_code;
+
+    Analysis(const CaptureReader& reader, const Options& options)
+        : reader(reader),
+          options(options),
+          block_frames(std::max<uint64_t>(1, std::llround(options.block_s * reader.info().sample_rate_hz))),
+          window(options.nfft)
+    {
+        for (uint32_t i = 0; i < options.nfft; ++i) {
+            window[i] = 0.5 - 0.5 * std::cos(2.0 * std::numbers::pi * i / options.nfft);
+        }
+        const auto& channel = reader.info().channels[options.channel];
+        max_code = (1u << std::min<uint32_t>(channel.bit_width, 16)) - 1;
+        if (channel.bit_width == kAdcResolutionBits) {
+            for (uint32_t code = 0; code <= max_code; ++code) {
+                temperature.push_back(convert_reading(code).temperature);
+            }
+        }
+    }
+
+    ChunkResult run_chunk(size_t index) const
+    {
+        ChunkResult result;
+        std::vector<uint16_t> samples;
+        if (!reader.decode_chunk(index, samples)) {
+            return result;
+        }
+        result.ok = true;
+        const size_t channels = reader.info().channels.size();
+        const uint64_t first = reader.chunk(index).first_frame;
+        const uint64_t frames = samples.size() / channels;
+
+        result.first_block = first / block_frames;
+        result.blocks.resize((first + frames - 1) / block_frames - result.first_block + 1);
+        for (auto& block : result.blocks) {
+            block.channels.resize(channels);
+        }
+        for (uint64_t f = 0; f < frames;) {
+            const uint64_t block_index = (first + f) / block_frames;
+            const uint64_t end = std::min(frames, (block_index + 1) * block_frames - first);
+            auto& block = result.blocks[block_index - result.first_block];
+            add_block_samples(block, samples.data() + f * channels, end - f, channels,
+                              first + f - block_index * block_frames);
+            f = end;
+        }
+
+        add_spectra(result, index, first, frames, samples);
+        return result;
+    }
+
+    void add_block_samples(Block& block, const uint16_t* samples, uint64_t frames, size_t channels,
+                           uint64_t offset_in_block) const
+    {
+        for (size_t c = 0; c < channels; ++c) {
+            auto& stats = block.channels[c];
+            uint64_t sum = 0;
+            uint64_t sum_sq = 0;
+            uint16_t min = stats.min;
+            uint16_t max = stats.max;
+            for (uint64_t f = 0; f < frames; ++f) {
+                const uint16_t value = samples[f * channels + c];
+                sum += value;
+                sum_sq += uint32_t(value) * value;
+                min = std::min(min, value);
+                max = std::max(max, value);
+            }
+            stats.count += frames;
+            stats.sum += sum;
+            stats.sum_sq += sum_sq;
+            stats.min = min;
+            stats.max = max;
+        }
+        if (temperature.empty()) {
+            return;
+        }
+        const size_t c = options.channel;
+        for (uint64_t f = 0; f < frames; ++f) {
+            const uint16_t value = samples[f * channels + c];
+            // Like the firmware, drop conversions whose code is out of range.
+            if (value > max_code) {
+                continue;
+            }
+            if (offset_in_block + f < kAdcSamplesToRead) {
+                block.frame_sum += value;
+                ++block.frame_count;
+            }
+            block.temperature_sum += temperature[value];
+            ++block.temperature_count;
+        }
+    }
+
+    // Welch segments are aligned to multiples of nfft from the start of the capture. Each belongs to the chunk it
+    // starts in, which decodes the following chunks as far as the segment reaches into them.
+    void add_spectra(ChunkResult& result, size_t index, uint64_t first, uint64_t frames,
+                     std::vector<uint16_t>& samples) const
+    {
+        const size_t channels = reader.info().channels.size();
+        const uint32_t n = options.nfft;
+        const uint64_t first_segment = (first + n - 1) / n;
+        const uint64_t end_segment = std::min((first + frames + n - 1) / n, reader.frame_count() / n);
+        if (first_segment >= end_segment) {
+            return;
+        }
+        const uint64_t needed = end_segment * n - first;
+        std::vector<uint16_t> next;
+        for (size_t i = index + 1; samples.size() / channels < needed && i < reader.chunk_count(); ++i) {
+            if (!reader.decode_chunk(i, next)) {
+                break;
+            }
+            samples.insert(samples.end(), next.begin(), next.end());
+        }
+        const uint64_t available = samples.size() / channels;
+
+        result.power.assign(channels, std::vector<double>(n / 2 + 1));
+        RealFft fft(n);
+        std::vector<double> x(n);
+        std::vector<std::complex<double>> bins(n / 2 + 1);
+        for (uint64_t segment = first_segment; segment < end_segment; ++segment) {
+            const uint64_t offset = segment * n - first;
+            if (offset + n > available) {
+                break;
+            }
+            for (size_t c = 0; c < channels; ++c) {
+                double mean = 0.0;
+                for (uint32_t i = 0; i < n; ++i) {
+                    mean += samples[(offset + i) * channels + c];
+                }
+                mean /= n;
+                for (uint32_t i = 0; i < n; ++i) {
+                    x[i] = (samples[(offset + i) * channels + c] - mean) * window[i];
+                }
+                fft.transform(x.data(), bins.data());
+                auto& power = result.power[c];
+                for (uint32_t k = 0; k <= n / 2; ++k) {
+                    power[k] += std::norm(bins[k]) * (k == 0 || k == n / 2 ? 1.0 : 2.0);
+                }
+            }
+            ++result.segments;
+        }
+    }
+};
+
+struct FilterScore
+{
+    float cutoff_hz = 0.0f;
+    double rms_error = 0.0;
+    double max_error = 0.0;
+    // Standard deviation of step-to-step changes: the noise the filter lets through.
+    double step_noise = 0.0;
+};
+
+struct Results
+{
+    std::vector<Block> blocks;
+    std::vector<std::vector<double>> psd;
+    uint32_t segments = 0;
+    size_t corrupt_chunks = 0;
+    double wall_s = 0.0;
+};
+
+static Results analyse(const CaptureReader& reader, const Options& options, unsigned threads)
+{
+    const Analysis analysis(reader, options);
+    std::vector<ChunkResult> partials(reader.chunk_count());
+    const auto start = std::chrono::steady_clock::now();
+    {
+        ThreadPool pool(threads);
+        pool.parallel_for(partials.size(), [&](size_t i) { partials[i] = analysis.run_chunk(i); });
+    }
+
+    Results results;
+    const size_t channels = reader.info().channels.size();
+    results.blocks.resize((reader.frame_count() + analysis.block_frames - 1) / analysis.block_frames);
+    results.psd.assign(channels, std::vector<double>(options.nfft / 2 + 1));
+    for (const auto& partial : partials) {
+        if (!partial.ok) {
+            ++results.corrupt_chunks;
+            continue;
+        }
+        for (size_t b = 0; b < partial.blocks.size(); ++b) {
+            results.blocks[partial.first_block + b].merge(partial.blocks[b]);
+        }
+        for (size_t c = 0; c < partial.power.size(); ++c) {
+            for (size_t k = 0; k < partial.power[c].size(); ++k) {
+                results.psd[c][k] += partial.power[c][k];
+            }
+        }
+        results.segments += partial.segments;
+    }
+    // Power spectral density: periodogram power over fs * sum(w^2), averaged over segments.
+    double window_power = 0.0;
+    for (const double w : analysis.window) {
+        window_power += w * w;
+    }
+    const double scale = results.segments ? 1.0 / (reader.info().sample_rate_hz * window_power * results.segments) : 0.0;
+    for (auto& psd : results.psd) {
+        for (auto& p : psd) {
+            p *= scale;
+        }
+    }
+    results.wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return results;
+}
+
+static float frame_temperature(const Block& block)
+{
+    return block.frame_count ? convert_reading(block.frame_sum / block.frame_count).temperature : NAN;
+}
+
+static float block_temperature(const Block& block, size_t channel)
+{
+    // Blocks entirely inside a corrupt chunk have no channels at all.
+    if (channel >= block.channels.size() || block.channels[channel].count == 0) {
+        return NAN;
+    }
+    const auto& stats = block.channels[channel];
+    return convert_reading(uint32_t(stats.sum / stats.count)).temperature;
+}
+
+static double sample_temperature(const Block& block)
+{
+    return block.temperature_count ? block.temperature_sum / block.temperature_count : NAN;
+}
+
+static std::vector<FilterScore> score_filters(const Results& results, const Options& options)
+{
+    std::vector<FilterScore> scores;
+    std::vector<float> cutoffs{0.0f};
+    cutoffs.insert(cutoffs.end(), options.cutoffs.begin(), options.cutoffs.end());
+    const float dt = float(options.block_s);
+    for (const float cutoff : cutoffs) {
+        FilterScore score;
+        score.cutoff_hz = cutoff;
+        const float alpha = cutoff > 0.0f ? low_pass_alpha(cutoff, dt) : 1.0f;
+        float filtered = NAN;
+        float previous = NAN;
+        double error_sq = 0.0;
+        double step_sum = 0.0;
+        double step_sq = 0.0;
+        uint64_t count = 0;
+        uint64_t steps = 0;
+        for (const auto& block : results.blocks) {
+            const float input = frame_temperature(block);
+            const double reference = sample_temperature(block);
+            if (std::isnan(input) || std::isnan(reference)) {
+                continue;
+            }
+            // Primed from the first reading, as the controller is.
+            filtered = std::isnan(filtered) ? input : filtered + alpha * (input - filtered);
+            const double error = filtered - reference;
+            error_sq += error * error;
+            score.max_error = std::max(score.max_error, std::abs(error));
+            ++count;
+            if (!std::isnan(previous)) {
+                step_sum += filtered - previous;
+                step_sq += double(filtered - previous) * (filtered - previous);
+                ++steps;
+            }
+            previous = filtered;
+        }
+        score.rms_error = count ? std::sqrt(error_sq / count) : NAN;
+        score.step_noise = steps > 1 ? std::sqrt(std::max(0.0, (step_sq - step_sum * step_sum / steps) / (steps - 1)))
+                                     : NAN;
+        scores.push_back(score);
+    }
+    return scores;
+}
+
+static double band_rms(const std::vector<double>& psd, double bin_hz, double from_hz)
+{
+    double power = 0.0;
+    for (size_t k = 0; k < psd.size(); ++k) {
+        if (k * bin_hz >= from_hz) {
+            power += psd[k] * bin_hz;
+        }
+    }
+    return std::sqrt(power);
+}
+
+static FILE* open_output(const std::string& path)
+{
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        perror(path.c_str());
+    }
+    return file;
+}
+
+static bool write_csv(const char* prefix, const CaptureReader& reader, const Options& options, const Results& results,
+                      const std::vector<FilterScore>& scores)
+{
+    const auto& channels = reader.info().channels;
+    const bool thermistor = channels[options.channel].bit_width == kAdcResolutionBits;
+
+    FILE* blocks = open_output(std::string(prefix) + "_blocks.csv");
+    if (blocks == nullptr) {
+        return false;
+    }
+    fprintf(blocks, "time_s");
+    for (const auto& channel : channels) {
+        const char* name = channel.name;
+        fprintf(blocks, ",%.12s_mean,%.12s_std,%.12s_min,%.12s_max", name, name, name, name);
+    }
+    if (thermistor) {
+        fprintf(blocks, ",frame_temperature,block_temperature,sample_temperature");
+    }
+    fprintf(blocks, "\n");
+    for (size_t b = 0; b < results.blocks.size(); ++b) {
+        const auto& block = results.blocks[b];
+        fprintf(blocks, "%.3f", b * options.block_s);
+        for (size_t c = 0; c < channels.size(); ++c) {
+            const auto& stats = c < block.channels.size() ? block.channels[c] : ChannelStats{};
+            fprintf(blocks, ",%.4f,%.4f,%u,%u", stats.mean(), stats.stddev(), stats.count ? stats.min : 0,
+                    stats.max);
+        }
+        if (thermistor) {
+            fprintf(blocks, ",%.4f,%.4f,%.4f", frame_temperature(block), block_temperature(block, options.channel),
+                    sample_temperature(block));
+        }
+        fprintf(blocks, "\n");
+    }
+    fclose(blocks);
+
+    FILE* spectrum = open_output(std::string(prefix) + "_spectrum.csv");
+    if (spectrum == nullptr) {
+        return false;
+    }
+    fprintf(spectrum, "frequency_hz");
+    for (const auto& channel : channels) {
+        fprintf(spectrum, ",%.12s_psd", channel.name);
+    }
+    fprintf(spectrum, "\n");
+    const double bin_hz = double(reader.info().sample_rate_hz) / options.nfft;
+    for (size_t k = 0; k <= options.nfft / 2; ++k) {
+        fprintf(spectrum, "%.4f", k * bin_hz);
+        for (const auto& psd : results.psd) {
+            fprintf(spectrum, ",%.6g", psd[k]);
+        }
+        fprintf(spectrum, "\n");
+    }
+    fclose(spectrum);
+
+    if (!thermistor) {
+        return true;
+    }
+    FILE* filters = open_output(std::string(prefix) + "_filters.csv");
+    if (filters == nullptr) {
+        return false;
+    }
+    fprintf(filters, "cutoff_hz,rms_error,max_error,step_noise\n");
+    for (const auto& score : scores) {
+        fprintf(filters, "%g,%.5f,%.5f,%.5f\n", score.cutoff_hz, score.rms_error, score.max_error, score.step_noise);
+    }
+    fclose(filters);
+    return true;
+}
+
+// Conversion error statistics over all blocks of `value - sample_temperature`.
+template <typename Value>
+static void conversion_error(const Results& results, Value value, double& mean, double& max_abs)
+{
+    double sum = 0.0;
+    uint64_t count = 0;
+    mean = NAN;
+    max_abs = 0.0;
+    for (const auto& block : results.blocks) {
+        const double error = value(block) - sample_temperature(block);
+        if (!std::isnan(error)) {
+            sum += error;
+            ++count;
+            max_abs = std::max(max_abs, std::abs(error));
+        }
+    }
+    if (count) {
+        mean = sum / count;
+    }
+}
+
+static void report(FILE* out, bool json, const CaptureReader& reader, const Options& options, unsigned threads,
+                   const Results& results, const std::vector<FilterScore>& scores)
+{
+    const auto& info = reader.info();
+    const double bin_hz = double(info.sample_rate_hz) / options.nfft;
+    const double seconds = double(reader.frame_count()) / info.sample_rate_hz;
+    const double samples = double(reader.frame_count()) * info.channels.size();
+    ChannelStats totals[kCaptureMaxChannels];
+    for (const auto& block : results.blocks) {
+        for (size_t c = 0; c < block.channels.size(); ++c) {
+            totals[c].merge(block.channels[c]);
+        }
+    }
+    const bool thermistor = info.channels[options.channel].bit_width == kAdcResolutionBits;
+    double frame_mean;
+    double frame_max;
+    double block_mean;
+    double block_max;
+    conversion_error(results, frame_temperature, frame_mean, frame_max);
+    conversion_error(
+        results, [&](const Block& block) { return block_temperature(block, options.channel); }, block_mean, block_max);
+
+    if (!json) {
+        fprintf(out, "%.1f s of %zu channels at %" PRIu32 " Hz, %u threads, %.3f s: %.0f MB/s, %.0f Msamples/s\n",
+                seconds, info.channels.size(), info.sample_rate_hz, threads, results.wall_s,
+                reader.size() / results.wall_s / 1e6, samples / results.wall_s / 1e6);
+        if (results.corrupt_chunks) {
+            fprintf(out, "%zu corrupt chunks skipped\n", results.corrupt_chunks);
+        }
+        for (size_t c = 0; c < info.channels.size(); ++c) {
+            fprintf(out, "  %-12.12s mean %.2f std %.2f min %u max %u, noise above %.0f Hz %.3f codes RMS\n",
+                    info.channels[c].name, totals[c].mean(), totals[c].stddev(), totals[c].min, totals[c].max,
+                    kNoiseBandHz, band_rms(results.psd[c], bin_hz, kNoiseBandHz));
+        }
+        if (!thermistor) {
+            return;
+        }
+        fprintf(out, "conversion vs per-sample mean: firmware frame %+.4f C mean, %.4f max; block mean %+.4f C mean, "
+                     "%.4f max\n",
+                frame_mean, frame_max, block_mean, block_max);
+        for (const auto& score : scores) {
+            fprintf(out, "  low-pass %-7g rms error %.4f C, max %.4f C, step noise %.4f C\n", score.cutoff_hz,
+                    score.rms_error, score.max_error, score.step_noise);
+        }
+        return;
+    }
+
+    fprintf(out, "{\n  \"file\": \"%s\",\n  \"seconds\": %.3f,\n  \"sample_rate_hz\": %" PRIu32 ",\n", options.path,
+            seconds, info.sample_rate_hz);
+    fprintf(out, "  \"threads\": %u,\n  \"wall_s\": %.4f,\n  \"corrupt_chunks\": %zu,\n  \"channels\": [\n", threads,
+            results.wall_s, results.corrupt_chunks);
+    for (size_t c = 0; c < info.channels.size(); ++c) {
+        fprintf(out,
+                "    {\"name\": \"%.12s\", \"mean\": %.4f, \"std\": %.4f, \"min\": %u, \"max\": %u, "
+                "\"noise_rms\": %.4f}%s\n",
+                info.channels[c].name, totals[c].mean(), totals[c].stddev(), totals[c].min, totals[c].max,
+                band_rms(results.psd[c], bin_hz, kNoiseBandHz), c + 1 < info.channels.size() ? "," : "");
+    }
+    fprintf(out, "  ]");
+    if (thermistor) {
+        fprintf(out,
+                ",\n  \"conversion\": {\"frame_bias\": %.5f, \"frame_max_error\": %.5f, \"block_bias\": %.5f, "
+                "\"block_max_error\": %.5f},\n  \"filters\": [\n",
+                frame_mean, frame_max, block_mean, block_max);
+        for (size_t i = 0; i < scores.size(); ++i) {
+            fprintf(out, "    {\"cutoff_hz\": %g, \"rms_error\": %.5f, \"max_error\": %.5f, \"step_noise\": %.5f}%s\n",
+                    scores[i].cutoff_hz, scores[i].rms_error, scores[i].max_error, scores[i].step_noise,
+                    i + 1 < scores.size() ? "," : "");
+        }
+        fprintf(out, "  ]");
+    }
+    fprintf(out, "\n}\n");
+}
+
+static bool parse(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (strcmp(arg, "--scaling") == 0) {
+            options.scaling = true;
+            continue;
+        }
+        if (arg[0] != '-' && options.path == nullptr) {
+            options.path = arg;
+            continue;
+        }
+        if (value == nullptr) {
+            return false;
+        }
+        ++i;
+        if (strcmp(arg, "--threads") == 0) {
+            options.threads = strtoul(value, nullptr, 0);
+        } else if (strcmp(arg, "--block") == 0) {
+            options.block_s = strtod(value, nullptr);
+        } else if (strcmp(arg, "--nfft") == 0) {
+            options.nfft = strtoul(value, nullptr, 0);
+        } else if (strcmp(arg, "--channel") == 0) {
+            options.channel = strtoul(value, nullptr, 0);
+        } else if (strcmp(arg, "--cutoff") == 0) {
+            options.cutoffs.push_back(strtof(value, nullptr));
+        } else if (strcmp(arg, "--csv") == 0) {
+            options.csv = value;
+        } else if (strcmp(arg, "--json") == 0) {
+            options.json = value;
+        } else {
+            return false;
+        }
+    }
+    if (options.cutoffs.empty()) {
+        options.cutoffs.push_back(HeaterControllerConfig{}.filter_cutoff_hz);
+    }
+    return options.path != nullptr && options.threads > 0 && options.block_s > 0.0 && options.nfft >= 16 &&
+           std::has_single_bit(options.nfft);
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parse(argc, argv, options)) {
+        fprintf(stderr,
+                "usage: %s FILE [--threads T] [--block S] [--nfft N] [--channel C] [--cutoff HZ]... [--csv PREFIX] "
+                "[--json FILE] [--scaling]\n",
+                argv[0]);
+        return 1;
+    }
+    CaptureReader reader;
+    std::string error;
+    if (!reader.open(options.path, error)) {
+        fprintf(stderr, "%s: %s\n", options.path, error.c_str());
+        return 1;
+    }
+    if (options.channel >= reader.info().channels.size()) {
+        fprintf(stderr, "%s: no channel %" PRIu32 "\n", options.path, options.channel);
+        return 1;
+    }
+    if (reader.info().channels[options.channel].bit_width != kAdcResolutionBits) {
+        fprintf(stderr, "%s: channel %" PRIu32 " is not %d-bit, skipping conversion and filters\n", options.path,
+                options.channel, kAdcResolutionBits);
+    }
+
+    if (options.scaling) {
+        printf("threads,mb_per_s,speedup\n");
+        double base = 0.0;
+        std::vector<unsigned> counts;
+        for (unsigned threads = 1; threads < options.threads; threads *= 2) {
+            counts.push_back(threads);
+        }
+        counts.push_back(options.threads);
+        for (const auto threads : counts) {
+            const double rate = reader.size() / analyse(reader, options, threads).wall_s / 1e6;
+            base = base == 0.0 ? rate : base;
+            printf("%u,%.0f,%.2f\n", threads, rate, rate / base);
+            fflush(stdout);
+        }
+        return 0;
+    }
+
+    const Results results = analyse(reader, options, options.threads);
+    const auto scores = score_filters(results, options);
+    report(stdout, false, reader, options, options.threads, results, scores);
+    if (options.csv != nullptr && !write_csv(options.csv, reader, options, results, scores)) {
+        return 1;
+    }
+    if (options.json != nullptr) {
+        FILE* json = open_output(options.json);
+        if (json == nullptr) {
+            return 1;
+        }
+        report(json, true, reader, options, options.threads, results, scores);
+        fclose(json);
+    }
+    return results.corrupt_chunks == 0 ? 0 : 1;
+}
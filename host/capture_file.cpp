@@ -0,0 +1,457 @@
+#include "capture_file.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+
+// Slicing-by-8 tables: kCrcTables[k][b] is the CRC of byte b followed by k zero bytes.
+static const auto kCrcTables = [] {
+    std::array<std::array<uint32_t, 256>, 8> tables{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = crc & 1 ? (crc >> 1) ^ 0xedb88320 : crc >> 1;
+        }
+        tables[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; ++i) {
+        for (int k = 1; k < 8; ++k) {
+            tables[k][i] = (tables[k - 1][i] >> 8) ^ tables[0][tables[k - 1][i] & 0xff];
+        }
+    }
+    return tables;
+}();
+
+uint32_t capture_crc32(const uint8_t* data, size_t size, uint32_t crc)
+{
+    const auto& t = kCrcTables;
+    crc = ~crc;
+    for (; size >= 8; data += 8, size -= 8) {
+        uint32_t lo;
+        uint32_t hi;
+        memcpy(&lo, data, 4);
+        memcpy(&hi, data + 4, 4);
+        lo ^= crc;
+        crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^ t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^
+              t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^ t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+    }
+    for (; size > 0; ++data, --size) {
+        crc = t[0][(crc ^ *data) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static uint32_t zigzag(int32_t value)
+{
+    return (uint32_t(value) << 1) ^ uint32_t(value >> 31);
+}
+
+static int32_t unzigzag(uint32_t value)
+{
+    return int32_t(value >> 1) ^ -int32_t(value & 1);
+}
+
+// Deltas of 16-bit samples need at most 17 bits after zigzag encoding.
+constexpr uint32_t kMaxDeltaBits = 17;
+
+void encode_capture_chunk(const uint16_t* samples, uint32_t frames, uint32_t channels, std::vector<uint8_t>& payload)
+{
+    payload.clear();
+    uint32_t deltas[kCaptureBlockSamples];
+    for (uint32_t c = 0; c < channels; ++c) {
+        int32_t previous = 0;
+        for (uint32_t block = 0; block < frames; block += kCaptureBlockSamples) {
+            const uint32_t count = std::min(kCaptureBlockSamples, frames - block);
+            uint32_t all = 0;
+            for (uint32_t i = 0; i < count; ++i) {
+                const int32_t value = samples[size_t(block + i) * channels + c];
+                deltas[i] = zigzag(value - previous);
+                all |= deltas[i];
+                previous = value;
+            }
+            const uint32_t width = std::bit_width(all);
+            payload.push_back(uint8_t(width));
+            uint64_t bits = 0;
+            uint32_t pending = 0;
+            for (uint32_t i = 0; i < count; ++i) {
+                bits |= uint64_t(deltas[i]) << pending;
+                pending += width;
+                while (pending >= 8) {
+                    payload.push_back(uint8_t(bits));
+                    bits >>= 8;
+                    pending -= 8;
+                }
+            }
+            if (pending > 0) {
+                payload.push_back(uint8_t(bits));
+            }
+        }
+    }
+}
+
+bool decode_capture_chunk(const uint8_t* payload, size_t size, uint32_t frames, uint32_t channels, uint16_t* samples)
+{
+    size_t pos = 0;
+    for (uint32_t c = 0; c < channels; ++c) {
+        int32_t previous = 0;
+        for (uint32_t block = 0; block < frames; block += kCaptureBlockSamples) {
+            const uint32_t count = std::min(kCaptureBlockSamples, frames - block);
+            if (pos >= size || payload[pos] > kMaxDeltaBits) {
+                return false;
+            }
+            const uint32_t width = payload[pos++];
+            const size_t bytes = (size_t(count) * width + 7) / 8;
+            if (bytes > size - pos) {
+                return false;
+            }
+            const uint8_t* in = payload + pos;
+            const uint32_t mask = (1u << width) - 1;
+            uint16_t* out = samples + size_t(block) * channels + c;
+            uint32_t deltas[kCaptureBlockSamples];
+            if (size - pos - bytes >= sizeof(uint64_t)) {
+                // Enough payload follows the block for every value to be one unaligned 8-byte load and a shift.
+                for (uint32_t i = 0, bit = 0; i < count; ++i, bit += width) {
+                    uint64_t word;
+                    memcpy(&word, in + bit / 8, sizeof(word));
+                    deltas[i] = uint32_t(word >> (bit % 8)) & mask;
+                }
+            } else {
+                uint64_t bits = 0;
+                uint32_t pending = 0;
+                for (uint32_t i = 0; i < count; ++i) {
+                    while (pending < width) {
+                        bits |= uint64_t(*in++) << pending;
+                        pending += 8;
+                    }
+                    deltas[i] = uint32_t(bits) & mask;
+                    bits >>= width;
+                    pending -= width;
+                }
+            }
+            uint32_t out_of_range = 0;
+            for (uint32_t i = 0; i < count; ++i) {
+                previous += unzigzag(deltas[i]);
+                out_of_range |= uint32_t(previous) >> 16;
+                out[size_t(i) * channels] = uint16_t(previous);
+            }
+            if (out_of_range != 0) {
+                return false;
+            }
+            pos += bytes;
+        }
+    }
+    return pos == size;
+}
+
+CaptureWriter::~CaptureWriter()
+{
+    if (file_ != nullptr) {
+        close();
+    }
+}
+
+bool CaptureWriter::write(const void* data, size_t size)
+{
+    if (fwrite(data, 1, size, file_) != size) {
+        return false;
+    }
+    offset_ += size;
+    return true;
+}
+
+bool CaptureWriter::open(const char* path, const CaptureInfo& info)
+{
+    if (info.channels.empty() || info.channels.size() > kCaptureMaxChannels || info.sample_rate_hz == 0 ||
+        info.chunk_frames == 0 || info.chunk_frames > kCaptureMaxChunkFrames) {
+        return false;
+    }
+    file_ = fopen(path, "wb");
+    if (file_ == nullptr) {
+        return false;
+    }
+    info_ = info;
+    pending_.clear();
+    pending_.reserve(size_t(info.chunk_frames) * info.channels.size());
+    index_.clear();
+    frames_ = 0;
+    offset_ = 0;
+
+    CaptureFileHeader header{};
+    header.magic = kCaptureMagic;
+    header.version = kCaptureVersion;
+    header.channel_count = uint16_t(info.channels.size());
+    header.sample_rate_hz = info.sample_rate_hz;
+    header.chunk_frames = info.chunk_frames;
+    header.start_time_us = info.start_time_us;
+    const size_t channels_size = info.channels.size() * sizeof(CaptureChannel);
+    header.crc = capture_crc32(reinterpret_cast<const uint8_t*>(&header), sizeof(header));
+    header.crc = capture_crc32(reinterpret_cast<const uint8_t*>(info.channels.data()), channels_size, header.crc);
+    return write(&header, sizeof(header)) && write(info.channels.data(), channels_size);
+}
+
+bool CaptureWriter::flush_chunk()
+{
+    const uint32_t channels = uint32_t(info_.channels.size());
+    const uint32_t frames = uint32_t(pending_.size() / channels);
+    encode_capture_chunk(pending_.data(), frames, channels, payload_);
+
+    CaptureChunkHeader header{};
+    header.magic = kCaptureChunkMagic;
+    header.frame_count = frames;
+    header.first_frame = frames_;
+    header.payload_size = uint32_t(payload_.size());
+    header.crc = capture_crc32(payload_.data(), payload_.size());
+    index_.push_back({frames_, offset_});
+    frames_ += frames;
+    pending_.clear();
+    return write(&header, sizeof(header)) && write(payload_.data(), payload_.size()) && fflush(file_) == 0;
+}
+
+bool CaptureWriter::append(const uint16_t* samples, size_t frames)
+{
+    if (file_ == nullptr) {
+        return false;
+    }
+    const size_t channels = info_.channels.size();
+    const size_t chunk_samples = size_t(info_.chunk_frames) * channels;
+    size_t remaining = frames * channels;
+    while (remaining > 0) {
+        const size_t take = std::min(remaining, chunk_samples - pending_.size());
+        pending_.insert(pending_.end(), samples, samples + take);
+        samples += take;
+        remaining -= take;
+        if (pending_.size() == chunk_samples && !flush_chunk()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CaptureWriter::close()
+{
+    if (file_ == nullptr) {
+        return false;
+    }
+    bool ok = pending_.empty() || flush_chunk();
+    CaptureFileFooter footer{};
+    footer.index_offset = offset_;
+    footer.frame_count = frames_;
+    footer.chunk_count = uint32_t(index_.size());
+    const size_t index_size = index_.size() * sizeof(CaptureIndexEntry);
+    footer.crc = capture_crc32(reinterpret_cast<const uint8_t*>(index_.data()), index_size);
+    footer.magic = kCaptureIndexMagic;
+    ok = ok && write(index_.data(), index_size) && write(&footer, sizeof(footer));
+    ok = fclose(file_) == 0 && ok;
+    file_ = nullptr;
+    return ok;
+}
+
+CaptureReader::~CaptureReader()
+{
+    if (mapped_) {
+        munmap(const_cast<uint8_t*>(data_), size_);
+    }
+}
+
+bool CaptureReader::open(const char* path, std::string& error)
+{
+    const int fd = ::open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        error = strerror(errno);
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return false;
+    }
+    void* data = st.st_size > 0 ? mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        error = st.st_size > 0 ? strerror(errno) : "empty file";
+        return false;
+    }
+    // Whole-file scans are the common case; let the kernel read ahead aggressively.
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+    data_ = static_cast<const uint8_t*>(data);
+    size_ = st.st_size;
+    mapped_ = true;
+    return parse(error);
+}
+
+bool CaptureReader::open(const uint8_t* data, size_t size, std::string& error)
+{
+    data_ = data;
+    size_ = size;
+    return parse(error);
+}
+
+bool CaptureReader::parse(std::string& error)
+{
+    CaptureFileHeader header;
+    if (size_ < sizeof(header)) {
+        error = "too short for a capture header";
+        return false;
+    }
+    memcpy(&header, data_, sizeof(header));
+    if (header.magic != kCaptureMagic) {
+        error = "not a capture file";
+        return false;
+    }
+    if (header.version != kCaptureVersion) {
+        error = "unsupported capture version " + std::to_string(header.version);
+        return false;
+    }
+    const size_t channels_size = size_t(header.channel_count) * sizeof(CaptureChannel);
+    if (header.channel_count == 0 || header.channel_count > kCaptureMaxChannels || header.sample_rate_hz == 0 ||
+        header.chunk_frames == 0 || header.chunk_frames > kCaptureMaxChunkFrames ||
+        size_ < sizeof(header) + channels_size) {
+        error = "malformed capture header";
+        return false;
+    }
+    const uint32_t crc = header.crc;
+    header.crc = 0;
+    if (capture_crc32(data_ + sizeof(header), channels_size,
+                      capture_crc32(reinterpret_cast<const uint8_t*>(&header), sizeof(header))) != crc) {
+        error = "capture header checksum mismatch";
+        return false;
+    }
+    info_.sample_rate_hz = header.sample_rate_hz;
+    info_.start_time_us = header.start_time_us;
+    info_.chunk_frames = header.chunk_frames;
+    info_.channels.resize(header.channel_count);
+    memcpy(info_.channels.data(), data_ + sizeof(header), channels_size);
+    chunks_offset_ = sizeof(header) + channels_size;
+
+    CaptureFileFooter footer{};
+    if (size_ >= chunks_offset_ + sizeof(footer)) {
+        memcpy(&footer, data_ + size_ - sizeof(footer), sizeof(footer));
+    }
+    if (!load_index(footer)) {
+        scan_chunks();
+    }
+    return true;
+}
+
+bool CaptureReader::load_index(const CaptureFileFooter& footer)
+{
+    const size_t index_size = size_t(footer.chunk_count) * sizeof(CaptureIndexEntry);
+    if (footer.magic != kCaptureIndexMagic || footer.index_offset < chunks_offset_ ||
+        footer.index_offset > size_ - sizeof(footer) || size_ - sizeof(footer) - footer.index_offset != index_size ||
+        capture_crc32(data_ + footer.index_offset, index_size) != footer.crc) {
+        return false;
+    }
+    index_.resize(footer.chunk_count);
+    memcpy(index_.data(), data_ + footer.index_offset, index_size);
+
+    // Entries must tile the frames and point at chunk headers that agree with them.
+    uint64_t expected_frame = 0;
+    for (const auto& entry : index_) {
+        CaptureChunkHeader header;
+        if (entry.first_frame != expected_frame || entry.offset < chunks_offset_ ||
+            entry.offset > footer.index_offset - sizeof(header)) {
+            index_.clear();
+            return false;
+        }
+        memcpy(&header, data_ + entry.offset, sizeof(header));
+        if (header.magic != kCaptureChunkMagic || header.first_frame != expected_frame || header.frame_count == 0 ||
+            header.frame_count > info_.chunk_frames ||
+            header.payload_size > footer.index_offset - entry.offset - sizeof(header)) {
+            index_.clear();
+            return false;
+        }
+        expected_frame += header.frame_count;
+    }
+    if (expected_frame != footer.frame_count) {
+        index_.clear();
+        return false;
+    }
+    frame_count_ = footer.frame_count;
+    return true;
+}
+
+void CaptureReader::scan_chunks()
+{
+    index_recovered_ = true;
+    index_.clear();
+    frame_count_ = 0;
+    size_t offset = chunks_offset_;
+    CaptureChunkHeader header;
+    while (size_ - offset >= sizeof(header)) {
+        memcpy(&header, data_ + offset, sizeof(header));
+        if (header.magic != kCaptureChunkMagic || header.first_frame != frame_count_ || header.frame_count == 0 ||
+            header.frame_count > info_.chunk_frames || header.payload_size > size_ - offset - sizeof(header)) {
+            break;
+        }
+        index_.push_back({frame_count_, offset});
+        frame_count_ += header.frame_count;
+        offset += sizeof(header) + header.payload_size;
+    }
+}
+
+uint32_t CaptureReader::chunk_frames(size_t i) const
+{
+    CaptureChunkHeader header;
+    memcpy(&header, data_ + index_[i].offset, sizeof(header));
+    return header.frame_count;
+}
+
+size_t CaptureReader::find_chunk(uint64_t frame) const
+{
+    const auto it = std::upper_bound(index_.begin(), index_.end(), frame,
+                                     [](uint64_t f, const CaptureIndexEntry& entry) { return f < entry.first_frame; });
+    return size_t(it - index_.begin()) - 1;
+}
+
+uint64_t CaptureReader::frame_at(double seconds) const
+{
+    if (!(seconds > 0.0)) {
+        return 0;
+    }
+    return uint64_t(std::min(std::ceil(seconds * info_.sample_rate_hz), double(frame_count_)));
+}
+
+bool CaptureReader::decode_chunk(size_t i, std::vector<uint16_t>& samples) const
+{
+    CaptureChunkHeader header;
+    memcpy(&header, data_ + index_[i].offset, sizeof(header));
+    const uint8_t* payload = data_ + index_[i].offset + sizeof(header);
+    if (capture_crc32(payload, header.payload_size) != header.crc) {
+        return false;
+    }
+    const uint32_t channels = uint32_t(info_.channels.size());
+    samples.resize(size_t(header.frame_count) * channels);
+    return decode_capture_chunk(payload, header.payload_size, header.frame_count, channels, samples.data());
+}
+
+bool CaptureReader::read(uint64_t first, size_t count, uint16_t* samples)
+{
+    if (first > frame_count_ || count > frame_count_ - first) {
+        return false;
+    }
+    const size_t channels = info_.channels.size();
+    while (count > 0) {
+        const size_t i = find_chunk(first);
+        if (i != cached_chunk_) {
+            cached_chunk_ = SIZE_MAX;
+            if (!decode_chunk(i, cache_)) {
+                return false;
+            }
+            cached_chunk_ = i;
+        }
+        const uint64_t offset = first - index_[i].first_frame;
+        const size_t take = std::min<uint64_t>(count, cache_.size() / channels - offset);
+        std::copy_n(cache_.begin() + offset * channels, take * channels, samples);
+        samples += take * channels;
+        first += take;
+        count -= take;
+    }
+    return true;
+}
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Container for raw ADC captures: written at the full sample rate in one pass, read back through a memory map.
+//
+// Layout, little-endian throughout:
+//   CaptureFileHeader and channel_count CaptureChannel entries
+//   chunks, each a CaptureChunkHeader and the payload of up to chunk_frames frames (one sample of every channel)
+//   one CaptureIndexEntry per chunk, then a CaptureFileFooter
+// Within a chunk each channel's samples are stored in turn as zigzag deltas from the previous sample, bit-packed in
+// blocks of kCaptureBlockSamples behind a width byte, so a quiet 10-bit signal takes a few bits per sample. Deltas
+// restart from 0 in every chunk, which keeps chunks independently decodable. A file whose writer never finished has
+// no valid footer; its chunks are then found by scanning from the header.
+
+constexpr uint32_t kCaptureMagic = 0x50414344;      // "DCAP"
+constexpr uint32_t kCaptureChunkMagic = 0x4b4e4843; // "CHNK"
+constexpr uint32_t kCaptureIndexMagic = 0x58444e49; // "INDX"
+constexpr uint16_t kCaptureVersion = 1;
+constexpr uint32_t kCaptureBlockSamples = 128;
+constexpr uint32_t kCaptureDefaultChunkFrames = 1 << 16;
+constexpr uint32_t kCaptureMaxChunkFrames = 1 << 20;
+constexpr uint32_t kCaptureMaxChannels = 16;
+
+struct CaptureFileHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t channel_count;
+    uint32_t sample_rate_hz;
+    uint32_t chunk_frames;
+    // Wall-clock time of the first frame in microseconds since the Unix epoch, 0 if unknown.
+    uint64_t start_time_us;
+    uint32_t reserved;
+    // CRC-32 of this header with crc zeroed, followed by the channel entries.
+    uint32_t crc;
+};
+
+struct CaptureChannel
+{
+    uint8_t unit;
+    uint8_t channel;
+    uint8_t bit_width;
+    // adc_atten_t of the channel.
+    uint8_t attenuation;
+    char name[12];
+};
+
+struct CaptureChunkHeader
+{
+    uint32_t magic;
+    uint32_t frame_count;
+    uint64_t first_frame;
+    uint32_t payload_size;
+    // CRC-32 of the payload.
+    uint32_t crc;
+};
+
+struct CaptureIndexEntry
+{
+    uint64_t first_frame;
+    // File offset of the chunk header.
+    uint64_t offset;
+};
+
+struct CaptureFileFooter
+{
+    uint64_t index_offset;
+    uint64_t frame_count;
+    uint32_t chunk_count;
+    // CRC-32 of the index entries.
+    uint32_t crc;
+    uint32_t reserved;
+    uint32_t magic;
+};
+
+static_assert(sizeof(CaptureFileHeader) == 32 && sizeof(CaptureChannel) == 16 && sizeof(CaptureChunkHeader) == 24 &&
+                  sizeof(CaptureIndexEntry) == 16 && sizeof(CaptureFileFooter) == 32,
+              "capture structures are written as is");
+
+struct CaptureInfo
+{
+    uint32_t sample_rate_hz = 0;
+    uint64_t start_time_us = 0;
+    uint32_t chunk_frames = kCaptureDefaultChunkFrames;
+    std::vector<CaptureChannel> channels;
+};
+
+uint32_t capture_crc32(const uint8_t* data, size_t size, uint32_t crc = 0);
+
+// Encodes one chunk's worth of interleaved frames into `payload`, replacing its contents.
+void encode_capture_chunk(const uint16_t* samples, uint32_t frames, uint32_t channels, std::vector<uint8_t>& payload);
+// Decodes a chunk payload into interleaved frames. Returns false unless the payload holds exactly `frames` frames.
+bool decode_capture_chunk(const uint8_t* payload, size_t size, uint32_t frames, uint32_t channels, uint16_t* samples);
+
+class CaptureWriter
+{
+public:
+    CaptureWriter() = default;
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+    ~CaptureWriter();
+
+    bool open(const char* path, const CaptureInfo& info);
+    // Appends `frames` frames of interleaved samples. Every completed chunk goes to disk at once, so a writer that
+    // dies loses at most the chunk in progress.
+    bool append(const uint16_t* samples, size_t frames);
+    // Writes the last partial chunk, the index and the footer.
+    bool close();
+
+    uint64_t frame_count() const { return frames_; }
+    uint64_t size() const { return offset_; }
+
+private:
+    bool write(const void* data, size_t size);
+    bool flush_chunk();
+
+    FILE* file_ = nullptr;
+    CaptureInfo info_;
+    std::vector<uint16_t> pending_;
+    std::vector<uint8_t> payload_;
+    std::vector<CaptureIndexEntry> index_;
+    uint64_t frames_ = 0;
+    uint64_t offset_ = 0;
+};
+
+class CaptureReader
+{
+public:
+    CaptureReader() = default;
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+    ~CaptureReader();
+
+    // Maps the file read-only.
+    bool open(const char* path, std::string& error);
+    // Reads a capture already in memory, which must outlive the reader.
+    bool open(const uint8_t* data, size_t size, std::string& error);
+
+    const CaptureInfo& info() const { return info_; }
+    uint64_t frame_count() const { return frame_count_; }
+    size_t chunk_count() const { return index_.size(); }
+    const CaptureIndexEntry& chunk(size_t i) const { return index_[i]; }
+    uint32_t chunk_frames(size_t i) const;
+    size_t size() const { return size_; }
+    // True if the footer was missing or damaged and the chunks were found by scanning.
+    bool index_recovered() const { return index_recovered_; }
+
+    // Chunk holding `frame`, by binary search of the index. `frame` must be below frame_count().
+    size_t find_chunk(uint64_t frame) const;
+    // First frame at or after `seconds` into the capture, clamped to frame_count().
+    uint64_t frame_at(double seconds) const;
+
+    // Checks the chunk's CRC and decodes it into `samples`, resized to hold its interleaved frames. Safe to call
+    // from several threads at once.
+    bool decode_chunk(size_t i, std::vector<uint16_t>& samples) const;
+    // Copies frames [first, first + count) into `samples`. Keeps the last decoded chunk, so sequential reads of any
+    // size decode each chunk once; not thread-safe.
+    bool read(uint64_t first, size_t count, uint16_t* samples);
+
+private:
+    bool parse(std::string& error);
+    bool load_index(const CaptureFileFooter& footer);
+    void scan_chunks();
+
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    CaptureInfo info_;
+    size_t chunks_offset_ = 0;
+    std::vector<CaptureIndexEntry> index_;
+    uint64_t frame_count_ = 0;
+    bool index_recovered_ = false;
+    size_t cached_chunk_ = SIZE_MAX;
+    std::vector<uint16_t> cache_;
+};
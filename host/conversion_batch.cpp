@@ -0,0 +1,167 @@
+#include "conversion_batch.hpp"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+// The vector paths mirror the expression trees of correct_adc, thermistor_temperature and adc_voltage:
+//   corrected   = ((c0 + c1 * raw) + c2 * float(raw * raw)) + c3 * (float(raw * raw) * raw)   in float
+//   temperature = float((double(c0) + c1 * double(corrected)) + double(c2 * corrected^2))    c1 is double
+//   voltage     = corrected * reference / 2^bits                                             in float
+// They must not be contracted into fused multiply-adds, which the host build disables with -ffp-contract=off.
+
+static void convert_scalar(const uint16_t* raw, size_t count, float* corrected, float* temperature, float* voltage,
+                           const AdcCorrection& adc, const ThermistorCurve& curve)
+{
+    for (size_t i = 0; i < count; ++i) {
+        const Reading reading = convert_reading(raw[i], adc, curve);
+        if (corrected != nullptr) {
+            corrected[i] = reading.corrected;
+        }
+        if (temperature != nullptr) {
+            temperature[i] = reading.temperature;
+        }
+        if (voltage != nullptr) {
+            voltage[i] = reading.voltage;
+        }
+    }
+}
+
+#if defined(__x86_64__)
+
+// Built for AVX2 without FMA, so the compiler has no fused instruction to contract into either.
+__attribute__((target("avx2"))) static size_t convert_avx2(const uint16_t* raw, size_t count, float* corrected,
+                                                           float* temperature, float* voltage,
+                                                           const AdcCorrection& adc, const ThermistorCurve& curve)
+{
+    const __m256 a0 = _mm256_set1_ps(adc.c0);
+    const __m256 a1 = _mm256_set1_ps(adc.c1);
+    const __m256 a2 = _mm256_set1_ps(adc.c2);
+    const __m256 a3 = _mm256_set1_ps(adc.c3);
+    const __m256d t0 = _mm256_set1_pd(curve.c0);
+    const __m256d t1 = _mm256_set1_pd(curve.c1);
+    const __m256 t2 = _mm256_set1_ps(curve.c2);
+    const __m256 reference = _mm256_set1_ps(kAdcReferenceVoltage);
+    const __m256 full_scale = _mm256_set1_ps(1 << kAdcResolutionBits);
+    const __m256 half_word = _mm256_set1_ps(65536.0f);
+    const __m256i low_mask = _mm256_set1_epi32(0xffff);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i code = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(raw + i)));
+        const __m256 x = _mm256_cvtepi32_ps(code);
+        // raw * raw is an unsigned 32-bit product. Converting its halves is exact, so the only rounding is in
+        // their sum, as in the scalar unsigned-to-float conversion.
+        const __m256i square = _mm256_mullo_epi32(code, code);
+        const __m256 x2 = _mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(square, 16)), half_word),
+                                        _mm256_cvtepi32_ps(_mm256_and_si256(square, low_mask)));
+        const __m256 x3 = _mm256_mul_ps(x2, x);
+        const __m256 corr = _mm256_add_ps(
+            _mm256_add_ps(_mm256_add_ps(a0, _mm256_mul_ps(a1, x)), _mm256_mul_ps(a2, x2)), _mm256_mul_ps(a3, x3));
+
+        if (corrected != nullptr) {
+            _mm256_storeu_ps(corrected + i, corr);
+        }
+        if (temperature != nullptr) {
+            const __m256 quadratic = _mm256_mul_ps(t2, _mm256_mul_ps(corr, corr));
+            const __m128 corr_lo = _mm256_castps256_ps128(corr);
+            const __m128 corr_hi = _mm256_extractf128_ps(corr, 1);
+            const __m256d lo = _mm256_add_pd(_mm256_add_pd(t0, _mm256_mul_pd(t1, _mm256_cvtps_pd(corr_lo))),
+                                             _mm256_cvtps_pd(_mm256_castps256_ps128(quadratic)));
+            const __m256d hi = _mm256_add_pd(_mm256_add_pd(t0, _mm256_mul_pd(t1, _mm256_cvtps_pd(corr_hi))),
+                                             _mm256_cvtps_pd(_mm256_extractf128_ps(quadratic, 1)));
+            _mm256_storeu_ps(temperature + i, _mm256_set_m128(_mm256_cvtpd_ps(hi), _mm256_cvtpd_ps(lo)));
+        }
+        if (voltage != nullptr) {
+            _mm256_storeu_ps(voltage + i, _mm256_div_ps(_mm256_mul_ps(corr, reference), full_scale));
+        }
+    }
+    return i;
+}
+
+#elif defined(__aarch64__)
+
+static size_t convert_neon(const uint16_t* raw, size_t count, float* corrected, float* temperature, float* voltage,
+                           const AdcCorrection& adc, const ThermistorCurve& curve)
+{
+    const float32x4_t a0 = vdupq_n_f32(adc.c0);
+    const float32x4_t a1 = vdupq_n_f32(adc.c1);
+    const float32x4_t a2 = vdupq_n_f32(adc.c2);
+    const float32x4_t a3 = vdupq_n_f32(adc.c3);
+    const float64x2_t t0 = vdupq_n_f64(curve.c0);
+    const float64x2_t t1 = vdupq_n_f64(curve.c1);
+    const float32x4_t t2 = vdupq_n_f32(curve.c2);
+    const float32x4_t reference = vdupq_n_f32(kAdcReferenceVoltage);
+    const float32x4_t full_scale = vdupq_n_f32(1 << kAdcResolutionBits);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const uint32x4_t code = vmovl_u16(vld1_u16(raw + i));
+        const float32x4_t x = vcvtq_f32_u32(code);
+        const float32x4_t x2 = vcvtq_f32_u32(vmulq_u32(code, code));
+        const float32x4_t x3 = vmulq_f32(x2, x);
+        const float32x4_t corr =
+            vaddq_f32(vaddq_f32(vaddq_f32(a0, vmulq_f32(a1, x)), vmulq_f32(a2, x2)), vmulq_f32(a3, x3));
+
+        if (corrected != nullptr) {
+            vst1q_f32(corrected + i, corr);
+        }
+        if (temperature != nullptr) {
+            const float32x4_t quadratic = vmulq_f32(t2, vmulq_f32(corr, corr));
+            const float64x2_t lo = vaddq_f64(vaddq_f64(t0, vmulq_f64(t1, vcvt_f64_f32(vget_low_f32(corr)))),
+                                             vcvt_f64_f32(vget_low_f32(quadratic)));
+            const float64x2_t hi = vaddq_f64(vaddq_f64(t0, vmulq_f64(t1, vcvt_high_f64_f32(corr))),
+                                             vcvt_high_f64_f32(quadratic));
+            vst1q_f32(temperature + i, vcvt_high_f32_f64(vcvt_f32_f64(lo), hi));
+        }
+        if (voltage != nullptr) {
+            vst1q_f32(voltage + i, vdivq_f32(vmulq_f32(corr, reference), full_scale));
+        }
+    }
+    return i;
+}
+
+#endif
+
+ConversionIsa conversion_isa()
+{
+#if defined(__x86_64__)
+    return __builtin_cpu_supports("avx2") ? ConversionIsa::Avx2 : ConversionIsa::Scalar;
+#elif defined(__aarch64__)
+    return ConversionIsa::Neon;
+#else
+    return ConversionIsa::Scalar;
+#endif
+}
+
+const char* conversion_isa_name(ConversionIsa isa)
+{
+    switch (isa) {
+    case ConversionIsa::Scalar:
+        return "scalar";
+    case ConversionIsa::Avx2:
+        return "avx2";
+    case ConversionIsa::Neon:
+        return "neon";
+    }
+    return "?";
+}
+
+void convert_readings(const uint16_t* raw, size_t count, float* corrected, float* temperature, float* voltage,
+                      const AdcCorrection& adc, const ThermistorCurve& curve, ConversionIsa isa)
+{
+    size_t done = 0;
+#if defined(__x86_64__)
+    if (isa == ConversionIsa::Avx2 && conversion_isa() == ConversionIsa::Avx2) {
+        done = convert_avx2(raw, count, corrected, temperature, voltage, adc, curve);
+    }
+#elif defined(__aarch64__)
+    if (isa == ConversionIsa::Neon) {
+        done = convert_neon(raw, count, corrected, temperature, voltage, adc, curve);
+    }
+#endif
+    const auto offset = [done](float* out) { return out != nullptr ? out + done : nullptr; };
+    convert_scalar(raw + done, count - done, offset(corrected), offset(temperature), offset(voltage), adc, curve);
+}
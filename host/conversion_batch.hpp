@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "conversion.hpp"
+
+// The firmware's conversion chain (convert_reading) over arrays of raw codes, for analysis of captures and for the
+// Python bindings. Every path performs the same float and double operations in the same order as the scalar code,
+// so results are bit-identical to it for every 16-bit code; conversion_bench checks this exhaustively.
+
+enum class ConversionIsa : uint8_t
+{
+    Scalar,
+    Avx2,
+    Neon,
+};
+
+// Widest instruction set this CPU supports.
+ConversionIsa conversion_isa();
+const char* conversion_isa_name(ConversionIsa isa);
+
+// Converts `count` codes, writing each output array that isn't null. An `isa` the CPU lacks falls back to scalar.
+void convert_readings(const uint16_t* raw, size_t count, float* corrected, float* temperature, float* voltage,
+                      const AdcCorrection& adc = kAdcCorrection, const ThermistorCurve& curve = kThermistorCurve,
+                      ConversionIsa isa = conversion_isa());
@@ -0,0 +1,102 @@
+// Checks the batch conversion paths (conversion_batch.hpp) against the firmware's scalar convert_reading for every
+// 16-bit code, under the firmware calibration and a perturbed one, then measures their throughput.
+//
+//   conversion_bench [--samples N]
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "conversion_batch.hpp"
+
+static bool same_bits(float a, float b)
+{
+    return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+// Number of codes where `isa` differs from convert_reading in any output bit.
+static size_t mismatches(ConversionIsa isa, const AdcCorrection& adc, const ThermistorCurve& curve)
+{
+    constexpr size_t kCodes = 1 << 16;
+    std::vector<uint16_t> raw(kCodes);
+    for (size_t code = 0; code < kCodes; ++code) {
+        raw[code] = uint16_t(code);
+    }
+    std::vector<float> corrected(kCodes);
+    std::vector<float> temperature(kCodes);
+    std::vector<float> voltage(kCodes);
+    convert_readings(raw.data(), kCodes, corrected.data(), temperature.data(), voltage.data(), adc, curve, isa);
+    size_t count = 0;
+    for (size_t code = 0; code < kCodes; ++code) {
+        const Reading expected = convert_reading(uint32_t(code), adc, curve);
+        if (!same_bits(corrected[code], expected.corrected) || !same_bits(temperature[code], expected.temperature) ||
+            !same_bits(voltage[code], expected.voltage)) {
+            if (count == 0) {
+                fprintf(stderr, "%s: code %zu gives %a %a %a, expected %a %a %a\n", conversion_isa_name(isa), code,
+                        corrected[code], temperature[code], voltage[code], expected.corrected, expected.temperature,
+                        expected.voltage);
+            }
+            ++count;
+        }
+    }
+    return count;
+}
+
+// Msamples per second converting `raw` repeatedly, with either all outputs or the temperature only.
+static double throughput(ConversionIsa isa, const std::vector<uint16_t>& raw, bool all_outputs)
+{
+    std::vector<float> corrected(raw.size());
+    std::vector<float> temperature(raw.size());
+    std::vector<float> voltage(raw.size());
+    double best = 1e9;
+    for (int run = 0; run < 5; ++run) {
+        const auto start = std::chrono::steady_clock::now();
+        convert_readings(raw.data(), raw.size(), all_outputs ? corrected.data() : nullptr, temperature.data(),
+                         all_outputs ? voltage.data() : nullptr, kAdcCorrection, kThermistorCurve, isa);
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    return raw.size() / best / 1e6;
+}
+
+int main(int argc, char** argv)
+{
+    size_t samples = 1 << 20;
+    if (argc == 3 && strcmp(argv[1], "--samples") == 0) {
+        samples = strtoull(argv[2], nullptr, 0);
+    } else if (argc != 1) {
+        fprintf(stderr, "usage: %s [--samples N]\n", argv[0]);
+        return 1;
+    }
+
+    const AdcCorrection perturbed_adc{kAdcCorrection.c0 * 1.01f, kAdcCorrection.c1 * 0.99f, kAdcCorrection.c2 * 1.1f,
+                                      kAdcCorrection.c3 * 0.9f};
+    const ThermistorCurve perturbed_curve{kThermistorCurve.c0 + 0.5f, kThermistorCurve.c1 * 1.02,
+                                          kThermistorCurve.c2 * 0.95f};
+    std::vector<ConversionIsa> isas{ConversionIsa::Scalar};
+    if (conversion_isa() != ConversionIsa::Scalar) {
+        isas.push_back(conversion_isa());
+    }
+
+    std::mt19937 rng(1);
+    std::normal_distribution<float> noise(0.0f, 2.0f);
+    std::vector<uint16_t> raw(samples);
+    for (size_t i = 0; i < samples; ++i) {
+        raw[i] = uint16_t(std::clamp(600.0f + 200.0f * float(i) / samples + noise(rng), 0.0f, 1023.0f));
+    }
+
+    bool ok = true;
+    printf("%-8s %12s %16s %16s\n", "isa", "mismatches", "all Msamples/s", "temp Msamples/s");
+    for (const auto isa : isas) {
+        const size_t bad = mismatches(isa, kAdcCorrection, kThermistorCurve) +
+                           mismatches(isa, perturbed_adc, perturbed_curve);
+        ok = ok && bad == 0;
+        printf("%-8s %12zu %16.0f %16.0f\n", conversion_isa_name(isa), bad, throughput(isa, raw, true),
+               throughput(isa, raw, false));
+    }
+    return ok ? 0 : 1;
+}
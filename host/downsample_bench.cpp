@@ -0,0 +1,210 @@
+// Benchmarks dashboard history downsampling: response time and JSON payload size for typical query ranges,
+// comparing min/max buckets and LTTB, fed from raw 1 Hz samples and from 1 minute rollups.
+//
+//   downsample_bench [--check]
+//
+// --check instead compares the streaming LTTB with a plain one on a series whose buckets both split alike, and
+// checks that a spike in the first rollup survives; exits non-zero if either differs.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "history.hpp"
+
+constexpr uint32_t kRollupPeriod = 60;
+constexpr uint32_t kMaxPoints = 1000;
+
+// Drying cycles of a few hours with sensor noise and the occasional door-open dip.
+static std::vector<HistoryPoint> make_history(uint32_t seconds)
+{
+    std::mt19937 rng(1234);
+    std::normal_distribution<float> noise(0.0f, 0.15f);
+    std::uniform_int_distribution<uint32_t> dip(0, 20'000);
+
+    std::vector<HistoryPoint> points;
+    points.reserve(seconds);
+    float temp = 22.0f;
+    for (uint32_t t = 0; t < seconds; ++t) {
+        const bool heating = (t / 3600) % 8 < 6;
+        const float target = heating ? 55.0f : 22.0f;
+        temp += (target - temp) * 0.0015f;
+        if (dip(rng) == 0) {
+            temp -= 12.0f;
+        }
+        points.push_back({t, temp + noise(rng)});
+    }
+    return points;
+}
+
+static void append_json(std::string& out, const HistoryPoint& p)
+{
+    char buf[32];
+    const int len = snprintf(buf, sizeof(buf), "%s[%lu,%.1f]", out.size() > 1 ? "," : "", (unsigned long)p.time, p.value);
+    out.append(buf, len);
+}
+
+template <typename Input, typename MakeDownsampler>
+static void run(const char* name, const char* source, const std::vector<Input>& input, uint32_t range,
+                MakeDownsampler make)
+{
+    constexpr int kRepeats = 5;
+    std::string json;
+    size_t points = 0;
+    double best_ms = 1e30;
+    for (int r = 0; r < kRepeats; ++r) {
+        json.assign(1, '[');
+        points = 0;
+        auto sink = [&](const HistoryPoint& p) {
+            append_json(json, p);
+            ++points;
+        };
+        const auto start = std::chrono::steady_clock::now();
+        auto downsampler = make(sink);
+        for (const auto& item : input) {
+            downsampler.add(item);
+        }
+        downsampler.finish();
+        json += "]";
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        best_ms = std::min(best_ms, elapsed.count());
+    }
+    char label[16];
+    snprintf(label, sizeof(label), range >= 86400 ? "%lud" : "%luh", (unsigned long)(range >= 86400 ? range / 86400 : range / 3600));
+    printf("%-8s %-8s %-8s %10zu %8zu %10zu %10.3f\n", name, source, label, input.size(), points, json.size(), best_ms);
+}
+
+// LTTB as Steinarsson gives it: the first and last points, and from each of `threshold - 2` buckets of the points
+// between them the one making the largest triangle with the point chosen before it and the next bucket's average.
+static std::vector<HistoryPoint> reference_lttb(const std::vector<HistoryPoint>& data, size_t threshold)
+{
+    if (threshold < 3 || threshold >= data.size()) {
+        return data;
+    }
+    std::vector<HistoryPoint> sampled{data.front()};
+    const double every = double(data.size() - 2) / double(threshold - 2);
+    HistoryPoint a = data.front();
+    for (size_t i = 0; i < threshold - 2; ++i) {
+        const size_t start = size_t(std::floor(double(i) * every)) + 1;
+        const size_t end = size_t(std::floor(double(i + 1) * every)) + 1;
+        const size_t next_end = std::min(size_t(std::floor(double(i + 2) * every)) + 1, data.size());
+        double next_time = 0.0;
+        double next_value = 0.0;
+        for (size_t j = end; j < next_end; ++j) {
+            next_time += data[j].time;
+            next_value += double(data[j].value);
+        }
+        next_time /= double(next_end - end);
+        next_value /= double(next_end - end);
+
+        double best_area = -1.0;
+        HistoryPoint best = data[start];
+        for (size_t j = start; j < end; ++j) {
+            const auto& c = data[j];
+            const double area = std::abs((double(a.time) - next_time) * (double(c.value) - a.value) -
+                                         (double(a.time) - double(c.time)) * (next_value - a.value));
+            if (area > best_area) {
+                best_area = area;
+                best = c;
+            }
+        }
+        sampled.push_back(best);
+        a = best;
+    }
+    sampled.push_back(data.back());
+    return sampled;
+}
+
+static bool check()
+{
+    // Buckets of kWidth points from time 1 on line up with the reference's, and a candidate pair per point makes
+    // the streaming preselection keep every point.
+    constexpr uint32_t kBuckets = 100;
+    constexpr uint32_t kWidth = 8;
+    const auto series = make_history(kBuckets * kWidth + 2);
+    std::vector<HistoryPoint> streamed;
+    LttbDownsampler<std::function<void(const HistoryPoint&)>, 2 * kWidth> lttb(
+        1, kBuckets * kWidth + 1, kBuckets + 2, [&](const HistoryPoint& p) { streamed.push_back(p); });
+    for (const auto& p : series) {
+        lttb.add(p);
+    }
+    lttb.finish();
+    const auto expected = reference_lttb(series, kBuckets + 2);
+    bool ok = streamed.size() == expected.size();
+    for (size_t i = 0; ok && i < streamed.size(); ++i) {
+        if (streamed[i].time != expected[i].time || streamed[i].value != expected[i].value) {
+            printf("lttb point %zu: (%lu, %.3f), the reference has (%lu, %.3f)\n", i, (unsigned long)streamed[i].time,
+                   streamed[i].value, (unsigned long)expected[i].time, expected[i].value);
+            ok = false;
+        }
+    }
+    printf("lttb: %zu points, the reference %zu, %s\n", streamed.size(), expected.size(),
+           ok ? "the same" : "different");
+
+    // A dip and then a spike opening the first rollup: the dip is the first point, the spike the rollup's other
+    // extreme.
+    auto flat = make_history(kRollupPeriod * 60);
+    flat[0].value -= 40.0f;
+    flat[1].value += 40.0f;
+    std::vector<Rollup> rollups;
+    RollupAccumulator accumulator(kRollupPeriod, [&](const Rollup& r) { rollups.push_back(r); });
+    for (const auto& p : flat) {
+        accumulator.add(p);
+    }
+    accumulator.flush();
+    bool spike = false;
+    LttbDownsampler from_rollups(0, uint32_t(flat.size()), 20, [&](const HistoryPoint& p) {
+        spike = spike || (p.time == flat[1].time && p.value == flat[1].value);
+    });
+    for (const auto& r : rollups) {
+        from_rollups.add(r);
+    }
+    from_rollups.finish();
+    printf("lttb from rollups: the first rollup's spike %s\n", spike ? "kept" : "lost");
+    return ok && spike;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc == 2 && strcmp(argv[1], "--check") == 0) {
+        return check() ? 0 : 1;
+    }
+    if (argc != 1) {
+        fprintf(stderr, "usage: %s [--check]\n", argv[0]);
+        return 1;
+    }
+
+    const uint32_t ranges[] = {3600, 86400, 7 * 86400, 28 * 86400};
+    const auto history = make_history(ranges[3]);
+
+    printf("%-8s %-8s %-8s %10s %8s %10s %10s\n", "algo", "source", "range", "input", "points", "bytes", "ms");
+    for (const auto range : ranges) {
+        const std::vector<HistoryPoint> raw(history.begin(), history.begin() + range);
+
+        std::vector<Rollup> rollups;
+        RollupAccumulator accumulator(kRollupPeriod, [&](const Rollup& r) { rollups.push_back(r); });
+        for (const auto& p : raw) {
+            accumulator.add(p);
+        }
+        accumulator.flush();
+
+        std::string raw_json(1, '[');
+        for (const auto& p : raw) {
+            append_json(raw_json, p);
+        }
+        printf("%-8s %-8s %-8s %10zu %8zu %10zu %10s\n", "none", "raw", "", raw.size(), raw.size(), raw_json.size() + 1, "-");
+
+        auto minmax = [&](auto sink) { return MinMaxDownsampler(0, range, kMaxPoints, sink); };
+        auto lttb = [&](auto sink) { return LttbDownsampler(0, range, kMaxPoints, sink); };
+        run("minmax", "raw", raw, range, minmax);
+        run("minmax", "rollup", rollups, range, minmax);
+        run("lttb", "raw", raw, range, lttb);
+        run("lttb", "rollup", rollups, range, lttb);
+    }
+    return 0;
+}
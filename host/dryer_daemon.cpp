@@ -0,0 +1,212 @@
+// Runs the host build of the firmware as a stand-in device behind a pseudo-terminal. Console output goes to the
+// pty exactly as the ESP32 prints it on UART0, paced against the wall clock at real time or any speed-up, so serial
+// tools and dashboards can be developed and load-tested without hardware.
+//
+//   dryer_daemon [--speed X] [--hours H] [--seed N] [--link PATH] [--history FILE] [--faults FILE]
+//                [--telemetry FILE]
+//
+// The pty's slave path is printed on stdout; --link also symlinks it, e.g. to /tmp/dryer0. --speed 0 runs as fast
+// as the simulation goes. Like a UART with nobody listening, output is dropped while the pty buffer is full rather
+// than stalling the device. --telemetry writes the binary frames the firmware sends on its telemetry UART to a file or
+// FIFO. SIGINT or SIGTERM stops the daemon and saves --history.
+
+#include <fcntl.h>
+#include <signal.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "idf_sim.hpp"
+#include "sim_board.hpp"
+#include "sim_files.hpp"
+
+extern "C" void app_main();
+
+// Pins the firmware uses; kept in step with main.cpp.
+constexpr auto kHeaterGpio = GPIO_NUM_25;
+constexpr auto kThermistorChannel = ADC_CHANNEL_6;
+
+// Virtual time advanced between checks of the wall clock and the pty.
+constexpr uint64_t kSliceUs = 10'000;
+
+static volatile sig_atomic_t s_stop = 0;
+
+struct PtyOutput
+{
+    int fd;
+    uint64_t written = 0;
+    uint64_t dropped = 0;
+    std::string line = {};
+};
+
+static ssize_t pty_write(void* cookie, const char* data, size_t size)
+{
+    auto* pty = static_cast<PtyOutput*>(cookie);
+    const char* bytes = data;
+    size_t length = size;
+#if CONFIG_NEWLIB_STDOUT_LINE_ENDING_CRLF
+    // newlib on the device turns every "\n" on stdout into "\r\n".
+    pty->line.clear();
+    for (size_t i = 0; i < size; ++i) {
+        if (data[i] == '\n') {
+            pty->line += '\r';
+        }
+        pty->line += data[i];
+    }
+    bytes = pty->line.data();
+    length = pty->line.size();
+#endif
+    size_t done = 0;
+    while (done < length) {
+        const ssize_t n = write(pty->fd, bytes + done, length - done);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            pty->dropped += length - done;
+            break;
+        }
+        done += n;
+    }
+    pty->written += done;
+    return size;
+}
+
+int main(int argc, char** argv)
+{
+    double speed = 1.0;
+    double hours = 0.0;
+    uint32_t seed = 1;
+    const char* link = nullptr;
+    const char* history = nullptr;
+    const char* faults = nullptr;
+    const char* telemetry = nullptr;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--speed") == 0) {
+            speed = strtod(argv[i + 1], nullptr);
+        } else if (strcmp(argv[i], "--hours") == 0) {
+            hours = strtod(argv[i + 1], nullptr);
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            seed = strtoul(argv[i + 1], nullptr, 0);
+        } else if (strcmp(argv[i], "--link") == 0) {
+            link = argv[i + 1];
+        } else if (strcmp(argv[i], "--history") == 0) {
+            history = argv[i + 1];
+        } else if (strcmp(argv[i], "--faults") == 0) {
+            faults = argv[i + 1];
+        } else if (strcmp(argv[i], "--telemetry") == 0) {
+            telemetry = argv[i + 1];
+        } else {
+            argc = 0;
+        }
+    }
+    if (argc % 2 == 0 || speed < 0.0 || hours < 0.0) {
+        fprintf(stderr,
+                "usage: %s [--speed X] [--hours H] [--seed N] [--link PATH] [--history FILE] [--faults FILE]\n"
+                "       %*s [--telemetry FILE]\n",
+                argv[0], int(strlen(argv[0])), "");
+        return 1;
+    }
+
+    const int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        perror("posix_openpt");
+        return 1;
+    }
+    const char* slave_path = ptsname(master);
+    // Holding the slave open keeps the pty alive between clients, and raw mode makes it pass bytes through like
+    // a UART.
+    const int slave = open(slave_path, O_RDWR | O_NOCTTY);
+    termios tio;
+    if (slave < 0 || tcgetattr(slave, &tio) != 0) {
+        perror(slave_path);
+        return 1;
+    }
+    cfmakeraw(&tio);
+    cfsetspeed(&tio, B115200);
+    tcsetattr(slave, TCSANOW, &tio);
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+    if (link != nullptr) {
+        unlink(link);
+        if (symlink(slave_path, link) != 0) {
+            perror(link);
+            return 1;
+        }
+    }
+
+    PtyOutput pty{master};
+    FILE* console = fopencookie(&pty, "w", {nullptr, pty_write, nullptr, nullptr});
+    setvbuf(console, nullptr, _IOLBF, 1024);
+    sim_log_set_output(console);
+    FILE* frames = nullptr;
+    if (telemetry != nullptr) {
+        if ((frames = fopen(telemetry, "wb")) == nullptr) {
+            perror(telemetry);
+            return 1;
+        }
+        sim_uart_set_output(static_cast<uart_port_t>(CONFIG_DRYER_TELEMETRY_UART_NUM), frames);
+    }
+
+    std::vector<uint8_t>* flash = nullptr;
+    if (history != nullptr && (flash = load_history_partition(history)) == nullptr) {
+        return 1;
+    }
+    if (faults != nullptr && !load_fault_script(faults, seed)) {
+        return 1;
+    }
+
+    SimBoard board(PlantParams{}, seed, kHeaterGpio, kThermistorChannel);
+    board.attach();
+    // A wakeup from deep sleep boots the firmware again.
+    auto boot = [] { xTaskCreate([](void*) { app_main(); }, "main", 3584, nullptr, 1, nullptr); };
+    sim_deep_sleep_set_boot(boot);
+    boot();
+
+    signal(SIGINT, [](int) { s_stop = 1; });
+    signal(SIGTERM, [](int) { s_stop = 1; });
+    printf("%s\n", slave_path);
+    fflush(stdout);
+
+    const uint64_t end_us = hours > 0.0 ? uint64_t(hours * 3600e6) : kSimForever;
+    const auto start = std::chrono::steady_clock::now();
+    uint64_t now_us = 0;
+    while (!s_stop && now_us < end_us) {
+        now_us = std::min(now_us + kSliceUs, end_us);
+        sim_run_until(now_us);
+        fflush(console);
+        if (frames != nullptr) {
+            fflush(frames);
+        }
+
+        // The firmware has no console input yet; drain it so clients never block on a full buffer.
+        char input[256];
+        while (read(master, input, sizeof(input)) > 0) {
+        }
+
+        if (speed > 0.0) {
+            std::this_thread::sleep_until(start + std::chrono::duration<double>(now_us / 1e6 / speed));
+        }
+    }
+    board.advance_to(now_us);
+
+    const std::chrono::duration<double> wall = std::chrono::steady_clock::now() - start;
+    fprintf(stderr, "stopped after %.1f s simulated in %.1f s, %llu bytes written, %llu dropped\n", now_us / 1e6,
+            wall.count(), (unsigned long long)pty.written, (unsigned long long)pty.dropped);
+    if (flash != nullptr && !save_partition(history, *flash)) {
+        return 1;
+    }
+    if (frames != nullptr) {
+        fclose(frames);
+    }
+    if (link != nullptr) {
+        unlink(link);
+    }
+    return 0;
+}
@@ -0,0 +1,344 @@
+// Runs the complete firmware on the host IDF backend with faults injected, and checks after each run that the
+// heater stayed safe and that control came back once the faults cleared. Every scenario runs in a forked child so
+// firmware statics start fresh, and a firmware abort fails that scenario instead of ending the campaign.
+//
+//   fault_campaign [--script FILE] [--random N] [--seed N] [--verbose]
+//
+// Without --script or --random, a built-in suite injects each fault on its own and then a few in combination. A
+// scenario passes when:
+//   - the heater is never on while the firmware is blind (a fault that hides every reading has been active for
+//     longer than the firmware's sensor timeout plus one control period),
+//   - the chamber never rises more than kMaxOvershoot above the setpoint,
+//   - the firmware logs a valid status line again, and the chamber is back within kSettleBand of the setpoint
+//     within kMaxRecoveryS of the last fault clearing.
+// The flash has the history and snapshot partitions, so the faults reach the firmware's writers of both.
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "dryer.hpp"
+#include "idf_sim.hpp"
+#include "sim_board.hpp"
+#include "sim_files.hpp"
+
+extern "C" void app_main();
+
+// Kept in step with main.cpp.
+constexpr auto kHeaterGpio = GPIO_NUM_25;
+constexpr auto kThermistorChannel = ADC_CHANNEL_6;
+constexpr uint64_t kSensorTimeoutUs = 3'000'000;
+constexpr uint64_t kControlPeriodUs = 1'000'000;
+
+// A retried ADC read adds one retry delay before the timeout check runs.
+constexpr uint64_t kBlindGraceUs = kSensorTimeoutUs + 2 * kControlPeriodUs;
+constexpr uint64_t kMonitorPeriodUs = 100'000;
+constexpr float kMaxOvershoot = 5.0f;
+constexpr float kSettleBand = 1.0f;
+constexpr double kMaxRecoveryS = 1800.0;
+// Warm-up before the built-in faults, and the minimum observation time after the last fault clears.
+constexpr double kWarmupS = 3600.0;
+constexpr double kObserveS = 2400.0;
+
+struct Scenario
+{
+    std::vector<SimFaultWindow> windows;
+};
+
+struct Result
+{
+    bool finished = false;
+    double blind_heat_s = 0.0;
+    float peak_air = 0.0f;
+    double recovery_s = -1.0;
+    bool valid_at_end = false;
+    uint32_t sensor_timeouts = 0;
+    uint64_t hits = 0;
+};
+
+static bool blinds_sensor(const SimFaultWindow& window)
+{
+    if (window.probability < 1.0f) {
+        return false;
+    }
+    switch (window.fault) {
+    case SimFault::AdcReadError:
+    case SimFault::AdcTimeout:
+    case SimFault::CorruptFrame:
+    case SimFault::SensorDropout:
+        return true;
+    case SimFault::AllocFailure:
+        // The firmware only allocates while starting up.
+        return window.start_us == 0;
+    default:
+        return false;
+    }
+}
+
+static uint64_t last_fault_end(const Scenario& scenario)
+{
+    uint64_t end = 0;
+    for (const auto& window : scenario.windows) {
+        end = std::max(end, window.end_us);
+    }
+    return end;
+}
+
+static std::string describe(const Scenario& scenario)
+{
+    std::string text;
+    char buf[96];
+    for (const auto& window : scenario.windows) {
+        int n = snprintf(buf, sizeof(buf), "%s%s@%.0f+%.0f", text.empty() ? "" : ",", sim_fault_name(window.fault),
+                         window.start_us / 1e6, (window.end_us - window.start_us) / 1e6);
+        if (window.probability < 1.0f) {
+            snprintf(buf + n, sizeof(buf) - n, "p%.2g", window.probability);
+        }
+        text += buf;
+    }
+    return text;
+}
+
+// Runs one scenario in the calling process. Only ever called in a forked child.
+static Result run_scenario(const Scenario& scenario, uint32_t seed, bool verbose)
+{
+    char* log_text = nullptr;
+    size_t log_size = 0;
+    FILE* log = open_memstream(&log_text, &log_size);
+    sim_log_set_output(log);
+
+    sim_flash_add_partition("history", kHistoryPartitionSubtype, kHistoryPartitionSize);
+    sim_flash_add_partition("snapshot", kSnapshotPartitionSubtype, kSnapshotPartitionSize);
+    SimBoard board(PlantParams{}, seed, kHeaterGpio, kThermistorChannel);
+    board.attach();
+    // A wakeup from deep sleep boots the firmware again.
+    auto boot = [] { xTaskCreate([](void*) { app_main(); }, "main", 3584, nullptr, 1, nullptr); };
+    sim_deep_sleep_set_boot(boot);
+    boot();
+
+    sim_fault_seed(seed);
+    for (const auto& window : scenario.windows) {
+        sim_fault_add(window);
+    }
+
+    const uint64_t fault_end = last_fault_end(scenario);
+    const float setpoint = kDefaultSetpoint;
+    Result result;
+    uint64_t in_band_since = 0;
+    bool in_band = false;
+    sim_add_periodic(kMonitorPeriodUs, kMonitorPeriodUs, [&] {
+        const uint64_t now = sim_now_us();
+        board.advance_to(now);
+        const float air = board.plant().air_temperature();
+        if (board.heater_on()) {
+            for (const auto& window : scenario.windows) {
+                if (blinds_sensor(window) && now >= window.start_us + kBlindGraceUs && now < window.end_us) {
+                    result.blind_heat_s += kMonitorPeriodUs / 1e6;
+                    break;
+                }
+            }
+        }
+        result.peak_air = std::max(result.peak_air, air);
+        const bool band = std::abs(air - setpoint) <= kSettleBand;
+        if (band && !in_band) {
+            in_band_since = now;
+        }
+        in_band = band;
+        if (now >= fault_end && band && result.recovery_s < 0.0) {
+            result.recovery_s = (std::max(in_band_since, fault_end) - fault_end) / 1e6;
+        }
+    });
+
+    const uint64_t end_us = std::max<uint64_t>(fault_end + uint64_t(kObserveS * 1e6), 2 * uint64_t(kWarmupS * 1e6));
+    sim_run_until(end_us);
+    fclose(log);
+
+    // The firmware's own view: its last status line must carry a valid reading.
+    const std::string text(log_text, log_size);
+    free(log_text);
+    const size_t last = text.rfind("Avg reading:");
+    result.valid_at_end = last != std::string::npos &&
+                          text.substr(last, text.find('\n', last) - last).find("SENSOR FAULT") == std::string::npos &&
+                          text.find("No valid ADC frame", last) == std::string::npos;
+    for (size_t pos = 0; (pos = text.find("No valid ADC frame", pos)) != std::string::npos; ++pos) {
+        ++result.sensor_timeouts;
+    }
+    if (verbose) {
+        fwrite(text.data(), 1, text.size(), stdout);
+    }
+    for (size_t i = 0; i < size_t(SimFault::Count); ++i) {
+        result.hits += sim_fault_hits(SimFault(i));
+    }
+    result.finished = true;
+    return result;
+}
+
+// Forks, runs the scenario in the child and collects its result. Returns false with a reason if the child died.
+static bool run_isolated(const Scenario& scenario, uint32_t seed, bool verbose, Result& result, std::string& reason)
+{
+    int fds[2];
+    if (pipe(fds) != 0) {
+        perror("pipe");
+        exit(1);
+    }
+    fflush(stdout);
+    const pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        exit(1);
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        const Result child = run_scenario(scenario, seed, verbose);
+        fflush(stdout);
+        const bool ok = write(fds[1], &child, sizeof(child)) == ssize_t(sizeof(child));
+        _exit(ok ? 0 : 1);
+    }
+
+    close(fds[1]);
+    size_t got = 0;
+    auto* bytes = reinterpret_cast<char*>(&result);
+    for (ssize_t n; got < sizeof(result) && (n = read(fds[0], bytes + got, sizeof(result) - got)) > 0;) {
+        got += n;
+    }
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (WIFSIGNALED(status)) {
+        reason = std::string("firmware died: ") + strsignal(WTERMSIG(status));
+        return false;
+    }
+    if (got != sizeof(result) || !result.finished) {
+        reason = "run did not complete";
+        return false;
+    }
+    return true;
+}
+
+static std::vector<Scenario> builtin_suite()
+{
+    const auto at = [](SimFault fault, double start_s, double duration_s, float probability = 1.0f) {
+        return SimFaultWindow{fault, uint64_t(start_s * 1e6), uint64_t((start_s + duration_s) * 1e6), probability};
+    };
+    const double t = kWarmupS;
+    return {
+        {{at(SimFault::AdcTimeout, t, 300)}},
+        {{at(SimFault::AdcReadError, t, 300)}},
+        {{at(SimFault::AdcReadError, t, 600, 0.3f)}},
+        {{at(SimFault::PoolOverflow, t, 600, 0.9f)}},
+        {{at(SimFault::CorruptFrame, t, 300)}},
+        {{at(SimFault::CorruptFrame, t, 600, 0.5f)}},
+        {{at(SimFault::NotifyDelay, t, 600)}},
+        {{at(SimFault::AllocFailure, 0, 60)}},
+        {{at(SimFault::FlashWriteFailure, t, 900)}},
+        {{at(SimFault::SensorDropout, t, 300)}},
+        {{at(SimFault::SensorDropout, t, 5)}},
+        {{at(SimFault::NotifyDelay, t, 600), at(SimFault::CorruptFrame, t + 100, 300, 0.3f),
+          at(SimFault::AdcTimeout, t + 200, 60)}},
+        {{at(SimFault::AllocFailure, 0, 20), at(SimFault::FlashWriteFailure, 0, 7200),
+          at(SimFault::SensorDropout, t, 120), at(SimFault::AdcReadError, t + 60, 120)}},
+    };
+}
+
+static std::vector<Scenario> random_suite(uint32_t count, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> kinds(0, int(SimFault::Count) - 1);
+    std::uniform_int_distribution<int> faults(1, 3);
+    std::uniform_real_distribution<double> start(0.5 * kWarmupS, 1.5 * kWarmupS);
+    std::uniform_real_distribution<double> duration(std::log(2.0), std::log(900.0));
+    std::uniform_real_distribution<float> probability(0.05f, 1.0f);
+
+    std::vector<Scenario> scenarios(count);
+    for (auto& scenario : scenarios) {
+        for (int i = faults(rng); i > 0; --i) {
+            const double s = start(rng);
+            const double d = std::exp(duration(rng));
+            const float p = rng() % 2 ? 1.0f : probability(rng);
+            scenario.windows.push_back({SimFault(kinds(rng)), uint64_t(s * 1e6), uint64_t((s + d) * 1e6), p});
+        }
+    }
+    return scenarios;
+}
+
+int main(int argc, char** argv)
+{
+    const char* script = nullptr;
+    uint32_t random = 0;
+    uint32_t seed = 1;
+    bool verbose = false;
+    bool usage = false;
+    for (int i = 1; i < argc && !usage; ++i) {
+        if (strcmp(argv[i], "--script") == 0 && i + 1 < argc) {
+            script = argv[++i];
+        } else if (strcmp(argv[i], "--random") == 0 && i + 1 < argc) {
+            random = strtoul(argv[++i], nullptr, 0);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoul(argv[++i], nullptr, 0);
+        } else if (strcmp(argv[i], "--verbose") == 0) {
+            verbose = true;
+        } else {
+            usage = true;
+        }
+    }
+    if (usage || (script != nullptr && random != 0)) {
+        fprintf(stderr, "usage: %s [--script FILE] [--random N] [--seed N] [--verbose]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<Scenario> scenarios;
+    if (script != nullptr) {
+        std::string text;
+        std::string error;
+        if (!read_text_file(script, text)) {
+            return 1;
+        }
+        if (!sim_fault_load_script(text.data(), text.size(), error)) {
+            fprintf(stderr, "%s: %s\n", script, error.c_str());
+            return 1;
+        }
+        if (sim_fault_windows().empty()) {
+            fprintf(stderr, "%s: no faults\n", script);
+            return 1;
+        }
+        scenarios.push_back({sim_fault_windows()});
+        sim_fault_clear();
+    } else if (random != 0) {
+        scenarios = random_suite(random, seed);
+    } else {
+        scenarios = builtin_suite();
+    }
+
+    printf("%-60s %9s %8s %8s %8s %9s  %s\n", "scenario", "hits", "timeouts", "blind s", "peak C", "recover s", "result");
+    int failed = 0;
+    for (size_t i = 0; i < scenarios.size(); ++i) {
+        const auto& scenario = scenarios[i];
+        Result result;
+        std::string reason;
+        if (run_isolated(scenario, seed + i, verbose, result, reason)) {
+            if (result.blind_heat_s > 0.0) {
+                reason = "heater on while blind";
+            } else if (result.peak_air > kDefaultSetpoint + kMaxOvershoot) {
+                reason = "over-temperature";
+            } else if (!result.valid_at_end) {
+                reason = "no valid reading at end";
+            } else if (result.recovery_s < 0.0 || result.recovery_s > kMaxRecoveryS) {
+                reason = "no recovery";
+            }
+        }
+        failed += !reason.empty();
+        printf("%-60s %9llu %8u %8.1f %8.1f %9.0f  %s\n", describe(scenario).c_str(),
+               (unsigned long long)result.hits, result.sensor_timeouts,
+               result.blind_heat_s, result.peak_air, result.recovery_s, reason.empty() ? "ok" : reason.c_str());
+    }
+    printf("%zu scenarios, %d failed\n", scenarios.size(), failed);
+    return failed != 0;
+}
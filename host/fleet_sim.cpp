@@ -0,0 +1,265 @@
+// Runs a fleet of simulated dryers, each executing the firmware's Dryer pipeline against its own plant model in
+// virtual time. Dryers advance in lockstep epochs spread over a work-stealing pool; at the end of each epoch every
+// dryer's log lines are published in device order, exactly as the unit would print them on its console.
+// --frames writes the binary telemetry frames (telemetry.hpp) of the whole fleet instead, as a gateway collecting
+// them would forward them, with each dryer's ID its index in the fleet.
+//
+// Each dryer dries one of four materials at its recommended temperature and stops once its moisture model says the
+// spool is dry. The summary compares the completion time each one forecast two hours in with when it finished.
+//
+//   fleet_sim [--dryers N] [--hours H] [--threads T] [--epoch S] [--seed N] [--telemetry FILE|-] [--frames FILE|-]
+//             [--scaling]
+
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "dryer.hpp"
+#include "plant.hpp"
+#include "telemetry.hpp"
+#include "thread_pool.hpp"
+
+constexpr uint32_t kControlPeriodMs = 1000;
+constexpr uint32_t kForecastCheckMs = 2 * 3600'000;
+
+struct Options
+{
+    uint32_t dryers = 1000;
+    double hours = 8.0;
+    unsigned threads = std::thread::hardware_concurrency();
+    uint32_t epoch_s = 60;
+    uint32_t seed = 1;
+    const char* telemetry = nullptr;
+    const char* frames = nullptr;
+    bool scaling = false;
+};
+
+struct SimulatedDryer
+{
+    SimulatedDryer(uint32_t id, const PlantParams& params, Material material, uint32_t start_ms, uint32_t seed)
+        : id(id), plant(params, seed), now_ms(start_ms), start_ms(start_ms)
+    {
+        DryingProfile profile;
+        profile.setpoint = material_kinetics(material).temperature;
+        profile.material = material;
+        dryer.start(profile);
+    }
+
+    uint32_t id;
+    Dryer dryer;
+    Plant plant;
+    uint32_t now_ms;
+    uint32_t start_ms;
+    // Run time at which the dryer forecast it would be dry, and when it was.
+    double forecast_s = NAN;
+    double done_s = NAN;
+    double energy_j = 0.0;
+    std::string telemetry;
+    std::string frames;
+    uint32_t sequence = 0;
+};
+
+static std::vector<std::unique_ptr<SimulatedDryer>> make_fleet(const Options& options)
+{
+    std::mt19937 rng(options.seed);
+    std::uniform_real_distribution<float> ambient(15.0f, 30.0f);
+    std::uniform_real_distribution<float> spread(0.85f, 1.15f);
+    const Material materials[] = {Material::Pla, Material::Petg, Material::Abs, Material::Tpu};
+    std::uniform_int_distribution<int> material(0, 3);
+    // Boot times spread over the first control period so units don't report in phase.
+    std::uniform_int_distribution<uint32_t> boot(0, kControlPeriodMs - 1);
+
+    std::vector<std::unique_ptr<SimulatedDryer>> fleet;
+    fleet.reserve(options.dryers);
+    for (uint32_t id = 0; id < options.dryers; ++id) {
+        PlantParams params;
+        params.ambient = ambient(rng);
+        params.heater_power *= spread(rng);
+        params.air_capacity *= spread(rng);
+        params.air_to_ambient *= spread(rng);
+        fleet.push_back(std::make_unique<SimulatedDryer>(id, params, materials[material(rng)], boot(rng), rng()));
+    }
+    return fleet;
+}
+
+static void run_epoch(SimulatedDryer& unit, const AdcModel& adc, uint32_t end_ms, bool publish, bool frames)
+{
+    char line[256];
+    uint8_t frame[kTelemetryFrameSize];
+    while (unit.now_ms < end_ms) {
+        const auto& status = unit.dryer.step(unit.plant.read_frame(adc), unit.now_ms);
+        if (publish) {
+            const int prefix = snprintf(line, sizeof(line), "dryer-%05" PRIu32 " I (%" PRIu32 ") main: ", unit.id, unit.now_ms);
+            format_status(line + prefix, sizeof(line) - prefix, status);
+            unit.telemetry += line;
+            unit.telemetry += '\n';
+        }
+        if (frames) {
+            const size_t size = encode_telemetry(frame, unit.id, unit.sequence++, status);
+            unit.frames.append(reinterpret_cast<const char*>(frame), size);
+        }
+        const uint32_t run_ms = unit.now_ms - unit.start_ms;
+        if (run_ms == kForecastCheckMs && status.eta_s != MoistureModel::kUnknownEta) {
+            unit.forecast_s = (run_ms + status.eta_s * 1000.0) / 1000.0;
+        }
+        if (status.phase == DryerPhase::Done && std::isnan(unit.done_s)) {
+            unit.done_s = run_ms / 1000.0;
+        }
+        unit.energy_j += unit.plant.step(status.heater_on, kControlPeriodMs / 1000.0f);
+        unit.now_ms += kControlPeriodMs;
+    }
+}
+
+// Returns simulated dryer-seconds per wall-clock second.
+static double simulate(const Options& options, unsigned threads, FILE* telemetry, FILE* frames)
+{
+    const AdcModel adc;
+    auto fleet = make_fleet(options);
+    ThreadPool pool(threads);
+
+    const uint32_t duration_ms = uint32_t(options.hours * 3600'000.0);
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t epoch_end = 0; epoch_end < duration_ms;) {
+        epoch_end = std::min<uint64_t>(duration_ms, uint64_t(epoch_end) + options.epoch_s * 1000ull);
+        pool.parallel_for(fleet.size(), [&](size_t i) {
+            run_epoch(*fleet[i], adc, epoch_end, telemetry != nullptr, frames != nullptr);
+        });
+        if (telemetry != nullptr) {
+            for (auto& unit : fleet) {
+                fwrite(unit->telemetry.data(), 1, unit->telemetry.size(), telemetry);
+                unit->telemetry.clear();
+            }
+        }
+        if (frames != nullptr) {
+            for (auto& unit : fleet) {
+                fwrite(unit->frames.data(), 1, unit->frames.size(), frames);
+                unit->frames.clear();
+            }
+        }
+    }
+    const std::chrono::duration<double> wall = std::chrono::steady_clock::now() - start;
+
+    double energy = 0.0;
+    double error = 0.0;
+    size_t running = 0;
+    size_t done = 0;
+    double done_s = 0.0;
+    size_t forecasts = 0;
+    double forecast_error = 0.0;
+    for (const auto& unit : fleet) {
+        energy += unit->energy_j;
+        if (std::isnan(unit->done_s)) {
+            error += std::abs(unit->plant.air_temperature() - unit->dryer.status().setpoint);
+            ++running;
+            continue;
+        }
+        ++done;
+        done_s += unit->done_s;
+        if (!std::isnan(unit->forecast_s)) {
+            forecast_error += std::abs(unit->forecast_s - unit->done_s);
+            ++forecasts;
+        }
+    }
+    fprintf(stderr, "threads %2u: %" PRIu32 " dryers x %.1f h in %.2f s, mean final |error| %.2f C, mean energy %.0f Wh\n",
+            threads, options.dryers, options.hours, wall.count(), running ? error / running : 0.0,
+            energy / fleet.size() / 3600.0);
+    if (done != 0) {
+        fprintf(stderr, "            %zu dry after %.2f h on average, forecast at 2 h off by %.2f h on average\n", done,
+                done_s / done / 3600, forecasts ? forecast_error / forecasts / 3600 : NAN);
+    }
+    return options.dryers * (duration_ms / 1000.0) / wall.count();
+}
+
+static bool parse(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (strcmp(arg, "--scaling") == 0) {
+            options.scaling = true;
+            continue;
+        }
+        if (value == nullptr) {
+            return false;
+        }
+        ++i;
+        if (strcmp(arg, "--dryers") == 0) {
+            options.dryers = strtoul(value, nullptr, 0);
+        } else if (strcmp(arg, "--hours") == 0) {
+            options.hours = strtod(value, nullptr);
+        } else if (strcmp(arg, "--threads") == 0) {
+            options.threads = strtoul(value, nullptr, 0);
+        } else if (strcmp(arg, "--epoch") == 0) {
+            options.epoch_s = std::max(1ul, strtoul(value, nullptr, 0));
+        } else if (strcmp(arg, "--seed") == 0) {
+            options.seed = strtoul(value, nullptr, 0);
+        } else if (strcmp(arg, "--telemetry") == 0) {
+            options.telemetry = value;
+        } else if (strcmp(arg, "--frames") == 0) {
+            options.frames = value;
+        } else {
+            return false;
+        }
+    }
+    return options.dryers > 0 && options.hours > 0.0;
+}
+
+static FILE* open_output(const char* path, const char* mode)
+{
+    FILE* output = strcmp(path, "-") == 0 ? stdout : fopen(path, mode);
+    if (output == nullptr) {
+        perror(path);
+    }
+    return output;
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parse(argc, argv, options)) {
+        fprintf(stderr,
+                "usage: %s [--dryers N] [--hours H] [--threads T] [--epoch S] [--seed N] [--telemetry FILE|-]\n"
+                "       %*s [--frames FILE|-] [--scaling]\n",
+                argv[0], int(strlen(argv[0])), "");
+        return 1;
+    }
+
+    if (options.scaling) {
+        printf("threads,dryer_s_per_wall_s,speedup\n");
+        double base = 0.0;
+        std::vector<unsigned> counts;
+        for (unsigned threads = 1; threads < options.threads; threads *= 2) {
+            counts.push_back(threads);
+        }
+        counts.push_back(options.threads);
+        for (const auto threads : counts) {
+            const double rate = simulate(options, threads, nullptr, nullptr);
+            base = base == 0.0 ? rate : base;
+            printf("%u,%.0f,%.2f\n", threads, rate, rate / base);
+            fflush(stdout);
+        }
+        return 0;
+    }
+
+    FILE* telemetry = nullptr;
+    FILE* frames = nullptr;
+    if ((options.telemetry != nullptr && (telemetry = open_output(options.telemetry, "w")) == nullptr) ||
+        (options.frames != nullptr && (frames = open_output(options.frames, "wb")) == nullptr)) {
+        return 1;
+    }
+    const double rate = simulate(options, options.threads, telemetry, frames);
+    fprintf(stderr, "%.0f simulated dryer-seconds per wall-second\n", rate);
+    for (FILE* output : {telemetry, frames}) {
+        if (output != nullptr && output != stdout) {
+            fclose(output);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,49 @@
+// Fuzzes the capture file reader, which maps whatever file it is pointed at. Beyond not crashing, every chunk it
+// decodes must encode back to a payload that decodes to the same samples, and reads through the chunk cache must
+// agree with decoding the chunks directly.
+
+#include <cassert>
+#include <string>
+#include <vector>
+
+#include "capture_file.hpp"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    CaptureReader reader;
+    std::string error;
+    if (!reader.open(data, size, error)) {
+        assert(!error.empty());
+        return 0;
+    }
+    const uint32_t channels = uint32_t(reader.info().channels.size());
+    assert(channels > 0 && channels <= kCaptureMaxChannels);
+
+    std::vector<uint16_t> samples;
+    std::vector<uint16_t> again;
+    std::vector<uint8_t> payload;
+    uint64_t frames = 0;
+    for (size_t i = 0; i < reader.chunk_count(); ++i) {
+        assert(reader.chunk(i).first_frame == frames);
+        assert(reader.find_chunk(frames) == i);
+        const uint32_t count = reader.chunk_frames(i);
+        assert(count > 0 && count <= reader.info().chunk_frames);
+        frames += count;
+        if (!reader.decode_chunk(i, samples)) {
+            continue;
+        }
+        assert(samples.size() == size_t(count) * channels);
+        encode_capture_chunk(samples.data(), count, channels, payload);
+        again.resize(samples.size());
+        const bool ok = decode_capture_chunk(payload.data(), payload.size(), count, channels, again.data());
+        assert(ok && again == samples);
+
+        again.assign(samples.size(), 0);
+        if (reader.read(reader.chunk(i).first_frame, count, again.data())) {
+            assert(again == samples);
+        }
+    }
+    assert(frames == reader.frame_count());
+    assert(!reader.read(reader.frame_count(), 1, samples.data()));
+    return 0;
+}
@@ -0,0 +1,24 @@
+// Fuzzes the fault script parser of the host IDF backend. Scripts it accepts must only produce well-formed
+// windows; scripts it rejects must leave the schedule untouched.
+
+#include <cassert>
+#include <string>
+
+#include "idf_sim.hpp"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    sim_fault_clear();
+    std::string error;
+    const bool ok = sim_fault_load_script(reinterpret_cast<const char*>(data), size, error);
+    assert(ok == error.empty());
+    if (!ok) {
+        assert(sim_fault_windows().empty());
+    }
+    for (const auto& window : sim_fault_windows()) {
+        assert(window.fault < SimFault::Count);
+        assert(window.start_us <= window.end_us);
+        assert(window.probability >= 0.0f && window.probability <= 1.0f);
+    }
+    return 0;
+}
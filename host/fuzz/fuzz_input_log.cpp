@@ -0,0 +1,83 @@
+// Fuzzes the input log decoder, which parses whatever a history partition dump contains. Beyond not crashing,
+// every record it accepts must survive re-encoding: decoding the re-encoded stream gives the same records.
+
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+#include "input_log.hpp"
+
+static bool same_float(float a, float b)
+{
+    return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+static bool same_record(const InputRecord& a, const InputRecord& b)
+{
+    return a.type == b.type && a.time_ms == b.time_ms && a.version == b.version && a.sample_count == b.sample_count &&
+           a.sample_sum == b.sample_sum && same_float(a.profile.setpoint, b.profile.setpoint) &&
+           same_float(a.profile.ramp_rate, b.profile.ramp_rate) && a.profile.soak_s == b.profile.soak_s &&
+           same_float(a.profile.soak_band, b.profile.soak_band) && a.profile.material == b.profile.material &&
+           same_float(a.setpoint, b.setpoint) &&
+           same_float(a.correction.offset, b.correction.offset) && same_float(a.correction.gain, b.correction.gain) &&
+           same_float(a.correction.curvature, b.correction.curvature) && a.sensor == b.sensor &&
+           same_float(a.temperature, b.temperature) && same_float(a.humidity, b.humidity) &&
+           same_float(a.weight, b.weight);
+}
+
+static size_t encode(InputLogEncoder& encoder, uint8_t* out, const InputRecord& record)
+{
+    switch (record.type) {
+    case InputRecordType::Boot:
+        return encoder.boot(out, record.time_ms);
+    case InputRecordType::Frame:
+        return encoder.frame(out, record.time_ms, record.sample_count, record.sample_sum);
+    case InputRecordType::Profile:
+        return encoder.profile(out, record.time_ms, record.profile);
+    case InputRecordType::Setpoint:
+        return encoder.setpoint(out, record.time_ms, record.setpoint);
+    case InputRecordType::SensorTimeout:
+        return encoder.sensor_timeout(out, record.time_ms);
+    case InputRecordType::Correction:
+        return encoder.correction(out, record.time_ms, record.correction);
+    case InputRecordType::Auxiliary:
+        return encoder.auxiliary(out, record.time_ms, record.sensor, record.temperature);
+    case InputRecordType::Humidity:
+        return encoder.humidity(out, record.time_ms, record.humidity);
+    case InputRecordType::Weight:
+        return encoder.weight(out, record.time_ms, record.weight);
+    }
+    assert(!"decoder accepted an unknown record type");
+    return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    std::vector<InputRecord> records;
+    std::vector<uint8_t> encoded;
+    InputLogEncoder encoder;
+    InputLogDecoder decoder(data, size);
+    InputRecord record;
+    while (decoder.next(record)) {
+        assert(decoder.offset() <= size);
+        records.push_back(record);
+        uint8_t buf[kMaxInputRecordSize];
+        const size_t len = encode(encoder, buf, record);
+        assert(len <= kMaxInputRecordSize);
+        encoded.insert(encoded.end(), buf, buf + len);
+    }
+    assert(decoder.offset() <= size);
+
+    InputLogDecoder again(encoded.data(), encoded.size());
+    for (const auto& expected : records) {
+        const bool ok = again.next(record);
+        assert(ok && same_record(record, expected));
+    }
+    assert(!again.next(record) && !again.error());
+
+    // The same bytes as a partition image, sector headers and all.
+    size_t count = 0;
+    decode_history_image(data, size, [&](const InputRecord&) { ++count; });
+    assert(count <= size);
+    return 0;
+}
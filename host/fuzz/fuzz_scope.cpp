@@ -0,0 +1,120 @@
+// Fuzzes the scope line parser, which scope_dump runs over every line of a console log. Each line of the input it
+// accepts must format back to a line that parses to the same fields. The input's bytes also drive a capture, fed in
+// frames of varying size, whose streamed lines must parse back to its samples and their CRC.
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "scope.hpp"
+#include "telemetry.hpp"
+
+static bool same(const ScopeLine& a, const ScopeLine& b)
+{
+    if (a.kind != b.kind || a.capture != b.capture) {
+        return false;
+    }
+    switch (a.kind) {
+    case ScopeLine::Kind::Header:
+        return a.sample_count == b.sample_count && a.sample_rate_hz == b.sample_rate_hz && a.trigger == b.trigger &&
+               a.level == b.level && a.trigger_index == b.trigger_index && a.lost == b.lost;
+    case ScopeLine::Kind::Data:
+        return a.line == b.line && a.count == b.count && std::equal(a.samples, a.samples + a.count, b.samples);
+    case ScopeLine::Kind::End:
+        return a.crc == b.crc;
+    }
+    return false;
+}
+
+static void check_lines(const uint8_t* data, size_t size)
+{
+    const std::string text(reinterpret_cast<const char*>(data), size);
+    size_t start = 0;
+    while (start <= text.size()) {
+        const size_t end = std::min(text.find('\n', start), text.size());
+        const std::string line = text.substr(start, end - start);
+        ScopeLine parsed;
+        if (parse_scope_line(line.c_str(), parsed)) {
+            assert(parsed.kind != ScopeLine::Kind::Data || (parsed.count >= 1 && parsed.count <= kScopeLineSamples));
+            assert(parsed.kind != ScopeLine::Kind::Header || parsed.trigger_index < parsed.sample_count);
+            char formatted[kScopeMaxLineSize];
+            format_scope_line(parsed, formatted, sizeof(formatted));
+            ScopeLine again;
+            assert(parse_scope_line(formatted, again) && same(parsed, again));
+        }
+        start = end + 1;
+    }
+}
+
+static void check_capture(const uint8_t* data, size_t size)
+{
+    if (size < 4) {
+        return;
+    }
+    ScopeConfig config;
+    config.trigger = ScopeTrigger(data[0] % uint8_t(ScopeTrigger::Count));
+    config.level = data[1] % 64;
+    config.pre_samples = data[2] % 80;
+    std::vector<uint16_t> buffer(2 + data[3] % 120);
+    ScopeCapture scope(config, buffer);
+    data += 4;
+    size -= 4;
+
+    // Ten-bit samples from byte pairs, in frames sized by the first byte of each.
+    std::vector<uint16_t> fed;
+    scope.start();
+    while (size >= 1 && scope.capturing()) {
+        std::vector<uint16_t> frame;
+        const size_t samples = std::min<size_t>(data[0] % 16, (size - 1) / 2);
+        for (size_t i = 0; i < samples; ++i) {
+            frame.push_back(uint16_t((data[1 + 2 * i] | data[2 + 2 * i] << 8) & 0x3ff));
+        }
+        scope.feed(frame, data[0] >> 4);
+        fed.insert(fed.end(), frame.begin(), frame.end());
+        data += 1 + 2 * samples;
+        size -= 1 + 2 * samples;
+        if (samples == 0) {
+            break;
+        }
+    }
+    if (!scope.streaming()) {
+        assert(scope.captures() == 0);
+        return;
+    }
+
+    // The capture stops partway through a frame, so it is somewhere in what was fed, in order and unbroken.
+    const auto samples = scope.samples();
+    const size_t pre = scope.trigger_index();
+    assert(pre >= 1 && pre < samples.size() && fed.size() >= samples.size());
+    assert(std::search(fed.begin(), fed.end(), samples.begin(), samples.end()) != fed.end());
+
+    std::vector<uint16_t> decoded(samples.size());
+    char text[kScopeMaxLineSize];
+    size_t lines = 0;
+    bool ended = false;
+    while (scope.format_line(text, sizeof(text))) {
+        ScopeLine line;
+        assert(strlen(text) < kScopeMaxLineSize && parse_scope_line(text, line) && !ended);
+        if (line.kind == ScopeLine::Kind::Header) {
+            assert(lines == 0 && line.sample_count == samples.size() && line.trigger_index == pre);
+        } else if (line.kind == ScopeLine::Kind::Data) {
+            assert(line.line == lines - 1);
+            std::copy(line.samples, line.samples + line.count, decoded.begin() + line.line * kScopeLineSamples);
+        } else {
+            ended = true;
+            assert(line.crc == telemetry_crc16(reinterpret_cast<const uint8_t*>(decoded.data()),
+                                               decoded.size() * sizeof(uint16_t)));
+        }
+        ++lines;
+    }
+    assert(ended && std::equal(decoded.begin(), decoded.end(), samples.begin()) && !scope.streaming());
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    check_lines(data, size);
+    check_capture(data, size);
+    return 0;
+}
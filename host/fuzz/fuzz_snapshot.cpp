@@ -0,0 +1,47 @@
+// Fuzzes the snapshot decoder, which parses whatever a snapshot partition dump contains. Every snapshot it accepts
+// must hold only steps the recorder could have written, and decode again unchanged from a slot rebuilt from it.
+
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+#include "snapshot.hpp"
+#include "telemetry.hpp"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    std::vector<uint8_t> slot(kSnapshotSlotSize);
+    std::vector<SnapshotStep> again(kSnapshotSteps);
+    size_t previous = 0;
+    bool first = true;
+    const size_t count = decode_snapshot_image(data, size, [&](const SnapshotHeader& header,
+                                                               std::span<const SnapshotStep> steps) {
+        assert(header.magic == kSnapshotMagic && header.version == kSnapshotVersion);
+        assert(steps.size() == header.step_count && steps.size() <= kSnapshotSteps);
+        assert(header.trigger_index < header.step_count);
+        assert(first || header.sequence >= previous);
+        first = false;
+        previous = header.sequence;
+        for (const auto& step : steps) {
+            assert(step.block_count <= kSnapshotBlocks && step.phase() <= DryerPhase::Done);
+        }
+
+        SnapshotHeader rebuilt = header;
+        rebuilt.crc = telemetry_crc16(reinterpret_cast<const uint8_t*>(steps.data()), steps.size_bytes());
+        assert(rebuilt.crc == header.crc);
+        memcpy(slot.data(), &rebuilt, sizeof(rebuilt));
+        memcpy(slot.data() + sizeof(rebuilt), steps.data(), steps.size_bytes());
+        SnapshotHeader decoded;
+        const bool ok = decode_snapshot(slot.data(), slot.size(), decoded, again.data());
+        assert(ok && memcmp(&decoded, &header, sizeof(header)) == 0);
+        assert(memcmp(again.data(), steps.data(), steps.size_bytes()) == 0);
+    });
+    assert(count <= size / kSnapshotSlotSize);
+
+    // A single slot, possibly cut short.
+    SnapshotHeader header;
+    if (decode_snapshot(data, size, header, again.data())) {
+        assert(sizeof(header) + header.step_count * sizeof(SnapshotStep) <= size);
+    }
+    return 0;
+}
@@ -0,0 +1,76 @@
+// Fuzzes the telemetry decoder, which reads whatever a gateway recorded off the wire. Beyond not crashing, the
+// frames it finds must be checked, ordered and non-overlapping, current-version frames must re-encode to the same
+// bytes, and both the segmented scan and a streaming scan fed in pieces must find exactly the frames of one
+// sequential scan. The first byte picks the segment and piece sizes.
+
+#include <cassert>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "telemetry_stream.hpp"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    if (size == 0) {
+        return 0;
+    }
+    const size_t split = 1 + data[0] % 97;
+    ++data;
+    --size;
+
+    std::vector<size_t> frames;
+    TelemetryScanner scanner(data, size);
+    scanner.set_complete();
+    TelemetryView frame;
+    std::string line;
+    while (scanner.next(frame)) {
+        const size_t offset = frame.data() - data;
+        assert(frames.empty() || offset >= frames.back() + TelemetryView(data + frames.back()).size());
+        assert(offset + frame.size() <= size && scanner.offset() == offset + frame.size());
+        assert(frame.size() >= kTelemetryMinFrameSize);
+        frames.push_back(offset);
+
+        if (frame.version() == kTelemetryVersion && frame.size() == kTelemetryFrameSize && frame.flags() <= 7) {
+            uint8_t again[kTelemetryFrameSize];
+            encode_telemetry(again, frame.device_id(), frame.sequence(), frame.status());
+            assert(memcmp(again, frame.data(), kTelemetryFrameSize) == 0);
+        }
+        line.clear();
+        append_line_protocol(line, frame, LineProtocolOptions{});
+        assert(line.back() == '\n' && line.find('\n') == line.size() - 1);
+    }
+    assert(scanner.offset() == size);
+
+    auto segments = split_telemetry(size, split);
+    for (auto& segment : segments) {
+        scan_telemetry_segment(data, size, segment);
+    }
+    stitch_telemetry_segments(data, size, segments);
+    std::vector<size_t> stitched;
+    for (const auto& segment : segments) {
+        stitched.insert(stitched.end(), segment.frames.begin(), segment.frames.end());
+    }
+    assert(stitched == frames);
+
+    // A reader on a serial port: keeps the unscanned tail and scans again as more arrives.
+    std::vector<uint8_t> buffer;
+    std::vector<size_t> streamed;
+    size_t consumed = 0;
+    for (size_t fed = 0; fed < size;) {
+        const size_t piece = std::min(split, size - fed);
+        buffer.insert(buffer.end(), data + fed, data + fed + piece);
+        fed += piece;
+        TelemetryScanner reader(buffer.data(), buffer.size());
+        if (fed == size) {
+            reader.set_complete();
+        }
+        while (reader.next(frame)) {
+            streamed.push_back(consumed + (frame.data() - buffer.data()));
+        }
+        consumed += reader.offset();
+        buffer.erase(buffer.begin(), buffer.begin() + reader.offset());
+    }
+    assert(streamed == frames);
+    return 0;
+}
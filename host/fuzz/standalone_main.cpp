@@ -0,0 +1,51 @@
+// Runs a libFuzzer target over files and directories of inputs without libFuzzer, for compilers that lack it and
+// for replaying a corpus or a crash reproducer under any sanitizer:
+//
+//   fuzz_<target> CORPUS_DIR_OR_FILE...
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s CORPUS_DIR_OR_FILE...\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<std::filesystem::path> inputs;
+    for (int i = 1; i < argc; ++i) {
+        if (std::filesystem::is_directory(argv[i])) {
+            for (const auto& entry : std::filesystem::recursive_directory_iterator(argv[i])) {
+                if (entry.is_regular_file()) {
+                    inputs.push_back(entry.path());
+                }
+            }
+        } else {
+            inputs.emplace_back(argv[i]);
+        }
+    }
+
+    size_t bytes = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto& path : inputs) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            fprintf(stderr, "%s: cannot open\n", path.c_str());
+            return 1;
+        }
+        const std::vector<uint8_t> data{std::istreambuf_iterator<char>(file), {}};
+        LLVMFuzzerTestOneInput(data.data(), data.size());
+        bytes += data.size();
+    }
+    const std::chrono::duration<double> wall = std::chrono::steady_clock::now() - start;
+    fprintf(stderr, "ran %zu inputs (%zu bytes) in %.3f s\n", inputs.size(), bytes, wall.count());
+    return 0;
+}
@@ -0,0 +1,670 @@
+// Golden-trace regression check for the conversion and control chain. A trace is a CSV of inputs to Dryer (frame
+// averages and their times, plus profile, setpoint, sensor timeout, correction, other sensor, humidity, weight and
+// boot events) together with the outputs the firmware produced for them when the trace was recorded. Checking
+// replays the inputs open loop through the current Dryer and compares every output column against its tolerance,
+// reporting the first divergence of each trace with the steps leading up to it.
+//
+//   golden [--check] [DIR|FILE...] [--tolerance COLUMN=VALUE]... [--context N]
+//   golden --generate DIR        write the synthetic traces with outputs from the current code
+//   golden --record FILE...      re-record the expected outputs of existing traces after an intended change
+//   golden --import IMAGE FILE   turn a history partition image into a trace
+//
+// Traces live in host/golden. Rows starting with '@' are events applied before the next frame:
+//   @profile,<time_ms>,<setpoint>,<ramp_rate>,<soak_s>,<soak_band>[,<material>]
+//   @setpoint,<time_ms>,<setpoint>
+//   @timeout,<time_ms>
+//   @correction,<time_ms>,<offset>,<gain>,<curvature>
+//   @auxiliary,<time_ms>,<sensor>,<temperature>
+//   @humidity,<time_ms>,<relative humidity>
+//   @weight,<time_ms>,<grams>
+//   @boot,<time_ms>            starts a fresh Dryer, as a reboot would
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "dryer.hpp"
+#include "input_log.hpp"
+#include "plant.hpp"
+
+constexpr uint32_t kControlPeriodMs = 1000;
+constexpr const char* kHeader = "time_ms,raw,corrected,temperature,voltage,setpoint,duty,heater,phase,fault";
+
+struct Outputs
+{
+    uint32_t corrected = 0;
+    float temperature = 0.0f;
+    float voltage = 0.0f;
+    float setpoint = 0.0f;
+    float duty = 0.0f;
+    uint32_t heater = 0;
+    uint32_t phase = 0;
+    uint32_t fault = 0;
+};
+
+enum class StepKind
+{
+    Frame,
+    Profile,
+    Setpoint,
+    Timeout,
+    Correction,
+    Auxiliary,
+    Humidity,
+    Weight,
+    Boot,
+};
+
+struct Step
+{
+    StepKind kind = StepKind::Frame;
+    uint32_t time_ms = 0;
+    uint32_t raw = 0;
+    DryingProfile profile{};
+    float setpoint = 0.0f;
+    TemperatureCorrection correction{};
+    uint32_t sensor = 0;
+    float temperature = 0.0f;
+    float humidity = 0.0f;
+    float weight = 0.0f;
+    Outputs expected{};
+};
+
+struct Trace
+{
+    std::string comment;
+    std::vector<Step> steps;
+};
+
+// Allowed absolute difference per output column. Integer columns default to exact.
+struct Tolerances
+{
+    double corrected = 0.0;
+    double temperature = 0.005;
+    double voltage = 5e-5;
+    double setpoint = 0.005;
+    double duty = 5e-5;
+    double heater = 0.0;
+    double phase = 0.0;
+    double fault = 0.0;
+};
+
+struct Column
+{
+    const char* name;
+    double Tolerances::*tolerance;
+    double (*value)(const Outputs&);
+};
+
+static const Column kColumns[] = {
+    {"corrected", &Tolerances::corrected, [](const Outputs& o) { return double(o.corrected); }},
+    {"temperature", &Tolerances::temperature, [](const Outputs& o) { return double(o.temperature); }},
+    {"voltage", &Tolerances::voltage, [](const Outputs& o) { return double(o.voltage); }},
+    {"setpoint", &Tolerances::setpoint, [](const Outputs& o) { return double(o.setpoint); }},
+    {"duty", &Tolerances::duty, [](const Outputs& o) { return double(o.duty); }},
+    {"heater", &Tolerances::heater, [](const Outputs& o) { return double(o.heater); }},
+    {"phase", &Tolerances::phase, [](const Outputs& o) { return double(o.phase); }},
+    {"fault", &Tolerances::fault, [](const Outputs& o) { return double(o.fault); }},
+};
+
+static Outputs outputs_of(const DryerStatus& status)
+{
+    return {uint32_t(status.reading.corrected), status.reading.temperature, status.reading.voltage, status.setpoint,
+            status.duty, status.heater_on, uint32_t(status.phase), status.fault};
+}
+
+// Replays the trace through a fresh Dryer; returns the outputs of every frame step in order.
+static std::vector<Outputs> run_trace(const Trace& trace)
+{
+    std::vector<Outputs> outputs;
+    auto dryer = std::make_unique<Dryer>();
+    for (const auto& step : trace.steps) {
+        switch (step.kind) {
+        case StepKind::Frame:
+            outputs.push_back(outputs_of(dryer->step(step.raw, step.time_ms)));
+            break;
+        case StepKind::Profile:
+            dryer->start(step.profile);
+            break;
+        case StepKind::Setpoint:
+            dryer->set_setpoint(step.setpoint);
+            break;
+        case StepKind::Timeout:
+            dryer->sensor_timeout(step.time_ms);
+            break;
+        case StepKind::Correction:
+            dryer->set_correction(step.correction);
+            break;
+        case StepKind::Auxiliary:
+            dryer->set_auxiliary(step.sensor, step.temperature);
+            break;
+        case StepKind::Humidity:
+            dryer->set_humidity(step.humidity);
+            break;
+        case StepKind::Weight:
+            dryer->set_weight(step.weight);
+            break;
+        case StepKind::Boot:
+            dryer = std::make_unique<Dryer>();
+            break;
+        }
+    }
+    return outputs;
+}
+
+static void format_outputs(char* buf, size_t size, const Step& step, const Outputs& o)
+{
+    snprintf(buf, size, "%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%.4f,%.5f,%.4f,%.5f,%" PRIu32 ",%" PRIu32 ",%" PRIu32,
+             step.time_ms, step.raw, o.corrected, o.temperature, o.voltage, o.setpoint, o.duty, o.heater, o.phase,
+             o.fault);
+}
+
+static bool write_trace(const char* path, const Trace& trace)
+{
+    FILE* file = fopen(path, "w");
+    if (file == nullptr) {
+        perror(path);
+        return false;
+    }
+    fprintf(file, "%s", trace.comment.c_str());
+    fprintf(file, "%s\n", kHeader);
+    const auto outputs = run_trace(trace);
+    size_t frame = 0;
+    char line[256];
+    for (const auto& step : trace.steps) {
+        switch (step.kind) {
+        case StepKind::Frame:
+            format_outputs(line, sizeof(line), step, outputs[frame++]);
+            fprintf(file, "%s\n", line);
+            break;
+        case StepKind::Profile:
+            fprintf(file, "@profile,%" PRIu32 ",%.9g,%.9g,%" PRIu32 ",%.9g,%u\n", step.time_ms, step.profile.setpoint,
+                    step.profile.ramp_rate, step.profile.soak_s, step.profile.soak_band,
+                    unsigned(step.profile.material));
+            break;
+        case StepKind::Setpoint:
+            fprintf(file, "@setpoint,%" PRIu32 ",%.9g\n", step.time_ms, step.setpoint);
+            break;
+        case StepKind::Timeout:
+            fprintf(file, "@timeout,%" PRIu32 "\n", step.time_ms);
+            break;
+        case StepKind::Correction:
+            fprintf(file, "@correction,%" PRIu32 ",%.9g,%.9g,%.9g\n", step.time_ms, step.correction.offset,
+                    step.correction.gain, step.correction.curvature);
+            break;
+        case StepKind::Auxiliary:
+            fprintf(file, "@auxiliary,%" PRIu32 ",%" PRIu32 ",%.9g\n", step.time_ms, step.sensor, step.temperature);
+            break;
+        case StepKind::Humidity:
+            fprintf(file, "@humidity,%" PRIu32 ",%.9g\n", step.time_ms, step.humidity);
+            break;
+        case StepKind::Weight:
+            fprintf(file, "@weight,%" PRIu32 ",%.9g\n", step.time_ms, step.weight);
+            break;
+        case StepKind::Boot:
+            fprintf(file, "@boot,%" PRIu32 "\n", step.time_ms);
+            break;
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+static bool load_trace(const char* path, Trace& trace)
+{
+    FILE* file = fopen(path, "r");
+    if (file == nullptr) {
+        perror(path);
+        return false;
+    }
+    char line[512];
+    size_t line_number = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), file) != nullptr) {
+        ++line_number;
+        if (line[0] == '#') {
+            trace.comment += line;
+            continue;
+        }
+        if (strncmp(line, "time_ms,", 8) == 0 || line[strspn(line, " \t\r\n")] == '\0') {
+            continue;
+        }
+        Step step;
+        auto& e = step.expected;
+        if (line[0] == '@') {
+            char kind[16];
+            int n = 0;
+            ok = sscanf(line, "@%15[a-z],%" SCNu32 "%n", kind, &step.time_ms, &n) == 2;
+            const char* args = line + n;
+            if (ok && strcmp(kind, "profile") == 0) {
+                step.kind = StepKind::Profile;
+                unsigned material = 0;
+                // Traces from before materials have no material.
+                ok = sscanf(args, ",%f,%f,%" SCNu32 ",%f,%u", &step.profile.setpoint, &step.profile.ramp_rate,
+                            &step.profile.soak_s, &step.profile.soak_band, &material) >= 4 &&
+                     material < unsigned(Material::Count);
+                step.profile.material = static_cast<Material>(material);
+            } else if (ok && strcmp(kind, "setpoint") == 0) {
+                step.kind = StepKind::Setpoint;
+                ok = sscanf(args, ",%f", &step.setpoint) == 1;
+            } else if (ok && strcmp(kind, "timeout") == 0) {
+                step.kind = StepKind::Timeout;
+            } else if (ok && strcmp(kind, "correction") == 0) {
+                step.kind = StepKind::Correction;
+                ok = sscanf(args, ",%f,%f,%f", &step.correction.offset, &step.correction.gain,
+                            &step.correction.curvature) == 3;
+            } else if (ok && strcmp(kind, "auxiliary") == 0) {
+                step.kind = StepKind::Auxiliary;
+                ok = sscanf(args, ",%" SCNu32 ",%f", &step.sensor, &step.temperature) == 2 &&
+                     step.sensor < Dryer::kMaxAuxiliary;
+            } else if (ok && strcmp(kind, "humidity") == 0) {
+                step.kind = StepKind::Humidity;
+                ok = sscanf(args, ",%f", &step.humidity) == 1;
+            } else if (ok && strcmp(kind, "weight") == 0) {
+                step.kind = StepKind::Weight;
+                ok = sscanf(args, ",%f", &step.weight) == 1;
+            } else if (ok && strcmp(kind, "boot") == 0) {
+                step.kind = StepKind::Boot;
+            } else {
+                ok = false;
+            }
+        } else {
+            ok = sscanf(line, "%" SCNu32 ",%" SCNu32 ",%" SCNu32 ",%f,%f,%f,%f,%" SCNu32 ",%" SCNu32 ",%" SCNu32,
+                        &step.time_ms, &step.raw, &e.corrected, &e.temperature, &e.voltage, &e.setpoint, &e.duty,
+                        &e.heater, &e.phase, &e.fault) == 10;
+        }
+        if (ok) {
+            trace.steps.push_back(step);
+        }
+    }
+    fclose(file);
+    if (!ok) {
+        fprintf(stderr, "%s:%zu: malformed row\n", path, line_number);
+    }
+    return ok;
+}
+
+// Compares one trace. Returns true when every frame is within tolerance.
+static bool check_trace(const char* path, const Trace& trace, const Tolerances& tolerances, size_t context)
+{
+    const auto actual = run_trace(trace);
+    std::vector<const Step*> frames;
+    for (const auto& step : trace.steps) {
+        if (step.kind == StepKind::Frame) {
+            frames.push_back(&step);
+        }
+    }
+
+    double max_error[std::size(kColumns)] = {};
+    size_t divergent = 0;
+    size_t first = SIZE_MAX;
+    const Column* first_column = nullptr;
+    for (size_t i = 0; i < frames.size(); ++i) {
+        bool bad = false;
+        for (size_t c = 0; c < std::size(kColumns); ++c) {
+            const auto& column = kColumns[c];
+            const double error = std::abs(column.value(actual[i]) - column.value(frames[i]->expected));
+            max_error[c] = std::max(max_error[c], error);
+            if (error > tolerances.*column.tolerance) {
+                if (!bad && first == SIZE_MAX) {
+                    first = i;
+                    first_column = &column;
+                }
+                bad = true;
+            }
+        }
+        divergent += bad;
+    }
+
+    if (first == SIZE_MAX) {
+        printf("ok    %-40s %6zu frames\n", path, frames.size());
+        return true;
+    }
+
+    printf("FAIL  %-40s %6zu of %zu frames diverge\n", path, divergent, frames.size());
+    printf("      first divergence at frame %zu, t=%" PRIu32 " ms, column %s: expected %.6g, got %.6g (tolerance %g)\n",
+           first + 1, frames[first]->time_ms, first_column->name, first_column->value(frames[first]->expected),
+           first_column->value(actual[first]), tolerances.*first_column->tolerance);
+    printf("      %s\n", kHeader);
+    char line[256];
+    for (size_t i = first - std::min(first, context); i <= std::min(first + 1, frames.size() - 1); ++i) {
+        format_outputs(line, sizeof(line), *frames[i], frames[i]->expected);
+        printf("    %c %s\n", i == first ? '-' : ' ', line);
+        if (i >= first) {
+            format_outputs(line, sizeof(line), *frames[i], actual[i]);
+            printf("    + %s\n", line);
+        }
+    }
+    printf("      max |error|:");
+    for (size_t c = 0; c < std::size(kColumns); ++c) {
+        printf(" %s %.3g", kColumns[c].name, max_error[c]);
+    }
+    printf("\n");
+    return false;
+}
+
+static Step frame(uint32_t time_ms, uint32_t raw)
+{
+    Step step;
+    step.time_ms = time_ms;
+    step.raw = raw;
+    return step;
+}
+
+static Step profile_event(uint32_t time_ms, const DryingProfile& profile)
+{
+    Step step;
+    step.kind = StepKind::Profile;
+    step.time_ms = time_ms;
+    step.profile = profile;
+    return step;
+}
+
+// Closes the loop through the plant model to produce realistic inputs. `raw_override` may replace a frame's
+// reading (to inject sensor faults); it returns UINT32_MAX to keep the plant's reading.
+template <typename Override, typename Event>
+static void closed_loop(Trace& trace, uint32_t duration_s, uint32_t seed, Override raw_override, Event event)
+{
+    const AdcModel adc;
+    Plant plant(PlantParams{}, seed);
+    Dryer dryer;
+    for (const auto& step : trace.steps) {
+        if (step.kind == StepKind::Profile) {
+            dryer.start(step.profile);
+        }
+    }
+    for (uint32_t t = 0; t < duration_s; ++t) {
+        const uint32_t now_ms = t * kControlPeriodMs;
+        for (Step& step : event(now_ms)) {
+            if (step.kind == StepKind::Setpoint) {
+                dryer.set_setpoint(step.setpoint);
+            } else if (step.kind == StepKind::Profile) {
+                dryer.start(step.profile);
+            } else if (step.kind == StepKind::Timeout) {
+                dryer.sensor_timeout(now_ms);
+            }
+            trace.steps.push_back(step);
+        }
+        uint32_t raw = plant.read_frame(adc);
+        if (const uint32_t forced = raw_override(t); forced != UINT32_MAX) {
+            raw = forced;
+        }
+        const auto& status = dryer.step(raw, now_ms);
+        trace.steps.push_back(frame(now_ms, raw));
+        plant.step(status.heater_on, kControlPeriodMs / 1000.0f);
+    }
+}
+
+static const auto kNoOverride = [](uint32_t) { return UINT32_MAX; };
+static const auto kNoEvents = [](uint32_t) { return std::vector<Step>{}; };
+
+static bool generate(const std::filesystem::path& dir)
+{
+    std::filesystem::create_directories(dir);
+    bool ok = true;
+
+    {
+        Trace trace;
+        trace.comment = "# Every ADC code once a second, low to high: exercises the whole conversion curve, both rail\n"
+                        "# faults and the controller's recovery from them.\n";
+        for (uint32_t code = 0; code < (1u << kAdcResolutionBits); ++code) {
+            trace.steps.push_back(frame(code * kControlPeriodMs, code));
+        }
+        ok &= write_trace((dir / "adc_sweep.csv").c_str(), trace);
+    }
+    {
+        Trace trace;
+        trace.comment = "# The first hour from cold at the default setpoint, closed loop through plant seed 1.\n";
+        closed_loop(trace, 3600, 1, kNoOverride, kNoEvents);
+        ok &= write_trace((dir / "heat_up.csv").c_str(), trace);
+    }
+    {
+        Trace trace;
+        trace.comment = "# 60 C profile ramped at 0.02 C/s with a 10 minute soak from when the spool core is in\n"
+                        "# band, run to completion (6.5 h), plant seed 2.\n";
+        trace.steps.push_back(profile_event(0, DryingProfile{60.0f, 0.02f, 600, 1.0f}));
+        closed_loop(trace, 23400, 2, kNoOverride, kNoEvents);
+        ok &= write_trace((dir / "ramp_soak.csv").c_str(), trace);
+    }
+    {
+        Trace trace;
+        trace.comment = "# Setpoint changes from 45 C to 60 C and down to 40 C while regulating, plant seed 3.\n";
+        trace.steps.push_back(profile_event(0, DryingProfile{45.0f, 0.0f, 0, 1.0f}));
+        closed_loop(trace, 3600, 3, kNoOverride, [](uint32_t now_ms) {
+            std::vector<Step> events;
+            if (now_ms == 1200'000 || now_ms == 2400'000) {
+                Step step;
+                step.kind = StepKind::Setpoint;
+                step.time_ms = now_ms;
+                step.setpoint = now_ms == 1200'000 ? 60.0f : 40.0f;
+                events.push_back(step);
+            }
+            return events;
+        });
+        ok &= write_trace((dir / "setpoint_steps.csv").c_str(), trace);
+    }
+    {
+        Trace trace;
+        trace.comment = "# Regulating at 50 C through an open thermistor (30 s), a short (10 s), a stall that trips the\n"
+                        "# sensor timeout, and single-frame spikes, plant seed 4.\n";
+        closed_loop(
+            trace, 3000, 4,
+            [](uint32_t t) -> uint32_t {
+                if (t >= 1500 && t < 1530) {
+                    return 1023;
+                }
+                if (t >= 1800 && t < 1810) {
+                    return 0;
+                }
+                if (t == 2400 || t == 2401) {
+                    return t == 2400 ? 200 : 1000;
+                }
+                return UINT32_MAX;
+            },
+            [](uint32_t now_ms) {
+                std::vector<Step> events;
+                if (now_ms == 2100'000) {
+                    Step step;
+                    step.kind = StepKind::Timeout;
+                    step.time_ms = now_ms;
+                    events.push_back(step);
+                }
+                return events;
+            });
+        ok &= write_trace((dir / "sensor_faults.csv").c_str(), trace);
+    }
+    return ok;
+}
+
+static bool import_history(const char* image_path, const char* out)
+{
+    FILE* file = fopen(image_path, "rb");
+    if (file == nullptr) {
+        perror(image_path);
+        return false;
+    }
+    std::vector<uint8_t> image;
+    uint8_t chunk[65536];
+    for (size_t n; (n = fread(chunk, 1, sizeof(chunk), file)) > 0;) {
+        image.insert(image.end(), chunk, chunk + n);
+    }
+    fclose(file);
+
+    Trace trace;
+    trace.comment = std::string("# Imported from ") + std::filesystem::path(image_path).filename().string() + ".\n";
+    bool booted = false;
+    decode_history_image(image.data(), image.size(), [&](const InputRecord& record) {
+        Step step;
+        step.time_ms = record.time_ms;
+        switch (record.type) {
+        case InputRecordType::Boot:
+            step.kind = StepKind::Boot;
+            booted = true;
+            break;
+        case InputRecordType::Frame:
+            step.raw = record.frame_average();
+            break;
+        case InputRecordType::Profile:
+            step.kind = StepKind::Profile;
+            step.profile = record.profile;
+            break;
+        case InputRecordType::Setpoint:
+            step.kind = StepKind::Setpoint;
+            step.setpoint = record.setpoint;
+            break;
+        case InputRecordType::SensorTimeout:
+            step.kind = StepKind::Timeout;
+            break;
+        case InputRecordType::Correction:
+            step.kind = StepKind::Correction;
+            step.correction = record.correction;
+            break;
+        case InputRecordType::Auxiliary:
+            step.kind = StepKind::Auxiliary;
+            step.sensor = record.sensor;
+            step.temperature = record.temperature;
+            break;
+        case InputRecordType::Humidity:
+            step.kind = StepKind::Humidity;
+            step.humidity = record.humidity;
+            break;
+        case InputRecordType::Weight:
+            step.kind = StepKind::Weight;
+            step.weight = record.weight;
+            break;
+        }
+        // Records before the oldest surviving boot continue a run whose state is unknown.
+        if (booted) {
+            trace.steps.push_back(step);
+        }
+    });
+    return write_trace(out, trace);
+}
+
+static bool set_tolerance(Tolerances& tolerances, const char* spec)
+{
+    const char* eq = strchr(spec, '=');
+    if (eq == nullptr) {
+        return false;
+    }
+    for (const auto& column : kColumns) {
+        if (strlen(column.name) == size_t(eq - spec) && strncmp(column.name, spec, eq - spec) == 0) {
+            tolerances.*column.tolerance = strtod(eq + 1, nullptr);
+            return true;
+        }
+    }
+    return false;
+}
+
+static std::vector<std::string> trace_files(const std::vector<const char*>& paths)
+{
+    std::vector<std::string> files;
+    for (const char* path : paths) {
+        if (std::filesystem::is_directory(path)) {
+            for (const auto& entry : std::filesystem::directory_iterator(path)) {
+                if (entry.path().extension() == ".csv") {
+                    files.push_back(entry.path().string());
+                }
+            }
+        } else {
+            files.emplace_back(path);
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+int main(int argc, char** argv)
+{
+    enum class Mode
+    {
+        Check,
+        Generate,
+        Record,
+        Import,
+    } mode = Mode::Check;
+    Tolerances tolerances;
+    size_t context = 3;
+    std::vector<const char*> paths;
+    bool usage = false;
+    for (int i = 1; i < argc && !usage; ++i) {
+        if (strcmp(argv[i], "--check") == 0) {
+            mode = Mode::Check;
+        } else if (strcmp(argv[i], "--generate") == 0) {
+            mode = Mode::Generate;
+        } else if (strcmp(argv[i], "--record") == 0) {
+            mode = Mode::Record;
+        } else if (strcmp(argv[i], "--import") == 0) {
+            mode = Mode::Import;
+        } else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            usage = !set_tolerance(tolerances, argv[++i]);
+        } else if (strcmp(argv[i], "--context") == 0 && i + 1 < argc) {
+            context = strtoul(argv[++i], nullptr, 0);
+        } else if (argv[i][0] != '-') {
+            paths.push_back(argv[i]);
+        } else {
+            usage = true;
+        }
+    }
+    if (mode == Mode::Generate) {
+        usage |= paths.size() != 1;
+    } else if (mode == Mode::Import) {
+        usage |= paths.size() != 2;
+    } else if (mode == Mode::Record) {
+        usage |= paths.empty();
+    }
+    if (usage) {
+        fprintf(stderr,
+                "usage: %s [--check] [DIR|FILE...] [--tolerance COLUMN=VALUE]... [--context N]\n"
+                "       %s --generate DIR\n"
+                "       %s --record FILE...\n"
+                "       %s --import IMAGE FILE\n",
+                argv[0], argv[0], argv[0], argv[0]);
+        return 1;
+    }
+
+    switch (mode) {
+    case Mode::Generate:
+        return generate(paths[0]) ? 0 : 1;
+    case Mode::Import:
+        return import_history(paths[0], paths[1]) ? 0 : 1;
+    case Mode::Record:
+        for (const auto& path : trace_files(paths)) {
+            Trace trace;
+            if (!load_trace(path.c_str(), trace) || !write_trace(path.c_str(), trace)) {
+                return 1;
+            }
+        }
+        return 0;
+    case Mode::Check:
+        break;
+    }
+
+    if (paths.empty()) {
+        paths.push_back(DRYER_GOLDEN_DIR);
+    }
+    const auto start = std::chrono::steady_clock::now();
+    size_t failed = 0;
+    size_t frames = 0;
+    const auto files = trace_files(paths);
+    for (const auto& path : files) {
+        Trace trace;
+        if (!load_trace(path.c_str(), trace)) {
+            return 1;
+        }
+        frames += std::count_if(trace.steps.begin(), trace.steps.end(),
+                                [](const Step& step) { return step.kind == StepKind::Frame; });
+        failed += !check_trace(path.c_str(), trace, tolerances, context);
+    }
+    const std::chrono::duration<double, std::milli> wall = std::chrono::steady_clock::now() - start;
+    printf("%zu traces, %zu frames, %zu failed, %.1f ms\n", files.size(), frames, failed, wall.count());
+    return failed != 0 || files.empty();
+}
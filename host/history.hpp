@@ -0,0 +1,308 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+// A single timestamped sample. Times are seconds.
+struct HistoryPoint
+{
+    uint32_t time;
+    float value;
+};
+
+// Aggregate of all samples that fell in [start, start + period) for one rollup tier.
+struct Rollup
+{
+    uint32_t start = 0;
+    uint32_t count = 0;
+    float sum = 0.0f;
+    float min = std::numeric_limits<float>::infinity();
+    float max = -std::numeric_limits<float>::infinity();
+    uint32_t min_time = 0;
+    uint32_t max_time = 0;
+
+    void add(const HistoryPoint& point)
+    {
+        if (point.value < min) {
+            min = point.value;
+            min_time = point.time;
+        }
+        if (point.value > max) {
+            max = point.value;
+            max_time = point.time;
+        }
+        sum += point.value;
+        ++count;
+    }
+
+    float mean() const { return count ? sum / count : 0.0f; }
+};
+
+// Folds a sample stream into fixed-period rollups, handing each one to `sink` once its period closes.
+template <typename Sink>
+class RollupAccumulator
+{
+public:
+    RollupAccumulator(uint32_t period, Sink sink) : period_(period), sink_(sink) {}
+
+    void add(const HistoryPoint& point)
+    {
+        const uint32_t start = point.time - point.time % period_;
+        if (current_.count != 0 && start != current_.start) {
+            flush();
+        }
+        if (current_.count == 0) {
+            current_.start = start;
+        }
+        current_.add(point);
+    }
+
+    void flush()
+    {
+        if (current_.count != 0) {
+            sink_(current_);
+            current_ = Rollup{};
+        }
+    }
+
+private:
+    uint32_t period_;
+    Sink sink_;
+    Rollup current_;
+};
+
+// Splits [begin, end) into `bucket_count` equal buckets, rounding the width up so the last bucket reaches `end`.
+class BucketGrid
+{
+public:
+    BucketGrid(uint32_t begin, uint32_t end, uint32_t bucket_count)
+        : begin_(begin),
+          width_(std::max<uint32_t>(1, (end - begin + bucket_count - 1) / std::max<uint32_t>(1, bucket_count)))
+    {
+    }
+
+    uint32_t index(uint32_t time) const { return (time - begin_) / width_; }
+
+private:
+    uint32_t begin_;
+    uint32_t width_;
+};
+
+// Min/max bucket downsampling: emits the extreme points of each of max_points / 2 buckets in time order.
+// Preserves every spike at the cost of no smoothing; state is a single bucket.
+template <typename Sink>
+class MinMaxDownsampler
+{
+public:
+    MinMaxDownsampler(uint32_t begin, uint32_t end, uint32_t max_points, Sink sink)
+        : grid_(begin, end, std::max<uint32_t>(1, max_points / 2)), sink_(sink)
+    {
+    }
+
+    void add(const HistoryPoint& point)
+    {
+        Rollup single;
+        single.add(point);
+        add(single);
+    }
+
+    void add(const Rollup& rollup)
+    {
+        const auto bucket = grid_.index(rollup.min_time < rollup.max_time ? rollup.min_time : rollup.max_time);
+        if (bucket_.count != 0 && bucket != bucket_index_) {
+            finish();
+        }
+        bucket_index_ = bucket;
+        if (rollup.min < bucket_.min) {
+            bucket_.min = rollup.min;
+            bucket_.min_time = rollup.min_time;
+        }
+        if (rollup.max > bucket_.max) {
+            bucket_.max = rollup.max;
+            bucket_.max_time = rollup.max_time;
+        }
+        bucket_.count += rollup.count;
+    }
+
+    void finish()
+    {
+        if (bucket_.count == 0) {
+            return;
+        }
+        HistoryPoint lo{bucket_.min_time, bucket_.min};
+        HistoryPoint hi{bucket_.max_time, bucket_.max};
+        if (hi.time < lo.time) {
+            std::swap(lo, hi);
+        }
+        sink_(lo);
+        if (hi.time != lo.time) {
+            sink_(hi);
+        }
+        bucket_ = Rollup{};
+    }
+
+private:
+    BucketGrid grid_;
+    Sink sink_;
+    uint32_t bucket_index_ = 0;
+    Rollup bucket_;
+};
+
+// Streaming Largest-Triangle-Three-Buckets. Each bucket keeps at most kCandidates points, preselected as the
+// min/max of kCandidates / 2 sub-buckets (MinMaxLTTB), so RAM is fixed regardless of how much input a bucket
+// covers. A bucket's point is chosen once the following bucket closes and its average is known.
+template <typename Sink, size_t kCandidates = 8>
+class LttbDownsampler
+{
+    static_assert(kCandidates >= 2 && kCandidates % 2 == 0, "candidates come in min/max pairs");
+
+public:
+    LttbDownsampler(uint32_t begin, uint32_t end, uint32_t max_points, Sink sink)
+        : buckets_(max_points > 2 ? max_points - 2 : 1),
+          grid_(begin, end, buckets_),
+          sub_grid_(begin, end, buckets_ * (kCandidates / 2)),
+          sink_(sink)
+    {
+    }
+
+    void add(const HistoryPoint& point)
+    {
+        Rollup single;
+        single.add(point);
+        add(single);
+    }
+
+    void add(const Rollup& rollup)
+    {
+        if (!have_first_) {
+            const bool min_first = rollup.min_time <= rollup.max_time;
+            selected_ = min_first ? HistoryPoint{rollup.min_time, rollup.min}
+                                  : HistoryPoint{rollup.max_time, rollup.max};
+            sink_(selected_);
+            last_ = selected_;
+            have_first_ = true;
+            // The rollup's other extreme goes to the first bucket like any later point.
+            if (rollup.min_time != rollup.max_time) {
+                Rollup rest;
+                rest.add(min_first ? HistoryPoint{rollup.max_time, rollup.max}
+                                   : HistoryPoint{rollup.min_time, rollup.min});
+                add(rest);
+            }
+            return;
+        }
+
+        const uint32_t time = std::min(rollup.min_time, rollup.max_time);
+        const auto bucket = grid_.index(time);
+        if (collecting_.count != 0 && bucket != collecting_.index) {
+            close_bucket();
+        }
+        collecting_.index = bucket;
+        collecting_.add(rollup, sub_grid_.index(time));
+
+        last_ = rollup.min_time > rollup.max_time ? HistoryPoint{rollup.min_time, rollup.min}
+                                                  : HistoryPoint{rollup.max_time, rollup.max};
+    }
+
+    void finish()
+    {
+        if (!have_first_) {
+            return;
+        }
+        if (collecting_.count != 0) {
+            close_bucket();
+        }
+        if (pending_.count != 0) {
+            // The final bucket looks ahead to the last point instead of a bucket average.
+            select(pending_, last_.time, last_.value);
+            pending_ = Bucket{};
+        }
+        if (last_.time != selected_.time) {
+            sink_(last_);
+        }
+        have_first_ = false;
+    }
+
+private:
+    struct Bucket
+    {
+        uint32_t index = 0;
+        uint32_t count = 0;
+        double time_sum = 0.0;
+        double value_sum = 0.0;
+        uint32_t sub_index = std::numeric_limits<uint32_t>::max();
+        size_t candidate_count = 0;
+        std::array<HistoryPoint, kCandidates> candidates{};
+
+        void add(const Rollup& rollup, uint32_t sub)
+        {
+            const double mid = 0.5 * (double(rollup.min_time) + double(rollup.max_time));
+            time_sum += mid * rollup.count;
+            value_sum += double(rollup.sum);
+            count += rollup.count;
+
+            if (sub != sub_index || candidate_count == 0) {
+                if (candidate_count + 2 > kCandidates) {
+                    // Sub-bucket rounding gave this bucket an extra slot; fold it into the last pair.
+                    merge(candidate_count - 2, rollup);
+                    return;
+                }
+                sub_index = sub;
+                candidates[candidate_count++] = {rollup.min_time, rollup.min};
+                candidates[candidate_count++] = {rollup.max_time, rollup.max};
+                return;
+            }
+            merge(candidate_count - 2, rollup);
+        }
+
+        void merge(size_t pair, const Rollup& rollup)
+        {
+            if (rollup.min < candidates[pair].value) {
+                candidates[pair] = {rollup.min_time, rollup.min};
+            }
+            if (rollup.max > candidates[pair + 1].value) {
+                candidates[pair + 1] = {rollup.max_time, rollup.max};
+            }
+        }
+    };
+
+    void close_bucket()
+    {
+        if (pending_.count != 0) {
+            select(pending_, collecting_.time_sum / collecting_.count, collecting_.value_sum / collecting_.count);
+        }
+        pending_ = collecting_;
+        collecting_ = Bucket{};
+    }
+
+    void select(const Bucket& bucket, double next_time, double next_value)
+    {
+        double best_area = -1.0;
+        HistoryPoint best = bucket.candidates[0];
+        for (size_t i = 0; i < bucket.candidate_count; ++i) {
+            const auto& c = bucket.candidates[i];
+            // Twice the triangle area; the constant factor does not affect the choice.
+            const double area = std::abs((double(selected_.time) - next_time) * (double(c.value) - selected_.value) -
+                                         (double(selected_.time) - double(c.time)) * (next_value - selected_.value));
+            if (area > best_area) {
+                best_area = area;
+                best = c;
+            }
+        }
+        sink_(best);
+        selected_ = best;
+    }
+
+    uint32_t buckets_;
+    BucketGrid grid_;
+    BucketGrid sub_grid_;
+    Sink sink_;
+    bool have_first_ = false;
+    HistoryPoint selected_{};
+    HistoryPoint last_{};
+    Bucket pending_;
+    Bucket collecting_;
+};
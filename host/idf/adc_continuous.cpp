@@ -0,0 +1,239 @@
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+#include "chip.hpp"
+#include "esp_adc/adc_continuous.h"
+#include "idf_sim.hpp"
+
+// Only frame boundaries are tracked as frames complete; sample values are produced from the source when read, so
+// an idle pool costs nothing per sample. on_conv_done therefore receives a null conv_frame_buffer.
+struct adc_continuous_ctx_t
+{
+    adc_continuous_handle_cfg_t handle_config{};
+    std::vector<adc_digi_pattern_config_t> patterns;
+    uint32_t sample_freq_hz = 0;
+    uint32_t bit_width = 12;
+    adc_continuous_evt_cbs_t cbs{};
+    void* user_data = nullptr;
+    bool configured = false;
+    int periodic = -1;
+
+    uint32_t frame_samples = 0;
+    size_t pool_frames = 0;
+    uint64_t start_us = 0;
+    uint64_t next_sample = 0;
+    // First sample index of each complete frame in the pool, oldest first.
+    std::deque<uint64_t> pool;
+    uint32_t read_offset = 0;
+    bool corrupt_frame = false;
+    SimWaitList readers;
+};
+
+static SimAdcSource& adc_source()
+{
+    static SimAdcSource source;
+    return source;
+}
+
+// Handles created and not yet deinitialised.
+static std::vector<adc_continuous_ctx_t*> s_handles;
+
+void sim_adc_set_source(SimAdcSource source)
+{
+    adc_source() = std::move(source);
+}
+
+void sim_adc_power_down()
+{
+    // The handles themselves belong to the firmware, which will never touch them again.
+    for (adc_continuous_ctx_t* handle : s_handles) {
+        if (handle->periodic >= 0) {
+            sim_remove_periodic(handle->periodic);
+            handle->periodic = -1;
+        }
+    }
+    s_handles.clear();
+}
+
+uint16_t sim_adc_sample(adc_channel_t channel, uint32_t bit_width)
+{
+    const uint32_t mask = (1u << bit_width) - 1;
+    if (sim_fault_hit(SimFault::SensorDropout)) {
+        return mask;
+    }
+    const auto& source = adc_source();
+    return source ? source(sim_now_us(), channel) & mask : 0;
+}
+
+static void frame_done(adc_continuous_ctx_t* ctx)
+{
+    const uint64_t first = ctx->next_sample;
+    ctx->next_sample += ctx->frame_samples;
+    if (sim_fault_hit(SimFault::AdcTimeout)) {
+        return;
+    }
+    if (sim_fault_hit(SimFault::PoolOverflow)) {
+        ctx->pool.clear();
+        ctx->read_offset = 0;
+    }
+
+    // A suppressed notification is effectively delivered late, by the first frame after the fault clears.
+    if (ctx->cbs.on_conv_done != nullptr && !sim_fault_hit(SimFault::NotifyDelay)) {
+        adc_continuous_evt_data_t edata{nullptr, ctx->frame_samples * SOC_ADC_DIGI_RESULT_BYTES};
+        ctx->cbs.on_conv_done(ctx, &edata, ctx->user_data);
+    }
+
+    if (ctx->pool.size() >= ctx->pool_frames) {
+        if (ctx->handle_config.flags.flush_pool) {
+            ctx->pool.clear();
+            ctx->read_offset = 0;
+            ctx->pool.push_back(first);
+        }
+        if (ctx->cbs.on_pool_ovf != nullptr) {
+            adc_continuous_evt_data_t edata{nullptr, 0};
+            ctx->cbs.on_pool_ovf(ctx, &edata, ctx->user_data);
+        }
+    } else {
+        ctx->pool.push_back(first);
+    }
+    sim_wake_all(ctx->readers);
+}
+
+extern "C" {
+
+esp_err_t adc_continuous_new_handle(const adc_continuous_handle_cfg_t* hdl_config, adc_continuous_handle_t* ret_handle)
+{
+    if (hdl_config == nullptr || ret_handle == nullptr || hdl_config->conv_frame_size == 0 ||
+        hdl_config->conv_frame_size % SOC_ADC_DIGI_RESULT_BYTES != 0 ||
+        hdl_config->max_store_buf_size < hdl_config->conv_frame_size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (sim_fault_hit(SimFault::AllocFailure)) {
+        return ESP_ERR_NO_MEM;
+    }
+    auto* ctx = new adc_continuous_ctx_t;
+    ctx->handle_config = *hdl_config;
+    ctx->frame_samples = hdl_config->conv_frame_size / SOC_ADC_DIGI_RESULT_BYTES;
+    ctx->pool_frames = hdl_config->max_store_buf_size / hdl_config->conv_frame_size;
+    s_handles.push_back(ctx);
+    *ret_handle = ctx;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_config(adc_continuous_handle_t handle, const adc_continuous_config_t* config)
+{
+    if (handle == nullptr || config == nullptr || config->pattern_num == 0 ||
+        config->pattern_num > SOC_ADC_PATT_LEN_MAX || config->sample_freq_hz < SOC_ADC_SAMPLE_FREQ_THRES_LOW ||
+        config->sample_freq_hz > SOC_ADC_SAMPLE_FREQ_THRES_HIGH) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (handle->periodic >= 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    handle->patterns.assign(config->adc_pattern, config->adc_pattern + config->pattern_num);
+    handle->sample_freq_hz = config->sample_freq_hz;
+    handle->bit_width = config->adc_pattern[0].bit_width != 0 ? config->adc_pattern[0].bit_width : 12;
+    handle->configured = true;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_register_event_callbacks(adc_continuous_handle_t handle, const adc_continuous_evt_cbs_t* cbs,
+                                                  void* user_data)
+{
+    if (handle == nullptr || cbs == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (handle->periodic >= 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    handle->cbs = *cbs;
+    handle->user_data = user_data;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_start(adc_continuous_handle_t handle)
+{
+    if (handle == nullptr || !handle->configured || handle->periodic >= 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    const uint64_t frame_us = uint64_t(handle->frame_samples) * 1'000'000 / handle->sample_freq_hz;
+    handle->start_us = sim_now_us();
+    handle->next_sample = 0;
+    handle->pool.clear();
+    handle->read_offset = 0;
+    handle->periodic = sim_add_periodic(handle->start_us + frame_us, frame_us, [handle] { frame_done(handle); });
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_read(adc_continuous_handle_t handle, uint8_t* buf, uint32_t length_max, uint32_t* out_length,
+                              uint32_t timeout_ms)
+{
+    if (handle == nullptr || buf == nullptr || out_length == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out_length = 0;
+    if (handle->pool.empty() && timeout_ms != 0) {
+        sim_block(handle->readers, timeout_ms == UINT32_MAX ? kSimForever : uint64_t(timeout_ms) * 1000);
+    }
+    if (handle->pool.empty()) {
+        return ESP_ERR_TIMEOUT;
+    }
+    if (sim_fault_hit(SimFault::AdcReadError)) {
+        return ESP_FAIL;
+    }
+
+    const auto& source = adc_source();
+    const uint32_t mask = (1u << handle->bit_width) - 1;
+    const bool dropout = sim_fault_hit(SimFault::SensorDropout);
+    auto* out = reinterpret_cast<adc_digi_output_data_t*>(buf);
+    uint32_t count = 0;
+    while (!handle->pool.empty() && (count + 1) * SOC_ADC_DIGI_RESULT_BYTES <= length_max) {
+        const uint64_t index = handle->pool.front() + handle->read_offset;
+        const auto& pattern = handle->patterns[index % handle->patterns.size()];
+        const uint64_t time_us = handle->start_us + index * 1'000'000 / handle->sample_freq_hz;
+        const auto channel = static_cast<adc_channel_t>(pattern.channel);
+        if (handle->read_offset == 0) {
+            handle->corrupt_frame = sim_fault_hit(SimFault::CorruptFrame);
+        }
+        adc_digi_output_data_t sample{};
+        if (handle->corrupt_frame) {
+            // Garbage that never carries the right channel, derived from the index to stay deterministic.
+            sample.type1.data = (index * 2654435761u) >> 20;
+            sample.type1.channel = (pattern.channel + 1 + index % 15) % 16;
+        } else {
+            sample.type1.data = dropout ? mask : source ? source(time_us, channel) & mask : 0;
+            sample.type1.channel = pattern.channel;
+        }
+        out[count++] = sample;
+        if (++handle->read_offset == handle->frame_samples) {
+            handle->pool.pop_front();
+            handle->read_offset = 0;
+        }
+    }
+    *out_length = count * SOC_ADC_DIGI_RESULT_BYTES;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_stop(adc_continuous_handle_t handle)
+{
+    if (handle == nullptr || handle->periodic < 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    sim_remove_periodic(handle->periodic);
+    handle->periodic = -1;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_deinit(adc_continuous_handle_t handle)
+{
+    if (handle == nullptr || handle->periodic >= 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_handles.erase(std::remove(s_handles.begin(), s_handles.end(), handle), s_handles.end());
+    delete handle;
+    return ESP_OK;
+}
+
+} // extern "C"
@@ -0,0 +1,27 @@
+#pragma once
+
+// Chip-level plumbing between the host drivers, not part of the harness API: what each driver loses when the
+// digital side powers down in deep sleep, and the ULP's path to wake it.
+
+#include <cstdint>
+
+#include "esp_adc/adc_continuous.h"
+
+// Each returns its driver to the state it has at boot.
+void sim_adc_power_down();
+void sim_gpio_power_down();
+void sim_i2c_power_down();
+void sim_ledc_power_down();
+void sim_spi_power_down();
+void sim_uart_power_down();
+// Deletes every task, the calling one last; never returns to it.
+[[noreturn]] void sim_tasks_power_down();
+
+// One conversion of `channel` by the RTC controller at the current time, as the ULP's ADC instruction makes it.
+uint16_t sim_adc_sample(adc_channel_t channel, uint32_t bit_width);
+
+bool sim_deep_sleeping();
+// The ULP's WAKE instruction: boots the chip if it sleeps and ULP wakeup is enabled.
+void sim_ulp_wake();
+// RTC_CNTL_RDY_FOR_WAKEUP: set while the chip sleeps.
+bool sim_ready_for_wakeup();
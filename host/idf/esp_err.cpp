@@ -0,0 +1,38 @@
+#include "esp_err.h"
+#include "nvs.h"
+
+extern "C" const char* esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+    case ESP_OK:
+        return "ESP_OK";
+    case ESP_FAIL:
+        return "ESP_FAIL";
+    case ESP_ERR_NO_MEM:
+        return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:
+        return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE:
+        return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE:
+        return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND:
+        return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_TIMEOUT:
+        return "ESP_ERR_TIMEOUT";
+    case ESP_ERR_NVS_NOT_INITIALIZED:
+        return "ESP_ERR_NVS_NOT_INITIALIZED";
+    case ESP_ERR_NVS_NOT_FOUND:
+        return "ESP_ERR_NVS_NOT_FOUND";
+    case ESP_ERR_NVS_INVALID_HANDLE:
+        return "ESP_ERR_NVS_INVALID_HANDLE";
+    case ESP_ERR_NVS_INVALID_LENGTH:
+        return "ESP_ERR_NVS_INVALID_LENGTH";
+    case ESP_ERR_NVS_NO_FREE_PAGES:
+        return "ESP_ERR_NVS_NO_FREE_PAGES";
+    case ESP_ERR_NVS_NEW_VERSION_FOUND:
+        return "ESP_ERR_NVS_NEW_VERSION_FOUND";
+    default:
+        return "UNKNOWN ERROR";
+    }
+}
@@ -0,0 +1,38 @@
+#include <cstdarg>
+#include <cstdio>
+
+#include "esp_log.h"
+#include "idf_sim.hpp"
+
+static FILE* s_output = stdout;
+static esp_log_level_t s_level = ESP_LOG_INFO;
+
+void sim_log_set_output(FILE* output)
+{
+    s_output = output;
+}
+
+extern "C" {
+
+uint32_t esp_log_timestamp(void)
+{
+    return uint32_t(sim_now_us() / 1000);
+}
+
+void esp_log_write(esp_log_level_t level, const char*, const char* format, ...)
+{
+    if (s_output == nullptr || level > s_level) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    vfprintf(s_output, format, args);
+    va_end(args);
+}
+
+void esp_log_level_set(const char*, esp_log_level_t level)
+{
+    s_level = level;
+}
+
+} // extern "C"
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <cstring>
+#include <list>
+
+#include "esp_partition.h"
+#include "idf_sim.hpp"
+
+constexpr uint32_t kSectorSize = 4096;
+
+struct SimPartition
+{
+    esp_partition_t info;
+    std::vector<uint8_t> data;
+};
+
+// A list keeps the esp_partition_t pointers handed to the firmware stable.
+static std::list<SimPartition>& partitions()
+{
+    static std::list<SimPartition> list;
+    return list;
+}
+
+static SimPartition* find(const esp_partition_t* partition)
+{
+    for (auto& p : partitions()) {
+        if (&p.info == partition) {
+            return &p;
+        }
+    }
+    return nullptr;
+}
+
+static bool in_range(const SimPartition& p, size_t offset, size_t size)
+{
+    return offset <= p.data.size() && size <= p.data.size() - offset;
+}
+
+std::vector<uint8_t>& sim_flash_add_partition(const char* label, uint8_t subtype, size_t size)
+{
+    // Addresses only need to be plausible; lay data partitions out after a 1 MB app as partitions.csv does.
+    uint32_t address = 0x110000;
+    for (const auto& p : partitions()) {
+        address = std::max(address, p.info.address + p.info.size);
+    }
+    auto& p = partitions().emplace_back();
+    p.info = {ESP_PARTITION_TYPE_DATA, esp_partition_subtype_t(subtype), address, uint32_t(size), kSectorSize, {}};
+    strncpy(p.info.label, label, sizeof(p.info.label) - 1);
+    p.data.assign(size, 0xff);
+    return p.data;
+}
+
+std::vector<uint8_t>* sim_flash_partition_data(const char* label)
+{
+    for (auto& p : partitions()) {
+        if (strcmp(p.info.label, label) == 0) {
+            return &p.data;
+        }
+    }
+    return nullptr;
+}
+
+void sim_flash_clear()
+{
+    partitions().clear();
+}
+
+extern "C" {
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char* label)
+{
+    for (const auto& p : partitions()) {
+        if (p.info.type == type && (subtype == ESP_PARTITION_SUBTYPE_ANY || p.info.subtype == subtype) &&
+            (label == nullptr || strcmp(p.info.label, label) == 0)) {
+            return &p.info;
+        }
+    }
+    return nullptr;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t* partition, size_t src_offset, void* dst, size_t size)
+{
+    SimPartition* p = find(partition);
+    if (p == nullptr || dst == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!in_range(*p, src_offset, size)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(dst, p->data.data() + src_offset, size);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t* partition, size_t dst_offset, const void* src, size_t size)
+{
+    SimPartition* p = find(partition);
+    if (p == nullptr || src == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!in_range(*p, dst_offset, size)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (sim_fault_hit(SimFault::FlashWriteFailure)) {
+        return ESP_FAIL;
+    }
+    const auto* bytes = static_cast<const uint8_t*>(src);
+    for (size_t i = 0; i < size; ++i) {
+        p->data[dst_offset + i] &= bytes[i];
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t* partition, size_t offset, size_t size)
+{
+    SimPartition* p = find(partition);
+    if (p == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (offset % kSectorSize != 0 || size % kSectorSize != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!in_range(*p, offset, size)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (sim_fault_hit(SimFault::FlashWriteFailure)) {
+        return ESP_FAIL;
+    }
+    memset(p->data.data() + offset, 0xff, size);
+    return ESP_OK;
+}
+
+} // extern "C"
@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+#include "idf_sim.hpp"
+
+static constexpr const char* kFaultNames[] = {
+    "adc_read_error", "adc_timeout", "pool_overflow", "corrupt_frame",
+    "notify_delay", "alloc_failure", "flash_write_failure", "sensor_dropout",
+};
+static_assert(std::size(kFaultNames) == size_t(SimFault::Count));
+
+struct FaultState
+{
+    std::vector<SimFaultWindow> windows;
+    std::array<uint64_t, size_t(SimFault::Count)> hits{};
+    std::mt19937 rng;
+};
+
+static FaultState& state()
+{
+    static FaultState instance;
+    return instance;
+}
+
+void sim_fault_add(const SimFaultWindow& window)
+{
+    state().windows.push_back(window);
+}
+
+void sim_fault_clear()
+{
+    state().windows.clear();
+    state().hits = {};
+}
+
+void sim_fault_seed(uint32_t seed)
+{
+    state().rng.seed(seed);
+}
+
+const std::vector<SimFaultWindow>& sim_fault_windows()
+{
+    return state().windows;
+}
+
+bool sim_fault_hit(SimFault fault)
+{
+    auto& s = state();
+    const uint64_t now = sim_now_us();
+    // Overlapping windows of one fault apply the highest probability among them.
+    float probability = 0.0f;
+    for (const auto& window : s.windows) {
+        if (window.fault == fault && now >= window.start_us && now < window.end_us) {
+            probability = std::max(probability, window.probability);
+        }
+    }
+    const bool hit = probability >= 1.0f ||
+                     (probability > 0.0f && std::uniform_real_distribution<float>(0.0f, 1.0f)(s.rng) < probability);
+    s.hits[size_t(fault)] += hit;
+    return hit;
+}
+
+uint64_t sim_fault_hits(SimFault fault)
+{
+    return state().hits[size_t(fault)];
+}
+
+const char* sim_fault_name(SimFault fault)
+{
+    return size_t(fault) < std::size(kFaultNames) ? kFaultNames[size_t(fault)] : "unknown";
+}
+
+bool sim_fault_from_name(const char* name, SimFault& fault)
+{
+    for (size_t i = 0; i < std::size(kFaultNames); ++i) {
+        if (strcmp(name, kFaultNames[i]) == 0) {
+            fault = SimFault(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Parses a non-negative decimal number of seconds that must end at whitespace or the end of the line.
+static bool parse_seconds(const char*& p, double& value)
+{
+    char* end;
+    value = strtod(p, &end);
+    // Written so that NaN fails too.
+    if (end == p || !(value >= 0.0 && value <= 1e9) || (*end != '\0' && *end != ' ' && *end != '\t')) {
+        return false;
+    }
+    p = end;
+    return true;
+}
+
+bool sim_fault_load_script(const char* text, size_t size, std::string& error)
+{
+    std::vector<SimFaultWindow> windows;
+    size_t line_number = 0;
+    for (size_t begin = 0; begin < size;) {
+        const char* newline = static_cast<const char*>(memchr(text + begin, '\n', size - begin));
+        const size_t end = newline != nullptr ? newline - text : size;
+        std::string line(text + begin, end - begin);
+        begin = end + 1;
+        ++line_number;
+
+        if (const size_t comment = line.find('#'); comment != std::string::npos) {
+            line.resize(comment);
+        }
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.find('\0') != std::string::npos) {
+            error = "line " + std::to_string(line_number) + ": embedded NUL";
+            return false;
+        }
+        const char* p = line.c_str() + strspn(line.c_str(), " \t");
+        if (*p == '\0') {
+            continue;
+        }
+
+        const size_t name_length = strcspn(p, " \t");
+        const std::string name(p, name_length);
+        p += name_length;
+        SimFault fault;
+        double start_s = 0.0;
+        double duration_s = 0.0;
+        double probability = 1.0;
+        if (!sim_fault_from_name(name.c_str(), fault)) {
+            error = "line " + std::to_string(line_number) + ": unknown fault '" + name + "'";
+            return false;
+        }
+        if (!parse_seconds(p, start_s) || !parse_seconds(p, duration_s)) {
+            error = "line " + std::to_string(line_number) + ": expected <start s> <duration s>";
+            return false;
+        }
+        p += strspn(p, " \t");
+        if (*p != '\0' && (!parse_seconds(p, probability) || probability > 1.0 || *(p + strspn(p, " \t")) != '\0')) {
+            error = "line " + std::to_string(line_number) + ": probability must be a number in [0, 1]";
+            return false;
+        }
+        windows.push_back({fault, uint64_t(start_s * 1e6), uint64_t((start_s + duration_s) * 1e6), float(probability)});
+    }
+    auto& s = state();
+    s.windows.insert(s.windows.end(), windows.begin(), windows.end());
+    return true;
+}
@@ -0,0 +1,115 @@
+#include <array>
+
+#include "chip.hpp"
+#include "driver/gpio.h"
+#include "idf_sim.hpp"
+
+static std::array<uint8_t, GPIO_NUM_MAX> s_levels;
+static std::array<uint8_t, GPIO_NUM_MAX> s_pull_ups;
+static std::array<uint8_t, GPIO_NUM_MAX> s_held;
+static std::array<SimGpioInput, GPIO_NUM_MAX> s_inputs;
+static SimGpioListener s_listener;
+
+void sim_gpio_set_listener(SimGpioListener listener)
+{
+    s_listener = std::move(listener);
+}
+
+uint32_t sim_gpio_level(gpio_num_t gpio)
+{
+    return gpio >= 0 && gpio < GPIO_NUM_MAX ? s_levels[gpio] : 0;
+}
+
+void sim_gpio_power_down()
+{
+    // Outputs float and the board's pull-downs take them low, unless held.
+    for (int gpio = 0; gpio < GPIO_NUM_MAX; ++gpio) {
+        s_pull_ups[gpio] = 0;
+        if (s_levels[gpio] != 0 && !s_held[gpio]) {
+            gpio_set_level(gpio_num_t(gpio), 0);
+        }
+    }
+}
+
+void sim_gpio_set_input(gpio_num_t gpio, SimGpioInput input)
+{
+    if (gpio >= 0 && gpio < GPIO_NUM_MAX) {
+        s_inputs[gpio] = std::move(input);
+    }
+}
+
+extern "C" {
+
+esp_err_t gpio_config(const gpio_config_t* config)
+{
+    if (config == nullptr || config->pin_bit_mask >> GPIO_NUM_MAX != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int gpio = 0; gpio < GPIO_NUM_MAX; ++gpio) {
+        if ((config->pin_bit_mask >> gpio) & 1) {
+            s_pull_ups[gpio] = config->pull_up_en == GPIO_PULLUP_ENABLE;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level)
+{
+    if (gpio_num < 0 || gpio_num >= GPIO_NUM_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_held[gpio_num]) {
+        // The driver takes the write, but the pad stays latched.
+        return ESP_OK;
+    }
+    s_levels[gpio_num] = level != 0;
+    if (s_listener) {
+        s_listener(gpio_num, s_levels[gpio_num]);
+    }
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_pull_mode(gpio_num_t gpio_num, gpio_pull_mode_t pull)
+{
+    if (gpio_num < 0 || gpio_num >= GPIO_NUM_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_pull_ups[gpio_num] = pull == GPIO_PULLUP_ONLY || pull == GPIO_PULLUP_PULLDOWN;
+    return ESP_OK;
+}
+
+esp_err_t gpio_hold_en(gpio_num_t gpio_num)
+{
+    if (gpio_num < 0 || gpio_num >= GPIO_NUM_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_held[gpio_num] = 1;
+    return ESP_OK;
+}
+
+esp_err_t gpio_hold_dis(gpio_num_t gpio_num)
+{
+    if (gpio_num < 0 || gpio_num >= GPIO_NUM_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_held[gpio_num] = 0;
+    return ESP_OK;
+}
+
+// Every pin the firmware holds keeps its level through deep sleep here, as the RTC GPIOs do on the chip.
+void gpio_deep_sleep_hold_en(void) {}
+
+void gpio_deep_sleep_hold_dis(void) {}
+
+int gpio_get_level(gpio_num_t gpio_num)
+{
+    if (gpio_num < 0 || gpio_num >= GPIO_NUM_MAX) {
+        return 0;
+    }
+    if (s_inputs[gpio_num]) {
+        return s_inputs[gpio_num]() != 0;
+    }
+    return s_levels[gpio_num] | s_pull_ups[gpio_num];
+}
+
+} // extern "C"
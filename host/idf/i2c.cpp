@@ -0,0 +1,118 @@
+#include <map>
+
+#include "chip.hpp"
+#include "driver/i2c_master.h"
+#include "idf_sim.hpp"
+
+struct i2c_master_bus_t
+{
+    i2c_port_num_t port;
+};
+
+struct i2c_master_dev_t
+{
+    uint16_t address;
+};
+
+static bool s_ports_in_use[I2C_NUM_MAX];
+static std::map<uint16_t, SimI2cDevice> s_devices;
+
+void sim_i2c_set_device(uint16_t address, SimI2cDevice device)
+{
+    if (device) {
+        s_devices[address] = std::move(device);
+    } else {
+        s_devices.erase(address);
+    }
+}
+
+void sim_i2c_power_down()
+{
+    for (bool& in_use : s_ports_in_use) {
+        in_use = false;
+    }
+}
+
+static esp_err_t transfer(i2c_master_dev_handle_t device, const uint8_t* write, size_t write_size, uint8_t* read,
+                          size_t read_size)
+{
+    if (device == nullptr || (write == nullptr && write_size != 0) || (read == nullptr && read_size != 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const auto it = s_devices.find(device->address);
+    // The driver reports a NACK as an invalid state.
+    if (it == s_devices.end() || !it->second(write, write_size, read, read_size)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return ESP_OK;
+}
+
+extern "C" {
+
+esp_err_t i2c_new_master_bus(const i2c_master_bus_config_t* bus_config, i2c_master_bus_handle_t* ret_bus_handle)
+{
+    if (bus_config == nullptr || ret_bus_handle == nullptr || bus_config->i2c_port < 0 ||
+        bus_config->i2c_port >= I2C_NUM_MAX || bus_config->sda_io_num >= GPIO_NUM_MAX ||
+        bus_config->scl_io_num >= GPIO_NUM_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_ports_in_use[bus_config->i2c_port]) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (sim_fault_hit(SimFault::AllocFailure)) {
+        return ESP_ERR_NO_MEM;
+    }
+    s_ports_in_use[bus_config->i2c_port] = true;
+    *ret_bus_handle = new i2c_master_bus_t{bus_config->i2c_port};
+    return ESP_OK;
+}
+
+esp_err_t i2c_del_master_bus(i2c_master_bus_handle_t bus_handle)
+{
+    if (bus_handle == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_ports_in_use[bus_handle->port] = false;
+    delete bus_handle;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_bus_add_device(i2c_master_bus_handle_t bus_handle, const i2c_device_config_t* dev_config,
+                                    i2c_master_dev_handle_t* ret_handle)
+{
+    if (bus_handle == nullptr || dev_config == nullptr || ret_handle == nullptr || dev_config->scl_speed_hz == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (sim_fault_hit(SimFault::AllocFailure)) {
+        return ESP_ERR_NO_MEM;
+    }
+    *ret_handle = new i2c_master_dev_t{dev_config->device_address};
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_bus_rm_device(i2c_master_dev_handle_t handle)
+{
+    if (handle == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    delete handle;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_transmit(i2c_master_dev_handle_t i2c_dev, const uint8_t* write_buffer, size_t write_size, int)
+{
+    return transfer(i2c_dev, write_buffer, write_size, nullptr, 0);
+}
+
+esp_err_t i2c_master_receive(i2c_master_dev_handle_t i2c_dev, uint8_t* read_buffer, size_t read_size, int)
+{
+    return transfer(i2c_dev, nullptr, 0, read_buffer, read_size);
+}
+
+esp_err_t i2c_master_transmit_receive(i2c_master_dev_handle_t i2c_dev, const uint8_t* write_buffer,
+                                      size_t write_size, uint8_t* read_buffer, size_t read_size, int)
+{
+    return transfer(i2c_dev, write_buffer, write_size, read_buffer, read_size);
+}
+
+} // extern "C"
@@ -0,0 +1,68 @@
+#pragma once
+
+// Host stand-in for the SPI master driver. A bus carries one device, whose transactions go to the function
+// registered for the bus with sim_spi_set_device(); without one MISO reads high, as a pulled-up empty bus would.
+// Queued transactions complete when the bus would have clocked out their last bit.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum { SPI1_HOST, SPI2_HOST, SPI3_HOST, SPI_HOST_MAX } spi_host_device_t;
+typedef enum { SPI_DMA_DISABLED = 0, SPI_DMA_CH_AUTO = 3 } spi_common_dma_t;
+
+typedef struct {
+    int mosi_io_num;
+    int miso_io_num;
+    int sclk_io_num;
+    int quadwp_io_num;
+    int quadhd_io_num;
+    int max_transfer_sz;
+    uint32_t flags;
+    int intr_flags;
+} spi_bus_config_t;
+
+typedef struct {
+    uint8_t command_bits;
+    uint8_t address_bits;
+    uint8_t dummy_bits;
+    uint8_t mode;
+    int clock_speed_hz;
+    int spics_io_num;
+    uint32_t flags;
+    int queue_size;
+} spi_device_interface_config_t;
+
+typedef struct {
+    uint32_t flags;
+    uint16_t cmd;
+    uint64_t addr;
+    // In bits.
+    size_t length;
+    size_t rxlength;
+    void* user;
+    const void* tx_buffer;
+    void* rx_buffer;
+} spi_transaction_t;
+
+typedef struct spi_device_t* spi_device_handle_t;
+
+esp_err_t spi_bus_initialize(spi_host_device_t host_id, const spi_bus_config_t* bus_config,
+                             spi_common_dma_t dma_chan);
+esp_err_t spi_bus_free(spi_host_device_t host_id);
+esp_err_t spi_bus_add_device(spi_host_device_t host_id, const spi_device_interface_config_t* dev_config,
+                             spi_device_handle_t* handle);
+esp_err_t spi_bus_remove_device(spi_device_handle_t handle);
+esp_err_t spi_device_queue_trans(spi_device_handle_t handle, spi_transaction_t* trans_desc, TickType_t ticks_to_wait);
+esp_err_t spi_device_get_trans_result(spi_device_handle_t handle, spi_transaction_t** trans_desc,
+                                      TickType_t ticks_to_wait);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,99 @@
+#pragma once
+
+// Host stand-in for the ESP32 ULP FSM coprocessor and its macro assembler. Programs written with the I_ and M_
+// macros below, a subset of ESP-IDF's, load with ulp_process_macros_and_load() and run on the virtual clock, each
+// run starting a wakeup period after the last one halted; data lives in RTC_SLOW_MEM as on the chip, the upper half
+// of each word a ST writes holding the instruction's address. The encoding is the host's own, so only the macros
+// may build programs.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "soc/rtc_cntl_reg.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define R0 0
+#define R1 1
+#define R2 2
+#define R3 3
+
+enum {
+    SIM_ULP_ADC,
+    SIM_ULP_MOVI,
+    SIM_ULP_MOVR,
+    SIM_ULP_ADDR,
+    SIM_ULP_ADDI,
+    SIM_ULP_SUBR,
+    SIM_ULP_SUBI,
+    SIM_ULP_ANDI,
+    SIM_ULP_RSHI,
+    SIM_ULP_LSHI,
+    SIM_ULP_LD,
+    SIM_ULP_ST,
+    SIM_ULP_RD_REG,
+    SIM_ULP_BL,
+    SIM_ULP_BGE,
+    SIM_ULP_BXI,
+    SIM_ULP_WAKE,
+    SIM_ULP_HALT,
+    // Macros resolved at load time.
+    SIM_ULP_LABEL,
+    SIM_ULP_M_BL,
+    SIM_ULP_M_BGE,
+    SIM_ULP_M_BX,
+};
+
+typedef struct {
+    uint8_t op;
+    uint8_t rd;
+    uint8_t rs1;
+    uint8_t rs2;
+    // Immediate, address offset, label number, register address or branch offset.
+    int32_t imm;
+    // Branch threshold, ADC unit or register bit range.
+    int32_t arg;
+} ulp_insn_t;
+
+#define I_ADC(reg_dest, adc_idx, pad_idx) {SIM_ULP_ADC, (reg_dest), 0, 0, (pad_idx), (adc_idx)}
+#define I_MOVI(reg_dest, imm_) {SIM_ULP_MOVI, (reg_dest), 0, 0, (imm_), 0}
+#define I_MOVR(reg_dest, reg_src) {SIM_ULP_MOVR, (reg_dest), (reg_src), 0, 0, 0}
+#define I_ADDR(reg_dest, reg_src1, reg_src2) {SIM_ULP_ADDR, (reg_dest), (reg_src1), (reg_src2), 0, 0}
+#define I_ADDI(reg_dest, reg_src, imm_) {SIM_ULP_ADDI, (reg_dest), (reg_src), 0, (imm_), 0}
+#define I_SUBR(reg_dest, reg_src1, reg_src2) {SIM_ULP_SUBR, (reg_dest), (reg_src1), (reg_src2), 0, 0}
+#define I_SUBI(reg_dest, reg_src, imm_) {SIM_ULP_SUBI, (reg_dest), (reg_src), 0, (imm_), 0}
+#define I_ANDI(reg_dest, reg_src, imm_) {SIM_ULP_ANDI, (reg_dest), (reg_src), 0, (imm_), 0}
+#define I_RSHI(reg_dest, reg_src, imm_) {SIM_ULP_RSHI, (reg_dest), (reg_src), 0, (imm_), 0}
+#define I_LSHI(reg_dest, reg_src, imm_) {SIM_ULP_LSHI, (reg_dest), (reg_src), 0, (imm_), 0}
+#define I_LD(reg_dest, reg_addr, offset_) {SIM_ULP_LD, (reg_dest), (reg_addr), 0, (offset_), 0}
+#define I_ST(reg_val, reg_addr, offset_) {SIM_ULP_ST, (reg_val), (reg_addr), 0, (offset_), 0}
+#define I_RD_REG(reg, low_bit, high_bit) {SIM_ULP_RD_REG, R0, 0, 0, (int32_t)(reg), (low_bit) | (high_bit) << 8}
+#define I_BL(pc_offset, imm_value) {SIM_ULP_BL, 0, 0, 0, (pc_offset), (imm_value)}
+#define I_BGE(pc_offset, imm_value) {SIM_ULP_BGE, 0, 0, 0, (pc_offset), (imm_value)}
+#define I_BXI(imm_pc) {SIM_ULP_BXI, 0, 0, 0, (imm_pc), 0}
+#define I_WAKE() {SIM_ULP_WAKE, 0, 0, 0, 0, 0}
+#define I_HALT() {SIM_ULP_HALT, 0, 0, 0, 0, 0}
+#define M_LABEL(label_num) {SIM_ULP_LABEL, 0, 0, 0, (label_num), 0}
+#define M_BL(label_num, imm_value) {SIM_ULP_M_BL, 0, 0, 0, (label_num), (imm_value)}
+#define M_BGE(label_num, imm_value) {SIM_ULP_M_BGE, 0, 0, 0, (label_num), (imm_value)}
+#define M_BX(label_num) {SIM_ULP_M_BX, 0, 0, 0, (label_num), 0}
+
+// 8 KB of RTC slow memory in 32-bit words; the first CONFIG_ULP_COPROC_RESERVE_MEM bytes are the ULP's.
+extern uint32_t sim_rtc_slow_mem[2048];
+#define RTC_SLOW_MEM sim_rtc_slow_mem
+
+// Resolves labels and loads the program at word `load_addr`. `psize` holds the number of macros in and the number
+// of instructions loaded out.
+esp_err_t ulp_process_macros_and_load(uint32_t load_addr, const ulp_insn_t* program, size_t* psize);
+// Starts the ULP's timer; the program runs from word `entry_point` at once and then a period after every HALT.
+esp_err_t ulp_run(uint32_t entry_point);
+// Stops the timer; a run in progress finishes.
+esp_err_t ulp_timer_stop(void);
+esp_err_t ulp_set_wakeup_period(size_t period_index, uint32_t period_us);
+
+#ifdef __cplusplus
+}
+#endif
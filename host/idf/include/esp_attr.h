@@ -0,0 +1,5 @@
+#pragma once
+
+// Placement attributes. On the host every variable already outlives deep sleep, which only deletes tasks and resets
+// drivers, so RTC memory needs no section of its own.
+#define RTC_DATA_ATTR
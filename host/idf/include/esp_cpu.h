@@ -0,0 +1,14 @@
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+
+typedef uint32_t esp_cpu_cycle_count_t;
+
+// Host time, not virtual time, in cycles of a 160 MHz core: the code being timed really runs on the host.
+static inline esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (esp_cpu_cycle_count_t)((uint64_t)now.tv_sec * 160000000u + (uint64_t)now.tv_nsec * 16u / 100u);
+}
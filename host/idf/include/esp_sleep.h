@@ -0,0 +1,31 @@
+#pragma once
+
+// Host stand-in for deep sleep. esp_deep_sleep_start() deletes every task and resets the drivers while the virtual
+// clock, the board and the ULP carry on; a wakeup boots the firmware again through the function the harness set
+// with sim_deep_sleep_set_boot().
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    ESP_SLEEP_WAKEUP_UNDEFINED,
+    ESP_SLEEP_WAKEUP_ALL,
+    ESP_SLEEP_WAKEUP_EXT0,
+    ESP_SLEEP_WAKEUP_EXT1,
+    ESP_SLEEP_WAKEUP_TIMER,
+    ESP_SLEEP_WAKEUP_TOUCHPAD,
+    ESP_SLEEP_WAKEUP_ULP,
+} esp_sleep_wakeup_cause_t;
+
+esp_err_t esp_sleep_enable_ulp_wakeup(void);
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause(void);
+__attribute__((noreturn)) void esp_deep_sleep_start(void);
+
+#ifdef __cplusplus
+}
+#endif
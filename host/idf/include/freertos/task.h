@@ -0,0 +1,34 @@
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct tskTaskControlBlock* TaskHandle_t;
+
+#define tskIDLE_PRIORITY ((UBaseType_t)0)
+
+BaseType_t xTaskCreate(TaskFunction_t pxTaskCode, const char* pcName, uint32_t usStackDepth, void* pvParameters,
+                       UBaseType_t uxPriority, TaskHandle_t* pxCreatedTask);
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pxTaskCode, const char* pcName, uint32_t usStackDepth,
+                                   void* pvParameters, UBaseType_t uxPriority, TaskHandle_t* pxCreatedTask,
+                                   BaseType_t xCoreID);
+void vTaskDelete(TaskHandle_t xTaskToDelete);
+void vTaskDelay(TickType_t xTicksToDelay);
+TickType_t xTaskGetTickCount(void);
+TickType_t xTaskGetTickCountFromISR(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait);
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify);
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t* pxHigherPriorityTaskWoken);
+
+void taskYIELD(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define portYIELD_FROM_ISR(x) ((void)(x))
@@ -0,0 +1,145 @@
+#pragma once
+
+// Harness-side API of the host IDF backend: the virtual clock and scheduler, the hooks that connect the ADC, GPIO,
+// UART, I2C, SPI and LEDC drivers to a simulated board, and deep sleep.
+//
+// Firmware tasks run as coroutines on the calling thread, one at a time. Virtual time only advances while every
+// task is blocked, so code between two blocking calls takes zero simulated time. Ready tasks run highest priority
+// first and FIFO within a priority, and events due at the same instant fire in the order they were scheduled,
+// which makes every run fully deterministic.
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "driver/gpio.h"
+#include "driver/i2c_master.h"
+#include "driver/ledc.h"
+#include "driver/spi_master.h"
+#include "driver/uart.h"
+#include "esp_adc/adc_continuous.h"
+#include "esp_partition.h"
+#include "freertos/task.h"
+
+constexpr uint64_t kSimForever = UINT64_MAX;
+
+uint64_t sim_now_us();
+
+// Runs tasks and due events until virtual time reaches `end_us`, or until nothing is left that could ever run.
+void sim_run_until(uint64_t end_us);
+
+// Deletes all tasks, timers and driver state and rewinds the clock to zero.
+void sim_reset();
+
+// Calls `fn` in interrupt context at first_us, first_us + period_us, ... until removed. Returns an id for removal.
+int sim_add_periodic(uint64_t first_us, uint64_t period_us, std::function<void()> fn);
+void sim_remove_periodic(int id);
+
+// True while an interrupt-context callback is running.
+bool sim_in_isr();
+
+// Lets drivers block the calling task until another context wakes the list or the timeout expires.
+struct SimWaitList
+{
+    std::vector<TaskHandle_t> waiters;
+};
+
+// Returns false on timeout. Must be called from a task.
+bool sim_block(SimWaitList& list, uint64_t timeout_us);
+void sim_wake_all(SimWaitList& list);
+
+// Source of ADC sample codes for a channel at a point in virtual time.
+using SimAdcSource = std::function<uint16_t(uint64_t time_us, adc_channel_t channel)>;
+void sim_adc_set_source(SimAdcSource source);
+
+// Called after every gpio_set_level(), with the clock at the time of the write.
+using SimGpioListener = std::function<void(gpio_num_t gpio, uint32_t level)>;
+void sim_gpio_set_listener(SimGpioListener listener);
+uint32_t sim_gpio_level(gpio_num_t gpio);
+// Drives an input pin, read by gpio_get_level() at the time of the read; an empty function releases it.
+using SimGpioInput = std::function<uint32_t()>;
+void sim_gpio_set_input(gpio_num_t gpio, SimGpioInput input);
+
+// Destination of ESP_LOGx output; nullptr discards it.
+void sim_log_set_output(FILE* output);
+// Destination of the bytes written to a UART; nullptr, the default, discards them.
+void sim_uart_set_output(uart_port_t port, FILE* output);
+
+// An I2C target: handles one transaction, the bytes written then the bytes read, and returns false to NACK it.
+using SimI2cDevice = std::function<bool(const uint8_t* write, size_t write_size, uint8_t* read, size_t read_size)>;
+// Puts a device on the bus at a 7-bit address, or removes it given an empty function.
+void sim_i2c_set_device(uint16_t address, SimI2cDevice device);
+
+// An SPI target: sees the `bits` clocked out of `tx` and fills `rx` with what it drives on MISO, MSB first.
+using SimSpiDevice = std::function<void(const uint8_t* tx, uint8_t* rx, size_t bits)>;
+// Puts a device on a bus, or removes it given an empty function.
+void sim_spi_set_device(spi_host_device_t host, SimSpiDevice device);
+
+// Width in microseconds of the pulses the LEDC channel on `gpio` outputs now, mid-fade included; NAN if no channel
+// drives the pin.
+float sim_ledc_high_us(gpio_num_t gpio);
+
+// Deep sleep. esp_deep_sleep_start() deletes every task and returns the drivers to their state at boot, switching
+// the heater and other outputs off; the clock, the board, NVS, flash, RTC memory and the ULP carry on. A wakeup
+// boots the chip by calling `boot`, which creates the main task as the bootloader would.
+void sim_deep_sleep_set_boot(std::function<void()> boot);
+// Virtual time spent in deep sleep so far, and the wakeups from it.
+uint64_t sim_deep_sleep_us();
+uint32_t sim_deep_sleep_wakes();
+// Runs of the ULP program, and the RTC_FAST_CLK cycles (8 MHz) they took by the ESP32's instruction timings.
+uint64_t sim_ulp_runs();
+uint64_t sim_ulp_cycles();
+
+// Erases every NVS entry.
+void sim_nvs_clear();
+
+// Creates an erased data partition that esp_partition_find_first() will return, and gives direct access to its
+// contents for loading or saving an image.
+std::vector<uint8_t>& sim_flash_add_partition(const char* label, uint8_t subtype, size_t size);
+std::vector<uint8_t>* sim_flash_partition_data(const char* label);
+void sim_flash_clear();
+
+// Fault injection. Each fault is active inside the windows scheduled for it; while active, every opportunity the
+// drivers have to apply it (an ADC read, a frame, a flash write, ...) hits with the window's probability. The
+// random draws come from one generator seeded by sim_fault_seed(), so a seed and a schedule reproduce a run.
+// Where windows of one fault overlap, the highest probability applies.
+enum class SimFault
+{
+    AdcReadError,      // adc_continuous_read() returns ESP_FAIL
+    AdcTimeout,        // conversions stall: no frames, no callbacks, reads time out
+    PoolOverflow,      // the pool overflows and is flushed as a frame completes
+    CorruptFrame,      // every sample of a frame has a wrong channel and garbage data
+    NotifyDelay,       // on_conv_done is held back until the fault clears
+    AllocFailure,      // driver handle and task creation fail with ESP_ERR_NO_MEM
+    FlashWriteFailure, // esp_partition_write() and erase fail with ESP_FAIL
+    SensorDropout,     // the thermistor reads open circuit, a full-scale code
+    Count,
+};
+
+struct SimFaultWindow
+{
+    SimFault fault;
+    uint64_t start_us;
+    uint64_t end_us;
+    float probability = 1.0f;
+};
+
+void sim_fault_add(const SimFaultWindow& window);
+void sim_fault_clear();
+void sim_fault_seed(uint32_t seed);
+const std::vector<SimFaultWindow>& sim_fault_windows();
+
+// Whether `fault` applies at the current virtual time; draws from the fault generator inside a window.
+bool sim_fault_hit(SimFault fault);
+// Number of hits of `fault` so far.
+uint64_t sim_fault_hits(SimFault fault);
+
+const char* sim_fault_name(SimFault fault);
+bool sim_fault_from_name(const char* name, SimFault& fault);
+
+// Adds the windows of a fault script, one per line: `<fault> <start s> <duration s> [probability]`, with blank
+// lines and '#' comments ignored. Returns false and describes the first bad line in `error` without adding
+// anything.
+bool sim_fault_load_script(const char* text, size_t size, std::string& error);
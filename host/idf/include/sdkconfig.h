@@ -0,0 +1,46 @@
+#pragma once
+
+// Values mirrored from the project's sdkconfig that the host build depends on. The optional features the
+// simulation tools exercise are enabled here even where the committed sdkconfig leaves them at their Kconfig default.
+#define CONFIG_FREERTOS_HZ 100
+#define CONFIG_IDF_TARGET "linux"
+#define CONFIG_NEWLIB_STDOUT_LINE_ENDING_CRLF 1
+#define CONFIG_DRYER_INPUT_RECORDING 1
+#define CONFIG_DRYER_SNAPSHOT 1
+#define CONFIG_DRYER_SNAPSHOT_FAULT 1
+#define CONFIG_DRYER_SNAPSHOT_DOOR 1
+#define CONFIG_DRYER_SNAPSHOT_OSCILLATION 1
+#define CONFIG_DRYER_SNAPSHOT_PRE_S 191
+#define CONFIG_DRYER_SNAPSHOT_POST_S 64
+#define CONFIG_DRYER_SCOPE 1
+#define CONFIG_DRYER_SCOPE_SAMPLE_RATE 200000
+#define CONFIG_DRYER_SCOPE_SAMPLES 4096
+#define CONFIG_DRYER_SCOPE_PRE_SAMPLES 1024
+#define CONFIG_DRYER_SCOPE_TRIGGER 2
+#define CONFIG_DRYER_SCOPE_LEVEL 20
+#define CONFIG_DRYER_SCOPE_ON_RELAY 1
+#define CONFIG_DRYER_SCOPE_INTERVAL_S 600
+#define CONFIG_DRYER_TELEMETRY 1
+#define CONFIG_DRYER_TELEMETRY_UART_NUM 1
+#define CONFIG_DRYER_TELEMETRY_TX_GPIO 17
+#define CONFIG_DRYER_TELEMETRY_BAUD_RATE 115200
+#define CONFIG_DRYER_DEVICE_ID 0
+#define CONFIG_DRYER_REFERENCE_SENSOR 1
+#define CONFIG_DRYER_REFERENCE_SDA_GPIO 21
+#define CONFIG_DRYER_REFERENCE_SCL_GPIO 22
+#define CONFIG_DRYER_MATERIAL 1
+#define CONFIG_DRYER_LOAD_CELL 1
+#define CONFIG_DRYER_LOAD_CELL_DOUT_GPIO 19
+#define CONFIG_DRYER_LOAD_CELL_SCK_GPIO 18
+#define CONFIG_DRYER_LOAD_CELL_ZERO 12000
+#define CONFIG_DRYER_LOAD_CELL_COUNTS_PER_KG 420000
+#define CONFIG_DRYER_VENT 1
+#define CONFIG_DRYER_VENT_GPIO 26
+#define CONFIG_DRYER_VENT_CLOSED_US 1000
+#define CONFIG_DRYER_VENT_OPEN_US 2000
+#define CONFIG_DRYER_HEATER_POWER_W 250
+#define CONFIG_DRYER_KEEP_DRY 1
+#define CONFIG_DRYER_KEEP_DRY_DELAY_MIN 30
+#define CONFIG_ULP_COPROC_ENABLED 1
+#define CONFIG_ULP_COPROC_TYPE_FSM 1
+#define CONFIG_ULP_COPROC_RESERVE_MEM 512
@@ -0,0 +1,5 @@
+#pragma once
+
+// The RTC controller registers the firmware's ULP program reads.
+#define RTC_CNTL_LOW_POWER_ST_REG 0x3ff480c0
+#define RTC_CNTL_RDY_FOR_WAKEUP_S 19
@@ -0,0 +1,7 @@
+#pragma once
+
+// ESP32 values of the SoC capabilities the firmware checks.
+#define SOC_ADC_PATT_LEN_MAX 16
+#define SOC_ADC_DIGI_RESULT_BYTES 2
+#define SOC_ADC_SAMPLE_FREQ_THRES_HIGH (2 * 1000 * 1000)
+#define SOC_ADC_SAMPLE_FREQ_THRES_LOW (20 * 1000)
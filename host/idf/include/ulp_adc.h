@@ -0,0 +1,26 @@
+#pragma once
+
+// Host stand-in for the ULP's ADC setup: the ULP's ADC instruction then samples the board's ADC source.
+
+#include "esp_adc/adc_continuous.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum { ADC_ULP_MODE_DISABLE, ADC_ULP_MODE_FSM, ADC_ULP_MODE_RISCV } adc_ulp_mode_t;
+
+typedef struct {
+    adc_unit_t adc_n;
+    adc_channel_t channel;
+    adc_atten_t atten;
+    adc_bitwidth_t width;
+    adc_ulp_mode_t ulp_mode;
+} ulp_adc_cfg_t;
+
+esp_err_t ulp_adc_init(const ulp_adc_cfg_t* cfg);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,193 @@
+#include <cmath>
+
+#include "chip.hpp"
+#include "driver/ledc.h"
+#include "idf_sim.hpp"
+
+struct LedcTimer
+{
+    bool configured = false;
+    uint32_t resolution_bits = 0;
+    uint32_t freq_hz = 0;
+};
+
+struct LedcChannel
+{
+    bool configured = false;
+    int gpio = -1;
+    ledc_timer_t timer = LEDC_TIMER_0;
+    // Set by ledc_set_duty() or ledc_set_fade_with_time(), taking effect at ledc_update_duty() or ledc_fade_start().
+    uint32_t pending_duty = 0;
+    uint32_t fade_ms = 0;
+    // The duty goes from `from` at from_us to `to` at to_us.
+    uint32_t from = 0;
+    uint32_t to = 0;
+    uint64_t from_us = 0;
+    uint64_t to_us = 0;
+
+    uint32_t duty() const
+    {
+        const uint64_t now_us = sim_now_us();
+        if (now_us >= to_us) {
+            return to;
+        }
+        const double progress = double(now_us - from_us) / double(to_us - from_us);
+        return uint32_t(std::lround(from + (double(to) - double(from)) * progress));
+    }
+};
+
+static LedcTimer s_timers[LEDC_TIMER_MAX];
+static LedcChannel s_channels[LEDC_CHANNEL_MAX];
+static bool s_fade_installed = false;
+
+static LedcChannel* channel_for(ledc_mode_t speed_mode, ledc_channel_t channel)
+{
+    if (speed_mode != LEDC_LOW_SPEED_MODE || channel < 0 || channel >= LEDC_CHANNEL_MAX ||
+        !s_channels[channel].configured) {
+        return nullptr;
+    }
+    return &s_channels[channel];
+}
+
+void sim_ledc_power_down()
+{
+    for (auto& timer : s_timers) {
+        timer = {};
+    }
+    for (auto& channel : s_channels) {
+        channel = {};
+    }
+    s_fade_installed = false;
+}
+
+float sim_ledc_high_us(gpio_num_t gpio)
+{
+    for (const auto& channel : s_channels) {
+        if (channel.configured && channel.gpio == gpio) {
+            const LedcTimer& timer = s_timers[channel.timer];
+            return float(channel.duty()) / float(1u << timer.resolution_bits) * 1e6f / float(timer.freq_hz);
+        }
+    }
+    return NAN;
+}
+
+extern "C" {
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t* timer_conf)
+{
+    if (timer_conf == nullptr || timer_conf->speed_mode != LEDC_LOW_SPEED_MODE || timer_conf->timer_num < 0 ||
+        timer_conf->timer_num >= LEDC_TIMER_MAX || timer_conf->duty_resolution < 1 ||
+        timer_conf->duty_resolution >= LEDC_TIMER_BIT_MAX || timer_conf->freq_hz == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // The 80 MHz APB clock divided down must leave every duty step at least one clock long.
+    if ((uint64_t(timer_conf->freq_hz) << timer_conf->duty_resolution) > 80'000'000) {
+        return ESP_FAIL;
+    }
+    s_timers[timer_conf->timer_num] = {true, uint32_t(timer_conf->duty_resolution), timer_conf->freq_hz};
+    return ESP_OK;
+}
+
+esp_err_t ledc_channel_config(const ledc_channel_config_t* ledc_conf)
+{
+    if (ledc_conf == nullptr || ledc_conf->speed_mode != LEDC_LOW_SPEED_MODE || ledc_conf->channel < 0 ||
+        ledc_conf->channel >= LEDC_CHANNEL_MAX || ledc_conf->timer_sel < 0 || ledc_conf->timer_sel >= LEDC_TIMER_MAX ||
+        ledc_conf->gpio_num < 0 || ledc_conf->gpio_num >= GPIO_NUM_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_timers[ledc_conf->timer_sel].configured) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    LedcChannel& channel = s_channels[ledc_conf->channel];
+    channel = {};
+    channel.configured = true;
+    channel.gpio = ledc_conf->gpio_num;
+    channel.timer = ledc_conf->timer_sel;
+    channel.pending_duty = channel.from = channel.to = ledc_conf->duty;
+    return ESP_OK;
+}
+
+esp_err_t ledc_fade_func_install(int)
+{
+    if (s_fade_installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (sim_fault_hit(SimFault::AllocFailure)) {
+        return ESP_ERR_NO_MEM;
+    }
+    s_fade_installed = true;
+    return ESP_OK;
+}
+
+void ledc_fade_func_uninstall(void)
+{
+    s_fade_installed = false;
+}
+
+esp_err_t ledc_set_duty(ledc_mode_t speed_mode, ledc_channel_t channel, uint32_t duty)
+{
+    LedcChannel* c = channel_for(speed_mode, channel);
+    if (c == nullptr || duty > (1u << s_timers[c->timer].resolution_bits)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    c->pending_duty = duty;
+    c->fade_ms = 0;
+    return ESP_OK;
+}
+
+esp_err_t ledc_update_duty(ledc_mode_t speed_mode, ledc_channel_t channel)
+{
+    LedcChannel* c = channel_for(speed_mode, channel);
+    if (c == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    c->from = c->to = c->pending_duty;
+    c->from_us = c->to_us = sim_now_us();
+    return ESP_OK;
+}
+
+uint32_t ledc_get_duty(ledc_mode_t speed_mode, ledc_channel_t channel)
+{
+    const LedcChannel* c = channel_for(speed_mode, channel);
+    return c != nullptr ? c->duty() : 0;
+}
+
+esp_err_t ledc_set_fade_with_time(ledc_mode_t speed_mode, ledc_channel_t channel, uint32_t target_duty,
+                                  int max_fade_time_ms)
+{
+    LedcChannel* c = channel_for(speed_mode, channel);
+    if (c == nullptr || target_duty > (1u << s_timers[c->timer].resolution_bits) || max_fade_time_ms < 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_fade_installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    c->pending_duty = target_duty;
+    c->fade_ms = uint32_t(max_fade_time_ms);
+    return ESP_OK;
+}
+
+esp_err_t ledc_fade_start(ledc_mode_t speed_mode, ledc_channel_t channel, ledc_fade_mode_t fade_mode)
+{
+    LedcChannel* c = channel_for(speed_mode, channel);
+    if (c == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_fade_installed || sim_now_us() < c->to_us) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    c->from = c->duty();
+    c->to = c->pending_duty;
+    c->from_us = sim_now_us();
+    c->to_us = c->from_us + uint64_t(c->fade_ms) * 1000;
+    if (fade_mode == LEDC_FADE_WAIT_DONE && c->to_us > c->from_us) {
+        if (sim_in_isr()) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        SimWaitList never;
+        sim_block(never, c->to_us - c->from_us);
+    }
+    return ESP_OK;
+}
+
+} // extern "C"
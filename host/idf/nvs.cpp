@@ -0,0 +1,106 @@
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "idf_sim.hpp"
+#include "nvs.h"
+#include "nvs_flash.h"
+
+static bool s_initialized = false;
+static std::map<std::string, std::vector<uint8_t>> s_entries;
+// Open handles index their namespace; 0 is never a valid handle.
+static std::vector<std::string> s_namespaces{""};
+
+void sim_nvs_clear()
+{
+    s_entries.clear();
+    s_namespaces.resize(1);
+    s_initialized = false;
+}
+
+static const std::string* namespace_of(nvs_handle_t handle)
+{
+    return handle != 0 && handle < s_namespaces.size() ? &s_namespaces[handle] : nullptr;
+}
+
+extern "C" {
+
+esp_err_t nvs_flash_init(void)
+{
+    s_initialized = true;
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void)
+{
+    if (sim_fault_hit(SimFault::FlashWriteFailure)) {
+        return ESP_FAIL;
+    }
+    s_entries.clear();
+    return ESP_OK;
+}
+
+esp_err_t nvs_open(const char* namespace_name, nvs_open_mode_t, nvs_handle_t* out_handle)
+{
+    if (!s_initialized) {
+        return ESP_ERR_NVS_NOT_INITIALIZED;
+    }
+    if (namespace_name == nullptr || out_handle == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_namespaces.push_back(namespace_name);
+    *out_handle = nvs_handle_t(s_namespaces.size() - 1);
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t)
+{
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char* key, void* out_value, size_t* length)
+{
+    const std::string* space = namespace_of(handle);
+    if (space == nullptr) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    if (key == nullptr || length == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const auto it = s_entries.find(*space + '\0' + key);
+    if (it == s_entries.end()) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (out_value != nullptr) {
+        if (*length < it->second.size()) {
+            return ESP_ERR_NVS_INVALID_LENGTH;
+        }
+        memcpy(out_value, it->second.data(), it->second.size());
+    }
+    *length = it->second.size();
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char* key, const void* value, size_t length)
+{
+    const std::string* space = namespace_of(handle);
+    if (space == nullptr) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    if (key == nullptr || (value == nullptr && length != 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (sim_fault_hit(SimFault::FlashWriteFailure)) {
+        return ESP_FAIL;
+    }
+    const auto* bytes = static_cast<const uint8_t*>(value);
+    s_entries[*space + '\0' + key].assign(bytes, bytes + length);
+    return ESP_OK;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    return namespace_of(handle) != nullptr ? ESP_OK : ESP_ERR_NVS_INVALID_HANDLE;
+}
+
+} // extern "C"
@@ -0,0 +1,82 @@
+#include <functional>
+
+#include "chip.hpp"
+#include "esp_sleep.h"
+#include "idf_sim.hpp"
+
+static std::function<void()> s_boot;
+static bool s_ulp_wakeup = false;
+static bool s_sleeping = false;
+static esp_sleep_wakeup_cause_t s_cause = ESP_SLEEP_WAKEUP_UNDEFINED;
+static uint64_t s_sleep_start_us = 0;
+static uint64_t s_slept_us = 0;
+static uint32_t s_wakes = 0;
+
+void sim_deep_sleep_set_boot(std::function<void()> boot)
+{
+    s_boot = std::move(boot);
+}
+
+bool sim_deep_sleeping()
+{
+    return s_sleeping;
+}
+
+uint64_t sim_deep_sleep_us()
+{
+    return s_slept_us + (s_sleeping ? sim_now_us() - s_sleep_start_us : 0);
+}
+
+uint32_t sim_deep_sleep_wakes()
+{
+    return s_wakes;
+}
+
+bool sim_ready_for_wakeup()
+{
+    return s_sleeping;
+}
+
+void sim_ulp_wake()
+{
+    if (!s_sleeping || !s_ulp_wakeup) {
+        return;
+    }
+    s_sleeping = false;
+    s_slept_us += sim_now_us() - s_sleep_start_us;
+    ++s_wakes;
+    // Wakeup sources are configured afresh on every boot.
+    s_ulp_wakeup = false;
+    s_cause = ESP_SLEEP_WAKEUP_ULP;
+    if (s_boot) {
+        s_boot();
+    }
+}
+
+extern "C" {
+
+esp_err_t esp_sleep_enable_ulp_wakeup(void)
+{
+    s_ulp_wakeup = true;
+    return ESP_OK;
+}
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause(void)
+{
+    return s_cause;
+}
+
+void esp_deep_sleep_start(void)
+{
+    s_sleeping = true;
+    s_sleep_start_us = sim_now_us();
+    sim_adc_power_down();
+    sim_gpio_power_down();
+    sim_i2c_power_down();
+    sim_ledc_power_down();
+    sim_spi_power_down();
+    sim_uart_power_down();
+    sim_tasks_power_down();
+}
+
+} // extern "C"
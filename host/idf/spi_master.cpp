@@ -0,0 +1,158 @@
+#include <algorithm>
+#include <cstring>
+#include <deque>
+
+#include "chip.hpp"
+#include "driver/spi_master.h"
+#include "idf_sim.hpp"
+
+struct spi_device_t
+{
+    spi_host_device_t host;
+    int clock_speed_hz;
+    int queue_size;
+    // Queued transactions and when each finishes.
+    std::deque<std::pair<spi_transaction_t*, uint64_t>> queue;
+    SimWaitList waiters;
+};
+
+static bool s_buses[SPI_HOST_MAX];
+static spi_device_t* s_bus_devices[SPI_HOST_MAX];
+static SimSpiDevice s_devices[SPI_HOST_MAX];
+
+void sim_spi_set_device(spi_host_device_t host, SimSpiDevice device)
+{
+    if (host >= 0 && host < SPI_HOST_MAX) {
+        s_devices[host] = std::move(device);
+    }
+}
+
+void sim_spi_power_down()
+{
+    for (int host = 0; host < SPI_HOST_MAX; ++host) {
+        s_buses[host] = false;
+        s_bus_devices[host] = nullptr;
+    }
+}
+
+extern "C" {
+
+esp_err_t spi_bus_initialize(spi_host_device_t host_id, const spi_bus_config_t* bus_config, spi_common_dma_t)
+{
+    // SPI1 is the flash's bus.
+    if (bus_config == nullptr || host_id <= SPI1_HOST || host_id >= SPI_HOST_MAX ||
+        bus_config->mosi_io_num >= GPIO_NUM_MAX || bus_config->miso_io_num >= GPIO_NUM_MAX ||
+        bus_config->sclk_io_num >= GPIO_NUM_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_buses[host_id]) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (sim_fault_hit(SimFault::AllocFailure)) {
+        return ESP_ERR_NO_MEM;
+    }
+    s_buses[host_id] = true;
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_free(spi_host_device_t host_id)
+{
+    if (host_id < 0 || host_id >= SPI_HOST_MAX || !s_buses[host_id] || s_bus_devices[host_id] != nullptr) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_buses[host_id] = false;
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_add_device(spi_host_device_t host_id, const spi_device_interface_config_t* dev_config,
+                             spi_device_handle_t* handle)
+{
+    if (dev_config == nullptr || handle == nullptr || host_id < 0 || host_id >= SPI_HOST_MAX ||
+        dev_config->clock_speed_hz <= 0 || dev_config->mode > 3) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_buses[host_id]) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (s_bus_devices[host_id] != nullptr) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (sim_fault_hit(SimFault::AllocFailure)) {
+        return ESP_ERR_NO_MEM;
+    }
+    *handle = new spi_device_t{host_id, dev_config->clock_speed_hz, std::max(1, dev_config->queue_size), {}, {}};
+    s_bus_devices[host_id] = *handle;
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_remove_device(spi_device_handle_t handle)
+{
+    if (handle == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!handle->queue.empty()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_bus_devices[handle->host] = nullptr;
+    delete handle;
+    return ESP_OK;
+}
+
+esp_err_t spi_device_queue_trans(spi_device_handle_t handle, spi_transaction_t* trans_desc, TickType_t)
+{
+    if (handle == nullptr || trans_desc == nullptr || trans_desc->length == 0 ||
+        (trans_desc->tx_buffer == nullptr && trans_desc->rx_buffer == nullptr)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (handle->queue.size() >= size_t(handle->queue_size)) {
+        return ESP_ERR_TIMEOUT;
+    }
+    const size_t bits = trans_desc->length;
+    const size_t bytes = (bits + 7) / 8;
+    // The target sees the whole transaction at once; only its end is timed.
+    uint8_t tx[64] = {};
+    uint8_t rx[64];
+    if (bytes > sizeof(tx)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (trans_desc->tx_buffer != nullptr) {
+        memcpy(tx, trans_desc->tx_buffer, bytes);
+    }
+    memset(rx, 0xff, sizeof(rx));
+    if (s_devices[handle->host]) {
+        s_devices[handle->host](tx, rx, bits);
+    }
+    if (trans_desc->rx_buffer != nullptr) {
+        memcpy(trans_desc->rx_buffer, rx, bytes);
+    }
+    const uint64_t start_us = handle->queue.empty() ? sim_now_us() : handle->queue.back().second;
+    const uint64_t end_us = start_us + (uint64_t(bits) * 1'000'000 + handle->clock_speed_hz - 1) /
+                                           uint64_t(handle->clock_speed_hz);
+    handle->queue.emplace_back(trans_desc, end_us);
+    return ESP_OK;
+}
+
+esp_err_t spi_device_get_trans_result(spi_device_handle_t handle, spi_transaction_t** trans_desc,
+                                      TickType_t ticks_to_wait)
+{
+    if (handle == nullptr || trans_desc == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const uint64_t deadline_us = ticks_to_wait == portMAX_DELAY
+                                     ? kSimForever
+                                     : sim_now_us() + uint64_t(pdTICKS_TO_MS(ticks_to_wait)) * 1000;
+    while (handle->queue.empty() || handle->queue.front().second > sim_now_us()) {
+        const uint64_t wake_us = handle->queue.empty() ? deadline_us
+                                                       : std::min(deadline_us, handle->queue.front().second);
+        if (wake_us <= sim_now_us() || sim_in_isr()) {
+            return ESP_ERR_TIMEOUT;
+        }
+        // Nothing wakes the list: this only waits out the transfer or the timeout.
+        sim_block(handle->waiters, wake_us - sim_now_us());
+    }
+    *trans_desc = handle->queue.front().first;
+    handle->queue.pop_front();
+    return ESP_OK;
+}
+
+} // extern "C"
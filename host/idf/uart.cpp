@@ -0,0 +1,81 @@
+#include <array>
+#include <cstdio>
+
+#include "chip.hpp"
+#include "driver/uart.h"
+#include "idf_sim.hpp"
+
+struct UartPort
+{
+    bool installed = false;
+    FILE* output = nullptr;
+};
+
+static std::array<UartPort, UART_NUM_MAX> s_ports;
+
+void sim_uart_set_output(uart_port_t port, FILE* output)
+{
+    s_ports[port].output = output;
+}
+
+void sim_uart_power_down()
+{
+    for (auto& port : s_ports) {
+        port.installed = false;
+    }
+}
+
+static bool valid(uart_port_t port)
+{
+    return port >= 0 && port < UART_NUM_MAX;
+}
+
+extern "C" {
+
+esp_err_t uart_driver_install(uart_port_t uart_num, int rx_buffer_size, int tx_buffer_size, int,
+                              void*, int)
+{
+    if (!valid(uart_num) || rx_buffer_size <= 0 || tx_buffer_size < 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_ports[uart_num].installed) {
+        return ESP_FAIL;
+    }
+    if (sim_fault_hit(SimFault::AllocFailure)) {
+        return ESP_ERR_NO_MEM;
+    }
+    s_ports[uart_num].installed = true;
+    return ESP_OK;
+}
+
+esp_err_t uart_driver_delete(uart_port_t uart_num)
+{
+    if (!valid(uart_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_ports[uart_num].installed = false;
+    return ESP_OK;
+}
+
+esp_err_t uart_param_config(uart_port_t uart_num, const uart_config_t* uart_config)
+{
+    return valid(uart_num) && uart_config != nullptr && uart_config->baud_rate > 0 ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t uart_set_pin(uart_port_t uart_num, int tx_io_num, int rx_io_num, int, int)
+{
+    return valid(uart_num) && tx_io_num < GPIO_NUM_MAX && rx_io_num < GPIO_NUM_MAX ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+int uart_write_bytes(uart_port_t uart_port, const void* src, size_t size)
+{
+    if (!valid(uart_port) || !s_ports[uart_port].installed || src == nullptr) {
+        return -1;
+    }
+    if (s_ports[uart_port].output != nullptr) {
+        fwrite(src, 1, size, s_ports[uart_port].output);
+    }
+    return int(size);
+}
+
+} // extern "C"
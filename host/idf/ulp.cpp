@@ -0,0 +1,230 @@
+#include <algorithm>
+#include <vector>
+
+#include "chip.hpp"
+#include "esp32/ulp.h"
+#include "idf_sim.hpp"
+#include "sdkconfig.h"
+#include "ulp_adc.h"
+
+constexpr size_t kReserveWords = CONFIG_ULP_COPROC_RESERVE_MEM / sizeof(uint32_t);
+constexpr size_t kPeriods = 5;
+// A program still running after this many instructions is stuck in a loop; the host ends the run there.
+constexpr uint64_t kMaxInstructionsPerRun = 100'000;
+
+// RTC_FAST_CLK cycles per instruction, from the ESP32 technical reference manual. The ADC's depends on the SAR
+// timing registers; this is about what the driver's defaults give.
+constexpr uint32_t kAluCycles = 6;
+constexpr uint32_t kMemoryCycles = 8;
+constexpr uint32_t kJumpCycles = 4;
+constexpr uint32_t kRegisterCycles = 8;
+constexpr uint32_t kWakeCycles = 6;
+constexpr uint32_t kHaltCycles = 2;
+constexpr uint32_t kAdcCycles = 80;
+
+uint32_t sim_rtc_slow_mem[2048];
+
+// Loaded instructions by word address; the data words they share RTC_SLOW_MEM with are in sim_rtc_slow_mem.
+static std::vector<ulp_insn_t> s_code(kReserveWords, ulp_insn_t{SIM_ULP_HALT, 0, 0, 0, 0, 0});
+static uint32_t s_period_us[kPeriods] = {10'000, 10'000, 10'000, 10'000, 10'000};
+static int s_periodic = -1;
+static uint32_t s_entry = 0;
+static bool s_adc_ready = false;
+static ulp_adc_cfg_t s_adc{};
+static uint64_t s_runs = 0;
+static uint64_t s_cycles = 0;
+
+uint64_t sim_ulp_runs()
+{
+    return s_runs;
+}
+
+uint64_t sim_ulp_cycles()
+{
+    return s_cycles;
+}
+
+static uint32_t read_register(uint32_t address)
+{
+    return address == RTC_CNTL_LOW_POWER_ST_REG ? uint32_t(sim_ready_for_wakeup()) << RTC_CNTL_RDY_FOR_WAKEUP_S : 0;
+}
+
+static void run_program()
+{
+    uint16_t r[4] = {};
+    uint32_t pc = s_entry;
+    ++s_runs;
+    for (uint64_t executed = 0; executed < kMaxInstructionsPerRun; ++executed) {
+        if (pc >= kReserveWords) {
+            return;
+        }
+        const ulp_insn_t& insn = s_code[pc++];
+        switch (insn.op) {
+        case SIM_ULP_ADC:
+            r[insn.rd] = insn.arg == 0 && s_adc_ready && insn.imm == s_adc.channel
+                             ? sim_adc_sample(s_adc.channel, s_adc.width)
+                             : 0;
+            s_cycles += kAdcCycles;
+            break;
+        case SIM_ULP_MOVI:
+            r[insn.rd] = uint16_t(insn.imm);
+            s_cycles += kAluCycles;
+            break;
+        case SIM_ULP_MOVR:
+            r[insn.rd] = r[insn.rs1];
+            s_cycles += kAluCycles;
+            break;
+        case SIM_ULP_ADDR:
+            r[insn.rd] = uint16_t(r[insn.rs1] + r[insn.rs2]);
+            s_cycles += kAluCycles;
+            break;
+        case SIM_ULP_ADDI:
+            r[insn.rd] = uint16_t(r[insn.rs1] + insn.imm);
+            s_cycles += kAluCycles;
+            break;
+        case SIM_ULP_SUBR:
+            r[insn.rd] = uint16_t(r[insn.rs1] - r[insn.rs2]);
+            s_cycles += kAluCycles;
+            break;
+        case SIM_ULP_SUBI:
+            r[insn.rd] = uint16_t(r[insn.rs1] - insn.imm);
+            s_cycles += kAluCycles;
+            break;
+        case SIM_ULP_ANDI:
+            r[insn.rd] = uint16_t(r[insn.rs1] & insn.imm);
+            s_cycles += kAluCycles;
+            break;
+        case SIM_ULP_RSHI:
+            r[insn.rd] = uint16_t(r[insn.rs1] >> insn.imm);
+            s_cycles += kAluCycles;
+            break;
+        case SIM_ULP_LSHI:
+            r[insn.rd] = uint16_t(r[insn.rs1] << insn.imm);
+            s_cycles += kAluCycles;
+            break;
+        case SIM_ULP_LD:
+            r[insn.rd] = uint16_t(sim_rtc_slow_mem[(r[insn.rs1] + insn.imm) & 0x7ff]);
+            s_cycles += kMemoryCycles;
+            break;
+        case SIM_ULP_ST:
+            sim_rtc_slow_mem[(r[insn.rs1] + insn.imm) & 0x7ff] = (pc - 1) << 21 | r[insn.rd];
+            s_cycles += kMemoryCycles;
+            break;
+        case SIM_ULP_RD_REG: {
+            const uint32_t low = insn.arg & 0xff;
+            const uint32_t width = (insn.arg >> 8) - low + 1;
+            r[R0] = uint16_t(read_register(uint32_t(insn.imm)) >> low & ((1u << width) - 1));
+            s_cycles += kRegisterCycles;
+            break;
+        }
+        case SIM_ULP_BL:
+        case SIM_ULP_BGE:
+            if ((r[R0] < insn.arg) == (insn.op == SIM_ULP_BL)) {
+                pc = pc - 1 + insn.imm;
+            }
+            s_cycles += kJumpCycles;
+            break;
+        case SIM_ULP_BXI:
+            pc = uint32_t(insn.imm);
+            s_cycles += kJumpCycles;
+            break;
+        case SIM_ULP_WAKE:
+            s_cycles += kWakeCycles;
+            sim_ulp_wake();
+            break;
+        case SIM_ULP_HALT:
+        default:
+            s_cycles += kHaltCycles;
+            return;
+        }
+    }
+}
+
+extern "C" {
+
+esp_err_t ulp_adc_init(const ulp_adc_cfg_t* cfg)
+{
+    if (cfg == nullptr || cfg->adc_n != ADC_UNIT_1 || cfg->channel > ADC_CHANNEL_7 || cfg->width < ADC_BITWIDTH_9 ||
+        cfg->width > ADC_BITWIDTH_12 || cfg->ulp_mode != ADC_ULP_MODE_FSM) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_adc = *cfg;
+    s_adc_ready = true;
+    return ESP_OK;
+}
+
+esp_err_t ulp_process_macros_and_load(uint32_t load_addr, const ulp_insn_t* program, size_t* psize)
+{
+    if (program == nullptr || psize == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // Labels take no space; the first pass places them.
+    std::vector<std::pair<int32_t, uint32_t>> labels;
+    uint32_t address = load_addr;
+    for (size_t i = 0; i < *psize; ++i) {
+        if (program[i].op != SIM_ULP_LABEL) {
+            ++address;
+            continue;
+        }
+        for (const auto& label : labels) {
+            if (label.first == program[i].imm) {
+                return ESP_ERR_INVALID_ARG;
+            }
+        }
+        labels.emplace_back(program[i].imm, address);
+    }
+    if (address > kReserveWords) {
+        return ESP_ERR_NO_MEM;
+    }
+    address = load_addr;
+    for (size_t i = 0; i < *psize; ++i) {
+        ulp_insn_t insn = program[i];
+        if (insn.op == SIM_ULP_LABEL) {
+            continue;
+        }
+        if (insn.op == SIM_ULP_M_BL || insn.op == SIM_ULP_M_BGE || insn.op == SIM_ULP_M_BX) {
+            const auto label = std::find_if(labels.begin(), labels.end(),
+                                            [&](const auto& l) { return l.first == insn.imm; });
+            if (label == labels.end()) {
+                return ESP_ERR_NOT_FOUND;
+            }
+            insn.op = insn.op == SIM_ULP_M_BL ? SIM_ULP_BL : insn.op == SIM_ULP_M_BGE ? SIM_ULP_BGE : SIM_ULP_BXI;
+            insn.imm = insn.op == SIM_ULP_BXI ? int32_t(label->second) : int32_t(label->second) - int32_t(address);
+        }
+        s_code[address++] = insn;
+    }
+    *psize = address - load_addr;
+    return ESP_OK;
+}
+
+esp_err_t ulp_set_wakeup_period(size_t period_index, uint32_t period_us)
+{
+    if (period_index >= kPeriods) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_period_us[period_index] = period_us;
+    return ESP_OK;
+}
+
+esp_err_t ulp_run(uint32_t entry_point)
+{
+    if (entry_point >= kReserveWords) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    ulp_timer_stop();
+    s_entry = entry_point;
+    // The program runs in zero time, so a period after each HALT is a period after each start.
+    s_periodic = sim_add_periodic(sim_now_us(), s_period_us[0], run_program);
+    return ESP_OK;
+}
+
+esp_err_t ulp_timer_stop(void)
+{
+    if (s_periodic >= 0) {
+        sim_remove_periodic(s_periodic);
+        s_periodic = -1;
+    }
+    return ESP_OK;
+}
+
+} // extern "C"
@@ -0,0 +1,400 @@
+#include <ucontext.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "chip.hpp"
+#include "freertos/task.h"
+#include "idf_sim.hpp"
+
+constexpr uint64_t kTickUs = 1'000'000 / configTICK_RATE_HZ;
+constexpr size_t kMinStackBytes = 256 * 1024;
+
+enum class TaskState
+{
+    Ready,
+    Blocked,
+    Deleted,
+};
+
+struct tskTaskControlBlock
+{
+    std::string name;
+    TaskFunction_t fn = nullptr;
+    void* arg = nullptr;
+    UBaseType_t priority = 0;
+    ucontext_t context{};
+    std::unique_ptr<char[]> stack;
+    TaskState state = TaskState::Ready;
+    uint64_t ready_seq = 0;
+    // Incremented on every block so stale timeout events can be recognised.
+    uint64_t wait_generation = 0;
+    bool timed_out = false;
+    bool waiting_notify = false;
+    uint32_t notify_count = 0;
+    SimWaitList* wait_list = nullptr;
+};
+
+namespace {
+
+enum class EventKind
+{
+    Timeout,
+    Periodic,
+};
+
+struct Event
+{
+    uint64_t time;
+    uint64_t seq;
+    EventKind kind;
+    TaskHandle_t task;
+    uint64_t generation;
+    int periodic;
+
+    bool operator>(const Event& other) const { return time != other.time ? time > other.time : seq > other.seq; }
+};
+
+struct Periodic
+{
+    uint64_t period_us;
+    std::function<void()> fn;
+};
+
+struct Scheduler
+{
+    uint64_t now_us = 0;
+    uint64_t seq = 0;
+    ucontext_t context{};
+    TaskHandle_t current = nullptr;
+    bool in_isr = false;
+    std::vector<std::unique_ptr<tskTaskControlBlock>> tasks;
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+    std::map<int, Periodic> periodics;
+    int next_periodic = 0;
+
+    void make_ready(TaskHandle_t task)
+    {
+        task->state = TaskState::Ready;
+        task->ready_seq = seq++;
+        task->waiting_notify = false;
+        if (task->wait_list != nullptr) {
+            auto& waiters = task->wait_list->waiters;
+            waiters.erase(std::remove(waiters.begin(), waiters.end(), task), waiters.end());
+            task->wait_list = nullptr;
+        }
+    }
+
+    TaskHandle_t next_ready()
+    {
+        TaskHandle_t best = nullptr;
+        for (const auto& task : tasks) {
+            if (task->state == TaskState::Ready &&
+                (best == nullptr || task->priority > best->priority ||
+                 (task->priority == best->priority && task->ready_seq < best->ready_seq))) {
+                best = task.get();
+            }
+        }
+        return best;
+    }
+
+    // Parks the current task until made ready again, optionally with a timeout at `wake_us`.
+    bool block(uint64_t wake_us)
+    {
+        TaskHandle_t task = current;
+        assert(task != nullptr && !in_isr && "blocking call outside a task");
+        task->state = TaskState::Blocked;
+        task->timed_out = false;
+        ++task->wait_generation;
+        if (wake_us != kSimForever) {
+            events.push({std::max(wake_us, now_us), seq++, EventKind::Timeout, task, task->wait_generation, 0});
+        }
+        swapcontext(&task->context, &context);
+        return !task->timed_out;
+    }
+
+    void yield()
+    {
+        TaskHandle_t task = current;
+        make_ready(task);
+        swapcontext(&task->context, &context);
+    }
+
+    // Preempts the current task if `woken` now outranks it, as FreeRTOS would on a yield.
+    void maybe_preempt(TaskHandle_t woken)
+    {
+        if (current != nullptr && !in_isr && woken->priority > current->priority) {
+            yield();
+        }
+    }
+
+    void fire(const Event& event)
+    {
+        if (event.kind == EventKind::Timeout) {
+            TaskHandle_t task = event.task;
+            const bool alive = std::any_of(tasks.begin(), tasks.end(), [&](const auto& t) { return t.get() == task; });
+            if (alive && task->state == TaskState::Blocked && task->wait_generation == event.generation) {
+                task->timed_out = true;
+                make_ready(task);
+            }
+            return;
+        }
+        const auto it = periodics.find(event.periodic);
+        if (it == periodics.end()) {
+            return;
+        }
+        events.push({event.time + it->second.period_us, seq++, EventKind::Periodic, nullptr, 0, event.periodic});
+        in_isr = true;
+        it->second.fn();
+        in_isr = false;
+    }
+
+    void run_until(uint64_t end_us)
+    {
+        while (true) {
+            if (TaskHandle_t task = next_ready()) {
+                current = task;
+                swapcontext(&context, &task->context);
+                current = nullptr;
+                if (task->state == TaskState::Deleted) {
+                    tasks.erase(std::find_if(tasks.begin(), tasks.end(), [&](const auto& t) { return t.get() == task; }));
+                }
+                continue;
+            }
+            if (events.empty() || events.top().time > end_us) {
+                now_us = std::max(now_us, end_us == kSimForever ? now_us : end_us);
+                return;
+            }
+            const Event event = events.top();
+            events.pop();
+            now_us = event.time;
+            fire(event);
+        }
+    }
+};
+
+Scheduler& scheduler()
+{
+    static Scheduler instance;
+    return instance;
+}
+
+void task_entry()
+{
+    auto& s = scheduler();
+    TaskHandle_t task = s.current;
+    task->fn(task->arg);
+    // Returning from a task function is treated as vTaskDelete(NULL), as IDF does for app_main.
+    vTaskDelete(nullptr);
+}
+
+uint64_t ticks_to_us(TickType_t ticks)
+{
+    return ticks == portMAX_DELAY ? kSimForever : scheduler().now_us + uint64_t(ticks) * kTickUs;
+}
+
+} // namespace
+
+uint64_t sim_now_us()
+{
+    return scheduler().now_us;
+}
+
+void sim_run_until(uint64_t end_us)
+{
+    scheduler().run_until(end_us);
+}
+
+void sim_reset()
+{
+    auto& s = scheduler();
+    assert(s.current == nullptr);
+    s.tasks.clear();
+    s.events = {};
+    s.periodics.clear();
+    s.now_us = 0;
+    s.seq = 0;
+}
+
+void sim_tasks_power_down()
+{
+    auto& s = scheduler();
+    while (s.tasks.size() > 1) {
+        auto it = std::find_if(s.tasks.begin(), s.tasks.end(), [&](const auto& t) { return t.get() != s.current; });
+        vTaskDelete(it->get());
+    }
+    vTaskDelete(nullptr);
+    abort();
+}
+
+int sim_add_periodic(uint64_t first_us, uint64_t period_us, std::function<void()> fn)
+{
+    auto& s = scheduler();
+    const int id = s.next_periodic++;
+    s.periodics[id] = {std::max<uint64_t>(1, period_us), std::move(fn)};
+    s.events.push({first_us, s.seq++, EventKind::Periodic, nullptr, 0, id});
+    return id;
+}
+
+void sim_remove_periodic(int id)
+{
+    scheduler().periodics.erase(id);
+}
+
+bool sim_in_isr()
+{
+    return scheduler().in_isr;
+}
+
+bool sim_block(SimWaitList& list, uint64_t timeout_us)
+{
+    auto& s = scheduler();
+    list.waiters.push_back(s.current);
+    s.current->wait_list = &list;
+    return s.block(timeout_us == kSimForever ? kSimForever : s.now_us + timeout_us);
+}
+
+void sim_wake_all(SimWaitList& list)
+{
+    auto& s = scheduler();
+    const auto waiters = list.waiters;
+    for (TaskHandle_t task : waiters) {
+        s.make_ready(task);
+    }
+    for (TaskHandle_t task : waiters) {
+        s.maybe_preempt(task);
+    }
+}
+
+extern "C" {
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pxTaskCode, const char* pcName, uint32_t usStackDepth,
+                                   void* pvParameters, UBaseType_t uxPriority, TaskHandle_t* pxCreatedTask,
+                                   BaseType_t)
+{
+    auto& s = scheduler();
+    auto task = std::make_unique<tskTaskControlBlock>();
+    task->name = pcName != nullptr ? pcName : "";
+    task->fn = pxTaskCode;
+    task->arg = pvParameters;
+    task->priority = uxPriority;
+
+    // Host frames are much larger than Xtensa ones, so never go below a generous floor.
+    const size_t stack_bytes = std::max<size_t>(kMinStackBytes, size_t(usStackDepth) * 8);
+    task->stack.reset(new char[stack_bytes]);
+    getcontext(&task->context);
+    task->context.uc_stack.ss_sp = task->stack.get();
+    task->context.uc_stack.ss_size = stack_bytes;
+    task->context.uc_link = &s.context;
+    makecontext(&task->context, task_entry, 0);
+
+    TaskHandle_t handle = task.get();
+    s.make_ready(handle);
+    s.tasks.push_back(std::move(task));
+    if (pxCreatedTask != nullptr) {
+        *pxCreatedTask = handle;
+    }
+    s.maybe_preempt(handle);
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t pxTaskCode, const char* pcName, uint32_t usStackDepth, void* pvParameters,
+                       UBaseType_t uxPriority, TaskHandle_t* pxCreatedTask)
+{
+    return xTaskCreatePinnedToCore(pxTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask, 0);
+}
+
+void vTaskDelete(TaskHandle_t xTaskToDelete)
+{
+    auto& s = scheduler();
+    TaskHandle_t task = xTaskToDelete != nullptr ? xTaskToDelete : s.current;
+    if (task != s.current) {
+        // make_ready() detaches it from any wait list before it goes.
+        s.make_ready(task);
+        s.tasks.erase(std::find_if(s.tasks.begin(), s.tasks.end(), [&](const auto& t) { return t.get() == task; }));
+        return;
+    }
+    task->state = TaskState::Deleted;
+    // The scheduler frees the stack once it is no longer running on it.
+    swapcontext(&task->context, &s.context);
+    abort();
+}
+
+void vTaskDelay(TickType_t xTicksToDelay)
+{
+    auto& s = scheduler();
+    if (xTicksToDelay == 0) {
+        s.yield();
+        return;
+    }
+    // Delays end on a tick boundary, like the tick interrupt that wakes the task on the device.
+    const uint64_t tick = s.now_us / kTickUs;
+    s.block((tick + xTicksToDelay) * kTickUs);
+}
+
+void taskYIELD(void)
+{
+    scheduler().yield();
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return TickType_t(scheduler().now_us / kTickUs);
+}
+
+TickType_t xTaskGetTickCountFromISR(void)
+{
+    return xTaskGetTickCount();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return scheduler().current;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait)
+{
+    auto& s = scheduler();
+    TaskHandle_t task = s.current;
+    if (task->notify_count == 0 && xTicksToWait != 0) {
+        task->waiting_notify = true;
+        s.block(ticks_to_us(xTicksToWait));
+    }
+    const uint32_t value = task->notify_count;
+    if (value != 0) {
+        task->notify_count = xClearCountOnExit ? 0 : value - 1;
+    }
+    return value;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t* pxHigherPriorityTaskWoken)
+{
+    auto& s = scheduler();
+    ++xTaskToNotify->notify_count;
+    if (xTaskToNotify->state == TaskState::Blocked && xTaskToNotify->waiting_notify) {
+        s.make_ready(xTaskToNotify);
+        if (pxHigherPriorityTaskWoken != nullptr) {
+            *pxHigherPriorityTaskWoken = pdTRUE;
+        }
+    }
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify)
+{
+    auto& s = scheduler();
+    const bool was_waiting = xTaskToNotify->state == TaskState::Blocked && xTaskToNotify->waiting_notify;
+    vTaskNotifyGiveFromISR(xTaskToNotify, nullptr);
+    if (was_waiting) {
+        s.maybe_preempt(xTaskToNotify);
+    }
+    return pdPASS;
+}
+
+} // extern "C"
@@ -0,0 +1,303 @@
+// Monte Carlo robustness analysis of the measurement and control chain. Each run draws a calibration error for the
+// app_main polynomials, ADC noise, thermistor tolerance and plant parameters, then runs a full drying profile with
+// the firmware's Dryer. Runs are stepped in batches through BatchPlant and spread over the thread pool.
+//
+// Prints percentiles of chamber temperature error, overshoot, completion time and energy, and the correlation of
+// every sampled input with every outcome.
+//
+//   monte_carlo [--runs N] [--seed N] [--threads N] [--out runs.csv]
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "batch_plant.hpp"
+#include "dryer.hpp"
+#include "thread_pool.hpp"
+
+constexpr size_t kLanes = 64;
+// The soak starts once the spool's core reaches the setpoint, some six hours in.
+constexpr uint32_t kMaxDurationS = 12 * 3600;
+constexpr float kSetpoint = 55.0f;
+constexpr uint32_t kSoakS = 4 * 3600;
+
+// Sampled uncertainties of one run. The calibration and thermistor errors are expressed as the difference between
+// the temperature the firmware computes and the true sensor temperature.
+struct Inputs
+{
+    float cal_offset;    // degC, polynomial fit error at 50 C
+    float cal_gain;      // degC/degC
+    float cal_curvature; // degC/degC^2
+    float tol_offset;    // degC, thermistor R25 tolerance
+    float tol_slope;     // degC/degC away from 25 C, thermistor beta tolerance
+    float adc_noise;     // codes RMS per sample
+    PlantParams plant;
+};
+
+struct Outcome
+{
+    float temp_error;   // mean (air - setpoint) while soaking
+    float overshoot;    // max (air - setpoint)
+    float completion_s; // kMaxDurationS if the profile never completed
+    float energy_wh;
+};
+
+constexpr std::array kInputNames{"cal_offset", "cal_gain", "cal_curvature", "tol_offset", "tol_slope", "adc_noise",
+                                 "ambient", "heater_power", "air_capacity", "air_to_ambient", "sensor_tau"};
+constexpr std::array kOutcomeNames{"temp_error", "overshoot", "completion_s", "energy_wh"};
+
+static std::array<float, kInputNames.size()> input_values(const Inputs& in)
+{
+    return {in.cal_offset, in.cal_gain, in.cal_curvature, in.tol_offset, in.tol_slope, in.adc_noise,
+            in.plant.ambient, in.plant.heater_power, in.plant.air_capacity, in.plant.air_to_ambient, in.plant.sensor_tau};
+}
+
+static std::array<float, kOutcomeNames.size()> outcome_values(const Outcome& out)
+{
+    return {out.temp_error, out.overshoot, out.completion_s, out.energy_wh};
+}
+
+static uint64_t splitmix64(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+static Inputs sample_inputs(std::mt19937& rng)
+{
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    Inputs in;
+    in.cal_offset = 0.7f * normal(rng);
+    in.cal_gain = 0.01f * normal(rng);
+    in.cal_curvature = 1e-4f * normal(rng);
+    in.tol_offset = 0.25f * normal(rng);
+    in.tol_slope = 0.004f * normal(rng);
+    in.adc_noise = 1.0f + 3.0f * unit(rng);
+    in.plant.ambient = 15.0f + 15.0f * unit(rng);
+    in.plant.heater_power *= 1.0f + 0.08f * normal(rng);
+    in.plant.air_capacity *= 0.7f + 0.8f * unit(rng);
+    in.plant.air_to_ambient *= 1.0f + 0.1f * normal(rng);
+    in.plant.heater_to_air *= 1.0f + 0.1f * normal(rng);
+    in.plant.sensor_tau = 5.0f + 10.0f * unit(rng);
+    return in;
+}
+
+// Runs lanes [first, first + count) of the analysis.
+static void run_batch(uint64_t seed, size_t first, size_t count, const AdcModel& adc, Inputs* inputs, Outcome* outcomes)
+{
+    BatchPlant plant(count);
+    std::vector<std::mt19937> rngs;
+    std::vector<Dryer> dryers(count);
+    DryingProfile profile;
+    profile.setpoint = kSetpoint;
+    profile.soak_s = kSoakS;
+
+    for (size_t lane = 0; lane < count; ++lane) {
+        rngs.emplace_back(uint32_t(splitmix64(seed ^ splitmix64(first + lane))));
+        inputs[lane] = sample_inputs(rngs[lane]);
+        plant.set(lane, inputs[lane].plant);
+        dryers[lane].start(profile);
+        outcomes[lane] = {0.0f, -100.0f, float(kMaxDurationS), 0.0f};
+    }
+    plant.reset();
+
+    std::vector<float> sensed(count);
+    std::vector<uint8_t> heater(count);
+    std::vector<double> energy(count);
+    std::vector<double> soak_error(count);
+    std::vector<uint32_t> soak_steps(count);
+    std::vector<uint8_t> done(count);
+    size_t remaining = count;
+
+    for (uint32_t t = 0; t < kMaxDurationS && remaining != 0; ++t) {
+        // What the firmware's conversion reports for the true sensor temperature.
+        for (size_t lane = 0; lane < count; ++lane) {
+            const auto& in = inputs[lane];
+            const float s = plant.sensor[lane];
+            const float d50 = s - 50.0f;
+            sensed[lane] = s + in.cal_offset + in.cal_gain * d50 + in.cal_curvature * d50 * d50 + in.tol_offset +
+                           in.tol_slope * (s - 25.0f);
+        }
+        for (size_t lane = 0; lane < count; ++lane) {
+            if (done[lane]) {
+                heater[lane] = 0;
+                continue;
+            }
+            const float sigma = inputs[lane].adc_noise / std::sqrt(100.0f);
+            std::normal_distribution<float> noise(0.0f, sigma);
+            const float code = std::clamp(adc.code_for(sensed[lane]) + noise(rngs[lane]), 0.0f, 1023.0f);
+            const auto& status = dryers[lane].step(uint32_t(code), t * 1000);
+            heater[lane] = status.heater_on;
+            if (status.phase == DryerPhase::Done) {
+                done[lane] = 1;
+                outcomes[lane].completion_s = t;
+                --remaining;
+            } else if (status.phase == DryerPhase::Soaking) {
+                soak_error[lane] += plant.air[lane] - kSetpoint;
+                ++soak_steps[lane];
+            }
+        }
+        plant.step(heater.data(), 1.0f, energy.data());
+        for (size_t lane = 0; lane < count; ++lane) {
+            outcomes[lane].overshoot = std::max(outcomes[lane].overshoot, plant.air[lane] - kSetpoint);
+        }
+    }
+
+    for (size_t lane = 0; lane < count; ++lane) {
+        outcomes[lane].temp_error = soak_steps[lane] ? soak_error[lane] / soak_steps[lane] : NAN;
+        outcomes[lane].energy_wh = energy[lane] / 3600.0;
+    }
+}
+
+static float percentile(std::vector<float>& sorted, float p)
+{
+    const float pos = p * (sorted.size() - 1);
+    const size_t lo = size_t(pos);
+    const size_t hi = std::min(lo + 1, sorted.size() - 1);
+    return sorted[lo] + (sorted[hi] - sorted[lo]) * (pos - lo);
+}
+
+static double correlation(const std::vector<float>& a, const std::vector<float>& b)
+{
+    double ma = 0.0;
+    double mb = 0.0;
+    size_t n = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (std::isfinite(a[i]) && std::isfinite(b[i])) {
+            ma += a[i];
+            mb += b[i];
+            ++n;
+        }
+    }
+    ma /= n;
+    mb /= n;
+    double cov = 0.0;
+    double va = 0.0;
+    double vb = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (std::isfinite(a[i]) && std::isfinite(b[i])) {
+            cov += (a[i] - ma) * (b[i] - mb);
+            va += (a[i] - ma) * (a[i] - ma);
+            vb += (b[i] - mb) * (b[i] - mb);
+        }
+    }
+    return va > 0.0 && vb > 0.0 ? cov / std::sqrt(va * vb) : 0.0;
+}
+
+int main(int argc, char** argv)
+{
+    size_t runs = 20'000;
+    uint64_t seed = 1;
+    unsigned threads = std::thread::hardware_concurrency();
+    const char* out = nullptr;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--runs") == 0) {
+            runs = strtoull(argv[i + 1], nullptr, 0);
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            seed = strtoull(argv[i + 1], nullptr, 0);
+        } else if (strcmp(argv[i], "--threads") == 0) {
+            threads = strtoul(argv[i + 1], nullptr, 0);
+        } else if (strcmp(argv[i], "--out") == 0) {
+            out = argv[i + 1];
+        } else {
+            argc = 0;
+        }
+    }
+    if (argc % 2 == 0 || runs == 0) {
+        fprintf(stderr, "usage: %s [--runs N] [--seed N] [--threads N] [--out runs.csv]\n", argv[0]);
+        return 1;
+    }
+
+    const AdcModel adc;
+    std::vector<Inputs> inputs(runs);
+    std::vector<Outcome> outcomes(runs);
+    ThreadPool pool(threads);
+
+    const auto start = std::chrono::steady_clock::now();
+    const size_t batches = (runs + kLanes - 1) / kLanes;
+    pool.parallel_for(batches, [&](size_t b) {
+        const size_t first = b * kLanes;
+        run_batch(seed, first, std::min(kLanes, runs - first), adc, &inputs[first], &outcomes[first]);
+    });
+    const std::chrono::duration<double> wall = std::chrono::steady_clock::now() - start;
+    printf("%zu runs in %.1f s on %u threads\n\n", runs, wall.count(), pool.size());
+
+    std::array<std::vector<float>, kInputNames.size()> in_columns;
+    std::array<std::vector<float>, kOutcomeNames.size()> out_columns;
+    for (size_t i = 0; i < runs; ++i) {
+        const auto in = input_values(inputs[i]);
+        const auto o = outcome_values(outcomes[i]);
+        for (size_t c = 0; c < in.size(); ++c) {
+            in_columns[c].push_back(in[c]);
+        }
+        for (size_t c = 0; c < o.size(); ++c) {
+            out_columns[c].push_back(o[c]);
+        }
+    }
+
+    printf("%-14s %10s %10s %10s %10s %10s %10s %10s\n", "outcome", "mean", "std", "p1", "p5", "p50", "p95", "p99");
+    for (size_t c = 0; c < out_columns.size(); ++c) {
+        std::vector<float> sorted;
+        std::copy_if(out_columns[c].begin(), out_columns[c].end(), std::back_inserter(sorted),
+                     [](float v) { return std::isfinite(v); });
+        std::sort(sorted.begin(), sorted.end());
+        double mean = 0.0;
+        double var = 0.0;
+        for (const auto v : sorted) {
+            mean += v / sorted.size();
+        }
+        for (const auto v : sorted) {
+            var += (v - mean) * (v - mean) / sorted.size();
+        }
+        printf("%-14s %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f\n", kOutcomeNames[c], mean, std::sqrt(var),
+               percentile(sorted, 0.01f), percentile(sorted, 0.05f), percentile(sorted, 0.5f),
+               percentile(sorted, 0.95f), percentile(sorted, 0.99f));
+    }
+    const auto unfinished = std::count_if(outcomes.begin(), outcomes.end(), [](const Outcome& o) {
+        return o.completion_s >= kMaxDurationS;
+    });
+    printf("%zd runs did not complete within %u h\n\n", unfinished, kMaxDurationS / 3600);
+
+    printf("%-14s", "correlation");
+    for (const auto name : kOutcomeNames) {
+        printf(" %13s", name);
+    }
+    printf("\n");
+    for (size_t i = 0; i < in_columns.size(); ++i) {
+        printf("%-14s", kInputNames[i]);
+        for (size_t o = 0; o < out_columns.size(); ++o) {
+            printf(" %13.3f", correlation(in_columns[i], out_columns[o]));
+        }
+        printf("\n");
+    }
+
+    if (out != nullptr) {
+        FILE* f = fopen(out, "w");
+        if (f == nullptr) {
+            perror(out);
+            return 1;
+        }
+        for (const auto name : kInputNames) {
+            fprintf(f, "%s,", name);
+        }
+        fprintf(f, "temp_error,overshoot,completion_s,energy_wh\n");
+        for (size_t i = 0; i < runs; ++i) {
+            for (size_t c = 0; c < in_columns.size(); ++c) {
+                fprintf(f, "%.6g,", in_columns[c][i]);
+            }
+            fprintf(f, "%.4f,%.4f,%.0f,%.2f\n", outcomes[i].temp_error, outcomes[i].overshoot, outcomes[i].completion_s,
+                    outcomes[i].energy_wh);
+        }
+        fclose(f);
+    }
+    return 0;
+}
@@ -0,0 +1,375 @@
+// Searches controller gains, measurement filter cutoff and profile ramp rate by running the real HeaterController
+// and Dryer against a set of plant variants. Every candidate is scored on settling time, overshoot and heater
+// energy; all runs and the Pareto front over the three objectives are written as CSV.
+//
+// Runs are evaluated in parallel, but every candidate and plant seed is derived from --seed and results are kept
+// in candidate order, so the output is identical for any thread count.
+//
+//   param_sweep [--mode grid|random|bayes] [--samples N] [--steps N] [--seed N] [--threads N] [--out PREFIX]
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "scenario.hpp"
+#include "thread_pool.hpp"
+
+struct Param
+{
+    const char* name;
+    float lo;
+    float hi;
+    bool log_scale;
+};
+
+constexpr std::array kParams{
+    Param{"kp", 0.01f, 0.4f, true},
+    Param{"ki", 0.00005f, 0.005f, true},
+    Param{"kd", 0.0f, 20.0f, false},
+    Param{"filter_hz", 0.005f, 0.5f, true},
+    Param{"ramp_rate", 0.0f, 0.1f, false},
+};
+constexpr size_t kDims = kParams.size();
+using Point = std::array<double, kDims>;
+
+// Weights for the scalarized objective used by the Bayesian search: minutes to settle / 10, degrees of overshoot,
+// watt-hours / 100.
+constexpr double kSettleWeight = 1.0 / 600.0;
+constexpr double kOvershootWeight = 1.0;
+constexpr double kEnergyWeight = 1.0 / 100.0;
+
+struct Result
+{
+    Point x;
+    RunMetrics metrics;
+    double score;
+};
+
+static float param_value(const Param& p, double unit)
+{
+    if (p.log_scale) {
+        return p.lo * std::pow(p.hi / p.lo, unit);
+    }
+    return p.lo + (p.hi - p.lo) * unit;
+}
+
+static std::vector<ScenarioConfig> make_scenarios(const Point& x)
+{
+    ScenarioConfig base;
+    base.controller.gains = {param_value(kParams[0], x[0]), param_value(kParams[1], x[1]), param_value(kParams[2], x[2])};
+    base.controller.filter_cutoff_hz = param_value(kParams[3], x[3]);
+    base.profile.setpoint = 55.0f;
+    base.profile.ramp_rate = param_value(kParams[4], x[4]);
+
+    // Nominal unit, a heavily loaded chamber, and a weak heater in a cold room.
+    std::vector<ScenarioConfig> scenarios(3, base);
+    scenarios[1].plant.air_capacity *= 1.4f;
+    scenarios[1].seed = 2;
+    scenarios[2].plant.heater_power *= 0.8f;
+    scenarios[2].plant.ambient = 15.0f;
+    scenarios[2].seed = 3;
+    return scenarios;
+}
+
+static Result evaluate(const Point& x, const AdcModel& adc)
+{
+    Result result{x, {}, 0.0};
+    const auto scenarios = make_scenarios(x);
+    for (const auto& scenario : scenarios) {
+        const auto m = run_scenario(scenario, adc);
+        result.metrics.settling_s += m.settling_s / scenarios.size();
+        result.metrics.energy_wh += m.energy_wh / scenarios.size();
+        result.metrics.soak_error += m.soak_error / scenarios.size();
+        result.metrics.overshoot = std::max(result.metrics.overshoot, m.overshoot);
+    }
+    result.score = kSettleWeight * result.metrics.settling_s + kOvershootWeight * result.metrics.overshoot +
+                   kEnergyWeight * result.metrics.energy_wh;
+    return result;
+}
+
+static void evaluate_all(ThreadPool& pool, const AdcModel& adc, const std::vector<Point>& points,
+                         std::vector<Result>& results)
+{
+    const size_t base = results.size();
+    results.resize(base + points.size());
+    pool.parallel_for(points.size(), [&](size_t i) { results[base + i] = evaluate(points[i], adc); });
+}
+
+static std::vector<Point> grid_points(uint32_t steps)
+{
+    std::vector<Point> points;
+    Point x{};
+    std::array<uint32_t, kDims> index{};
+    while (true) {
+        for (size_t d = 0; d < kDims; ++d) {
+            x[d] = steps > 1 ? double(index[d]) / (steps - 1) : 0.5;
+        }
+        points.push_back(x);
+        size_t d = 0;
+        while (d < kDims && ++index[d] == steps) {
+            index[d++] = 0;
+        }
+        if (d == kDims) {
+            return points;
+        }
+    }
+}
+
+static std::vector<Point> random_points(std::mt19937_64& rng, size_t count)
+{
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<Point> points(count);
+    for (auto& x : points) {
+        for (auto& v : x) {
+            v = unit(rng);
+        }
+    }
+    return points;
+}
+
+// Gaussian-process surrogate with a squared-exponential kernel over the unit cube.
+class GaussianProcess
+{
+public:
+    explicit GaussianProcess(const std::vector<Result>& results) : results_(results)
+    {
+        const size_t n = results.size();
+        for (const auto& r : results) {
+            mean_ += r.score / n;
+        }
+        for (const auto& r : results) {
+            scale_ += (r.score - mean_) * (r.score - mean_) / n;
+        }
+        scale_ = std::sqrt(std::max(scale_, 1e-12));
+
+        // Cholesky factor of K + noise * I, then alpha = K^-1 y.
+        chol_.assign(n * n, 0.0);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j <= i; ++j) {
+                double sum = kernel(results[i].x, results[j].x) + (i == j ? kNoise : 0.0);
+                for (size_t k = 0; k < j; ++k) {
+                    sum -= chol_[i * n + k] * chol_[j * n + k];
+                }
+                chol_[i * n + j] = i == j ? std::sqrt(std::max(sum, 1e-12)) : sum / chol_[j * n + j];
+            }
+        }
+        alpha_.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            alpha_[i] = (results[i].score - mean_) / scale_;
+        }
+        solve(alpha_);
+    }
+
+    // Expected improvement over `best` (in score units) at x.
+    double expected_improvement(const Point& x, double best) const
+    {
+        const size_t n = results_.size();
+        std::vector<double> k(n);
+        double mu = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            k[i] = kernel(x, results_[i].x);
+            mu += k[i] * alpha_[i];
+        }
+        // Forward substitution only: var = k(x,x) - |L^-1 k|^2.
+        for (size_t i = 0; i < n; ++i) {
+            double sum = k[i];
+            for (size_t j = 0; j < i; ++j) {
+                sum -= chol_[i * n + j] * k[j];
+            }
+            k[i] = sum / chol_[i * n + i];
+        }
+        double var = 1.0;
+        for (const auto v : k) {
+            var -= v * v;
+        }
+        const double sigma = std::sqrt(std::max(var, 1e-12));
+        const double z_best = (best - mean_) / scale_;
+        const double z = (z_best - mu - kXi) / sigma;
+        const double pdf = std::exp(-0.5 * z * z) / std::sqrt(2.0 * M_PI);
+        const double cdf = 0.5 * std::erfc(-z / std::sqrt(2.0));
+        return (z_best - mu - kXi) * cdf + sigma * pdf;
+    }
+
+private:
+    static constexpr double kLength = 0.25;
+    static constexpr double kNoise = 1e-4;
+    static constexpr double kXi = 0.01;
+
+    static double kernel(const Point& a, const Point& b)
+    {
+        double d2 = 0.0;
+        for (size_t d = 0; d < kDims; ++d) {
+            d2 += (a[d] - b[d]) * (a[d] - b[d]);
+        }
+        return std::exp(-0.5 * d2 / (kLength * kLength));
+    }
+
+    void solve(std::vector<double>& b) const
+    {
+        const size_t n = b.size();
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < i; ++j) {
+                b[i] -= chol_[i * n + j] * b[j];
+            }
+            b[i] /= chol_[i * n + i];
+        }
+        for (size_t i = n; i-- > 0;) {
+            for (size_t j = i + 1; j < n; ++j) {
+                b[i] -= chol_[j * n + i] * b[j];
+            }
+            b[i] /= chol_[i * n + i];
+        }
+    }
+
+    const std::vector<Result>& results_;
+    double mean_ = 0.0;
+    double scale_ = 0.0;
+    std::vector<double> chol_;
+    std::vector<double> alpha_;
+};
+
+// Picks `batch` candidates by expected improvement, skipping any within a small radius of an earlier pick so one
+// batch explores more than one basin.
+static std::vector<Point> propose(const std::vector<Result>& results, std::mt19937_64& rng, size_t batch)
+{
+    constexpr size_t kCandidates = 4000;
+    constexpr double kMinSpacing2 = 0.1 * 0.1;
+
+    const GaussianProcess gp(results);
+    const double best = std::min_element(results.begin(), results.end(), [](const auto& a, const auto& b) {
+        return a.score < b.score;
+    })->score;
+
+    auto candidates = random_points(rng, kCandidates);
+    std::vector<std::pair<double, size_t>> ranked(kCandidates);
+    for (size_t i = 0; i < kCandidates; ++i) {
+        ranked[i] = {-gp.expected_improvement(candidates[i], best), i};
+    }
+    std::sort(ranked.begin(), ranked.end());
+
+    std::vector<Point> picked;
+    for (const auto& [ei, i] : ranked) {
+        const bool crowded = std::any_of(picked.begin(), picked.end(), [&](const Point& p) {
+            double d2 = 0.0;
+            for (size_t d = 0; d < kDims; ++d) {
+                d2 += (p[d] - candidates[i][d]) * (p[d] - candidates[i][d]);
+            }
+            return d2 < kMinSpacing2;
+        });
+        if (!crowded) {
+            picked.push_back(candidates[i]);
+            if (picked.size() == batch) {
+                break;
+            }
+        }
+    }
+    return picked;
+}
+
+static bool dominates(const RunMetrics& a, const RunMetrics& b)
+{
+    const bool no_worse = a.settling_s <= b.settling_s && a.overshoot <= b.overshoot && a.energy_wh <= b.energy_wh;
+    const bool better = a.settling_s < b.settling_s || a.overshoot < b.overshoot || a.energy_wh < b.energy_wh;
+    return no_worse && better;
+}
+
+static bool write_csv(const std::string& path, const std::vector<Result>& results)
+{
+    FILE* f = fopen(path.c_str(), "w");
+    if (f == nullptr) {
+        perror(path.c_str());
+        return false;
+    }
+    for (const auto& p : kParams) {
+        fprintf(f, "%s,", p.name);
+    }
+    fprintf(f, "settling_s,overshoot,energy_wh,soak_error,score\n");
+    for (const auto& r : results) {
+        for (size_t d = 0; d < kDims; ++d) {
+            fprintf(f, "%.6g,", param_value(kParams[d], r.x[d]));
+        }
+        fprintf(f, "%.0f,%.3f,%.2f,%.3f,%.5f\n", r.metrics.settling_s, r.metrics.overshoot, r.metrics.energy_wh,
+                r.metrics.soak_error, r.score);
+    }
+    fclose(f);
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    std::string mode = "bayes";
+    uint32_t samples = 256;
+    uint32_t steps = 4;
+    uint64_t seed = 1;
+    unsigned threads = std::thread::hardware_concurrency();
+    std::string out = "sweep";
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--mode") == 0) {
+            mode = argv[i + 1];
+        } else if (strcmp(argv[i], "--samples") == 0) {
+            samples = strtoul(argv[i + 1], nullptr, 0);
+        } else if (strcmp(argv[i], "--steps") == 0) {
+            steps = strtoul(argv[i + 1], nullptr, 0);
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            seed = strtoull(argv[i + 1], nullptr, 0);
+        } else if (strcmp(argv[i], "--threads") == 0) {
+            threads = strtoul(argv[i + 1], nullptr, 0);
+        } else if (strcmp(argv[i], "--out") == 0) {
+            out = argv[i + 1];
+        } else {
+            argc = 0;
+        }
+    }
+    if (argc % 2 == 0 || (mode != "grid" && mode != "random" && mode != "bayes")) {
+        fprintf(stderr, "usage: %s [--mode grid|random|bayes] [--samples N] [--steps N] [--seed N] [--threads N] [--out PREFIX]\n", argv[0]);
+        return 1;
+    }
+
+    const AdcModel adc;
+    ThreadPool pool(threads);
+    std::mt19937_64 rng(seed);
+    std::vector<Result> results;
+
+    if (mode == "grid") {
+        evaluate_all(pool, adc, grid_points(steps), results);
+    } else if (mode == "random") {
+        evaluate_all(pool, adc, random_points(rng, samples), results);
+    } else {
+        // Seed the surrogate with a random design, then evaluate proposals a batch at a time.
+        const size_t batch = std::max<size_t>(8, pool.size());
+        evaluate_all(pool, adc, random_points(rng, std::min<size_t>(samples, 4 * batch)), results);
+        while (results.size() < samples) {
+            auto proposals = propose(results, rng, std::min<size_t>(batch, samples - results.size()));
+            evaluate_all(pool, adc, proposals, results);
+        }
+    }
+
+    std::vector<Result> front;
+    for (const auto& r : results) {
+        if (std::none_of(results.begin(), results.end(), [&](const Result& o) { return dominates(o.metrics, r.metrics); })) {
+            front.push_back(r);
+        }
+    }
+    std::sort(front.begin(), front.end(), [](const Result& a, const Result& b) { return a.score < b.score; });
+
+    if (!write_csv(out + "_runs.csv", results) || !write_csv(out + "_pareto.csv", front)) {
+        return 1;
+    }
+
+    const auto& best = front.front();
+    printf("%zu runs, %zu on the Pareto front\n", results.size(), front.size());
+    printf("best score %.4f:", best.score);
+    for (size_t d = 0; d < kDims; ++d) {
+        printf(" %s=%.4g", kParams[d].name, param_value(kParams[d], best.x[d]));
+    }
+    printf("\n  settling %.0f s, overshoot %.2f C, energy %.1f Wh\n", best.metrics.settling_s, best.metrics.overshoot,
+           best.metrics.energy_wh);
+    return 0;
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <random>
+
+#include "conversion.hpp"
+#include "psychrometrics.hpp"
+
+// Lumped thermal model of a dehydrator: heater element and chamber air exchanging heat, chamber losing heat to
+// ambient, and a thermistor that lags the air. Room air flows through the chamber's seams and its exhaust vent,
+// and through the door while it is open, carrying off the heat of warming it and the water vapour the spool gives
+// off.
+struct PlantParams
+{
+    float ambient = 22.0f;          // degC
+    float ambient_humidity = 50.0f; // % relative
+    float heater_power = 250.0f;    // W while the relay is closed
+    float heater_capacity = 300.0f; // J/K
+    float air_capacity = 2500.0f;   // J/K, air plus chamber walls and trays
+    float heater_to_air = 6.0f;     // W/K
+    float air_to_ambient = 2.8f;    // W/K, walls, seams and the vent fully open as a stock dehydrator has it
+    float vent_flow = 1.2e-3f;      // m^3/s through the fully open vent
+    float leak_flow = 1e-4f;        // m^3/s through the seams
+    float door_flow = 0.02f;        // m^3/s through the open door
+    float chamber_volume = 0.04f;   // m^3
+    float sensor_tau = 8.0f;        // s
+    float adc_noise = 2.0f;         // codes RMS, per sample
+    uint32_t samples_per_frame = 100;
+};
+
+// Raw ADC code for a thermistor temperature under the firmware's calibration, found by interpolating a table of
+// the forward conversion at every code. Codes outside the curve clamp to the rails.
+class AdcModel
+{
+public:
+    AdcModel(const AdcCorrection& adc = kAdcCorrection, const ThermistorCurve& curve = kThermistorCurve)
+    {
+        for (uint32_t code = 0; code < kCodes; ++code) {
+            temperature_[code] = convert_reading(code, adc, curve).temperature;
+        }
+    }
+
+    // Fractional code; temperature falls as the code rises.
+    float code_for(float temperature) const
+    {
+        if (temperature >= temperature_[0]) {
+            return 0.0f;
+        }
+        if (temperature <= temperature_[kCodes - 1]) {
+            return kCodes - 1;
+        }
+        const auto it = std::lower_bound(temperature_.begin(), temperature_.end(), temperature, std::greater<float>());
+        const uint32_t hi = it - temperature_.begin();
+        const uint32_t lo = hi - 1;
+        return lo + (temperature_[lo] - temperature) / (temperature_[lo] - temperature_[hi]);
+    }
+
+private:
+    static constexpr uint32_t kCodes = 1 << kAdcResolutionBits;
+    std::array<float, kCodes> temperature_;
+};
+
+class Plant
+{
+public:
+    Plant(const PlantParams& params, uint32_t seed)
+        : params_(params),
+          rng_(seed),
+          heater_(params.ambient),
+          air_(params.ambient),
+          sensor_(params.ambient),
+          ambient_vapour_pressure_(::vapour_pressure(params.ambient, params.ambient_humidity)),
+          vapour_pressure_(ambient_vapour_pressure_)
+    {
+    }
+
+    // Vent opening from 0, closed, to 1, fully open.
+    void set_vent(float opening) { vent_ = std::clamp(opening, 0.0f, 1.0f); }
+    void set_door(bool open) { door_open_ = open; }
+    // Water the spool has given off into the chamber air.
+    void evaporate(float grams)
+    {
+        vapour_pressure_ += grams * (air_ + kKelvin) / (kVapourDensityFactor * params_.chamber_volume);
+    }
+
+    // Advances the model by `dt` seconds with the heater relay in the given state. Returns the heater energy used.
+    float step(bool heater_on, float dt)
+    {
+        // Sub-step so the heater node stays stable for coarse control periods.
+        constexpr float kMaxStep = 0.5f;
+        const int steps = std::max(1, int(std::ceil(dt / kMaxStep)));
+        const float h = dt / steps;
+        const float power = heater_on ? params_.heater_power : 0.0f;
+        // Closing the vent saves the heat of the air that no longer passes through it.
+        const float door_flow = door_open_ ? params_.door_flow : 0.0f;
+        const float air_to_ambient = params_.air_to_ambient - (1.0f - vent_) * kAirHeatCapacity * params_.vent_flow +
+                                     kAirHeatCapacity * door_flow;
+        const float flow = params_.leak_flow + vent_ * params_.vent_flow + door_flow;
+        for (int i = 0; i < steps; ++i) {
+            const float to_air = params_.heater_to_air * (heater_ - air_);
+            const float to_ambient = air_to_ambient * (air_ - params_.ambient);
+            heater_ += h * (power - to_air) / params_.heater_capacity;
+            air_ += h * (to_air - to_ambient) / params_.air_capacity;
+            sensor_ += (air_ - sensor_) * (1.0f - std::exp(-h / params_.sensor_tau));
+            // Room air warmed in the chamber keeps its vapour pressure; the air it replaces leaves with the chamber's.
+            const float excess = vapour_pressure_ - ambient_vapour_pressure_;
+            if (excess != 0.0f) {
+                const float exchanged = excess * (1.0f - std::exp(-h * flow / params_.chamber_volume));
+                water_vented_ += exchanged * kVapourDensityFactor * params_.chamber_volume / (air_ + kKelvin);
+                vapour_pressure_ -= exchanged;
+            }
+        }
+        return power * dt;
+    }
+
+    // Integer average of one frame of noisy samples, as the firmware computes it. The noise of the frame mean is
+    // drawn directly rather than per sample.
+    uint32_t read_frame(const AdcModel& adc)
+    {
+        const float sigma = params_.adc_noise / std::sqrt(float(params_.samples_per_frame));
+        std::normal_distribution<float> noise(0.0f, sigma);
+        const float code = adc.code_for(sensor_) + noise(rng_);
+        return uint32_t(std::clamp(code, 0.0f, float((1 << kAdcResolutionBits) - 1)));
+    }
+
+    // One raw sample with per-sample noise, for drivers that hand the firmware individual conversions.
+    uint16_t read_sample(const AdcModel& adc)
+    {
+        std::normal_distribution<float> noise(0.0f, params_.adc_noise);
+        const float code = std::round(adc.code_for(sensor_) + noise(rng_));
+        return uint16_t(std::clamp(code, 0.0f, float((1 << kAdcResolutionBits) - 1)));
+    }
+
+    float air_temperature() const { return air_; }
+    float heater_temperature() const { return heater_; }
+    float sensor_temperature() const { return sensor_; }
+    float vent() const { return vent_; }
+    bool door_open() const { return door_open_; }
+    // Of the chamber air, kPa and percent.
+    float vapour_pressure() const { return vapour_pressure_; }
+    float humidity() const { return relative_humidity(air_, vapour_pressure_); }
+    // Water carried out of the chamber so far, g.
+    double water_vented() const { return water_vented_; }
+    const PlantParams& params() const { return params_; }
+    std::mt19937& rng() { return rng_; }
+
+private:
+    PlantParams params_;
+    std::mt19937 rng_;
+    float heater_;
+    float air_;
+    float sensor_;
+    float ambient_vapour_pressure_;
+    float vapour_pressure_;
+    float vent_ = 1.0f;
+    bool door_open_ = false;
+    double water_vented_ = 0.0;
+};
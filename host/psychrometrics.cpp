@@ -0,0 +1,267 @@
+// Checks the firmware's fast log and exp (fast_math.hpp) and the psychrometrics built on them (psychrometrics.hpp)
+// against double precision, and times them against libm on this host.
+//
+//   psychrometrics [--threads N] [--csv FILE]
+//
+// fast_log runs over every positive float and fast_exp over every float it doesn't flush or overflow, spread over a
+// thread pool; each fails the run if it exceeds the bound fast_math.hpp states. Saturation pressure, dew point and
+// absolute humidity are then checked against the Magnus formula in double from 0 to 100 C in 0.01 C steps at every
+// relative humidity from 1% to 100% in 0.5% steps, and Magnus itself against the IAPWS saturation curve (Wagner and
+// Pruss) every 10 C. --csv writes `temperature,magnus,iapws,magnus_error` rows of that comparison every degree.
+//
+// The firmware runs the same benchmark on the ESP32 at boot with CONFIG_DRYER_MATH_BENCH.
+
+#include <bit>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+#include "psychrometrics.hpp"
+#include "thread_pool.hpp"
+
+// The bounds stated in fast_math.hpp.
+constexpr double kLogBound = 2e-7;
+constexpr double kExpBound = 2e-7;
+// Bounds on the psychrometrics between 0 and 100 C from the fast log and exp and float rounding; Magnus's own error
+// is beside these.
+constexpr double kPressureBound = 1e-6;    // relative
+constexpr double kDewPointBound = 1e-4;    // C
+constexpr double kHumidityBound = 1e-6;    // relative
+
+struct Options
+{
+    unsigned threads = 0;
+    const char* csv = nullptr;
+};
+
+// Largest error over a range of float bit patterns, with the argument where it occurs.
+struct WorstError
+{
+    double error = 0.0;
+    float at = NAN;
+
+    void add(double e, float x)
+    {
+        if (e > error) {
+            error = e;
+            at = x;
+        }
+    }
+    void merge(const WorstError& other) { add(other.error, other.at); }
+};
+
+// Runs check(x, worst) for every float with bit patterns in [first, last], spread over the pool.
+template <typename Check>
+static WorstError sweep(ThreadPool& pool, uint32_t first, uint32_t last, Check check)
+{
+    constexpr size_t kChunk = 1 << 20;
+    const size_t chunks = (size_t(last) - first) / kChunk + 1;
+    WorstError worst;
+    std::mutex mutex;
+    pool.parallel_for(chunks, [&](size_t c) {
+        WorstError local;
+        const uint32_t begin = first + uint32_t(c * kChunk);
+        const uint32_t end = uint32_t(std::min<uint64_t>(uint64_t(begin) + kChunk - 1, last));
+        for (uint32_t bits = begin;; ++bits) {
+            check(std::bit_cast<float>(bits), local);
+            if (bits == end) {
+                break;
+            }
+        }
+        std::lock_guard lock(mutex);
+        worst.merge(local);
+    });
+    return worst;
+}
+
+static bool check_log(ThreadPool& pool)
+{
+    // Absolute error near 1, where the log goes to zero, relative elsewhere.
+    const auto worst = sweep(pool, std::bit_cast<uint32_t>(0x1p-149f), std::bit_cast<uint32_t>(FLT_MAX),
+                             [](float x, WorstError& w) {
+                                 const double exact = std::log(double(x));
+                                 const double error = std::abs(double(fast_log(x)) - exact);
+                                 w.add(x >= 0.5f && x <= 2.0f ? error : error / std::abs(exact), x);
+                             });
+    const bool special = fast_log(0.0f) == -INFINITY && std::isnan(fast_log(-1.0f)) && std::isnan(fast_log(NAN)) &&
+                         fast_log(INFINITY) == INFINITY && fast_log(1.0f) == 0.0f;
+    printf("fast_log: every positive float within %.3g (worst at %.9g), bound %.3g%s\n", worst.error, worst.at,
+           kLogBound, special ? "" : ", special values wrong");
+    return worst.error <= kLogBound && special;
+}
+
+static bool check_exp(ThreadPool& pool)
+{
+    auto relative = [](float x, WorstError& w) {
+        const double exact = std::exp(double(x));
+        w.add(std::abs(double(fast_exp(x)) - exact) / exact, x);
+    };
+    // Negative floats have the larger bit patterns, so the range is swept in two halves.
+    WorstError worst = sweep(pool, 0, std::bit_cast<uint32_t>(88.72f), relative);
+    worst.merge(sweep(pool, std::bit_cast<uint32_t>(-0.0f), std::bit_cast<uint32_t>(std::nextafter(-87.33f, 0.0f)),
+                      relative));
+    const bool special = fast_exp(-100.0f) == 0.0f && fast_exp(100.0f) == INFINITY && std::isnan(fast_exp(NAN)) &&
+                         fast_exp(0.0f) == 1.0f;
+    printf("fast_exp: every float from -87.33 to 88.72 within %.3g relative (worst at %.9g), bound %.3g%s\n",
+           worst.error, worst.at, kExpBound, special ? "" : ", special values wrong");
+    return worst.error <= kExpBound && special;
+}
+
+static double magnus(double temperature)
+{
+    return double(kMagnusPressure) * std::exp(double(kMagnusA) * temperature / (temperature + double(kMagnusB)));
+}
+
+static double magnus_dew_point(double temperature, double humidity)
+{
+    const double gamma = std::log(humidity / 100.0) + double(kMagnusA) * temperature / (temperature + double(kMagnusB));
+    return double(kMagnusB) * gamma / (double(kMagnusA) - gamma);
+}
+
+// Saturation pressure over water, kPa, by the IAPWS formulation of Wagner and Pruss (2002).
+static double iapws(double temperature)
+{
+    constexpr double kCritical = 647.096;  // K
+    constexpr double kPressure = 22064.0;  // kPa
+    constexpr double a[] = {-7.85951783, 1.84408259, -11.7866497, 22.6807411, -15.9618719, 1.80122502};
+    const double t = temperature + double(kKelvin);
+    const double tau = 1.0 - t / kCritical;
+    const double sum = a[0] * tau + a[1] * std::pow(tau, 1.5) + a[2] * std::pow(tau, 3.0) +
+                       a[3] * std::pow(tau, 3.5) + a[4] * std::pow(tau, 4.0) + a[5] * std::pow(tau, 7.5);
+    return kPressure * std::exp(kCritical / t * sum);
+}
+
+static bool check_psychrometrics(ThreadPool& pool, const Options& options)
+{
+    constexpr int kSteps = 10'000;
+    std::mutex mutex;
+    WorstError pressure;
+    WorstError dew;
+    WorstError absolute;
+    pool.parallel_for(kSteps + 1, [&](size_t i) {
+        const float t = 100.0f * float(i) / kSteps;
+        WorstError p;
+        WorstError d;
+        WorstError a;
+        const double exact = magnus(t);
+        p.add(std::abs(saturation_pressure(t) - exact) / exact, t);
+        for (int h = 2; h <= 200; ++h) {
+            const float rh = 0.5f * float(h);
+            d.add(std::abs(dew_point(t, rh) - magnus_dew_point(t, rh)), t);
+            d.add(std::abs(dew_point_from_pressure(vapour_pressure(t, rh)) - magnus_dew_point(t, rh)), t);
+            const double density = double(kVapourDensityFactor) * rh / 100.0 * exact / (t + double(kKelvin));
+            a.add(std::abs(absolute_humidity(t, rh) - density) / density, t);
+        }
+        std::lock_guard lock(mutex);
+        pressure.merge(p);
+        dew.merge(d);
+        absolute.merge(a);
+    });
+    printf("0 to 100 C against Magnus in double: saturation pressure within %.3g relative (bound %.3g), dew point "
+           "%.3g C (%.3g), absolute humidity %.3g relative (%.3g)\n",
+           pressure.error, kPressureBound, dew.error, kDewPointBound, absolute.error, kHumidityBound);
+
+    FILE* csv = nullptr;
+    if (options.csv != nullptr) {
+        csv = fopen(options.csv, "w");
+        if (csv == nullptr) {
+            perror(options.csv);
+            return false;
+        }
+        fprintf(csv, "temperature,magnus,iapws,magnus_error\n");
+    }
+    printf("Magnus against IAPWS:");
+    for (int t = 0; t <= 100; ++t) {
+        const double error = magnus(t) / iapws(t) - 1.0;
+        if (t % 10 == 0) {
+            printf(" %d C %+.2f%%%s", t, 100 * error, t < 100 ? "," : "\n");
+        }
+        if (csv != nullptr) {
+            fprintf(csv, "%d,%.6f,%.6f,%.6f\n", t, magnus(t), iapws(t), error);
+        }
+    }
+    if (csv != nullptr) {
+        fclose(csv);
+    }
+    return pressure.error <= kPressureBound && dew.error <= kDewPointBound && absolute.error <= kHumidityBound;
+}
+
+// Nanoseconds per call of f over arguments spread across [low, high], summing the results so nothing is skipped.
+template <typename F>
+static double time_calls(F f, float low, float high, float& sink)
+{
+    constexpr int kCalls = 20'000'000;
+    const float step = (high - low) / kCalls;
+    float sum = 0.0f;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kCalls; ++i) {
+        sum += f(low + step * float(i));
+    }
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    sink += sum;
+    return elapsed.count() / kCalls;
+}
+
+static void bench()
+{
+    float sink = 0.0f;
+    // Drier air as it gets hotter, so the humidity isn't a constant the compiler could fold.
+    auto fast_dew_point = [](float t) { return dew_point(t, 100.0f - 0.9f * t); };
+    auto libm_dew_point = [](float t) {
+        const float gamma = logf(1.0f - 0.009f * t) + kMagnusA * t / (t + kMagnusB);
+        return kMagnusB * gamma / (kMagnusA - gamma);
+    };
+    const double log_fast = time_calls([](float x) { return fast_log(x); }, 0.01f, 1000.0f, sink);
+    const double log_libm = time_calls([](float x) { return logf(x); }, 0.01f, 1000.0f, sink);
+    const double exp_fast = time_calls([](float x) { return fast_exp(x); }, -20.0f, 20.0f, sink);
+    const double exp_libm = time_calls([](float x) { return expf(x); }, -20.0f, 20.0f, sink);
+    const double pressure_fast = time_calls([](float t) { return saturation_pressure(t); }, 0.0f, 100.0f, sink);
+    const double pressure_libm = time_calls(
+        [](float t) { return kMagnusPressure * expf(kMagnusA * t / (t + kMagnusB)); }, 0.0f, 100.0f, sink);
+    const double dew_fast = time_calls(fast_dew_point, 0.0f, 100.0f, sink);
+    const double dew_libm = time_calls(libm_dew_point, 0.0f, 100.0f, sink);
+    printf("ns per call on this host, fast / libm: log %.2f / %.2f, exp %.2f / %.2f, saturation pressure %.2f / %.2f, "
+           "dew point %.2f / %.2f (checksum %g)\n",
+           log_fast, log_libm, exp_fast, exp_libm, pressure_fast, pressure_libm, dew_fast, dew_libm, sink);
+}
+
+static bool parse(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        const char* value = argv[++i];
+        if (strcmp(arg, "--threads") == 0) {
+            options.threads = unsigned(strtoul(value, nullptr, 0));
+        } else if (strcmp(arg, "--csv") == 0) {
+            options.csv = value;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parse(argc, argv, options)) {
+        fprintf(stderr, "usage: %s [--threads N] [--csv FILE]\n", argv[0]);
+        return 1;
+    }
+    ThreadPool pool(options.threads != 0 ? options.threads : std::thread::hardware_concurrency());
+    const auto start = std::chrono::steady_clock::now();
+    bool ok = check_log(pool);
+    ok = check_exp(pool) && ok;
+    ok = check_psychrometrics(pool, options) && ok;
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    printf("checked in %.1f s on %u threads\n", elapsed.count(), pool.size());
+    bench();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+// Python bindings for the batch conversion (conversion_batch.hpp), so notebooks compute exactly the numbers the
+// firmware does instead of re-deriving the polynomials in numpy:
+//
+//   import dryer_conversion as dc
+//   corrected, temperature, voltage = dc.convert(codes)   # codes: uint16 array of any shape
+//   dc.convert(codes, temperature=out)                    # fill preallocated float32 arrays instead
+//   dc.temperature(codes, adc=(c0, c1, c2, c3), curve=(c0, c1, c2))
+//
+// A C-contiguous uint16 input is read in place; anything else is converted to one first. Outputs passed in must be
+// writeable C-contiguous float32 arrays of the input's size. The conversion itself runs without the GIL.
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include <array>
+#include <optional>
+#include <string>
+#include <tuple>
+
+#include "conversion_batch.hpp"
+
+namespace py = pybind11;
+
+using Codes = py::array_t<uint16_t, py::array::c_style | py::array::forcecast>;
+using AdcArg = std::optional<std::array<float, 4>>;
+using CurveArg = std::optional<std::tuple<float, double, float>>;
+
+static AdcCorrection adc_correction(const AdcArg& adc)
+{
+    return adc ? AdcCorrection{(*adc)[0], (*adc)[1], (*adc)[2], (*adc)[3]} : kAdcCorrection;
+}
+
+static ThermistorCurve thermistor_curve(const CurveArg& curve)
+{
+    return curve ? ThermistorCurve{std::get<0>(*curve), std::get<1>(*curve), std::get<2>(*curve)} : kThermistorCurve;
+}
+
+// The output array for one result: the caller's, checked so a silent copy can't swallow the results, or a new one.
+static py::array output(const std::optional<py::array>& given, const Codes& codes, const char* name)
+{
+    if (!given) {
+        return py::array_t<float>(std::vector<py::ssize_t>(codes.shape(), codes.shape() + codes.ndim()));
+    }
+    const auto& out = *given;
+    if (!out.dtype().is(py::dtype::of<float>()) || !(out.flags() & py::array::c_style) || !out.writeable() ||
+        out.size() != codes.size()) {
+        throw py::value_error(std::string(name) + " must be a writeable C-contiguous float32 array of " +
+                              std::to_string(codes.size()) + " elements");
+    }
+    return out;
+}
+
+static py::tuple convert(const Codes& codes, const AdcArg& adc, const CurveArg& curve,
+                         const std::optional<py::array>& corrected, const std::optional<py::array>& temperature,
+                         const std::optional<py::array>& voltage)
+{
+    auto corrected_out = output(corrected, codes, "corrected");
+    auto temperature_out = output(temperature, codes, "temperature");
+    auto voltage_out = output(voltage, codes, "voltage");
+    const AdcCorrection adc_k = adc_correction(adc);
+    const ThermistorCurve curve_k = thermistor_curve(curve);
+    {
+        py::gil_scoped_release release;
+        convert_readings(codes.data(), codes.size(), static_cast<float*>(corrected_out.mutable_data()),
+                         static_cast<float*>(temperature_out.mutable_data()),
+                         static_cast<float*>(voltage_out.mutable_data()), adc_k, curve_k);
+    }
+    return py::make_tuple(corrected_out, temperature_out, voltage_out);
+}
+
+static py::array temperature(const Codes& codes, const AdcArg& adc, const CurveArg& curve,
+                             const std::optional<py::array>& out)
+{
+    auto temperature_out = output(out, codes, "out");
+    const AdcCorrection adc_k = adc_correction(adc);
+    const ThermistorCurve curve_k = thermistor_curve(curve);
+    {
+        py::gil_scoped_release release;
+        convert_readings(codes.data(), codes.size(), nullptr, static_cast<float*>(temperature_out.mutable_data()),
+                         nullptr, adc_k, curve_k);
+    }
+    return temperature_out;
+}
+
+PYBIND11_MODULE(dryer_conversion, m)
+{
+    m.doc() = "The filament dryer firmware's ADC conversion chain, bit-identical to convert_reading";
+    m.def("convert", &convert, py::arg("codes"), py::kw_only(), py::arg("adc") = py::none(),
+          py::arg("curve") = py::none(), py::arg("corrected") = py::none(), py::arg("temperature") = py::none(),
+          py::arg("voltage") = py::none(),
+          "Corrected codes, temperatures and voltages of raw ADC codes, as float32 arrays of the input's shape");
+    m.def("temperature", &temperature, py::arg("codes"), py::kw_only(), py::arg("adc") = py::none(),
+          py::arg("curve") = py::none(), py::arg("out") = py::none(), "Temperatures only of raw ADC codes");
+    m.def(
+        "isa", [] { return conversion_isa_name(conversion_isa()); }, "Instruction set the conversion runs on");
+    m.attr("adc_correction") = py::make_tuple(kAdcCorrection.c0, kAdcCorrection.c1, kAdcCorrection.c2,
+                                              kAdcCorrection.c3);
+    m.attr("thermistor_curve") = py::make_tuple(kThermistorCurve.c0, kThermistorCurve.c1, kThermistorCurve.c2);
+}
@@ -0,0 +1,183 @@
+// Replays a field run from an image of the "history" flash partition. Every recorded input goes back through the
+// firmware's Dryer in order, so the status lines come out exactly as the unit printed them.
+//
+//   replay IMAGE [--compare LOG] [--quiet]
+//
+// --compare checks the replayed lines against a console log of the same boots (virtual_dryer --log, or a serial
+// capture) and reports the first line that differs. Each boot's log may run past what reached flash by up to one
+// flush interval, which is what a power cut loses; those lines are skipped when the next boot starts.
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "dryer.hpp"
+#include "input_log.hpp"
+
+static bool read_file(const char* path, std::vector<uint8_t>& data)
+{
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr) {
+        perror(path);
+        return false;
+    }
+    uint8_t chunk[65536];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        data.insert(data.end(), chunk, chunk + n);
+    }
+    fclose(file);
+    return true;
+}
+
+// Status lines of a console log with the "I (1234) main: " prefix removed.
+static bool read_status_lines(const char* path, std::vector<std::string>& lines)
+{
+    FILE* file = fopen(path, "r");
+    if (file == nullptr) {
+        perror(path);
+        return false;
+    }
+    char line[512];
+    while (fgets(line, sizeof(line), file) != nullptr) {
+        const char* status = strstr(line, "Avg reading: ");
+        if (status != nullptr) {
+            lines.emplace_back(status, strcspn(status, "\r\n"));
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    const char* image_path = nullptr;
+    const char* compare = nullptr;
+    bool quiet = false;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--compare") == 0 && i + 1 < argc) {
+            compare = argv[++i];
+        } else if (strcmp(argv[i], "--quiet") == 0) {
+            quiet = true;
+        } else if (image_path == nullptr && argv[i][0] != '-') {
+            image_path = argv[i];
+        } else {
+            image_path = nullptr;
+            break;
+        }
+    }
+    if (image_path == nullptr) {
+        fprintf(stderr, "usage: %s IMAGE [--compare LOG] [--quiet]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<uint8_t> image;
+    std::vector<std::string> expected;
+    if (!read_file(image_path, image) || (compare != nullptr && !read_status_lines(compare, expected))) {
+        return 1;
+    }
+
+    std::unique_ptr<Dryer> dryer;
+    size_t boots = 0;
+    size_t frames = 0;
+    size_t orphaned = 0;
+    size_t log_line = 0;
+    size_t lost = 0;
+    bool resync = false;
+    size_t mismatch = SIZE_MAX;
+    char line[224];
+    const auto start = std::chrono::steady_clock::now();
+    const size_t records = decode_history_image(image.data(), image.size(), [&](const InputRecord& record) {
+        switch (record.type) {
+        case InputRecordType::Boot:
+            dryer = std::make_unique<Dryer>();
+            resync = boots++ > 0;
+            return;
+        case InputRecordType::Profile:
+            if (dryer) {
+                dryer->start(record.profile);
+            }
+            return;
+        case InputRecordType::Setpoint:
+            if (dryer) {
+                dryer->set_setpoint(record.setpoint);
+            }
+            return;
+        case InputRecordType::SensorTimeout:
+            if (dryer) {
+                dryer->sensor_timeout(record.time_ms);
+            }
+            return;
+        case InputRecordType::Correction:
+            if (dryer) {
+                dryer->set_correction(record.correction);
+            }
+            return;
+        case InputRecordType::Auxiliary:
+            if (dryer) {
+                dryer->set_auxiliary(record.sensor, record.temperature);
+            }
+            return;
+        case InputRecordType::Humidity:
+            if (dryer) {
+                dryer->set_humidity(record.humidity);
+            }
+            return;
+        case InputRecordType::Weight:
+            if (dryer) {
+                dryer->set_weight(record.weight);
+            }
+            return;
+        case InputRecordType::Frame:
+            break;
+        }
+        // A history that wrapped can begin mid-boot; frames before the first surviving Boot have no known state.
+        if (!dryer) {
+            ++orphaned;
+            return;
+        }
+        format_status(line, sizeof(line), dryer->step(record.frame_average(), record.time_ms));
+        if (compare != nullptr && mismatch == SIZE_MAX) {
+            if (resync) {
+                size_t next = log_line;
+                while (next < expected.size() && expected[next] != line) {
+                    ++next;
+                }
+                if (next < expected.size()) {
+                    lost += next - log_line;
+                    log_line = next;
+                }
+                resync = false;
+            }
+            if (log_line >= expected.size() || expected[log_line] != line) {
+                mismatch = log_line;
+                fprintf(stderr, "first divergence at log status line %zu (t=%u ms)\n  replay: %s\n  log:    %s\n",
+                        log_line + 1, (unsigned)record.time_ms, line,
+                        log_line < expected.size() ? expected[log_line].c_str() : "<end of log>");
+            }
+            ++log_line;
+        }
+        if (!quiet) {
+            puts(line);
+        }
+        ++frames;
+    });
+    const std::chrono::duration<double> wall = std::chrono::steady_clock::now() - start;
+
+    fprintf(stderr, "replayed %zu records (%zu boots, %zu frames) in %.1f ms, %.2f M records/s\n", records, boots, frames,
+            wall.count() * 1e3, records / wall.count() / 1e6);
+    if (orphaned != 0) {
+        fprintf(stderr, "history wrapped: skipped %zu frames recorded before the oldest surviving boot\n", orphaned);
+    }
+    if (compare != nullptr) {
+        if (mismatch != SIZE_MAX) {
+            return 1;
+        }
+        fprintf(stderr, "all %zu replayed lines match the log (%zu log lines never reached flash)\n", frames,
+                lost + expected.size() - log_line);
+    }
+    return 0;
+}
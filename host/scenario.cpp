@@ -0,0 +1,48 @@
+#include "scenario.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+constexpr uint32_t kControlPeriodMs = 1000;
+
+RunMetrics run_scenario(const ScenarioConfig& config, const AdcModel& adc)
+{
+    Dryer dryer(config.controller);
+    dryer.start(config.profile);
+    Plant plant(config.plant, config.seed);
+
+    RunMetrics metrics;
+    metrics.completion_s = config.duration_s;
+    const float setpoint = config.profile.setpoint;
+    uint32_t last_outside_s = 0;
+    double energy_j = 0.0;
+    double soak_error = 0.0;
+    uint32_t soak_steps = 0;
+    bool reached = false;
+
+    for (uint32_t t = 0; t < config.duration_s; ++t) {
+        const auto& status = dryer.step(plant.read_frame(adc), t * kControlPeriodMs);
+        if (status.phase == DryerPhase::Done) {
+            metrics.completion_s = t;
+            break;
+        }
+        energy_j += plant.step(status.heater_on, kControlPeriodMs / 1000.0f);
+
+        const float air = plant.air_temperature();
+        metrics.overshoot = std::max(metrics.overshoot, air - setpoint);
+        if (std::abs(air - setpoint) > config.settle_band) {
+            last_outside_s = t + 1;
+        }
+        // The soak itself starts hours later, once the spool's core has caught up; the air is held from here on.
+        reached |= std::abs(air - setpoint) <= config.settle_band;
+        if (reached) {
+            soak_error += std::abs(air - setpoint);
+            ++soak_steps;
+        }
+    }
+
+    metrics.settling_s = last_outside_s;
+    metrics.energy_wh = energy_j / 3600.0;
+    metrics.soak_error = soak_steps ? soak_error / soak_steps : 0.0f;
+    return metrics;
+}
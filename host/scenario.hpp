@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+#include "dryer.hpp"
+#include "plant.hpp"
+
+// One simulated drying run: the firmware's Dryer against a plant, from cold, at a 1 s control period.
+struct ScenarioConfig
+{
+    HeaterControllerConfig controller;
+    DryingProfile profile;
+    PlantParams plant;
+    uint32_t seed = 1;
+    uint32_t duration_s = 2 * 3600;
+    // Settling is the time after which the chamber air stays within this band of the setpoint.
+    float settle_band = 1.0f;
+};
+
+struct RunMetrics
+{
+    float settling_s = 0.0f;
+    float overshoot = 0.0f;
+    float energy_wh = 0.0f;
+    // Time the profile reached Done, or the scenario duration if it never did.
+    float completion_s = 0.0f;
+    // Mean |air - setpoint| from when the air first reaches the settle band.
+    float soak_error = 0.0f;
+};
+
+RunMetrics run_scenario(const ScenarioConfig& config, const AdcModel& adc);
@@ -0,0 +1,241 @@
+// Reads oscilloscope captures (scope.hpp) back out of a console log and summarises them.
+//
+//   scope_dump LOG [--csv FILE] [--capture PREFIX]
+//
+// For each capture: its trigger, sample rate and lost samples, whether every line arrived and the CRC matches, the
+// pre-trigger window's mean, noise and strongest tone (PWM pickup shows up there), and after the trigger the peak
+// excursion from that mean, when it came and how long the line took to settle back within four times the noise.
+// Lines from the middle of a capture whose header the log missed are skipped. --csv writes
+// `capture,index,time_us,code` rows, time relative to the trigger sample; --capture writes each complete capture as
+// PREFIX<n>.dcap, a one-channel capture file for capture_analysis.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <numbers>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "capture_file.hpp"
+#include "conversion.hpp"
+#include "scope.hpp"
+#include "telemetry.hpp"
+
+// Thermistor input of the firmware; kept in step with main.cpp.
+constexpr uint8_t kThermistorChannel = 6;
+constexpr uint8_t kAdcAtten12Db = 3;
+
+struct Capture
+{
+    ScopeLine header;
+    std::vector<uint16_t> samples;
+    std::vector<bool> received;
+    bool ended = false;
+    bool crc_ok = false;
+
+    size_t missing() const { return std::count(received.begin(), received.end(), false); }
+};
+
+static double sample_us(const Capture& capture, size_t index)
+{
+    return (double(index) - capture.header.trigger_index) * 1e6 / capture.header.sample_rate_hz;
+}
+
+// Strongest tone of the mean-removed samples, by a plain DFT; the window is short enough not to need an FFT.
+static void strongest_tone(std::span<const uint16_t> samples, double mean, double rate, double& hz, double& codes)
+{
+    hz = 0.0;
+    codes = 0.0;
+    const size_t n = samples.size();
+    for (size_t k = 1; k < n / 2; ++k) {
+        double re = 0.0;
+        double im = 0.0;
+        const double step = 2.0 * std::numbers::pi * double(k) / double(n);
+        for (size_t i = 0; i < n; ++i) {
+            re += (samples[i] - mean) * std::cos(step * double(i));
+            im -= (samples[i] - mean) * std::sin(step * double(i));
+        }
+        const double amplitude = 2.0 * std::hypot(re, im) / double(n);
+        if (amplitude > codes) {
+            codes = amplitude;
+            hz = double(k) * rate / double(n);
+        }
+    }
+}
+
+static void summarise(const Capture& capture)
+{
+    const ScopeLine& header = capture.header;
+    printf("capture %u: %u samples at %.0f kHz, %s %u codes, trigger at sample %u (%.0f us in)",
+           unsigned(header.capture), unsigned(header.sample_count), header.sample_rate_hz / 1e3,
+           scope_trigger_name(header.trigger), unsigned(header.level), unsigned(header.trigger_index),
+           header.trigger_index * 1e6 / header.sample_rate_hz);
+    printf(header.lost != 0 ? ", %u samples lost\n" : "\n", unsigned(header.lost));
+    const size_t missing = capture.missing();
+    if (missing != 0 || !capture.ended) {
+        printf("  incomplete: %zu of %u samples missing%s\n", missing, unsigned(header.sample_count),
+               capture.ended ? "" : ", no end line");
+        return;
+    }
+    if (!capture.crc_ok) {
+        printf("  CRC mismatch, samples damaged in the log\n");
+    }
+
+    const auto pre = std::span(capture.samples).first(header.trigger_index);
+    const auto post = std::span(capture.samples).subspan(header.trigger_index);
+    double mean = 0.0;
+    double noise = 0.0;
+    if (!pre.empty()) {
+        for (const uint16_t sample : pre) {
+            mean += sample;
+        }
+        mean /= double(pre.size());
+        for (const uint16_t sample : pre) {
+            noise += (sample - mean) * (sample - mean);
+        }
+        noise = std::sqrt(noise / double(pre.size()));
+        double tone_hz;
+        double tone_codes;
+        strongest_tone(pre, mean, header.sample_rate_hz, tone_hz, tone_codes);
+        const auto [low, high] = std::minmax_element(pre.begin(), pre.end());
+        printf("  before: mean %.1f codes (%.2f C), noise %.2f codes RMS, %u to %u, strongest tone %.1f kHz at "
+               "%.2f codes\n",
+               mean, convert_reading(uint32_t(std::lround(mean))).temperature, noise, unsigned(*low), unsigned(*high),
+               tone_hz / 1e3, tone_codes);
+    }
+
+    size_t peak = 0;
+    size_t last_out = 0;
+    const double band = 4.0 * std::max(noise, 1.0);
+    for (size_t i = 0; i < post.size(); ++i) {
+        if (std::abs(post[i] - mean) > std::abs(post[peak] - mean)) {
+            peak = i;
+        }
+        if (std::abs(post[i] - mean) > band) {
+            last_out = i;
+        }
+    }
+    printf("  after:  peak %+.1f codes at %+.1f us, ", post[peak] - mean,
+           sample_us(capture, header.trigger_index + peak));
+    if (last_out + 1 == post.size()) {
+        printf("still beyond %.1f codes at the end, %.0f us on\n", band,
+               sample_us(capture, header.sample_count - 1));
+    } else {
+        printf("within %.1f codes after %.1f us\n", band, sample_us(capture, header.trigger_index + last_out + 1));
+    }
+}
+
+static bool write_capture(const char* prefix, const Capture& capture)
+{
+    const std::string path = std::string(prefix) + std::to_string(capture.header.capture) + ".dcap";
+    CaptureInfo info;
+    info.sample_rate_hz = capture.header.sample_rate_hz;
+    CaptureChannel channel{};
+    channel.unit = 1;
+    channel.channel = kThermistorChannel;
+    channel.bit_width = kAdcResolutionBits;
+    channel.attenuation = kAdcAtten12Db;
+    strncpy(channel.name, "thermistor", sizeof(channel.name) - 1);
+    info.channels.push_back(channel);
+    CaptureWriter writer;
+    if (!writer.open(path.c_str(), info) || !writer.append(capture.samples.data(), capture.samples.size()) ||
+        !writer.close()) {
+        perror(path.c_str());
+        return false;
+    }
+    printf("  written to %s\n", path.c_str());
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    const char* log_path = nullptr;
+    const char* csv_path = nullptr;
+    const char* capture_prefix = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+            csv_path = argv[++i];
+        } else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+            capture_prefix = argv[++i];
+        } else if (log_path == nullptr && argv[i][0] != '-') {
+            log_path = argv[i];
+        } else {
+            log_path = nullptr;
+            break;
+        }
+    }
+    if (log_path == nullptr) {
+        fprintf(stderr, "usage: %s LOG [--csv FILE] [--capture PREFIX]\n", argv[0]);
+        return 1;
+    }
+
+    FILE* log = fopen(log_path, "r");
+    if (log == nullptr) {
+        perror(log_path);
+        return 1;
+    }
+    FILE* csv = nullptr;
+    if (csv_path != nullptr) {
+        csv = fopen(csv_path, "w");
+        if (csv == nullptr) {
+            perror(csv_path);
+            fclose(log);
+            return 1;
+        }
+        fprintf(csv, "capture,index,time_us,code\n");
+    }
+
+    std::vector<Capture> captures;
+    // The capture data lines go to, until its end line or another header.
+    Capture* current = nullptr;
+    char text[512];
+    while (fgets(text, sizeof(text), log) != nullptr) {
+        ScopeLine line;
+        if (!parse_scope_line(text, line)) {
+            continue;
+        }
+        if (line.kind == ScopeLine::Kind::Header) {
+            captures.push_back({line, std::vector<uint16_t>(line.sample_count), std::vector<bool>(line.sample_count)});
+            current = &captures.back();
+            continue;
+        }
+        if (current == nullptr || line.capture != current->header.capture) {
+            continue;
+        }
+        if (line.kind == ScopeLine::Kind::Data) {
+            const size_t first = size_t(line.line) * kScopeLineSamples;
+            for (size_t i = 0; i < line.count && first + i < current->samples.size(); ++i) {
+                current->samples[first + i] = line.samples[i];
+                current->received[first + i] = true;
+            }
+        } else {
+            current->ended = true;
+            current->crc_ok = telemetry_crc16(reinterpret_cast<const uint8_t*>(current->samples.data()),
+                                              current->samples.size() * sizeof(uint16_t)) == line.crc;
+            current = nullptr;
+        }
+    }
+    fclose(log);
+
+    bool ok = true;
+    for (const auto& capture : captures) {
+        summarise(capture);
+        const bool complete = capture.ended && capture.missing() == 0;
+        if (csv != nullptr && complete) {
+            for (size_t i = 0; i < capture.samples.size(); ++i) {
+                fprintf(csv, "%u,%zu,%.2f,%u\n", unsigned(capture.header.capture), i, sample_us(capture, i),
+                        unsigned(capture.samples[i]));
+            }
+        }
+        if (capture_prefix != nullptr && complete) {
+            ok = write_capture(capture_prefix, capture) && ok;
+        }
+    }
+    if (csv != nullptr) {
+        fclose(csv);
+    }
+    printf("%zu captures\n", captures.size());
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <numbers>
+#include <optional>
+
+#include "idf_sim.hpp"
+#include "load_cell.hpp"
+#include "plant.hpp"
+#include "psychrometrics.hpp"
+#include "reference_sensor.hpp"
+#include "sim_load_cell.hpp"
+
+// Pickup on the thermistor line, at rates only the firmware's scope mode samples fast enough to see.
+struct SimInterference
+{
+    // The heater relay's switching kick: a damped ring starting at this many codes.
+    float relay_spike = 40.0f;
+    float relay_decay_us = 150.0f;
+    float relay_ring_hz = 8'000.0f;
+    // A PWM fan's supply ripple, as a square wave of this many codes peak to peak.
+    float fan_ripple = 3.0f;
+    float fan_pwm_hz = 25'000.0f;
+};
+
+// Wires the host IDF backend to a plant: the thermistor channel samples the plant's sensor node and the heater GPIO
+// drives its relay. The plant is integrated lazily up to the virtual time of each sample or relay change.
+class SimBoard
+{
+public:
+    SimBoard(const PlantParams& params, uint32_t seed, gpio_num_t heater_gpio, adc_channel_t thermistor_channel)
+        : plant_(params, seed), heater_gpio_(heater_gpio), thermistor_channel_(thermistor_channel)
+    {
+    }
+
+    // Installs the ADC source and GPIO listener. The board must outlive the simulation run.
+    void attach()
+    {
+        sim_adc_set_source([this](uint64_t time_us, adc_channel_t channel) -> uint16_t {
+            advance_to(time_us);
+            if (channel != thermistor_channel_) {
+                return 0;
+            }
+            const uint16_t sample = plant_.read_sample(adc_);
+            if (!interference_) {
+                return sample;
+            }
+            const float code = std::round(sample + interference(time_us));
+            return uint16_t(std::clamp(code, 0.0f, float((1 << kAdcResolutionBits) - 1)));
+        });
+        sim_gpio_set_listener([this](gpio_num_t gpio, uint32_t level) {
+            if (gpio == heater_gpio_) {
+                advance_to(sim_now_us());
+                if (heater_on_ != (level != 0)) {
+                    previous_switch_us_ = last_switch_us_;
+                    last_switch_us_ = sim_now_us();
+                }
+                heater_on_ = level != 0;
+            }
+        });
+    }
+
+    // Makes the thermistor follow `curve` while the firmware converts with its own, so the firmware reads it off by
+    // the difference.
+    void set_thermistor_curve(const ThermistorCurve& curve) { adc_ = AdcModel(kAdcCorrection, curve); }
+
+    // Puts an SHT3x on the I2C bus that reads the chamber air to within `noise` degrees RMS, measuring once a second
+    // after the firmware starts it.
+    void attach_reference_sensor(float noise = 0.05f)
+    {
+        sim_i2c_set_device(ReferenceSensor::kAddress, [this, noise](const uint8_t* write, size_t write_size,
+                                                                    uint8_t* read, size_t read_size) {
+            static constexpr uint8_t kStartPeriodic[] = {0x21, 0x30};
+            static constexpr uint8_t kFetchData[] = {0xe0, 0x00};
+            if (write_size == 2 && memcmp(write, kStartPeriodic, 2) == 0 && read_size == 0) {
+                reference_ready_us_ = sim_now_us() + 1'000'000;
+                return true;
+            }
+            if (write_size != 2 || memcmp(write, kFetchData, 2) != 0 || read_size != 6 ||
+                sim_now_us() < reference_ready_us_) {
+                return false;
+            }
+            advance_to(sim_now_us());
+            std::normal_distribution<float> error(0.0f, noise);
+            const float temperature = plant_.air_temperature() + error(plant_.rng());
+            const float humidity = chamber_humidity() / 100.0f;
+            const uint16_t words[2] = {uint16_t(std::lround(std::clamp((temperature + 45.0f) / 175.0f, 0.0f, 1.0f) *
+                                                            65535.0f)),
+                                       uint16_t(std::lround(std::clamp(humidity, 0.0f, 1.0f) * 65535.0f))};
+            for (int i = 0; i < 2; ++i) {
+                read[3 * i] = words[i] >> 8;
+                read[3 * i + 1] = words[i] & 0xff;
+                read[3 * i + 2] = sht3x_crc8(read + 3 * i, 2);
+            }
+            return true;
+        });
+    }
+
+    // Puts a drying spool in the chamber, whose water goes into the chamber air.
+    void attach_spool(const SimLoadCellParams& params = {})
+    {
+        spool_.emplace(params, plant_.rng()());
+        spool_us_ = sim_now_us();
+    }
+
+    // Puts the spool on an HX711 load cell with DOUT on `dout_gpio` and PD_SCK on the MOSI of the second SPI bus. It
+    // converts ten times a second after a settling time, and a read that starts with no conversion ready gets
+    // nothing but ones.
+    void attach_load_cell(gpio_num_t dout_gpio, const SimLoadCellParams& params = {})
+    {
+        if (!spool_) {
+            attach_spool(params);
+        }
+        load_cell_ready_us_ = sim_now_us() + 400'000;
+        sim_gpio_set_input(dout_gpio, [this] { return sim_now_us() < load_cell_ready_us_; });
+        sim_spi_set_device(SPI2_HOST, [this](const uint8_t* tx, uint8_t* rx, size_t bits) {
+            auto mosi = [&](size_t bit) { return bit < bits && (tx[bit / 8] >> (7 - bit % 8)) & 1; };
+            size_t pulses = 0;
+            for (size_t bit = 0; bit < bits; ++bit) {
+                pulses += mosi(bit) && !mosi(bit + 1);
+            }
+            if (sim_now_us() < load_cell_ready_us_ || pulses < LoadCell::kPulses) {
+                return;
+            }
+            advance_to(sim_now_us());
+            hx711_encode(spool_->counts(), rx, (bits + 7) / 8);
+            load_cell_ready_us_ = sim_now_us() + 100'000;
+        });
+    }
+
+    // Connects a vent servo driven by the LEDC channel on `gpio`, closed at a pulse of `closed_us` and fully open at
+    // `open_us`. Until then the vent stays fully open.
+    void attach_vent(gpio_num_t gpio, float closed_us, float open_us)
+    {
+        vent_gpio_ = gpio;
+        vent_closed_us_ = closed_us;
+        vent_open_us_ = open_us;
+    }
+
+    // Adds `interference` to every thermistor sample.
+    void attach_interference(const SimInterference& interference = {}) { interference_ = interference; }
+
+    // Opens the chamber door from `open_us` until `close_us`, as someone checking the spool would.
+    void open_door(uint64_t open_us, uint64_t close_us)
+    {
+        door_open_us_ = open_us;
+        door_close_us_ = close_us;
+    }
+
+    float chamber_humidity() const { return plant_.humidity(); }
+
+    void advance_to(uint64_t time_us)
+    {
+        if (time_us <= last_us_) {
+            return;
+        }
+        if (vent_gpio_ != GPIO_NUM_NC) {
+            const float pulse_us = sim_ledc_high_us(vent_gpio_);
+            if (std::isfinite(pulse_us)) {
+                plant_.set_vent((pulse_us - vent_closed_us_) / (vent_open_us_ - vent_closed_us_));
+            }
+        }
+        plant_.set_door(time_us > door_open_us_ && time_us <= door_close_us_);
+        energy_j_ += plant_.step(heater_on_, (time_us - last_us_) / 1e6f);
+        last_us_ = time_us;
+        // The spool's moisture changes over minutes; a step a second is plenty.
+        if (spool_ && time_us - spool_us_ >= 1'000'000) {
+            const float before = spool_->moisture();
+            spool_->step(plant_.air_temperature(), chamber_humidity(), (time_us - spool_us_) / 1e6f);
+            plant_.evaporate((before - spool_->moisture()) / 100.0f * spool_->params().filament);
+            spool_us_ = time_us;
+        }
+    }
+
+    Plant& plant() { return plant_; }
+    const AdcModel& adc() const { return adc_; }
+    bool heater_on() const { return heater_on_; }
+    SimLoadCell* spool() { return spool_ ? &*spool_ : nullptr; }
+    double energy_j() const { return energy_j_; }
+
+private:
+    // Samples are produced when the firmware reads them, which can be after a relay switch later than the sample.
+    float interference(uint64_t time_us) const
+    {
+        const SimInterference& params = *interference_;
+        const double phase = std::fmod(time_us * 1e-6 * params.fan_pwm_hz, 1.0);
+        float code = (phase < 0.5f ? 0.5f : -0.5f) * params.fan_ripple;
+        const uint64_t switch_us = time_us >= last_switch_us_ ? last_switch_us_ : previous_switch_us_;
+        if (switch_us != kSimForever && time_us >= switch_us) {
+            const float since_us = float(time_us - switch_us);
+            code += params.relay_spike * std::exp(-since_us / params.relay_decay_us) *
+                    std::cos(2.0f * std::numbers::pi_v<float> * params.relay_ring_hz * since_us * 1e-6f);
+        }
+        return code;
+    }
+
+    Plant plant_;
+    AdcModel adc_;
+    gpio_num_t heater_gpio_;
+    adc_channel_t thermistor_channel_;
+    bool heater_on_ = false;
+    uint64_t last_us_ = 0;
+    double energy_j_ = 0.0;
+    uint64_t reference_ready_us_ = kSimForever;
+    std::optional<SimLoadCell> spool_;
+    uint64_t spool_us_ = 0;
+    uint64_t load_cell_ready_us_ = kSimForever;
+    gpio_num_t vent_gpio_ = GPIO_NUM_NC;
+    float vent_closed_us_ = 0.0f;
+    float vent_open_us_ = 0.0f;
+    uint64_t door_open_us_ = kSimForever;
+    uint64_t door_close_us_ = kSimForever;
+    std::optional<SimInterference> interference_;
+    uint64_t last_switch_us_ = kSimForever;
+    uint64_t previous_switch_us_ = kSimForever;
+};
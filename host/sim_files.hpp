@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "idf_sim.hpp"
+
+// File plumbing shared by the tools that run the firmware on the host IDF backend.
+
+// Sizes and subtypes of the data partitions in partitions.csv.
+constexpr size_t kHistoryPartitionSize = 0xe0000;
+constexpr uint8_t kHistoryPartitionSubtype = 0x40;
+constexpr size_t kSnapshotPartitionSize = 0x10000;
+constexpr uint8_t kSnapshotPartitionSubtype = 0x41;
+
+inline bool read_text_file(const char* path, std::string& text)
+{
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr) {
+        perror(path);
+        return false;
+    }
+    char chunk[4096];
+    for (size_t n; (n = fread(chunk, 1, sizeof(chunk), file)) > 0;) {
+        text.append(chunk, n);
+    }
+    fclose(file);
+    return true;
+}
+
+// Creates a data partition, loaded from `path` if that file exists and erased otherwise.
+inline std::vector<uint8_t>* load_partition(const char* path, const char* label, uint8_t subtype, size_t size)
+{
+    auto& flash = sim_flash_add_partition(label, subtype, size);
+    if (FILE* image = fopen(path, "rb")) {
+        const size_t size = fread(flash.data(), 1, flash.size(), image);
+        fclose(image);
+        if (size != flash.size()) {
+            fprintf(stderr, "%s: expected a %zu byte partition image\n", path, flash.size());
+            return nullptr;
+        }
+    }
+    return &flash;
+}
+
+inline std::vector<uint8_t>* load_history_partition(const char* path)
+{
+    return load_partition(path, "history", kHistoryPartitionSubtype, kHistoryPartitionSize);
+}
+
+inline std::vector<uint8_t>* load_snapshot_partition(const char* path)
+{
+    return load_partition(path, "snapshot", kSnapshotPartitionSubtype, kSnapshotPartitionSize);
+}
+
+inline bool save_partition(const char* path, const std::vector<uint8_t>& flash)
+{
+    FILE* image = fopen(path, "wb");
+    if (image == nullptr || fwrite(flash.data(), 1, flash.size(), image) != flash.size()) {
+        perror(path);
+        if (image != nullptr) {
+            fclose(image);
+        }
+        return false;
+    }
+    return fclose(image) == 0;
+}
+
+// Schedules the faults of a script file, drawing from a generator seeded with `seed`.
+inline bool load_fault_script(const char* path, uint32_t seed)
+{
+    std::string text;
+    std::string error;
+    if (!read_text_file(path, text)) {
+        return false;
+    }
+    if (!sim_fault_load_script(text.data(), text.size(), error)) {
+        fprintf(stderr, "%s: %s\n", path, error.c_str());
+        return false;
+    }
+    sim_fault_seed(seed);
+    return true;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+
+#include "moisture_model.hpp"
+#include "spool_model.hpp"
+#include "spool_scale.hpp"
+
+// A spool drying on a load cell, as the HX711 would report it. The truth behind it: the spool's water follows the
+// firmware's own moisture physics from a starting moisture the firmware doesn't know, and the cell has the faults
+// SpoolScale corrects for, with coefficients a little off the firmware's nominal ones.
+struct SimLoadCellParams
+{
+    Material material = Material::Pla;
+    float filament = 1000.0f;          // g, dry
+    float spool = 240.0f;              // g, empty
+    // Starting moisture in percent; NAN for the material's nominal one.
+    float initial_moisture = NAN;
+    float noise = 1.0f;                // g RMS per reading
+    float counts_per_gram = 420.0f;
+    int32_t zero_counts = 12'000;
+    ScaleParams cell = {0.11f, 1.6e-5f, 22.0f, 0.52f, 1900.0f, 2.2e-4f, 1100.0f};
+};
+
+class SimLoadCell
+{
+public:
+    SimLoadCell(const SimLoadCellParams& params, uint32_t seed) : params_(params), rng_(seed)
+    {
+        moisture_.start(params.material, params.initial_moisture);
+        cell_temperature_ = params.cell.reference_temperature;
+    }
+
+    // Advances by `dt` seconds with the chamber air at `air` and `humidity` percent relative humidity.
+    void step(float air, float humidity, float dt)
+    {
+        spool_.step(air, dt);
+        moisture_.update(spool_, air, humidity, NAN, dt);
+        const float target = params_.cell.reference_temperature +
+                             params_.cell.thermal_coupling * (air - params_.cell.reference_temperature);
+        cell_temperature_ += (target - cell_temperature_) * (1.0f - std::exp(-dt / params_.cell.thermal_tau_s));
+        loaded_s_ += dt;
+    }
+
+    float weight() const { return params_.spool + params_.filament * (1.0f + moisture_.moisture() / 100.0f); }
+    float moisture() const { return moisture_.moisture(); }
+    const MoistureModel& model() const { return moisture_; }
+
+    // A reading in grams as the cell's static calibration makes it.
+    float reading()
+    {
+        const ScaleParams& cell = params_.cell;
+        const float rise = cell_temperature_ - cell.reference_temperature;
+        const float load = weight();
+        const float creep = load * cell.creep * (1.0f - std::exp(-loaded_s_ / cell.creep_tau_s));
+        std::normal_distribution<float> noise(0.0f, params_.noise);
+        return (load + creep) * (1.0f + cell.span_tempco * rise) + cell.zero_tempco * rise + noise(rng_);
+    }
+
+    // The HX711's code for a reading.
+    int32_t counts()
+    {
+        const float code = params_.zero_counts + reading() * params_.counts_per_gram;
+        return int32_t(std::clamp(std::lround(code), -0x800000l, 0x7fffffl));
+    }
+
+    const SimLoadCellParams& params() const { return params_; }
+
+private:
+    SimLoadCellParams params_;
+    std::mt19937 rng_;
+    SpoolModel spool_;
+    MoistureModel moisture_;
+    float cell_temperature_;
+    float loaded_s_ = 0.0f;
+};
+
+// What the HX711 drives on DOUT for `counts` during the MOSI pulse train of LoadCell: data bit k, MSB first, while
+// pulse k is high. DOUT stays high after the last data bit.
+inline void hx711_encode(int32_t counts, uint8_t* rx, size_t bytes)
+{
+    for (size_t i = 0; i < bytes; ++i) {
+        rx[i] = 0xff;
+    }
+    const uint32_t value = uint32_t(counts) & 0xffffff;
+    for (size_t bit = 0; bit < 24; ++bit) {
+        if (((value >> (23 - bit)) & 1) == 0) {
+            rx[bit / 4] &= ~(0x80 >> (bit % 4 * 2));
+        }
+    }
+}
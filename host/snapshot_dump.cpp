@@ -0,0 +1,184 @@
+// Prints the snapshots in an image of the "snapshot" flash partition, oldest first.
+//
+//   snapshot_dump IMAGE [--steps] [--csv FILE]
+//
+// For each snapshot: what triggered it and when, the steps it spans, and a summary of the temperature, heater duty
+// and ADC frame noise before the trigger and after it. --steps lists every step, with its blocks' means and
+// standard deviations in codes. --csv writes `snapshot,time_ms,offset_s,temperature,setpoint,duty,raw,heater,fault,
+// drift,timeout,phase,block,mean,variance` rows, one per block, with mean and variance in codes and codes^2; a step
+// without blocks gets one row with the block columns empty.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "snapshot.hpp"
+
+static bool read_file(const char* path, std::vector<uint8_t>& data)
+{
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr) {
+        perror(path);
+        return false;
+    }
+    uint8_t chunk[65536];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        data.insert(data.end(), chunk, chunk + n);
+    }
+    fclose(file);
+    return true;
+}
+
+static std::string trigger_names(uint8_t trigger)
+{
+    std::string names;
+    for (uint8_t bit = 1; bit != 0 && bit <= trigger; bit <<= 1) {
+        if (trigger & bit) {
+            names += names.empty() ? "" : "+";
+            names += snapshot_trigger_name(bit);
+        }
+    }
+    return names.empty() ? "none" : names;
+}
+
+struct Summary
+{
+    size_t steps = 0;
+    float min = INFINITY;
+    float max = -INFINITY;
+    double duty = 0.0;
+    size_t blocks = 0;
+    // Largest frame standard deviation, codes.
+    float noise = 0.0f;
+    size_t faulted = 0;
+
+    void add(const SnapshotStep& step)
+    {
+        ++steps;
+        if ((step.flags & (kSnapshotFaulted | kSnapshotTimeout)) != 0) {
+            ++faulted;
+        } else {
+            min = std::min(min, step.temperature);
+            max = std::max(max, step.temperature);
+        }
+        duty += step.duty;
+        blocks += step.block_count;
+        for (size_t b = 0; b < step.block_count; ++b) {
+            noise = std::max(noise, std::sqrt(step.blocks[b].variance / 16.0f));
+        }
+    }
+
+    void print(const char* what) const
+    {
+        if (steps == 0) {
+            printf("  %-7s no steps\n", what);
+            return;
+        }
+        printf("  %-7s %3zu steps, %.2f to %.2f C, duty %.2f, %.1f frames a step, frame noise up to %.2f codes",
+               what, steps, min, max, duty / steps, double(blocks) / steps, noise);
+        printf(faulted != 0 ? ", %zu faulted\n" : "\n", faulted);
+    }
+};
+
+static void print_steps(std::span<const SnapshotStep> steps, size_t trigger)
+{
+    for (size_t i = 0; i < steps.size(); ++i) {
+        const auto& step = steps[i];
+        printf("  %c %9u ms %7.2f C set %5.1f duty %.2f raw %4u %s%s%s%s phase %u:", i == trigger ? '>' : ' ',
+               unsigned(step.time_ms), step.temperature, step.setpoint, step.duty, unsigned(step.raw),
+               step.flags & kSnapshotHeaterOn ? "H" : "-", step.flags & kSnapshotFaulted ? "F" : "-",
+               step.flags & kSnapshotDrift ? "D" : "-", step.flags & kSnapshotTimeout ? "T" : "-",
+               unsigned(step.phase()));
+        for (size_t b = 0; b < step.block_count; ++b) {
+            printf(" %.2f~%.2f", step.blocks[b].mean / 16.0, std::sqrt(step.blocks[b].variance / 16.0));
+        }
+        printf("\n");
+    }
+}
+
+static void write_csv(FILE* csv, const SnapshotHeader& header, std::span<const SnapshotStep> steps)
+{
+    for (const auto& step : steps) {
+        char prefix[160];
+        snprintf(prefix, sizeof(prefix), "%u,%u,%.3f,%.4f,%.2f,%.4f,%u,%d,%d,%d,%d,%u", unsigned(header.sequence),
+                 unsigned(step.time_ms), (int64_t(step.time_ms) - int64_t(header.trigger_ms)) / 1000.0,
+                 step.temperature, step.setpoint, step.duty, unsigned(step.raw), (step.flags & kSnapshotHeaterOn) != 0,
+                 (step.flags & kSnapshotFaulted) != 0, (step.flags & kSnapshotDrift) != 0,
+                 (step.flags & kSnapshotTimeout) != 0, unsigned(step.phase()));
+        if (step.block_count == 0) {
+            fprintf(csv, "%s,,,\n", prefix);
+        }
+        for (size_t b = 0; b < step.block_count; ++b) {
+            fprintf(csv, "%s,%zu,%.4f,%.4f\n", prefix, b, step.blocks[b].mean / 16.0, step.blocks[b].variance / 16.0);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const char* image_path = nullptr;
+    const char* csv_path = nullptr;
+    bool list_steps = false;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+            csv_path = argv[++i];
+        } else if (strcmp(argv[i], "--steps") == 0) {
+            list_steps = true;
+        } else if (image_path == nullptr && argv[i][0] != '-') {
+            image_path = argv[i];
+        } else {
+            image_path = nullptr;
+            break;
+        }
+    }
+    if (image_path == nullptr) {
+        fprintf(stderr, "usage: %s IMAGE [--steps] [--csv FILE]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<uint8_t> image;
+    if (!read_file(image_path, image)) {
+        return 1;
+    }
+    FILE* csv = nullptr;
+    if (csv_path != nullptr) {
+        csv = fopen(csv_path, "w");
+        if (csv == nullptr) {
+            perror(csv_path);
+            return 1;
+        }
+        fprintf(csv, "snapshot,time_ms,offset_s,temperature,setpoint,duty,raw,heater,fault,drift,timeout,phase,block,"
+                     "mean,variance\n");
+    }
+
+    const size_t count = decode_snapshot_image(
+        image.data(), image.size(), [&](const SnapshotHeader& header, std::span<const SnapshotStep> steps) {
+            printf("snapshot %u: %s at %.1f s, steps from %.1f to %.1f s", unsigned(header.sequence),
+                   trigger_names(header.trigger).c_str(), header.trigger_ms / 1000.0, steps.front().time_ms / 1000.0,
+                   steps.back().time_ms / 1000.0);
+            printf(header.missed != 0 ? ", %u later triggers missed\n" : "\n", unsigned(header.missed));
+            Summary before;
+            Summary after;
+            for (size_t i = 0; i < steps.size(); ++i) {
+                (i < header.trigger_index ? before : after).add(steps[i]);
+            }
+            before.print("before");
+            after.print("after");
+            if (list_steps) {
+                print_steps(steps, header.trigger_index);
+            }
+            if (csv != nullptr) {
+                write_csv(csv, header, steps);
+            }
+        });
+    if (csv != nullptr) {
+        fclose(csv);
+    }
+    printf("%zu snapshots in %zu slots\n", count, image.size() / kSnapshotSlotSize);
+    return 0;
+}
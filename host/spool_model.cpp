@@ -0,0 +1,289 @@
+// Validates the firmware's spool core model (SpoolModel) against a fine-grid solution of the same heat equation,
+// and against logged core temperatures when there are any.
+//
+//   spool_model [--setpoint C] [--ambient C] [--hours H] [--band C] [--nodes N] [--log CSV [--fit]]
+//
+// Without --log, the chamber air rises from ambient to the setpoint with the dehydrator's time constant, holds for
+// H hours (default 8) and falls back for H/2, and the model's core temperature is compared with that of an
+// N-shell (default 200) double precision solution over the same spool: largest error, and when each reaches the
+// soak band around the setpoint, which is when the firmware's soak timer starts.
+//
+// --log reads `time_s,air,core` rows, such as from a probe pushed into the middle of a spool's winding, drives the
+// model with the logged air and reports the error against the logged core. --fit also searches the spool's
+// conductivity and surface coefficient for the best fit, the two parameters the winding makes uncertain.
+//
+// Either way the cost of a model step on the host is printed last.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <numbers>
+#include <vector>
+
+#include "spool_model.hpp"
+
+// Time constant of the chamber air approaching the setpoint under control.
+constexpr double kChamberTau = 600.0;
+constexpr double kStep = 1.0;
+
+struct Options
+{
+    double setpoint = 60.0;
+    double ambient = 22.0;
+    double hours = 8.0;
+    double band = 1.0;
+    size_t nodes = 200;
+    const char* log = nullptr;
+    bool fit = false;
+};
+
+// The same geometry finely divided, in double precision, with its own explicit sub-steps.
+class ReferenceSpool
+{
+public:
+    ReferenceSpool(const SpoolParams& params, size_t nodes, double temperature)
+        : capacity_(nodes), conductance_(nodes), nodes_(nodes, temperature), flow_(nodes)
+    {
+        constexpr double kPi = std::numbers::pi;
+        const double thickness = (params.outer_radius - params.hub_radius) / double(nodes);
+        for (size_t i = 0; i < nodes; ++i) {
+            const double inner = params.hub_radius + i * thickness;
+            const double outer = inner + thickness;
+            const double center = inner + thickness / 2;
+            capacity_[i] = params.volumetric_heat_capacity * kPi * (outer * outer - inner * inner);
+            if (i + 1 < nodes) {
+                conductance_[i] = 2 * kPi * params.conductivity / std::log((center + thickness) / center);
+            } else {
+                conductance_[i] = 1.0 / (std::log(outer / center) / (2 * kPi * params.conductivity) +
+                                         1.0 / (params.surface_coefficient * 2 * kPi * outer));
+            }
+        }
+        max_step_ = INFINITY;
+        for (size_t i = 0; i < nodes; ++i) {
+            max_step_ = std::min(max_step_, 0.4 * capacity_[i] / (conductance_[i] + (i > 0 ? conductance_[i - 1] : 0)));
+        }
+    }
+
+    void step(double air, double dt)
+    {
+        const int steps = std::max(1, int(std::ceil(dt / max_step_)));
+        const double h = dt / steps;
+        const size_t n = nodes_.size();
+        for (int s = 0; s < steps; ++s) {
+            for (size_t i = 0; i < n; ++i) {
+                flow_[i] = conductance_[i] * ((i + 1 < n ? nodes_[i + 1] : air) - nodes_[i]);
+            }
+            for (size_t i = 0; i < n; ++i) {
+                nodes_[i] += h * (flow_[i] - (i > 0 ? flow_[i - 1] : 0.0)) / capacity_[i];
+            }
+        }
+    }
+
+    double core() const { return nodes_[0]; }
+
+private:
+    std::vector<double> capacity_;
+    std::vector<double> conductance_;
+    std::vector<double> nodes_;
+    std::vector<double> flow_;
+    double max_step_;
+};
+
+struct Row
+{
+    double time;
+    double air;
+    double core;
+};
+
+static bool read_log(const char* path, std::vector<Row>& rows)
+{
+    FILE* in = fopen(path, "r");
+    if (in == nullptr) {
+        perror(path);
+        return false;
+    }
+    char line[256];
+    while (fgets(line, sizeof(line), in) != nullptr) {
+        Row row;
+        if (sscanf(line, "%lf,%lf,%lf", &row.time, &row.air, &row.core) == 3 && std::isfinite(row.time) &&
+            (rows.empty() || row.time > rows.back().time)) {
+            rows.push_back(row);
+        }
+    }
+    fclose(in);
+    return true;
+}
+
+struct LogError
+{
+    double rms = 0.0;
+    double max = 0.0;
+};
+
+// Starts the model at the first logged core temperature, as the spool is rarely in equilibrium with the air when a
+// log starts.
+static LogError log_error(const SpoolParams& params, const std::vector<Row>& rows)
+{
+    SpoolModel model(params);
+    model.reset(float(rows[0].core));
+    LogError error;
+    size_t count = 0;
+    for (size_t i = 1; i < rows.size(); ++i) {
+        model.step(float(rows[i - 1].air), float(rows[i].time - rows[i - 1].time));
+        if (std::isfinite(rows[i].core)) {
+            const double e = std::abs(model.core() - rows[i].core);
+            error.rms += e * e;
+            error.max = std::max(error.max, e);
+            ++count;
+        }
+    }
+    error.rms = count != 0 ? std::sqrt(error.rms / count) : 0.0;
+    return error;
+}
+
+static int run_log(const Options& options)
+{
+    std::vector<Row> rows;
+    if (!read_log(options.log, rows)) {
+        return 1;
+    }
+    if (rows.size() < 2) {
+        fprintf(stderr, "%s: %zu rows, need at least 2\n", options.log, rows.size());
+        return 1;
+    }
+    const SpoolParams params;
+    const LogError error = log_error(params, rows);
+    printf("%zu rows over %.1f h: core error rms %.3f C, max %.3f C\n", rows.size(),
+           (rows.back().time - rows.front().time) / 3600, error.rms, error.max);
+    if (!options.fit) {
+        return 0;
+    }
+
+    // Log-spaced grid over the plausible range of each, from loosely wound to solid.
+    constexpr int kGrid = 40;
+    SpoolParams best = params;
+    LogError best_error = error;
+    for (int i = 0; i < kGrid; ++i) {
+        for (int j = 0; j < kGrid; ++j) {
+            SpoolParams candidate = params;
+            candidate.conductivity = float(0.05 * std::pow(20.0, i / double(kGrid - 1)));
+            candidate.surface_coefficient = float(2.0 * std::pow(25.0, j / double(kGrid - 1)));
+            const LogError e = log_error(candidate, rows);
+            if (e.rms < best_error.rms) {
+                best = candidate;
+                best_error = e;
+            }
+        }
+    }
+    printf("fit: conductivity %.3g W/(m K), surface coefficient %.3g W/(m^2 K): rms %.3f C, max %.3f C\n",
+           best.conductivity, best.surface_coefficient, best_error.rms, best_error.max);
+    return 0;
+}
+
+static void run_profile(const Options& options)
+{
+    const SpoolParams params;
+    SpoolModel model(params);
+    model.reset(float(options.ambient));
+    ReferenceSpool reference(params, options.nodes, options.ambient);
+
+    const double heat_s = options.hours * 3600;
+    const double end_s = heat_s * 1.5;
+    double air = options.ambient;
+    double max_error = 0.0;
+    double model_in_band = NAN;
+    double reference_in_band = NAN;
+    printf("%7s %8s %8s %8s %8s\n", "time_h", "air", "core", "model", "error");
+    for (double t = 0; t < end_s; t += kStep) {
+        const double target = t < heat_s ? options.setpoint : options.ambient;
+        air += (target - air) * (1 - std::exp(-kStep / kChamberTau));
+        model.step(float(air), float(kStep));
+        reference.step(air, kStep);
+        const double error = model.core() - reference.core();
+        max_error = std::max(max_error, std::abs(error));
+        if (std::isnan(model_in_band) && std::abs(model.core() - options.setpoint) <= options.band) {
+            model_in_band = t + kStep;
+        }
+        if (std::isnan(reference_in_band) && std::abs(reference.core() - options.setpoint) <= options.band) {
+            reference_in_band = t + kStep;
+        }
+        if (std::fmod(t + kStep, 1800) == 0) {
+            printf("%7.1f %8.2f %8.2f %8.2f %+8.3f\n", (t + kStep) / 3600, air, reference.core(), model.core(), error);
+        }
+    }
+    printf("%zu-node model against %zu shells: max core error %.3f C\n", SpoolModel::kNodes, options.nodes,
+           max_error);
+    printf("core within %.1f C of %.1f C after %.2f h (model %.2f h); air after %.2f h\n", options.band,
+           options.setpoint, reference_in_band / 3600, model_in_band / 3600,
+           kChamberTau * std::log(std::abs(options.setpoint - options.ambient) / options.band) / 3600);
+}
+
+static void bench()
+{
+    constexpr int kSteps = 10'000'000;
+    SpoolModel model;
+    model.reset(22.0f);
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kSteps; ++i) {
+        model.step(i & 1 ? 60.0f : 59.0f, 1.0f);
+    }
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    printf("step: %.1f ns on this host (core %.2f), %.2f s stable step\n", elapsed.count() / kSteps, model.core(),
+           model.max_step());
+}
+
+static bool parse(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--fit") == 0) {
+            options.fit = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            return false;
+        }
+        const char* value = argv[++i];
+        if (strcmp(arg, "--setpoint") == 0) {
+            options.setpoint = strtod(value, nullptr);
+        } else if (strcmp(arg, "--ambient") == 0) {
+            options.ambient = strtod(value, nullptr);
+        } else if (strcmp(arg, "--hours") == 0) {
+            options.hours = strtod(value, nullptr);
+        } else if (strcmp(arg, "--band") == 0) {
+            options.band = strtod(value, nullptr);
+        } else if (strcmp(arg, "--nodes") == 0) {
+            options.nodes = strtoul(value, nullptr, 0);
+        } else if (strcmp(arg, "--log") == 0) {
+            options.log = value;
+        } else {
+            return false;
+        }
+    }
+    return options.hours > 0 && options.band > 0 && options.nodes >= SpoolModel::kNodes &&
+           (!options.fit || options.log != nullptr);
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parse(argc, argv, options)) {
+        fprintf(stderr,
+                "usage: %s [--setpoint C] [--ambient C] [--hours H] [--band C] [--nodes N]\n"
+                "       %*s [--log CSV [--fit]]\n",
+                argv[0], int(strlen(argv[0])), "");
+        return 1;
+    }
+    if (options.log != nullptr) {
+        if (run_log(options) != 0) {
+            return 1;
+        }
+    } else {
+        run_profile(options);
+    }
+    bench();
+    return 0;
+}
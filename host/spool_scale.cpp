@@ -0,0 +1,259 @@
+// Checks the firmware's load cell processing (SpoolScale, and the HX711 bit codec of LoadCell) against a simulated
+// spool drying on a load cell (sim_load_cell.hpp).
+//
+//   spool_scale [--material NAME] [--moisture M] [--filament G] [--noise G] [--hours H] [--seed N] [--csv FILE]
+//
+// Runs a drying of the material (PLA by default) from M percent moisture, twice its nominal value by default, so
+// that the moisture model's prior is wrong. One Dryer gets the load cell's readings; a second one sees the same
+// frames without them, and a SpoolScale without temperature or creep compensation sees the same readings. Reports
+// the weight and loss rate errors against the truth, the moisture each Dryer predicts, and when each declares the
+// spool dry and how dry it really was. --csv writes `time_h,true_weight,weight,raw_weight,loss_rate,true_loss_rate,
+// true_moisture,moisture,moisture_unweighed` rows once a minute.
+//
+// Last, every HX711 code goes through LoadCell's decoder from the bits the simulated HX711 drives, and the cost of a
+// SpoolScale update on the host is printed.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <strings.h>
+
+#include "dryer.hpp"
+#include "load_cell.hpp"
+#include "plant.hpp"
+#include "psychrometrics.hpp"
+#include "sim_load_cell.hpp"
+
+constexpr uint32_t kControlPeriodMs = 1000;
+
+struct Options
+{
+    Material material = Material::Pla;
+    float moisture = NAN;
+    float filament = 1000.0f;
+    float noise = 1.0f;
+    double hours = 14.0;
+    uint32_t seed = 1;
+    const char* csv = nullptr;
+};
+
+struct Error
+{
+    double sum2 = 0.0;
+    double max = 0.0;
+    size_t count = 0;
+
+    void add(double e)
+    {
+        sum2 += e * e;
+        max = std::max(max, std::abs(e));
+        ++count;
+    }
+    double rms() const { return count != 0 ? std::sqrt(sum2 / count) : NAN; }
+};
+
+static int run(const Options& options)
+{
+    const auto& kinetics = material_kinetics(options.material);
+    SimLoadCellParams cell;
+    cell.material = options.material;
+    cell.filament = options.filament;
+    cell.noise = options.noise;
+    cell.initial_moisture = std::isnan(options.moisture) ? 2 * kinetics.initial : options.moisture;
+    SimLoadCell truth(cell, options.seed);
+
+    FILE* csv = nullptr;
+    if (options.csv != nullptr) {
+        csv = fopen(options.csv, "w");
+        if (csv == nullptr) {
+            perror(options.csv);
+            return 1;
+        }
+        fprintf(csv, "time_h,true_weight,weight,raw_weight,loss_rate,true_loss_rate,true_moisture,moisture,"
+                     "moisture_unweighed\n");
+    }
+
+    Plant plant(PlantParams{}, options.seed);
+    // The chamber air holds the water of room air at 50% relative humidity.
+    const float room_vapour_pressure = vapour_pressure(PlantParams{}.ambient, 50.0f);
+    const AdcModel adc;
+    DryingProfile profile;
+    profile.setpoint = kinetics.temperature;
+    profile.material = options.material;
+    Dryer weighed;
+    Dryer unweighed;
+    weighed.start(profile);
+    unweighed.start(profile);
+    // The cell's faults uncorrected: what the readings would give taken at face value.
+    SpoolScale raw({0.0f, 0.0f, 22.0f, 0.0f, 1.0f, 0.0f, 1.0f});
+
+    Error weight_error;
+    Error raw_error;
+    Error rate_error;
+    double done_s[2] = {NAN, NAN};
+    float done_moisture[2] = {NAN, NAN};
+    float two_hours[3] = {NAN, NAN, NAN};
+    const uint32_t end_ms = uint32_t(options.hours * 3600'000.0);
+    for (uint32_t now_ms = 0; now_ms < end_ms; now_ms += kControlPeriodMs) {
+        const float dt = kControlPeriodMs / 1000.0f;
+        const float air = plant.air_temperature();
+        const float humidity = relative_humidity(air, room_vapour_pressure);
+        // From the moisture: the weight's float resolution is too coarse for one step's loss.
+        const float before = truth.moisture();
+        truth.step(air, humidity, dt);
+        const float true_rate = (before - truth.moisture()) * options.filament / 100.0f / dt * 3600.0f;
+        const float reading = truth.reading();
+
+        const uint32_t frame = plant.read_frame(adc);
+        weighed.set_humidity(humidity);
+        unweighed.set_humidity(humidity);
+        weighed.set_weight(reading);
+        raw.update(reading, NAN, dt);
+        const auto& status = weighed.step(frame, now_ms);
+        const auto& open = unweighed.step(frame, now_ms);
+
+        if (std::isfinite(status.weight)) {
+            weight_error.add(status.weight - truth.weight());
+            raw_error.add(raw.weight() - truth.weight());
+        }
+        if (std::isfinite(status.loss_rate) && status.phase == DryerPhase::Soaking) {
+            rate_error.add(status.loss_rate - true_rate);
+        }
+        const DryerStatus* statuses[2] = {&status, &open};
+        for (int i = 0; i < 2; ++i) {
+            if (statuses[i]->phase == DryerPhase::Done && std::isnan(done_s[i])) {
+                done_s[i] = now_ms / 1000.0;
+                done_moisture[i] = truth.moisture();
+            }
+        }
+        if (now_ms == 2 * 3600'000) {
+            two_hours[0] = truth.moisture();
+            two_hours[1] = status.moisture;
+            two_hours[2] = open.moisture;
+        }
+        if (csv != nullptr && now_ms % 60'000 == 0) {
+            fprintf(csv, "%.4f,%.3f,%.3f,%.3f,%.4f,%.4f,%.4f,%.4f,%.4f\n", now_ms / 3600e3, truth.weight(),
+                    status.weight, raw.weight(), status.loss_rate, true_rate, truth.moisture(), status.moisture,
+                    open.moisture);
+        }
+        // Both dryers control the same chamber from the same frames, so they agree on the heater until one is done;
+        // the other carries on to the end of its own run.
+        plant.step(status.heater_on || open.heater_on, dt);
+    }
+    if (csv != nullptr) {
+        fclose(csv);
+    }
+
+    printf("%s: %.0f g of filament at %.2f%% moisture (nominal %.2f%%), dried at %.0f C to %.2f%%, %.1f g noise\n",
+           kinetics.name, options.filament, cell.initial_moisture, kinetics.initial, kinetics.temperature,
+           kinetics.target, options.noise);
+    printf("weight error: rms %.2f g, max %.2f g; uncompensated rms %.2f g, max %.2f g\n", weight_error.rms(),
+           weight_error.max, raw_error.rms(), raw_error.max);
+    if (rate_error.count != 0) {
+        printf("loss rate error while soaking: rms %.3f g/h, max %.3f g/h\n", rate_error.rms(), rate_error.max);
+    } else {
+        printf("loss rate: no estimate while soaking\n");
+    }
+    printf("moisture at 2 h: %.3f%%, predicted %.3f%% weighed, %.3f%% unweighed\n", two_hours[0], two_hours[1],
+           two_hours[2]);
+    const char* names[2] = {"weighed", "unweighed"};
+    for (int i = 0; i < 2; ++i) {
+        if (std::isnan(done_s[i])) {
+            printf("%s: not dry after %.1f h\n", names[i], options.hours);
+        } else {
+            printf("%s: dry after %.2f h at %.3f%% moisture\n", names[i], done_s[i] / 3600, done_moisture[i]);
+        }
+    }
+    return 0;
+}
+
+static bool check_codec()
+{
+    uint8_t tx[LoadCell::kTransferBytes];
+    hx711_pulses(tx);
+    for (int32_t code = -0x800000; code <= 0x7fffff; ++code) {
+        uint8_t rx[LoadCell::kTransferBytes];
+        hx711_encode(code, rx, sizeof(rx));
+        if (hx711_decode(rx) != code) {
+            printf("codec: code %d decodes as %d\n", code, hx711_decode(rx));
+            return false;
+        }
+    }
+    size_t pulses = 0;
+    for (size_t bit = 0; bit < LoadCell::kTransferBits; ++bit) {
+        const bool high = (tx[bit / 8] >> (7 - bit % 8)) & 1;
+        const bool next = bit + 1 < LoadCell::kTransferBits && (tx[(bit + 1) / 8] >> (7 - (bit + 1) % 8)) & 1;
+        pulses += high && !next;
+    }
+    printf("codec: all %d codes decode, %zu pulses of %zu bits\n", 1 << 24, pulses, LoadCell::kTransferBits);
+    return pulses == LoadCell::kPulses;
+}
+
+static void bench()
+{
+    constexpr int kUpdates = 10'000'000;
+    SpoolScale scale;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kUpdates; ++i) {
+        scale.update(1250.0f - i * 1e-6f + (i & 1), 60.0f, 1.0f);
+    }
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    printf("update: %.1f ns on this host (weight %.1f g)\n", elapsed.count() / kUpdates, scale.weight());
+}
+
+static bool parse(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        const char* value = argv[++i];
+        if (strcmp(arg, "--material") == 0) {
+            options.material = Material::None;
+            for (size_t m = 1; m < size_t(Material::Count); ++m) {
+                if (strcasecmp(value, material_kinetics(Material(m)).name) == 0) {
+                    options.material = Material(m);
+                }
+            }
+        } else if (strcmp(arg, "--moisture") == 0) {
+            options.moisture = strtof(value, nullptr);
+        } else if (strcmp(arg, "--filament") == 0) {
+            options.filament = strtof(value, nullptr);
+        } else if (strcmp(arg, "--noise") == 0) {
+            options.noise = strtof(value, nullptr);
+        } else if (strcmp(arg, "--hours") == 0) {
+            options.hours = strtod(value, nullptr);
+        } else if (strcmp(arg, "--seed") == 0) {
+            options.seed = strtoul(value, nullptr, 0);
+        } else if (strcmp(arg, "--csv") == 0) {
+            options.csv = value;
+        } else {
+            return false;
+        }
+    }
+    return options.material != Material::None && options.filament > 0 && options.noise >= 0 && options.hours > 0 &&
+           !(options.moisture < 0);
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parse(argc, argv, options)) {
+        fprintf(stderr,
+                "usage: %s [--material NAME] [--moisture M] [--filament G] [--noise G] [--hours H] [--seed N]\n"
+                "       %*s [--csv FILE]\n",
+                argv[0], int(strlen(argv[0])), "");
+        return 1;
+    }
+    if (run(options) != 0) {
+        return 1;
+    }
+    if (!check_codec()) {
+        return 1;
+    }
+    bench();
+    return 0;
+}
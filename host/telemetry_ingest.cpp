@@ -0,0 +1,453 @@
+// Decodes the binary telemetry (telemetry.hpp) gateways record from a fleet of dryers and writes it as InfluxDB line
+// protocol, for `influx write --precision ms` or any line-protocol collector.
+//
+//   telemetry_ingest [--threads N] [--out FILE|-] [--batch LINES] [--epoch MS] [--measurement NAME] FILE|-...
+//   telemetry_ingest --bench [--dryers N] [--hours H] [--threads N]
+//
+// Files are read in the order given, regular ones memory-mapped, each as one stream interleaving any number of
+// devices. A stream is scanned in segments across the thread pool and stitched (telemetry_stream.hpp), so frames are
+// decoded in place and found exactly as a sequential scan would find them. Frames are then demultiplexed into shards
+// by device, each shard on its own task, which tracks every device's sequence numbers for lost, duplicated (dropped)
+// and restarted streams and formats its lines into batches of --batch lines, each written to --out in one piece. A
+// device's lines keep their order; with more than one thread, batches of different shards interleave. Timestamps
+// are the unit's uptime plus --epoch.
+//
+// --bench builds a stream from a simulated fleet in memory, with corrupt frames and log text mixed in, and reports
+// scan and full ingestion throughput per thread count.
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "dryer.hpp"
+#include "plant.hpp"
+#include "telemetry_stream.hpp"
+#include "thread_pool.hpp"
+
+constexpr size_t kSegmentSize = 4 << 20;
+// Shards per thread, so work stealing can even out fleets where a few devices send most of the frames.
+constexpr unsigned kShardsPerThread = 4;
+
+struct Options
+{
+    std::vector<const char*> paths;
+    unsigned threads = std::thread::hardware_concurrency();
+    const char* out = "-";
+    size_t batch = 5000;
+    LineProtocolOptions line;
+    bool bench = false;
+    uint32_t dryers = 1000;
+    double hours = 1.0;
+};
+
+struct DeviceState
+{
+    uint32_t last_sequence = 0;
+    uint64_t frames = 0;
+};
+
+struct Counts
+{
+    uint64_t bytes = 0;
+    uint64_t frame_bytes = 0;
+    uint64_t frames = 0;
+    uint64_t lost = 0;
+    uint64_t duplicates = 0;
+    uint64_t restarts = 0;
+    uint64_t devices = 0;
+
+    void add(const Counts& other)
+    {
+        bytes += other.bytes;
+        frame_bytes += other.frame_bytes;
+        frames += other.frames;
+        lost += other.lost;
+        duplicates += other.duplicates;
+        restarts += other.restarts;
+        devices += other.devices;
+    }
+};
+
+// Writes whole batches of lines, one at a time, from any thread.
+class BatchWriter
+{
+public:
+    explicit BatchWriter(FILE* out) : out_(out) {}
+
+    void write(const std::string& lines)
+    {
+        std::lock_guard lock(mutex_);
+        failed_ = failed_ || fwrite(lines.data(), 1, lines.size(), out_) != lines.size();
+    }
+
+    bool failed() const { return failed_; }
+
+private:
+    FILE* out_;
+    std::mutex mutex_;
+    bool failed_ = false;
+};
+
+class Ingest
+{
+public:
+    Ingest(const Options& options, ThreadPool& pool, BatchWriter& writer)
+        : options_(options), pool_(pool), writer_(writer), shards_(pool.size() * kShardsPerThread)
+    {
+    }
+
+    void stream(const uint8_t* data, size_t size)
+    {
+        auto segments = split_telemetry(size, kSegmentSize);
+        pool_.parallel_for(segments.size(), [&](size_t i) { scan_telemetry_segment(data, size, segments[i]); });
+        stitch_telemetry_segments(data, size, segments);
+
+        // buckets[segment][shard] keeps each shard's frames in stream order.
+        std::vector<std::vector<std::vector<size_t>>> buckets(segments.size());
+        std::atomic<uint64_t> frame_bytes{0};
+        pool_.parallel_for(segments.size(), [&](size_t i) {
+            buckets[i].resize(shards_.size());
+            uint64_t bytes = 0;
+            for (const size_t offset : segments[i].frames) {
+                const TelemetryView frame(data + offset);
+                buckets[i][frame.device_id() % shards_.size()].push_back(offset);
+                bytes += frame.size();
+            }
+            frame_bytes += bytes;
+        });
+        counts_.bytes += size;
+        counts_.frame_bytes += frame_bytes;
+
+        pool_.parallel_for(shards_.size(), [&](size_t s) {
+            for (const auto& segment : buckets) {
+                for (const size_t offset : segment[s]) {
+                    add(shards_[s], TelemetryView(data + offset));
+                }
+            }
+        });
+    }
+
+    // Writes the last partial batches and returns the totals.
+    Counts finish()
+    {
+        Counts counts = counts_;
+        for (auto& shard : shards_) {
+            if (!shard.batch.empty()) {
+                writer_.write(shard.batch);
+                shard.batch.clear();
+                shard.lines = 0;
+            }
+            shard.counts.devices = shard.devices.size();
+            counts.add(shard.counts);
+        }
+        return counts;
+    }
+
+private:
+    struct Shard
+    {
+        std::unordered_map<uint32_t, DeviceState> devices;
+        std::string batch;
+        size_t lines = 0;
+        Counts counts;
+    };
+
+    void add(Shard& shard, const TelemetryView& frame)
+    {
+        auto& device = shard.devices[frame.device_id()];
+        const uint32_t sequence = frame.sequence();
+        if (device.frames != 0) {
+            if (sequence == device.last_sequence) {
+                ++shard.counts.duplicates;
+                return;
+            }
+            if (sequence < device.last_sequence) {
+                // The unit rebooted and counts from zero again.
+                ++shard.counts.restarts;
+            } else {
+                shard.counts.lost += sequence - device.last_sequence - 1;
+            }
+        }
+        device.last_sequence = sequence;
+        ++device.frames;
+        ++shard.counts.frames;
+
+        append_line_protocol(shard.batch, frame, options_.line);
+        if (++shard.lines == options_.batch) {
+            writer_.write(shard.batch);
+            shard.batch.clear();
+            shard.lines = 0;
+        }
+    }
+
+    const Options& options_;
+    ThreadPool& pool_;
+    BatchWriter& writer_;
+    std::vector<Shard> shards_;
+    Counts counts_;
+};
+
+// A read-only view of a file's contents: mapped for regular files, read into memory from stdin, pipes and FIFOs.
+class InputFile
+{
+public:
+    ~InputFile()
+    {
+        if (mapped_ != nullptr) {
+            munmap(mapped_, size_);
+        }
+    }
+
+    bool open(const char* path)
+    {
+        const bool is_stdin = strcmp(path, "-") == 0;
+        const int fd = is_stdin ? STDIN_FILENO : ::open(path, O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        bool ok = fstat(fd, &st) == 0;
+        if (ok && S_ISREG(st.st_mode) && st.st_size > 0) {
+            size_ = st.st_size;
+            void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            mapped_ = data != MAP_FAILED ? data : nullptr;
+            ok = mapped_ != nullptr;
+            if (ok) {
+                madvise(mapped_, size_, MADV_SEQUENTIAL);
+            }
+        } else if (ok) {
+            uint8_t buffer[1 << 16];
+            ssize_t n;
+            while ((n = read(fd, buffer, sizeof(buffer))) > 0 || (n < 0 && errno == EINTR)) {
+                contents_.insert(contents_.end(), buffer, buffer + std::max<ssize_t>(n, 0));
+            }
+            ok = n == 0;
+            size_ = contents_.size();
+        }
+        if (!is_stdin) {
+            ::close(fd);
+        }
+        return ok;
+    }
+
+    const uint8_t* data() const { return mapped_ != nullptr ? static_cast<const uint8_t*>(mapped_) : contents_.data(); }
+    size_t size() const { return size_; }
+
+private:
+    void* mapped_ = nullptr;
+    size_t size_ = 0;
+    std::vector<uint8_t> contents_;
+};
+
+static void report(const Counts& counts, double seconds)
+{
+    fprintf(stderr,
+            "%" PRIu64 " frames from %" PRIu64 " devices in %.3f s (%.2f M frames/s, %.0f MB/s): %" PRIu64
+            " bytes skipped, %" PRIu64 " frames lost, %" PRIu64 " duplicates dropped, %" PRIu64 " restarts\n",
+            counts.frames, counts.devices, seconds, counts.frames / seconds / 1e6, counts.bytes / seconds / 1e6,
+            counts.bytes - counts.frame_bytes, counts.lost, counts.duplicates, counts.restarts);
+}
+
+static int ingest(const Options& options)
+{
+    FILE* out = strcmp(options.out, "-") == 0 ? stdout : fopen(options.out, "w");
+    if (out == nullptr) {
+        perror(options.out);
+        return 1;
+    }
+    ThreadPool pool(options.threads);
+    BatchWriter writer(out);
+    Ingest ingest(options, pool, writer);
+    const auto start = std::chrono::steady_clock::now();
+    for (const char* path : options.paths) {
+        InputFile file;
+        if (!file.open(path)) {
+            perror(path);
+            return 1;
+        }
+        ingest.stream(file.data(), file.size());
+    }
+    const Counts counts = ingest.finish();
+    if (fflush(out) != 0 || writer.failed()) {
+        perror(options.out);
+        return 1;
+    }
+    if (out != stdout) {
+        fclose(out);
+    }
+    report(counts, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    return 0;
+}
+
+// A gateway's recording of a fleet: every dryer's frame of each control step in turn, with one frame in 1000
+// corrupted on the wire and a console line caught every 10000.
+static std::vector<uint8_t> make_stream(uint32_t dryers, double hours, uint64_t& corrupted)
+{
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> ambient(15.0f, 30.0f);
+    const AdcModel adc;
+    std::vector<Plant> plants;
+    std::vector<Dryer> fleet(dryers);
+    for (uint32_t i = 0; i < dryers; ++i) {
+        PlantParams params;
+        params.ambient = ambient(rng);
+        plants.emplace_back(params, rng());
+    }
+
+    std::vector<uint8_t> stream;
+    const uint32_t steps = uint32_t(hours * 3600.0);
+    stream.reserve(size_t(steps) * dryers * kTelemetryFrameSize * 1001 / 1000);
+    uint8_t frame[kTelemetryFrameSize];
+    uint64_t count = 0;
+    corrupted = 0;
+    for (uint32_t step = 0; step < steps; ++step) {
+        for (uint32_t i = 0; i < dryers; ++i) {
+            const auto& status = fleet[i].step(plants[i].read_frame(adc), step * 1000);
+            plants[i].step(status.heater_on, 1.0f);
+            const size_t size = encode_telemetry(frame, i, step, status);
+            if (++count % 1000 == 0) {
+                frame[rng() % size] ^= 1 << (rng() % 8);
+                ++corrupted;
+            }
+            if (count % 10000 == 0) {
+                char line[160];
+                const int length = snprintf(line, sizeof(line), "I (%" PRIu32 ") main: ", step * 1000);
+                format_status(line + length, sizeof(line) - length, status);
+                stream.insert(stream.end(), line, line + strlen(line));
+            }
+            stream.insert(stream.end(), frame, frame + size);
+        }
+    }
+    return stream;
+}
+
+static int bench(const Options& options)
+{
+    uint64_t corrupted = 0;
+    const auto stream = make_stream(options.dryers, options.hours, corrupted);
+    const uint64_t sent = uint64_t(options.dryers) * uint32_t(options.hours * 3600.0);
+    fprintf(stderr, "%" PRIu64 " frames from %" PRIu32 " dryers, %" PRIu64 " corrupted, %.1f MB\n", sent,
+            options.dryers, corrupted, stream.size() / 1e6);
+
+    // The decoder alone: find, check and read every frame on one thread.
+    auto start = std::chrono::steady_clock::now();
+    TelemetryScanner scanner(stream.data(), stream.size());
+    scanner.set_complete();
+    TelemetryView frame;
+    uint64_t frames = 0;
+    float checksum = 0.0f;
+    while (scanner.next(frame)) {
+        checksum += frame.temperature();
+        ++frames;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    fprintf(stderr, "decode: %" PRIu64 " frames in %.3f s, %.1f M frames/s, %.0f MB/s on one thread (checksum %g)\n",
+            frames, seconds, frames / seconds / 1e6, stream.size() / seconds / 1e6, checksum);
+
+    FILE* null = fopen("/dev/null", "w");
+    if (null == nullptr) {
+        perror("/dev/null");
+        return 1;
+    }
+    printf("threads,frames_per_s,mb_per_s,speedup\n");
+    double base = 0.0;
+    std::vector<unsigned> counts;
+    for (unsigned threads = 1; threads < options.threads; threads *= 2) {
+        counts.push_back(threads);
+    }
+    counts.push_back(options.threads);
+    int status = 0;
+    for (const auto threads : counts) {
+        ThreadPool pool(threads);
+        BatchWriter writer(null);
+        Ingest ingest(options, pool, writer);
+        start = std::chrono::steady_clock::now();
+        ingest.stream(stream.data(), stream.size());
+        const Counts result = ingest.finish();
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (result.frames != sent - corrupted || result.frames != frames) {
+            fprintf(stderr, "threads %u: ingested %" PRIu64 " frames, expected %" PRIu64 "\n", threads,
+                    result.frames, sent - corrupted);
+            status = 1;
+        }
+        const double rate = result.frames / seconds;
+        base = base == 0.0 ? rate : base;
+        printf("%u,%.0f,%.0f,%.2f\n", threads, rate, stream.size() / seconds / 1e6, rate / base);
+        fflush(stdout);
+    }
+    fclose(null);
+    return status;
+}
+
+static bool parse(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--bench") == 0) {
+            options.bench = true;
+            continue;
+        }
+        if (strncmp(arg, "--", 2) != 0) {
+            options.paths.push_back(arg);
+            continue;
+        }
+        const char* value = i + 1 < argc ? argv[++i] : nullptr;
+        if (value == nullptr) {
+            return false;
+        }
+        if (strcmp(arg, "--threads") == 0) {
+            options.threads = strtoul(value, nullptr, 0);
+        } else if (strcmp(arg, "--out") == 0) {
+            options.out = value;
+        } else if (strcmp(arg, "--batch") == 0) {
+            options.batch = strtoul(value, nullptr, 0);
+        } else if (strcmp(arg, "--epoch") == 0) {
+            options.line.epoch_ms = strtoll(value, nullptr, 0);
+        } else if (strcmp(arg, "--measurement") == 0) {
+            options.line.measurement = value;
+        } else if (strcmp(arg, "--dryers") == 0) {
+            options.dryers = strtoul(value, nullptr, 0);
+        } else if (strcmp(arg, "--hours") == 0) {
+            options.hours = strtod(value, nullptr);
+        } else {
+            return false;
+        }
+    }
+    // Measurement names go into every line unescaped.
+    const auto& name = options.line.measurement;
+    const bool plain_name = !name.empty() && name[0] != '_' &&
+                            name.find_first_not_of("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_") ==
+                                std::string::npos;
+    if (options.bench) {
+        return options.paths.empty() && options.dryers > 0 && options.hours > 0.0;
+    }
+    return !options.paths.empty() && options.batch > 0 && plain_name;
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parse(argc, argv, options)) {
+        fprintf(stderr,
+                "usage: %s [--threads N] [--out FILE|-] [--batch LINES] [--epoch MS] [--measurement NAME] FILE|-...\n"
+                "       %s --bench [--dryers N] [--hours H] [--threads N]\n",
+                argv[0], argv[0]);
+        return 1;
+    }
+    return options.bench ? bench(options) : ingest(options);
+}
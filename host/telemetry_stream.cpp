@@ -0,0 +1,136 @@
+#include "telemetry_stream.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
+std::vector<TelemetrySegment> split_telemetry(size_t size, size_t segment_size)
+{
+    segment_size = std::max<size_t>(segment_size, 1);
+    std::vector<TelemetrySegment> segments;
+    for (size_t begin = 0; begin < size; begin += segment_size) {
+        TelemetrySegment segment;
+        segment.begin = begin;
+        segment.end = std::min(size, begin + segment_size);
+        segments.push_back(std::move(segment));
+    }
+    return segments;
+}
+
+void scan_telemetry_segment(const uint8_t* data, size_t size, TelemetrySegment& segment)
+{
+    segment.frames.clear();
+    TelemetryScanner scanner(data, size, segment.begin);
+    scanner.set_complete();
+    TelemetryView frame;
+    while (scanner.offset() < segment.end && scanner.next(frame)) {
+        const size_t offset = frame.data() - data;
+        if (offset >= segment.end) {
+            break;
+        }
+        segment.frames.push_back(offset);
+    }
+}
+
+// The scanner's next step depends only on its position, so two scans agree from any position both pass through.
+// A scan passes through every position except those inside the frames it finds.
+void stitch_telemetry_segments(const uint8_t* data, size_t size, std::vector<TelemetrySegment>& segments)
+{
+    // Where the sequential scan stands: just past its last frame, or in the bytes it skips after it.
+    size_t position = 0;
+    for (auto& segment : segments) {
+        position = std::max(position, segment.begin);
+        if (position >= segment.end) {
+            segment.frames.clear();
+            continue;
+        }
+        auto& frames = segment.frames;
+        const auto first = std::lower_bound(frames.begin(), frames.end(), position);
+        if (first != frames.begin() && *(first - 1) + TelemetryView(data + *(first - 1)).size() > position) {
+            TelemetrySegment rescan;
+            rescan.begin = position;
+            rescan.end = segment.end;
+            scan_telemetry_segment(data, size, rescan);
+            frames = std::move(rescan.frames);
+        } else {
+            frames.erase(frames.begin(), first);
+        }
+        if (!frames.empty()) {
+            position = frames.back() + TelemetryView(data + frames.back()).size();
+        }
+    }
+}
+
+static const char* phase_name(uint8_t phase)
+{
+    static constexpr const char* kPhaseNames[] = {"heating", "soaking", "done"};
+    return phase < std::size(kPhaseNames) ? kPhaseNames[phase] : nullptr;
+}
+
+// Room for any integer or float up to 64 bits.
+constexpr size_t kMaxNumberChars = 24;
+
+template <typename T>
+static char* put_number(char* p, T value)
+{
+    return std::to_chars(p, p + kMaxNumberChars, value).ptr;
+}
+
+static char* put(char* p, const char* text)
+{
+    while (*text != '\0') {
+        *p++ = *text++;
+    }
+    return p;
+}
+
+static char* put_float(char* p, const char* name, float value)
+{
+    if (!std::isfinite(value)) {
+        return p;
+    }
+    p = put(p, name);
+    return put_number(p, value);
+}
+
+void append_line_protocol(std::string& out, const TelemetryView& frame, const LineProtocolOptions& options)
+{
+    // Room for everything after the measurement name with every number at its widest.
+    char line[352];
+    char* p = line;
+    p = put(p, ",device=");
+    p = put_number(p, frame.device_id());
+    p = put(p, " raw=");
+    p = put_number(p, frame.raw());
+    *p++ = 'i';
+    p = put_float(p, ",corrected=", frame.corrected());
+    p = put_float(p, ",temperature=", frame.control_temperature());
+    p = put_float(p, ",thermistor=", frame.temperature());
+    p = put_float(p, ",voltage=", frame.voltage());
+    p = put_float(p, ",setpoint=", frame.setpoint());
+    p = put_float(p, ",duty=", frame.duty());
+    p = put(p, frame.heater_on() ? ",heater=t" : ",heater=f");
+    p = put(p, frame.fault() ? ",fault=t" : ",fault=f");
+    p = put(p, frame.sensor_drift() ? ",drift=t" : ",drift=f");
+    p = put(p, ",phase=\"");
+    const char* phase = phase_name(frame.phase());
+    p = phase != nullptr ? put(p, phase) : put_number(p, frame.phase());
+    p = put(p, "\",soak_s=");
+    p = put_number(p, frame.soak_elapsed_s());
+    *p++ = 'i';
+    p = put_float(p, ",core=", frame.core_temperature());
+    p = put_float(p, ",moisture=", frame.moisture());
+    if (frame.eta_s() != MoistureModel::kUnknownEta) {
+        p = put(p, ",eta_s=");
+        p = put_number(p, frame.eta_s());
+        *p++ = 'i';
+    }
+    p = put(p, ",seq=");
+    p = put_number(p, frame.sequence());
+    *p++ = 'i';
+    *p++ = ' ';
+    p = put_number(p, options.epoch_ms + frame.time_ms());
+    *p++ = '\n';
+    out += options.measurement;
+    out.append(line, p);
+}
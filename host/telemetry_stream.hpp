@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "telemetry.hpp"
+
+// Bulk decoding of the telemetry streams gateways record (telemetry.hpp): one stream is split into segments that
+// are scanned concurrently, then stitched so the result is exactly what one sequential scan finds. Frames stay in
+// the stream's buffer and are read through TelemetryView.
+
+struct TelemetrySegment
+{
+    size_t begin = 0;
+    size_t end = 0;
+    // Offsets of the frames starting in [begin, end), in stream order. The last may extend past end.
+    std::vector<size_t> frames;
+};
+
+// Splits [0, size) into segments of about `segment_size` bytes.
+std::vector<TelemetrySegment> split_telemetry(size_t size, size_t segment_size);
+
+// Finds the frames starting in the segment, treating `data` as complete. Segments of one stream may be scanned
+// concurrently.
+void scan_telemetry_segment(const uint8_t* data, size_t size, TelemetrySegment& segment);
+
+// Reconciles consecutive scanned segments with a sequential scan of the whole stream. A segment's scan starts
+// blind and may have locked onto a false sync inside the previous segment's last frame; frames that overlap what
+// came before are dropped, and a segment whose scan can't rejoin the sequential one is rescanned from where it
+// enters. This is rare, so stitching costs next to nothing.
+void stitch_telemetry_segments(const uint8_t* data, size_t size, std::vector<TelemetrySegment>& segments);
+
+struct LineProtocolOptions
+{
+    std::string measurement = "dryer";
+    // Added to each frame's time_ms, which counts from the unit's boot, to give the timestamp in milliseconds.
+    int64_t epoch_ms = 0;
+};
+
+// Appends the frame as one line of InfluxDB line protocol, with the device as a tag and a millisecond timestamp.
+// Fields that aren't finite are left out, as line protocol can't carry them.
+void append_line_protocol(std::string& out, const TelemetryView& frame, const LineProtocolOptions& options);
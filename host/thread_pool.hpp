@@ -0,0 +1,166 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool. Each worker owns a deque: it pushes and pops its own work LIFO for locality and, when
+// empty, steals the oldest task from another worker. Tasks submitted from outside are dealt round-robin.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(unsigned threads = std::thread::hardware_concurrency())
+    {
+        threads = std::max(1u, threads);
+        for (unsigned i = 0; i < threads; ++i) {
+            queues_.push_back(std::make_unique<Queue>());
+        }
+        for (unsigned i = 0; i < threads; ++i) {
+            workers_.emplace_back([this, i] { run(i); });
+        }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard lock(sleep_mutex_);
+            stopping_ = true;
+        }
+        sleep_cv_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return unsigned(workers_.size()); }
+
+    void submit(std::function<void()> task)
+    {
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        const size_t target = current_worker_ != nullptr && current_worker_->pool == this
+                                  ? current_worker_->index
+                                  : next_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+        {
+            std::lock_guard lock(queues_[target]->mutex);
+            queues_[target]->tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard lock(sleep_mutex_);
+            ++generation_;
+        }
+        sleep_cv_.notify_one();
+    }
+
+    // Blocks until every submitted task, including ones submitted by tasks, has finished.
+    void wait()
+    {
+        std::unique_lock lock(done_mutex_);
+        done_cv_.wait(lock, [this] { return pending_.load(std::memory_order_acquire) == 0; });
+    }
+
+    // Runs body(i) for i in [0, count), split into about four chunks per worker, and waits for completion.
+    template <typename Body>
+    void parallel_for(size_t count, Body body)
+    {
+        const size_t chunks = std::min(count, size_t(size()) * 4);
+        for (size_t c = 0; c < chunks; ++c) {
+            const size_t begin = count * c / chunks;
+            const size_t end = count * (c + 1) / chunks;
+            submit([=, &body] {
+                for (size_t i = begin; i < end; ++i) {
+                    body(i);
+                }
+            });
+        }
+        wait();
+    }
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    struct WorkerContext
+    {
+        ThreadPool* pool;
+        size_t index;
+    };
+
+    bool take(size_t index, std::function<void()>& task)
+    {
+        {
+            auto& own = *queues_[index];
+            std::lock_guard lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+        for (size_t offset = 1; offset < queues_.size(); ++offset) {
+            auto& victim = *queues_[(index + offset) % queues_.size()];
+            std::lock_guard lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void run(size_t index)
+    {
+        WorkerContext context{this, index};
+        current_worker_ = &context;
+        std::function<void()> task;
+        while (true) {
+            uint64_t generation;
+            {
+                std::lock_guard lock(sleep_mutex_);
+                generation = generation_;
+            }
+            if (take(index, task)) {
+                task();
+                task = nullptr;
+                if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    std::lock_guard lock(done_mutex_);
+                    done_cv_.notify_all();
+                }
+                continue;
+            }
+            std::unique_lock lock(sleep_mutex_);
+            sleep_cv_.wait(lock, [&] { return stopping_ || generation_ != generation; });
+            if (stopping_) {
+                return;
+            }
+        }
+    }
+
+    static inline thread_local WorkerContext* current_worker_ = nullptr;
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> next_{0};
+    std::atomic<size_t> pending_{0};
+
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_cv_;
+    uint64_t generation_ = 0;
+    bool stopping_ = false;
+
+    std::mutex done_mutex_;
+    std::condition_variable done_cv_;
+};
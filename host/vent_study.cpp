@@ -0,0 +1,228 @@
+// Measures the heater energy per gram of water removed for ways of working the exhaust vent, with the firmware's
+// Dryer and VentController in closed loop with the plant's heat and humidity model (plant.hpp) and a drying spool
+// (sim_load_cell.hpp) whose water goes into the chamber air.
+//
+//   vent_study [--material NAME] [--moisture M] [--hours H] [--seed N] [--csv FILE] [--filament G] [--leak FLOW]
+//              [--room-humidity RH]
+//
+// Dries G grams (1000 by default) of the material (PLA by default) from M percent moisture, its nominal one by
+// default, until the Dryer, weighing the spool as with CONFIG_DRYER_LOAD_CELL, declares it dry: with the vent fully
+// open as a stock dehydrator has it, fixed part open, closed, and under VentController. Reports for each the drying
+// time, the heater energy, the water removed and the energy per gram, the moisture really left, and the chamber's
+// mean relative humidity and vent opening, then the controller against stock and against the best fixed opening. A
+// run not done after H hours reports what it had done by then. --leak sets the air through the chamber's seams in
+// m^3/s and --room-humidity the room's relative humidity in percent, for both the plant and the controller.
+// --csv writes `strategy,time_h,opening,air,humidity,moisture,energy_wh` rows once a minute.
+//
+// With the plant's default seams (1e-4 m^3/s) enough air leaks to carry a spool's water off, and closed is the best
+// opening; the controller then keeps the vent closed. In a tighter box the closed chamber grows humid and slows
+// drying, and the controller opens part way as the spool's water demands, e.g. for three wet kilograms of nylon:
+//   vent_study --material Nylon --moisture 3.5 --filament 3000 --leak 3e-5 --room-humidity 65 --hours 48
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <strings.h>
+
+#include "dryer.hpp"
+#include "plant.hpp"
+#include "sim_load_cell.hpp"
+#include "vent_controller.hpp"
+
+constexpr uint32_t kControlPeriodMs = 1000;
+
+struct Options
+{
+    Material material = Material::Pla;
+    float moisture = NAN;
+    double hours = 24.0;
+    uint32_t seed = 1;
+    const char* csv = nullptr;
+    PlantParams plant;
+    float filament = 1000.0f;
+};
+
+// A fixed opening, or NAN for VentController's.
+struct Strategy
+{
+    const char* name;
+    float opening;
+};
+
+constexpr Strategy kStrategies[] = {
+    {"stock", 1.0f}, {"50% open", 0.5f}, {"20% open", 0.2f}, {"5% open", 0.05f}, {"closed", 0.0f},
+    {"controller", NAN},
+};
+
+struct Result
+{
+    bool done = false;
+    float moisture = NAN;     // true, at the end
+    double hours = 0.0;
+    double energy_wh = 0.0;
+    double water = 0.0;       // g
+    double humidity = 0.0;    // mean, %
+    double opening = 0.0;     // mean
+};
+
+static Result run(const Options& options, const Strategy& strategy, FILE* csv)
+{
+    const auto& kinetics = material_kinetics(options.material);
+    SimLoadCellParams cell;
+    cell.material = options.material;
+    cell.initial_moisture = options.moisture;
+    cell.filament = options.filament;
+    SimLoadCell spool(cell, options.seed);
+    const PlantParams& params = options.plant;
+    Plant plant(params, options.seed);
+    const AdcModel adc;
+    DryingProfile profile;
+    profile.setpoint = kinetics.temperature;
+    profile.material = options.material;
+    Dryer dryer;
+    dryer.start(profile);
+    VentController controller({.full_flow = params.vent_flow,
+                               .leak_flow = params.leak_flow,
+                               .chamber_volume = params.chamber_volume,
+                               .heater_power = params.heater_power,
+                               .ambient = params.ambient,
+                               .ambient_humidity = params.ambient_humidity});
+
+    Result result;
+    const float initial = spool.moisture();
+    double energy_j = 0.0;
+    size_t steps = 0;
+    const uint32_t end_ms = uint32_t(options.hours * 3600'000.0);
+    uint32_t now_ms = 0;
+    for (; now_ms < end_ms && !result.done; now_ms += kControlPeriodMs) {
+        const float dt = kControlPeriodMs / 1000.0f;
+        const float air = plant.air_temperature();
+        const float humidity = plant.humidity();
+        const float before = spool.moisture();
+        spool.step(air, humidity, dt);
+        plant.evaporate((before - spool.moisture()) / 100.0f * cell.filament);
+
+        dryer.set_humidity(humidity);
+        dryer.set_weight(spool.reading());
+        const auto& status = dryer.step(plant.read_frame(adc), now_ms);
+        const float opening =
+            std::isnan(strategy.opening)
+                ? controller.update(dryer.moisture(), status.temperature, humidity, status.duty,
+                                    status.phase == DryerPhase::Done, dt)
+                : strategy.opening;
+        plant.set_vent(opening);
+        energy_j += plant.step(status.heater_on, dt);
+
+        result.humidity += humidity;
+        result.opening += opening;
+        ++steps;
+        result.done = status.phase == DryerPhase::Done;
+        if (csv != nullptr && now_ms % 60'000 == 0) {
+            fprintf(csv, "%s,%.4f,%.3f,%.2f,%.2f,%.4f,%.2f\n", strategy.name, now_ms / 3600e3, opening, air, humidity,
+                    spool.moisture(), energy_j / 3600.0);
+        }
+    }
+    result.hours = now_ms / 3600e3;
+    result.energy_wh = energy_j / 3600.0;
+    result.moisture = spool.moisture();
+    result.water = (initial - spool.moisture()) / 100.0 * cell.filament;
+    result.humidity /= double(steps);
+    result.opening /= double(steps);
+    return result;
+}
+
+static bool parse(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        const char* value = argv[++i];
+        if (strcmp(arg, "--material") == 0) {
+            options.material = Material::None;
+            for (size_t m = 1; m < size_t(Material::Count); ++m) {
+                if (strcasecmp(value, material_kinetics(Material(m)).name) == 0) {
+                    options.material = Material(m);
+                }
+            }
+        } else if (strcmp(arg, "--moisture") == 0) {
+            options.moisture = strtof(value, nullptr);
+        } else if (strcmp(arg, "--hours") == 0) {
+            options.hours = strtod(value, nullptr);
+        } else if (strcmp(arg, "--seed") == 0) {
+            options.seed = strtoul(value, nullptr, 0);
+        } else if (strcmp(arg, "--csv") == 0) {
+            options.csv = value;
+        } else if (strcmp(arg, "--leak") == 0) {
+            options.plant.leak_flow = strtof(value, nullptr);
+        } else if (strcmp(arg, "--room-humidity") == 0) {
+            options.plant.ambient_humidity = strtof(value, nullptr);
+        } else if (strcmp(arg, "--filament") == 0) {
+            options.filament = strtof(value, nullptr);
+        } else {
+            return false;
+        }
+    }
+    return options.material != Material::None && options.hours > 0 && !(options.moisture < 0) &&
+           options.filament > 0 && options.plant.leak_flow > 0 && options.plant.ambient_humidity >= 0 &&
+           options.plant.ambient_humidity <= 100;
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parse(argc, argv, options)) {
+        fprintf(stderr, "usage: %s [--material NAME] [--moisture M] [--hours H] [--seed N] [--csv FILE] "
+                        "[--filament G] [--leak FLOW] [--room-humidity RH]\n", argv[0]);
+        return 1;
+    }
+    FILE* csv = nullptr;
+    if (options.csv != nullptr) {
+        csv = fopen(options.csv, "w");
+        if (csv == nullptr) {
+            perror(options.csv);
+            return 1;
+        }
+        fprintf(csv, "strategy,time_h,opening,air,humidity,moisture,energy_wh\n");
+    }
+
+    const auto& kinetics = material_kinetics(options.material);
+    const float moisture = std::isnan(options.moisture) ? kinetics.initial : options.moisture;
+    printf("%s from %.2f%% to %.2f%% moisture at %.0f C\n", kinetics.name, moisture, kinetics.target,
+           kinetics.temperature);
+    printf("%-12s %7s %8s %8s %7s %7s %9s %8s %8s\n", "strategy", "hours", "Wh", "water g", "Wh/g", "g/kWh",
+           "moisture", "mean RH", "opening");
+    double stock = NAN;
+    double controlled = NAN;
+    double best_fixed = INFINITY;
+    const char* best_name = nullptr;
+    for (const auto& strategy : kStrategies) {
+        const Result r = run(options, strategy, csv);
+        const double per_gram = r.energy_wh / r.water;
+        printf("%-12s %7.2f %8.1f %8.2f %7.2f %7.1f %8.3f%% %7.1f%% %7.0f%%%s\n", strategy.name, r.hours, r.energy_wh,
+               r.water, per_gram, 1000.0 / per_gram, r.moisture, r.humidity, 100 * r.opening,
+               r.done ? "" : "  not done");
+        if (strategy.opening == 1.0f) {
+            stock = per_gram;
+        } else if (std::isnan(strategy.opening)) {
+            controlled = per_gram;
+        }
+        if (!std::isnan(strategy.opening) && r.done && per_gram < best_fixed) {
+            best_fixed = per_gram;
+            best_name = strategy.name;
+        }
+    }
+    if (csv != nullptr) {
+        fclose(csv);
+    }
+    if (std::isfinite(stock) && std::isfinite(controlled)) {
+        printf("controller: %+.1f%% energy per gram against stock\n", 100 * (controlled / stock - 1.0));
+    }
+    if (best_name != nullptr && std::isfinite(controlled)) {
+        printf("controller: %+.1f%% energy per gram against the best fixed opening, %s\n",
+               100 * (controlled / best_fixed - 1.0), best_name);
+    }
+    return 0;
+}
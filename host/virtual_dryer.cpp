@@ -0,0 +1,190 @@
+// Runs the unmodified firmware (main/main.cpp) on the host. app_main executes as a task under the virtual-time
+// scheduler of the host IDF backend, the continuous ADC samples a simulated thermistor and the heater GPIO drives
+// the plant, so hours of operation finish in well under a second of wall time.
+//
+//   virtual_dryer [--hours H] [--seed N] [--log FILE|-|none] [--history FILE] [--snapshots FILE] [--faults FILE]
+//                 [--thermistor-error C] [--reference on|off] [--load-cell on|off] [--vent on|off] [--door S]
+//                 [--interference on|off]
+//
+// --history loads the flash history partition from FILE if it exists, and saves it back when the run ends, as a
+// power cut would leave it. Repeated runs with the same file append boots to one history, which replay can read.
+// --snapshots does the same for the snapshot partition, which snapshot_dump reads; without it the firmware takes
+// no snapshots. --door opens the chamber door S seconds into the run for kDoorOpenS seconds. --interference on
+// couples the relay's switching spike and a fan's PWM ripple into the thermistor line (SimInterference), for the
+// firmware's scope captures in the log; scope_dump reads them.
+// --faults injects the faults of a script (see sim_fault_load_script), drawing from the --seed generator.
+// --thermistor-error makes the simulated thermistor read C degrees high under the firmware's curve, and --reference
+// on fits the chamber's reference sensor, against which the firmware learns to correct that. --load-cell on puts the
+// spool on a simulated HX711 load cell (sim_load_cell.hpp), and the run ends with how wet it really is. --vent on
+// connects the firmware's vent servo to the chamber's exhaust vent and puts a drying spool in the chamber if there is
+// none, and the run ends with the water the air carried off and the heater energy per gram of it. Once the firmware
+// keeps a dried spool dry in deep sleep, the run ends with the time asleep and what the ULP did meanwhile.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "idf_sim.hpp"
+#include "sim_board.hpp"
+#include "sim_files.hpp"
+
+extern "C" void app_main();
+
+// Pins the firmware uses; kept in step with main.cpp.
+constexpr auto kHeaterGpio = GPIO_NUM_25;
+constexpr auto kThermistorChannel = ADC_CHANNEL_6;
+constexpr auto kLoadCellDoutGpio = static_cast<gpio_num_t>(CONFIG_DRYER_LOAD_CELL_DOUT_GPIO);
+constexpr auto kVentGpio = static_cast<gpio_num_t>(CONFIG_DRYER_VENT_GPIO);
+
+constexpr double kDoorOpenS = 20.0;
+
+// IDF runs app_main from the "main" task at priority 1.
+static void main_task(void*)
+{
+    app_main();
+}
+
+int main(int argc, char** argv)
+{
+    double hours = 1.0;
+    uint32_t seed = 1;
+    const char* log = "-";
+    const char* history = nullptr;
+    const char* snapshots = nullptr;
+    const char* faults = nullptr;
+    float thermistor_error = 0.0f;
+    bool reference = false;
+    bool load_cell = false;
+    bool vent = false;
+    double door_s = -1.0;
+    bool interference = false;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--hours") == 0) {
+            hours = strtod(argv[i + 1], nullptr);
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            seed = strtoul(argv[i + 1], nullptr, 0);
+        } else if (strcmp(argv[i], "--log") == 0) {
+            log = argv[i + 1];
+        } else if (strcmp(argv[i], "--history") == 0) {
+            history = argv[i + 1];
+        } else if (strcmp(argv[i], "--snapshots") == 0) {
+            snapshots = argv[i + 1];
+        } else if (strcmp(argv[i], "--faults") == 0) {
+            faults = argv[i + 1];
+        } else if (strcmp(argv[i], "--thermistor-error") == 0) {
+            thermistor_error = strtof(argv[i + 1], nullptr);
+        } else if (strcmp(argv[i], "--reference") == 0 &&
+                   (strcmp(argv[i + 1], "on") == 0 || strcmp(argv[i + 1], "off") == 0)) {
+            reference = strcmp(argv[i + 1], "on") == 0;
+        } else if (strcmp(argv[i], "--load-cell") == 0 &&
+                   (strcmp(argv[i + 1], "on") == 0 || strcmp(argv[i + 1], "off") == 0)) {
+            load_cell = strcmp(argv[i + 1], "on") == 0;
+        } else if (strcmp(argv[i], "--vent") == 0 &&
+                   (strcmp(argv[i + 1], "on") == 0 || strcmp(argv[i + 1], "off") == 0)) {
+            vent = strcmp(argv[i + 1], "on") == 0;
+        } else if (strcmp(argv[i], "--door") == 0) {
+            door_s = strtod(argv[i + 1], nullptr);
+        } else if (strcmp(argv[i], "--interference") == 0 &&
+                   (strcmp(argv[i + 1], "on") == 0 || strcmp(argv[i + 1], "off") == 0)) {
+            interference = strcmp(argv[i + 1], "on") == 0;
+        } else {
+            argc = 0;
+        }
+    }
+    if (argc % 2 == 0 || hours <= 0.0) {
+        fprintf(stderr,
+                "usage: %s [--hours H] [--seed N] [--log FILE|-|none] [--history FILE] [--snapshots FILE]\n"
+                "       %*s [--faults FILE] [--thermistor-error C] [--reference on|off] [--load-cell on|off]\n"
+                "       %*s [--vent on|off] [--door S] [--interference on|off]\n",
+                argv[0], int(strlen(argv[0])), "", int(strlen(argv[0])), "");
+        return 1;
+    }
+
+    FILE* output = nullptr;
+    if (strcmp(log, "-") == 0) {
+        output = stdout;
+    } else if (strcmp(log, "none") != 0) {
+        output = fopen(log, "w");
+        if (output == nullptr) {
+            perror(log);
+            return 1;
+        }
+    }
+    sim_log_set_output(output);
+
+    std::vector<uint8_t>* flash = nullptr;
+    if (history != nullptr && (flash = load_history_partition(history)) == nullptr) {
+        return 1;
+    }
+    std::vector<uint8_t>* snapshot_flash = nullptr;
+    if (snapshots != nullptr && (snapshot_flash = load_snapshot_partition(snapshots)) == nullptr) {
+        return 1;
+    }
+    if (faults != nullptr && !load_fault_script(faults, seed)) {
+        return 1;
+    }
+
+    SimBoard board(PlantParams{}, seed, kHeaterGpio, kThermistorChannel);
+    board.attach();
+    if (thermistor_error != 0.0f) {
+        ThermistorCurve curve = kThermistorCurve;
+        curve.c0 -= thermistor_error;
+        board.set_thermistor_curve(curve);
+    }
+    if (reference) {
+        board.attach_reference_sensor();
+    }
+    if (load_cell) {
+        board.attach_load_cell(kLoadCellDoutGpio);
+    }
+    if (vent) {
+        if (board.spool() == nullptr) {
+            board.attach_spool();
+        }
+        board.attach_vent(kVentGpio, CONFIG_DRYER_VENT_CLOSED_US, CONFIG_DRYER_VENT_OPEN_US);
+    }
+    if (interference) {
+        board.attach_interference();
+    }
+    if (door_s >= 0.0) {
+        board.open_door(uint64_t(door_s * 1e6), uint64_t((door_s + kDoorOpenS) * 1e6));
+    }
+    // A wakeup from deep sleep boots the firmware again.
+    auto boot = [] { xTaskCreate(main_task, "main", 3584, nullptr, 1, nullptr); };
+    sim_deep_sleep_set_boot(boot);
+    boot();
+
+    const uint64_t end_us = uint64_t(hours * 3600e6);
+    const auto start = std::chrono::steady_clock::now();
+    sim_run_until(end_us);
+    board.advance_to(end_us);
+    const std::chrono::duration<double, std::milli> wall = std::chrono::steady_clock::now() - start;
+
+    fprintf(stderr, "simulated %.2f h in %.1f ms (%.0fx real time), air %.1f C, heater energy %.1f Wh\n", hours,
+            wall.count(), hours * 3600e3 / wall.count(), board.plant().air_temperature(), board.energy_j() / 3600.0);
+    if (board.spool() != nullptr) {
+        fprintf(stderr, "spool %.1f g, %.3f%% moisture\n", board.spool()->weight(), board.spool()->moisture());
+    }
+    if (vent) {
+        const double vented = board.plant().water_vented();
+        fprintf(stderr, "vent %.0f%% open, %.1f g of water vented, %.2f Wh/g\n", 100 * board.plant().vent(), vented,
+                board.energy_j() / 3600.0 / vented);
+    }
+    if (sim_deep_sleep_wakes() != 0 || sim_deep_sleep_us() != 0) {
+        const uint64_t runs = sim_ulp_runs();
+        fprintf(stderr, "deep sleep %.2f h, %u wakes; ULP ran %llu times, %.0f us a run\n",
+                sim_deep_sleep_us() / 3600e6, sim_deep_sleep_wakes(), (unsigned long long)runs,
+                runs != 0 ? sim_ulp_cycles() / 8.0 / runs : 0.0);
+    }
+    if (flash != nullptr && !save_partition(history, *flash)) {
+        return 1;
+    }
+    if (snapshot_flash != nullptr && !save_partition(snapshots, *snapshot_flash)) {
+        return 1;
+    }
+    if (output != nullptr && output != stdout) {
+        fclose(output);
+    }
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include "consistency_monitor.hpp"
+
+#include <cmath>
+
+void ConsistencyMonitor::configure(size_t sensor, float weight, uint8_t trust)
+{
+    weight_[sensor] = weight;
+    trust_[sensor] = trust;
+}
+
+void ConsistencyMonitor::update(const float* temperatures, bool steady)
+{
+    if (!steady) {
+        return;
+    }
+    bool changed = false;
+    for (size_t a = 0; a < kMaxSensors; ++a) {
+        for (size_t b = a + 1; b < kMaxSensors; ++b) {
+            if (!std::isfinite(temperatures[a]) || !std::isfinite(temperatures[b])) {
+                continue;
+            }
+            auto& p = pairs_[a][b];
+            // A plain running mean until the window fills, then exponential weighting.
+            if (p.samples < kWindow) {
+                ++p.samples;
+            }
+            const float alpha = 1.0f / p.samples;
+            const float difference = temperatures[a] - temperatures[b] - p.mean;
+            const float step = alpha * difference;
+            p.mean += step;
+            p.variance = (1.0f - alpha) * (p.variance + difference * step);
+
+            const bool inconsistent = p.samples >= kMinSamples &&
+                                      std::abs(p.mean) > (p.inconsistent ? kTolerance / 2 : kTolerance);
+            changed |= inconsistent != p.inconsistent;
+            p.inconsistent = inconsistent;
+        }
+    }
+    if (changed) {
+        blame();
+    }
+}
+
+void ConsistencyMonitor::blame()
+{
+    int count[kMaxSensors] = {};
+    for (size_t a = 0; a < kMaxSensors; ++a) {
+        for (size_t b = a + 1; b < kMaxSensors; ++b) {
+            if (pairs_[a][b].inconsistent) {
+                ++count[a];
+                ++count[b];
+            }
+        }
+    }
+    // Each inconsistent pair is put on whichever of its two sensors looks worse.
+    drifting_ = 0;
+    for (size_t a = 0; a < kMaxSensors; ++a) {
+        for (size_t b = a + 1; b < kMaxSensors; ++b) {
+            if (pairs_[a][b].inconsistent) {
+                const bool a_worse = count[a] != count[b] ? count[a] > count[b] : trust_[a] <= trust_[b];
+                drifting_ |= 1u << (a_worse ? a : b);
+            }
+        }
+    }
+}
+
+float ConsistencyMonitor::fuse(const float* temperatures) const
+{
+    float sum = 0.0f;
+    float total = 0.0f;
+    size_t present = 0;
+    size_t last = 0;
+    for (size_t i = 0; i < kMaxSensors; ++i) {
+        if (std::isfinite(temperatures[i])) {
+            const float w = drifting(i) ? weight_[i] * kDriftWeight : weight_[i];
+            sum += w * temperatures[i];
+            total += w;
+            ++present;
+            last = i;
+        }
+    }
+    if (present == 1) {
+        return temperatures[last];
+    }
+    return present != 0 ? sum / total : NAN;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Watches several temperature sensors in the chamber for one drifting away from the rest, and fuses them into the
+// temperature control runs on. The mean and variance of every pair's difference are tracked as exponentially
+// weighted streaming statistics, only while the chamber holds steady, where all sensors should agree. A pair whose
+// mean difference leaves the tolerance is inconsistent; the sensor in the most inconsistent pairs, or of two equal
+// suspects the less trusted, is flagged as drifting, and fusion gives it only a small fraction of its weight until
+// the difference comes back to half the tolerance.
+//
+// With two sensors a disagreement can't be pinned on either by majority, so trust decides: a precision reference
+// outranks the thermistor, and the thermistor is flagged however the two really stand. The reference can only be
+// flagged once a third sensor outvotes it.
+class ConsistencyMonitor
+{
+public:
+    static constexpr size_t kMaxSensors = 4;
+    // Largest steady-state disagreement of two healthy sensors, in degrees.
+    static constexpr float kTolerance = 1.0f;
+    // Samples the statistics average over, about ten minutes at the control rate, and the fewest before a pair is
+    // judged.
+    static constexpr uint32_t kWindow = 600;
+    static constexpr uint32_t kMinSamples = 120;
+    // Fraction of its weight a drifting sensor keeps in fusion.
+    static constexpr float kDriftWeight = 0.05f;
+
+    struct PairStatistics
+    {
+        uint32_t samples = 0;
+        float mean = 0.0f;
+        float variance = 0.0f;
+        bool inconsistent = false;
+    };
+
+    // Fusion weight, such as the inverse of the sensor's noise variance, and rank in deciding blame.
+    void configure(size_t sensor, float weight, uint8_t trust);
+
+    // Feeds one reading per sensor, NAN where a sensor has none. Statistics only move while `steady`.
+    void update(const float* temperatures, bool steady);
+    // Weighted mean of the readings present. A single reading comes back unchanged; none gives NAN.
+    float fuse(const float* temperatures) const;
+
+    bool drifting(size_t sensor) const { return (drifting_ >> sensor) & 1; }
+    // Bit i set while sensor i is flagged.
+    uint8_t drifting_mask() const { return drifting_; }
+    // Statistics of sensor a minus sensor b, a < b.
+    const PairStatistics& pair(size_t a, size_t b) const { return pairs_[a][b]; }
+
+private:
+    void blame();
+
+    float weight_[kMaxSensors] = {1.0f, 1.0f, 1.0f, 1.0f};
+    uint8_t trust_[kMaxSensors] = {};
+    PairStatistics pairs_[kMaxSensors][kMaxSensors];
+    uint8_t drifting_ = 0;
+};
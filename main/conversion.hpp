@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+
+constexpr int kAdcResolutionBits = 10;
+constexpr float kAdcReferenceVoltage = 3.3f;
+
+// Cubic correction for the ESP32 ADC non-linearity, fitted to adc_testing.csv.
+struct AdcCorrection
+{
+    float c0;
+    float c1;
+    float c2;
+    float c3;
+};
+
+// Quadratic temperature curve over the corrected ADC code, fitted to thermistor.calibration.csv.
+// The linear term is double to keep the exact promotion of the original calibration expression.
+struct ThermistorCurve
+{
+    float c0;
+    double c1;
+    float c2;
+};
+
+// Refinement of the thermistor curve learned in the field (self_calibration.hpp): an offset, plus gain and curvature
+// about kCorrectionCenter, added to the curve's temperature. The zero correction changes nothing.
+struct TemperatureCorrection
+{
+    float offset = 0.0f;
+    float gain = 0.0f;
+    float curvature = 0.0f;
+};
+
+constexpr float kCorrectionCenter = 50.0f;
+
+constexpr AdcCorrection kAdcCorrection{40.4597f, 0.976323f, 0.000163748f, -1.76614e-7f};
+constexpr ThermistorCurve kThermistorCurve{129.85f, -0.150499, 0.0000343308f};
+
+struct Reading
+{
+    uint32_t raw;
+    float corrected;
+    float temperature;
+    float voltage;
+};
+
+// Correct for non-lineararity in ESP32 ADC.
+constexpr float correct_adc(uint32_t raw, const AdcCorrection& k = kAdcCorrection)
+{
+    const float raw2 = raw * raw;
+    const float raw3 = raw2 * raw;
+    return k.c0 + k.c1*raw + k.c2*raw2 + k.c3*raw3;
+}
+
+// Calculate temperature based off calibration curve
+constexpr float thermistor_temperature(float adc_corr, const ThermistorCurve& k = kThermistorCurve)
+{
+    const float adc_corr2 = adc_corr * adc_corr;
+    return k.c0 + k.c1*adc_corr + k.c2*adc_corr2;
+}
+
+constexpr float adc_voltage(float adc_corr)
+{
+    return adc_corr * kAdcReferenceVoltage / (1 << kAdcResolutionBits);
+}
+
+constexpr float correct_temperature(float temperature, const TemperatureCorrection& k)
+{
+    const float d = temperature - kCorrectionCenter;
+    return temperature + (k.offset + k.gain*d + k.curvature*d*d);
+}
+
+constexpr Reading convert_reading(uint32_t raw, const AdcCorrection& adc = kAdcCorrection,
+                                  const ThermistorCurve& curve = kThermistorCurve)
+{
+    const float adc_corr = correct_adc(raw, adc);
+    return {raw, adc_corr, thermistor_temperature(adc_corr, curve), adc_voltage(adc_corr)};
+}
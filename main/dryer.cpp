@@ -0,0 +1,175 @@
+#include "dryer.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <iterator>
+
+#include "psychrometrics.hpp"
+
+Dryer::Dryer(const HeaterControllerConfig& config) : controller_(config)
+{
+    // The thermistor is the sensor least to be trusted over a disagreement: the others are precision parts.
+    for (size_t sensor = 1; sensor < ConsistencyMonitor::kMaxSensors; ++sensor) {
+        monitor_.configure(sensor, 1.0f, 1);
+    }
+    std::fill(std::begin(auxiliary_), std::end(auxiliary_), NAN);
+    start(profile_);
+}
+
+void Dryer::start(const DryingProfile& profile)
+{
+    profile_ = profile;
+    soak_ms_ = 0;
+    status_.phase = DryerPhase::Heating;
+    status_.soak_elapsed_s = 0;
+    moisture_.start(profile.material);
+    forecast_due_ = true;
+    controller_.set_ramp_rate(profile.ramp_rate);
+    controller_.reset();
+    controller_.set_setpoint(profile.setpoint);
+}
+
+void Dryer::set_setpoint(float setpoint)
+{
+    profile_.setpoint = setpoint;
+    controller_.set_setpoint(setpoint);
+}
+
+void Dryer::advance_phase(uint32_t elapsed_ms)
+{
+    const bool in_band = std::abs(status_.core_temperature - profile_.setpoint) <= profile_.soak_band;
+    // NAN compares false: no scale, or not a full window yet.
+    const bool drained = status_.phase == DryerPhase::Soaking &&
+                         status_.loss_rate < kDryLossRate * (status_.weight - kEmptySpoolWeight);
+    if (status_.phase != DryerPhase::Done && (moisture_.dry() || drained) && !status_.fault) {
+        status_.phase = DryerPhase::Done;
+    } else if (status_.phase == DryerPhase::Heating && in_band && !status_.fault) {
+        status_.phase = DryerPhase::Soaking;
+    } else if (status_.phase == DryerPhase::Soaking) {
+        soak_ms_ += elapsed_ms;
+        status_.soak_elapsed_s = soak_ms_ / 1000;
+        if (profile_.soak_s != 0 && status_.soak_elapsed_s >= profile_.soak_s) {
+            status_.phase = DryerPhase::Done;
+        }
+    }
+}
+
+const DryerStatus& Dryer::step(uint32_t raw, uint32_t now_ms)
+{
+    const uint32_t elapsed_ms = started_ ? now_ms - last_ms_ : 0;
+    const float dt = elapsed_ms / 1000.0f;
+    if (!started_) {
+        window_start_ms_ = now_ms - kHeaterWindowMs;
+        started_ = true;
+    }
+    last_ms_ = now_ms;
+
+    status_.time_ms = now_ms;
+    status_.reading = convert_reading(raw);
+    status_.reading.temperature = correct_temperature(status_.reading.temperature, correction_);
+    constexpr uint32_t kMaxCode = (1u << kAdcResolutionBits) - 1;
+    const bool railed = raw <= kAdcRailMargin || raw >= kMaxCode - kAdcRailMargin;
+
+    float temperatures[ConsistencyMonitor::kMaxSensors] = {status_.reading.temperature};
+    std::copy(std::begin(auxiliary_), std::end(auxiliary_), temperatures + 1);
+    std::fill(std::begin(auxiliary_), std::end(auxiliary_), NAN);
+    monitor_.update(temperatures, !railed && status_.phase == DryerPhase::Soaking && !status_.fault);
+    status_.temperature = monitor_.fuse(temperatures);
+    status_.sensor_drift = monitor_.drifting_mask() != 0;
+    // The spool has stood in the dryer since boot; a new run doesn't cool it down.
+    spool_.step(railed ? NAN : status_.temperature, dt);
+    status_.core_temperature = spool_.core();
+    scale_.update(weight_, railed ? NAN : status_.temperature, dt);
+    weight_ = NAN;
+    if (scale_.loads() != scale_loads_) {
+        moisture_.reset_weight();
+        scale_loads_ = scale_.loads();
+    }
+    status_.weight = scale_.weight();
+    status_.loss_rate = scale_.loss_rate();
+    moisture_.update(spool_, railed ? NAN : status_.temperature, humidity_, status_.weight, dt);
+    if (std::isfinite(humidity_) && !railed) {
+        vapour_pressure_ = vapour_pressure(status_.temperature, std::clamp(humidity_, 0.0f, 100.0f));
+    }
+    humidity_ = NAN;
+    status_.dew_point = dew_point_from_pressure(vapour_pressure_);
+    status_.absolute_humidity = kVapourDensityFactor * vapour_pressure_ / (status_.temperature + kKelvin);
+    if (status_.phase != DryerPhase::Done &&
+        (forecast_due_ || now_ms - forecast_ms_ >= kMoistureForecastIntervalMs)) {
+        moisture_.forecast(spool_, profile_.setpoint);
+        forecast_ms_ = now_ms;
+        forecast_due_ = false;
+    }
+    status_.moisture = moisture_.moisture();
+    // The spool goes on taking up or giving off moisture after the run, but nothing is drying it any more.
+    status_.eta_s = status_.phase != DryerPhase::Done ? moisture_.eta_s() : 0;
+    // The fused temperature can lean on a sensor that has failed low, so the controller's validity window and
+    // over-temperature cutoff go by the thermistor itself, or by any live sensor reading hotter.
+    float guard = railed ? NAN : status_.reading.temperature;
+    for (size_t i = 1; i < ConsistencyMonitor::kMaxSensors; ++i) {
+        if (std::isfinite(temperatures[i]) && temperatures[i] <= controller_.config().max_valid_temperature) {
+            guard = std::max(guard, temperatures[i]);
+        }
+    }
+    status_.duty = controller_.update(railed ? NAN : status_.temperature, guard, dt);
+    status_.setpoint = controller_.effective_setpoint();
+    status_.fault = controller_.fault();
+
+    advance_phase(elapsed_ms);
+    if (status_.phase == DryerPhase::Done) {
+        status_.duty = 0.0f;
+    }
+
+    if (now_ms - window_start_ms_ >= kHeaterWindowMs) {
+        window_start_ms_ = now_ms;
+        window_duty_ = status_.duty;
+    }
+    // A fault or over-temperature cuts the heater mid-window rather than waiting for the next one.
+    if (status_.duty == 0.0f) {
+        window_duty_ = 0.0f;
+    }
+    status_.heater_on = (now_ms - window_start_ms_) < window_duty_ * kHeaterWindowMs;
+    return status_;
+}
+
+const DryerStatus& Dryer::sensor_timeout(uint32_t now_ms)
+{
+    controller_.trip();
+    status_.time_ms = now_ms;
+    status_.duty = 0.0f;
+    status_.fault = true;
+    status_.heater_on = false;
+    window_duty_ = 0.0f;
+    return status_;
+}
+
+int format_status(char* buf, size_t size, const DryerStatus& status)
+{
+    static constexpr const char* kPhaseNames[] = {"heating", "soaking", "done"};
+    int len = snprintf(buf, size, "Avg reading: %" PRIu32 " corrected %" PRIu32 " (%.1f) [%.4fV] setpoint %.1f core %.1f duty %.2f heater %s %s%s%s",
+                       status.reading.raw, (uint32_t)status.reading.corrected, status.reading.temperature,
+                       status.reading.voltage, status.setpoint, status.core_temperature, status.duty,
+                       status.heater_on ? "on" : "off", kPhaseNames[static_cast<int>(status.phase)],
+                       status.fault ? " SENSOR FAULT" : "", status.sensor_drift ? " SENSOR DRIFT" : "");
+    if (std::isfinite(status.moisture) && len >= 0 && size_t(len) < size) {
+        if (status.eta_s == MoistureModel::kUnknownEta) {
+            len += snprintf(buf + len, size - len, " moisture %.2f%% eta unknown", status.moisture);
+        } else {
+            len += snprintf(buf + len, size - len, " moisture %.2f%% eta %" PRIu32 "h%02" PRIu32 "m", status.moisture,
+                            status.eta_s / 3600, status.eta_s / 60 % 60);
+        }
+    }
+    if (std::isfinite(status.weight) && len >= 0 && size_t(len) < size) {
+        len += snprintf(buf + len, size - len, " weight %.1fg", status.weight);
+        if (std::isfinite(status.loss_rate) && size_t(len) < size) {
+            len += snprintf(buf + len, size - len, " losing %.2fg/h", status.loss_rate);
+        }
+    }
+    if (std::isfinite(status.dew_point) && len >= 0 && size_t(len) < size) {
+        len += snprintf(buf + len, size - len, " dew point %.1fC %.1fg/m3", status.dew_point,
+                        status.absolute_humidity);
+    }
+    return len;
+}
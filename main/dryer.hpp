@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "consistency_monitor.hpp"
+#include "conversion.hpp"
+#include "heater_controller.hpp"
+#include "moisture_model.hpp"
+#include "spool_model.hpp"
+#include "spool_scale.hpp"
+
+// The heater relay is time-proportioned over this window; duty is latched at the start of each window.
+constexpr uint32_t kHeaterWindowMs = 10'000;
+constexpr float kDefaultSetpoint = 50.0f;
+// Frame averages this close to either ADC rail mean an open or shorted thermistor, whatever temperature the curve
+// maps them to: an open circuit saturates the ADC at a plausible 12 degrees.
+constexpr uint32_t kAdcRailMargin = 2;
+constexpr uint32_t kMoistureForecastIntervalMs = 60'000;
+// A soaking spool losing less than this fraction of its filament's weight an hour is dry, whatever the moisture
+// model says.
+constexpr float kDryLossRate = 1e-4f;
+
+struct DryingProfile
+{
+    float setpoint = kDefaultSetpoint;
+    // Setpoint ramp in degrees per second from the starting temperature; 0 steps straight to the setpoint.
+    float ramp_rate = 0.0f;
+    // Hold time once the spool's core is within soak_band of the setpoint (SpoolModel), not the air: the core is what
+    // dries and lags the air by hours. 0 holds until stopped.
+    uint32_t soak_s = 0;
+    float soak_band = 1.0f;
+    // With a material, the run also ends as soon as the spool is predicted dry (MoistureModel), soak or not. With a
+    // scale, it ends once the soaking spool has stopped losing weight (kDryLossRate).
+    Material material = Material::None;
+};
+
+enum class DryerPhase : uint8_t
+{
+    Heating,
+    Soaking,
+    Done,
+};
+
+struct DryerStatus
+{
+    uint32_t time_ms = 0;
+    Reading reading{};
+    // What control acts on: the thermistor's temperature fused with any other chamber sensors' readings.
+    float temperature = 0.0f;
+    // Estimated temperature at the core of the spool, which the soak timer waits for.
+    float core_temperature = 0.0f;
+    float setpoint = 0.0f;
+    float duty = 0.0f;
+    bool heater_on = false;
+    bool fault = false;
+    // Some chamber sensor disagrees with the others (ConsistencyMonitor).
+    bool sensor_drift = false;
+    DryerPhase phase = DryerPhase::Heating;
+    uint32_t soak_elapsed_s = 0;
+    // Predicted moisture of the spool in percent and seconds until it is dry, 0 once dry or the run is over; with a
+    // material only.
+    float moisture = NAN;
+    uint32_t eta_s = MoistureModel::kUnknownEta;
+    // Weight of the spool in grams and the grams per hour it is losing, with a scale only (SpoolScale).
+    float weight = NAN;
+    float loss_rate = NAN;
+    // Dew point in C and water vapour in g/m^3 of the chamber air, from the last humidity reading.
+    float dew_point = NAN;
+    float absolute_humidity = NAN;
+};
+
+// Everything between an averaged ADC frame and the heater relay state: conversion, control and time-proportioning.
+// Shared by the firmware and the host simulators so both run identical code.
+class Dryer
+{
+public:
+    // Chamber sensors besides the thermistor; sensor 0 is the reference sensor.
+    static constexpr size_t kMaxAuxiliary = ConsistencyMonitor::kMaxSensors - 1;
+
+    explicit Dryer(const HeaterControllerConfig& config = {});
+
+    // Starts a new run. The soak timer restarts and the heater resumes if a previous run had finished.
+    void start(const DryingProfile& profile);
+    void set_setpoint(float setpoint);
+    // Refines every temperature from the next frame on. Replay needs the same corrections at the same frames.
+    void set_correction(const TemperatureCorrection& correction) { correction_ = correction; }
+    // A reading of another chamber sensor, fused with the thermistor's in the next step only. Replay needs these
+    // too.
+    void set_auxiliary(size_t sensor, float temperature) { auxiliary_[sensor] = temperature; }
+    // Relative humidity of the chamber air in percent, for the next step only.
+    void set_humidity(float humidity) { humidity_ = humidity; }
+    // A load cell reading in grams from its static calibration, for the next step only.
+    void set_weight(float weight) { weight_ = weight; }
+
+    // Processes one averaged ADC frame taken at `now_ms`.
+    const DryerStatus& step(uint32_t raw, uint32_t now_ms);
+    // Called instead of step() when no usable frame has arrived for too long. Switches the heater off and flags a
+    // sensor fault until the next valid reading.
+    const DryerStatus& sensor_timeout(uint32_t now_ms);
+
+    const DryerStatus& status() const { return status_; }
+    const DryingProfile& profile() const { return profile_; }
+    const TemperatureCorrection& correction() const { return correction_; }
+    const ConsistencyMonitor& monitor() const { return monitor_; }
+    const SpoolModel& spool() const { return spool_; }
+    const MoistureModel& moisture() const { return moisture_; }
+    const SpoolScale& scale() const { return scale_; }
+    HeaterController& controller() { return controller_; }
+
+private:
+    void advance_phase(uint32_t elapsed_ms);
+
+    HeaterController controller_;
+    DryingProfile profile_;
+    TemperatureCorrection correction_{};
+    ConsistencyMonitor monitor_;
+    SpoolModel spool_;
+    MoistureModel moisture_;
+    SpoolScale scale_;
+    float auxiliary_[kMaxAuxiliary];
+    float humidity_ = NAN;
+    // kPa, held from the last humidity reading.
+    float vapour_pressure_ = NAN;
+    float weight_ = NAN;
+    uint32_t scale_loads_ = 0;
+    uint32_t forecast_ms_ = 0;
+    bool forecast_due_ = true;
+    uint32_t soak_ms_ = 0;
+    DryerStatus status_;
+    bool started_ = false;
+    uint32_t last_ms_ = 0;
+    uint32_t window_start_ms_ = 0;
+    float window_duty_ = 0.0f;
+};
+
+// Formats the status line the firmware logs once per control step.
+int format_status(char* buf, size_t size, const DryerStatus& status);
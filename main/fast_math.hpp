@@ -0,0 +1,122 @@
+#pragma once
+
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// Natural logarithm and exponential in single precision, for the firmware's hot paths. The ESP32's FPU has no
+// transcendental instructions and newlib's logf and expf take some 250 cycles each; these reduce the argument with
+// a 128-entry table (log) or a 64-entry table (exp) and finish with a cubic, a dozen float operations. Checked
+// against double precision over every float they accept by host/psychrometrics.cpp: fast_log is within 2e-7
+// absolute for x in [0.5, 2] and 2e-7 relative elsewhere, fast_exp within 2e-7 relative, about 3 ulp. Denormal
+// results flush to zero.
+
+constexpr size_t kFastLogBits = 7;
+constexpr size_t kFastExpBits = 6;
+constexpr double kLn2 = 0.693147180559945309;
+
+// ln(y) for y in [0.5, 2], in double, for the tables: 2 atanh((y - 1) / (y + 1)).
+constexpr double series_log(double y)
+{
+    const double s = (y - 1.0) / (y + 1.0);
+    const double s2 = s * s;
+    double term = s;
+    double sum = 0.0;
+    for (int k = 1; k < 60; k += 2) {
+        sum += term / k;
+        term *= s2;
+    }
+    return 2.0 * sum;
+}
+
+// e^z for |z| <= 1, in double, for the tables.
+constexpr double series_exp(double z)
+{
+    double term = 1.0;
+    double sum = 1.0;
+    for (int k = 1; k < 30; ++k) {
+        term *= z / k;
+        sum += term;
+    }
+    return sum;
+}
+
+// For each of the 2^kFastLogBits intervals of the mantissa [1, 2): the reciprocal of its lower end, rounded to
+// float, and minus the log of that float, so that ln(m) = ln(m * inverse) + log exactly.
+struct FastLogTable
+{
+    float inverse[1 << kFastLogBits];
+    float log[1 << kFastLogBits];
+};
+
+constexpr FastLogTable make_fast_log_table()
+{
+    FastLogTable table{};
+    for (size_t i = 0; i < (1 << kFastLogBits); ++i) {
+        table.inverse[i] = float(1.0 / (1.0 + double(i) / (1 << kFastLogBits)));
+        table.log[i] = float(-series_log(double(table.inverse[i])));
+    }
+    return table;
+}
+
+// 2^(j / 2^kFastExpBits).
+struct FastExpTable
+{
+    float exp2[1 << kFastExpBits];
+};
+
+constexpr FastExpTable make_fast_exp_table()
+{
+    FastExpTable table{};
+    for (size_t j = 0; j < (1 << kFastExpBits); ++j) {
+        table.exp2[j] = float(series_exp(kLn2 * double(j) / (1 << kFastExpBits)));
+    }
+    return table;
+}
+
+inline constexpr FastLogTable kFastLogTable = make_fast_log_table();
+inline constexpr FastExpTable kFastExpTable = make_fast_exp_table();
+
+inline float fast_log(float x)
+{
+    // Zero, negative, denormal, infinite and NaN arguments.
+    if (!(x >= 0x1p-126f) || x == INFINITY) {
+        if (x > 0.0f && x < 0x1p-126f) {
+            return fast_log(x * 0x1p24f) - float(24 * kLn2);
+        }
+        return x == 0.0f ? -INFINITY : x == INFINITY ? x : NAN;
+    }
+    const uint32_t bits = std::bit_cast<uint32_t>(x);
+    const int exponent = int(bits >> 23) - 127;
+    const size_t i = (bits >> (23 - kFastLogBits)) & ((1 << kFastLogBits) - 1);
+    const float m = std::bit_cast<float>((bits & 0x7fffff) | 0x3f800000);
+    // In [0, 2^-kFastLogBits): the cubic's truncation error is below r^4 / 4, 1e-9. In the first interval the
+    // inverse is 1 and r is exact, so logs just above 1 keep their relative accuracy.
+    const float r = m * kFastLogTable.inverse[i] - 1.0f;
+    const float p = r + r * r * (-0.5f + r * (1.0f / 3.0f));
+    return float(exponent) * float(kLn2) + (kFastLogTable.log[i] + p);
+}
+
+inline float fast_exp(float x)
+{
+    // Results that would be denormal, or infinite, and NaN.
+    if (!(x > -87.33f)) {
+        return std::isnan(x) ? x : 0.0f;
+    }
+    if (x > 88.72f) {
+        return INFINITY;
+    }
+    // x = n ln2 / 64 + t. The step is split Cody-Waite style: its high part has 11 significant bits, so n times it
+    // is exact for every n in range, 13 bits.
+    constexpr float kStepHigh = 0x1.63p-7f;
+    constexpr float kStepLow = float(kLn2 / (1 << kFastExpBits) - double(kStepHigh));
+    const float y = x * float((1 << kFastExpBits) / kLn2);
+    const int n = int(y + (y >= 0.0f ? 0.5f : -0.5f));
+    const float t = (x - float(n) * kStepHigh) - float(n) * kStepLow;
+    // |t| <= ln2 / 128: truncation below t^4 / 24, 4e-11.
+    const float p = 1.0f + t * (1.0f + t * (0.5f + t * (1.0f / 6.0f)));
+    const float mantissa = kFastExpTable.exp2[n & ((1 << kFastExpBits) - 1)] * p;
+    const int scale = n >> kFastExpBits;
+    return std::bit_cast<float>(std::bit_cast<uint32_t>(mantissa) + (uint32_t(scale) << 23));
+}
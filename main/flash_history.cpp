@@ -0,0 +1,143 @@
+#include "flash_history.hpp"
+
+#include <esp_log.h>
+
+#include <cstring>
+
+constexpr const char* TAG = "history";
+
+esp_err_t FlashHistory::begin(uint32_t now_ms, const DryingProfile& profile)
+{
+    partition_ = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "history");
+    if (partition_ == nullptr) {
+        ESP_LOGW(TAG, "No history partition, input recording disabled");
+        return ESP_ERR_NOT_FOUND;
+    }
+    sector_count_ = partition_->size / kHistorySectorSize;
+
+    bool found = false;
+    uint32_t newest = 0;
+    for (uint32_t sector = 0; sector < sector_count_; ++sector) {
+        HistorySectorHeader header;
+        if (esp_partition_read(partition_, sector * kHistorySectorSize, &header, sizeof(header)) == ESP_OK &&
+            header.magic == kHistorySectorMagic && (!found || header.sequence > sequence_)) {
+            found = true;
+            newest = sector;
+            sequence_ = header.sequence;
+        }
+    }
+
+    const esp_err_t err = open_sector(found ? (newest + 1) % sector_count_ : 0);
+    if (err != ESP_OK) {
+        return err;
+    }
+    last_flush_ms_ = last_record_ms_ = now_ms;
+    append(now_ms, [&](uint8_t* out) { return encoder_.boot(out, now_ms); });
+    record_profile(now_ms, profile);
+    return ESP_OK;
+}
+
+void FlashHistory::record_frame(uint32_t now_ms, uint32_t sample_count, uint32_t sample_sum)
+{
+    append(now_ms, [&](uint8_t* out) { return encoder_.frame(out, now_ms, sample_count, sample_sum); });
+}
+
+void FlashHistory::record_profile(uint32_t now_ms, const DryingProfile& profile)
+{
+    append(now_ms, [&](uint8_t* out) { return encoder_.profile(out, now_ms, profile); });
+}
+
+void FlashHistory::record_setpoint(uint32_t now_ms, float setpoint)
+{
+    append(now_ms, [&](uint8_t* out) { return encoder_.setpoint(out, now_ms, setpoint); });
+}
+
+void FlashHistory::record_sensor_timeout(uint32_t now_ms)
+{
+    append(now_ms, [&](uint8_t* out) { return encoder_.sensor_timeout(out, now_ms); });
+}
+
+void FlashHistory::record_correction(uint32_t now_ms, const TemperatureCorrection& correction)
+{
+    append(now_ms, [&](uint8_t* out) { return encoder_.correction(out, now_ms, correction); });
+}
+
+void FlashHistory::record_auxiliary(uint32_t now_ms, uint8_t sensor, float temperature)
+{
+    append(now_ms, [&](uint8_t* out) { return encoder_.auxiliary(out, now_ms, sensor, temperature); });
+}
+
+void FlashHistory::record_humidity(uint32_t now_ms, float humidity)
+{
+    append(now_ms, [&](uint8_t* out) { return encoder_.humidity(out, now_ms, humidity); });
+}
+
+void FlashHistory::record_weight(uint32_t now_ms, float weight)
+{
+    append(now_ms, [&](uint8_t* out) { return encoder_.weight(out, now_ms, weight); });
+}
+
+template <typename Encode>
+void FlashHistory::append(uint32_t now_ms, Encode encode)
+{
+    if (partition_ == nullptr) {
+        return;
+    }
+
+    last_record_ms_ = now_ms;
+    uint8_t record[kMaxInputRecordSize];
+    size_t len = encode(record);
+    if (flushed_offset_ + buffered_ + len > kHistorySectorSize) {
+        flush();
+        if (open_sector((sector_ + 1) % sector_count_) != ESP_OK) {
+            return;
+        }
+        // The new sector starts a fresh delta chain.
+        len = encode(record);
+    }
+    if (buffered_ + len > buffer_.size()) {
+        flush();
+    }
+    memcpy(buffer_.data() + buffered_, record, len);
+    buffered_ += len;
+
+    if (now_ms - last_flush_ms_ >= kFlushIntervalMs) {
+        flush();
+    }
+}
+
+esp_err_t FlashHistory::flush()
+{
+    if (partition_ == nullptr || buffered_ == 0) {
+        return ESP_OK;
+    }
+    const esp_err_t err =
+        esp_partition_write(partition_, sector_ * kHistorySectorSize + flushed_offset_, buffer_.data(), buffered_);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Dropping %u bytes of input log: %s", (unsigned)buffered_, esp_err_to_name(err));
+    }
+    // Skip the range either way so a partially programmed area is never written twice.
+    flushed_offset_ += buffered_;
+    buffered_ = 0;
+    last_flush_ms_ = last_record_ms_;
+    return err;
+}
+
+esp_err_t FlashHistory::open_sector(uint32_t sector)
+{
+    const HistorySectorHeader header{kHistorySectorMagic, ++sequence_};
+    esp_err_t err = esp_partition_erase_range(partition_, sector * kHistorySectorSize, kHistorySectorSize);
+    if (err == ESP_OK) {
+        err = esp_partition_write(partition_, sector * kHistorySectorSize, &header, sizeof(header));
+    }
+    sector_ = sector;
+    flushed_offset_ = sizeof(header);
+    buffered_ = 0;
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to open history sector %u: %s", (unsigned)sector, esp_err_to_name(err));
+        // Mark it full so the next record moves on; one bad sector cannot stall recording.
+        flushed_offset_ = kHistorySectorSize;
+    }
+    encoder_.restart();
+    return err;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <esp_err.h>
+#include <esp_partition.h>
+
+#include "input_log.hpp"
+
+// Appends the input log to the "history" data partition as a ring of sectors. Records are buffered in RAM and
+// written when the buffer fills, when a sector fills, or kFlushIntervalMs after the last write, so at most that
+// much input is lost on a power cut. Write failures are logged and the affected records dropped; recording never
+// stops the control loop.
+class FlashHistory
+{
+public:
+    static constexpr uint32_t kFlushIntervalMs = 60'000;
+
+    // Finds the partition, opens the sector after the newest one written so far, and records the boot and the
+    // profile in effect. Returns ESP_ERR_NOT_FOUND if the partition table has no history partition.
+    esp_err_t begin(uint32_t now_ms, const DryingProfile& profile);
+
+    void record_frame(uint32_t now_ms, uint32_t sample_count, uint32_t sample_sum);
+    void record_profile(uint32_t now_ms, const DryingProfile& profile);
+    void record_setpoint(uint32_t now_ms, float setpoint);
+    void record_sensor_timeout(uint32_t now_ms);
+    void record_correction(uint32_t now_ms, const TemperatureCorrection& correction);
+    void record_auxiliary(uint32_t now_ms, uint8_t sensor, float temperature);
+    void record_humidity(uint32_t now_ms, float humidity);
+    void record_weight(uint32_t now_ms, float weight);
+
+    esp_err_t flush();
+
+private:
+    template <typename Encode>
+    void append(uint32_t now_ms, Encode encode);
+    esp_err_t open_sector(uint32_t sector);
+
+    const esp_partition_t* partition_ = nullptr;
+    InputLogEncoder encoder_;
+    uint32_t sector_count_ = 0;
+    uint32_t sector_ = 0;
+    uint32_t sequence_ = 0;
+    size_t flushed_offset_ = 0;
+    size_t buffered_ = 0;
+    uint32_t last_record_ms_ = 0;
+    uint32_t last_flush_ms_ = 0;
+    std::array<uint8_t, 256> buffer_{};
+};
@@ -0,0 +1,136 @@
+#include "flash_snapshots.hpp"
+
+#include <esp_log.h>
+
+#include <algorithm>
+#include <cinttypes>
+
+#include "telemetry.hpp"
+
+constexpr const char* TAG = "snapshot";
+constexpr uint32_t kWriterStackSize = 3072;
+constexpr uint32_t kSyncPollMs = 10;
+
+esp_err_t FlashSnapshots::begin(SnapshotRecorder& recorder)
+{
+    partition_ = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "snapshot");
+    if (partition_ == nullptr) {
+        ESP_LOGW(TAG, "No snapshot partition, snapshots disabled");
+        return ESP_ERR_NOT_FOUND;
+    }
+    slot_count_ = partition_->size / kSnapshotSlotSize;
+    if (slot_count_ == 0) {
+        ESP_LOGW(TAG, "Snapshot partition too small for a snapshot, snapshots disabled");
+        partition_ = nullptr;
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    bool found = false;
+    uint32_t newest = 0;
+    for (uint32_t slot = 0; slot < slot_count_; ++slot) {
+        SnapshotHeader header;
+        if (esp_partition_read(partition_, slot * kSnapshotSlotSize, &header, sizeof(header)) == ESP_OK &&
+            header.magic == kSnapshotMagic && (!found || header.sequence > sequence_)) {
+            found = true;
+            newest = slot;
+            sequence_ = header.sequence;
+        }
+    }
+    slot_ = found ? (newest + 1) % slot_count_ : 0;
+    sequence_ = found ? sequence_ + 1 : 0;
+
+    recorder_ = &recorder;
+    if (xTaskCreate(task, "snapshot", kWriterStackSize, this, tskIDLE_PRIORITY, &task_) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to start the snapshot writer, snapshots disabled");
+        partition_ = nullptr;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void FlashSnapshots::flush()
+{
+    if (task_ != nullptr) {
+        xTaskNotifyGive(task_);
+    }
+}
+
+bool FlashSnapshots::sync(TickType_t timeout)
+{
+    const TickType_t started = xTaskGetTickCount();
+    while (task_ != nullptr && recorder_->frozen()) {
+        if (xTaskGetTickCount() - started >= timeout) {
+            return false;
+        }
+        // The writer runs at idle priority, so only while this task is blocked.
+        vTaskDelay(pdMS_TO_TICKS(kSyncPollMs));
+    }
+    return true;
+}
+
+void FlashSnapshots::task(void* arg)
+{
+    auto* self = static_cast<FlashSnapshots*>(arg);
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (!self->recorder_->frozen()) {
+            continue;
+        }
+        const esp_err_t err = self->write();
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Dropping the %s snapshot: %s", snapshot_trigger_name(self->recorder_->trigger()),
+                     esp_err_to_name(err));
+        }
+        self->recorder_->release();
+    }
+}
+
+esp_err_t FlashSnapshots::write()
+{
+    const SnapshotRecorder& recorder = *recorder_;
+    const size_t base = slot_ * kSnapshotSlotSize;
+    // Move past the slot even if the write fails, so a worn slot costs one snapshot rather than every later one.
+    slot_ = (slot_ + 1) % slot_count_;
+    for (size_t sector = 0; sector < kSnapshotSlotSize; sector += kSnapshotSectorSize) {
+        const esp_err_t err = esp_partition_erase_range(partition_, base + sector, kSnapshotSectorSize);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+
+    const auto [first, second] = recorder.steps();
+    uint16_t crc = 0xffff;
+    size_t offset = base + sizeof(SnapshotHeader);
+    for (const auto part : {first, second}) {
+        const auto* data = reinterpret_cast<const uint8_t*>(part.data());
+        const size_t size = part.size_bytes();
+        crc = telemetry_crc16(data, size, crc);
+        for (size_t done = 0; done < size; done += kChunkSize) {
+            const esp_err_t err = esp_partition_write(partition_, offset + done, data + done,
+                                                      std::min(kChunkSize, size - done));
+            if (err != ESP_OK) {
+                return err;
+            }
+        }
+        offset += size;
+    }
+
+    SnapshotHeader header{};
+    header.magic = kSnapshotMagic;
+    header.sequence = sequence_;
+    header.trigger_ms = recorder.trigger_ms();
+    header.missed = recorder.missed();
+    header.step_count = recorder.step_count();
+    header.trigger_index = recorder.trigger_index();
+    header.version = kSnapshotVersion;
+    header.trigger = recorder.trigger();
+    header.crc = crc;
+    const esp_err_t err = esp_partition_write(partition_, base, &header, sizeof(header));
+    if (err != ESP_OK) {
+        return err;
+    }
+    ESP_LOGI(TAG, "Snapshot %" PRIu32 ": %s at %" PRIu32 " ms, %u steps", sequence_,
+             snapshot_trigger_name(header.trigger), header.trigger_ms, unsigned(header.step_count));
+    ++sequence_;
+    return ESP_OK;
+}
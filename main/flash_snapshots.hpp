@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+#include <esp_err.h>
+#include <esp_partition.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "snapshot.hpp"
+
+// Stores the recorder's frozen snapshots in the "snapshot" data partition from a task of its own at idle priority,
+// so the control loop never waits on the flash. Each snapshot takes the slot after the newest one; the slot is
+// erased a sector at a time and programmed in kChunkSize pieces, which bounds how long each flash operation holds
+// off the other tasks. A failed write is logged and the snapshot dropped; either way the recorder is re-armed.
+class FlashSnapshots
+{
+public:
+    static constexpr size_t kChunkSize = 1024;
+
+    // Finds the partition and the newest snapshot in it, and starts the writer task. Returns ESP_ERR_NOT_FOUND if
+    // the partition table has no snapshot partition, in which case the recorder should not be fed.
+    esp_err_t begin(SnapshotRecorder& recorder);
+
+    // Wakes the writer for the recorder's frozen snapshot; from the control loop when record() returns true.
+    void flush();
+    // Waits up to `timeout` for the writer to store the frozen snapshot, if there is one, as before deep sleep.
+    // Returns false if it is still being written.
+    bool sync(TickType_t timeout);
+
+private:
+    static void task(void* arg);
+    esp_err_t write();
+
+    const esp_partition_t* partition_ = nullptr;
+    SnapshotRecorder* recorder_ = nullptr;
+    TaskHandle_t task_ = nullptr;
+    uint32_t slot_count_ = 0;
+    uint32_t slot_ = 0;
+    uint32_t sequence_ = 0;
+};
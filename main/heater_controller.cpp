@@ -0,0 +1,83 @@
+#include "heater_controller.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+float low_pass_alpha(float cutoff_hz, float dt)
+{
+    return 1.0f - std::exp(-2.0f * std::numbers::pi_v<float> * cutoff_hz * dt);
+}
+
+HeaterController::HeaterController(const HeaterControllerConfig& config) : config_(config)
+{
+}
+
+void HeaterController::set_setpoint(float setpoint)
+{
+    target_ = setpoint;
+    if (ramp_rate_ <= 0.0f || !primed_) {
+        setpoint_ = setpoint;
+    }
+}
+
+void HeaterController::reset()
+{
+    integral_ = 0.0f;
+    duty_ = 0.0f;
+    primed_ = false;
+    fault_ = false;
+    setpoint_ = target_;
+}
+
+void HeaterController::trip()
+{
+    fault_ = true;
+    duty_ = 0.0f;
+}
+
+float HeaterController::update(float temperature, float guard_temperature, float dt)
+{
+    if (!std::isfinite(guard_temperature) || guard_temperature < config_.min_valid_temperature ||
+        guard_temperature > config_.max_valid_temperature || !std::isfinite(temperature)) {
+        fault_ = true;
+        duty_ = 0.0f;
+        return duty_;
+    }
+
+    if (fault_ || !primed_) {
+        // Restart from the current reading so a recovered sensor doesn't produce a derivative kick.
+        filtered_ = temperature;
+        if (!primed_ && ramp_rate_ > 0.0f) {
+            setpoint_ = std::min(target_, temperature);
+        }
+        integral_ = 0.0f;
+        fault_ = false;
+        primed_ = true;
+    }
+
+    if (ramp_rate_ > 0.0f) {
+        const float step = ramp_rate_ * dt;
+        setpoint_ = std::clamp(target_, setpoint_ - step, setpoint_ + step);
+    }
+
+    const float alpha = low_pass_alpha(config_.filter_cutoff_hz, dt);
+    const float previous = filtered_;
+    filtered_ += alpha * (temperature - filtered_);
+
+    const float error = setpoint_ - filtered_;
+    const float derivative = dt > 0.0f ? (filtered_ - previous) / dt : 0.0f;
+    const float proportional = config_.gains.kp * error - config_.gains.kd * derivative;
+
+    const float candidate = integral_ + config_.gains.ki * error * dt;
+    const float unclamped = proportional + candidate;
+    if ((unclamped < 1.0f || error < 0.0f) && (unclamped > 0.0f || error > 0.0f)) {
+        integral_ = std::clamp(candidate, 0.0f, 1.0f);
+    }
+
+    duty_ = std::clamp(proportional + integral_, 0.0f, 1.0f);
+    if (guard_temperature >= config_.max_temperature) {
+        duty_ = 0.0f;
+    }
+    return duty_;
+}
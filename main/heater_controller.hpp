@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+
+struct PidGains
+{
+    float kp;
+    float ki;
+    float kd;
+};
+
+struct HeaterControllerConfig
+{
+    PidGains gains{0.08f, 0.0006f, 2.0f};
+    // Cutoff of the first-order low-pass applied to the measurement before the derivative term.
+    float filter_cutoff_hz = 0.05f;
+    // Readings outside this window are treated as a sensor fault and force the heater off.
+    float min_valid_temperature = -20.0f;
+    float max_valid_temperature = 110.0f;
+    // Hard over-temperature cutoff, independent of the setpoint.
+    float max_temperature = 90.0f;
+};
+
+// Smoothing factor of the controller's first-order measurement low-pass for a step of `dt` seconds.
+float low_pass_alpha(float cutoff_hz, float dt);
+
+// PID temperature controller producing a heater duty in [0, 1]. Derivative acts on the filtered measurement and
+// the integrator only accumulates while the output is not saturated.
+class HeaterController
+{
+public:
+    explicit HeaterController(const HeaterControllerConfig& config = {});
+
+    void set_setpoint(float setpoint);
+    // Setpoint slew limit in degrees per second; 0 applies setpoint changes immediately.
+    void set_ramp_rate(float ramp_rate) { ramp_rate_ = ramp_rate; }
+    float setpoint() const { return target_; }
+    float effective_setpoint() const { return setpoint_; }
+
+    // Advances the controller by `dt` seconds and returns the new duty.
+    float update(float temperature, float dt) { return update(temperature, temperature, dt); }
+    // As above, with the control error taken from `temperature` and the validity window and over-temperature cutoff
+    // applied to `guard_temperature`, for a caller whose control temperature blends several sensors.
+    float update(float temperature, float guard_temperature, float dt);
+    void reset();
+    // Enters the fault state as an invalid reading would, for when readings stop arriving altogether.
+    void trip();
+
+    bool fault() const { return fault_; }
+    float duty() const { return duty_; }
+    const HeaterControllerConfig& config() const { return config_; }
+
+private:
+    HeaterControllerConfig config_;
+    float ramp_rate_ = 0.0f;
+    float target_ = 0.0f;
+    float setpoint_ = 0.0f;
+    float filtered_ = 0.0f;
+    float integral_ = 0.0f;
+    float duty_ = 0.0f;
+    bool primed_ = false;
+    bool fault_ = false;
+};
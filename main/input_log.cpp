@@ -0,0 +1,189 @@
+#include "input_log.hpp"
+
+static size_t write_varint(uint8_t* out, uint32_t value)
+{
+    size_t len = 0;
+    do {
+        uint8_t byte = value & 0x7f;
+        value >>= 7;
+        out[len++] = byte | (value != 0 ? 0x80 : 0);
+    } while (value != 0);
+    return len;
+}
+
+static size_t write_float(uint8_t* out, float value)
+{
+    memcpy(out, &value, sizeof(value));
+    return sizeof(value);
+}
+
+size_t InputLogEncoder::header(uint8_t* out, InputRecordType type, uint32_t time_ms)
+{
+    out[0] = static_cast<uint8_t>(type);
+    const size_t len = 1 + write_varint(out + 1, type == InputRecordType::Boot ? time_ms : time_ms - last_ms_);
+    last_ms_ = time_ms;
+    return len;
+}
+
+size_t InputLogEncoder::boot(uint8_t* out, uint32_t time_ms)
+{
+    size_t len = header(out, InputRecordType::Boot, time_ms);
+    out[len++] = kInputLogVersion;
+    return len;
+}
+
+size_t InputLogEncoder::frame(uint8_t* out, uint32_t time_ms, uint32_t sample_count, uint32_t sample_sum)
+{
+    size_t len = header(out, InputRecordType::Frame, time_ms);
+    len += write_varint(out + len, sample_count);
+    len += write_varint(out + len, sample_sum);
+    return len;
+}
+
+size_t InputLogEncoder::profile(uint8_t* out, uint32_t time_ms, const DryingProfile& profile)
+{
+    size_t len = header(out, InputRecordType::Profile, time_ms);
+    len += write_float(out + len, profile.setpoint);
+    len += write_float(out + len, profile.ramp_rate);
+    len += write_varint(out + len, profile.soak_s);
+    len += write_float(out + len, profile.soak_band);
+    out[len++] = static_cast<uint8_t>(profile.material);
+    return len;
+}
+
+size_t InputLogEncoder::setpoint(uint8_t* out, uint32_t time_ms, float setpoint)
+{
+    size_t len = header(out, InputRecordType::Setpoint, time_ms);
+    len += write_float(out + len, setpoint);
+    return len;
+}
+
+size_t InputLogEncoder::sensor_timeout(uint8_t* out, uint32_t time_ms)
+{
+    return header(out, InputRecordType::SensorTimeout, time_ms);
+}
+
+size_t InputLogEncoder::correction(uint8_t* out, uint32_t time_ms, const TemperatureCorrection& correction)
+{
+    size_t len = header(out, InputRecordType::Correction, time_ms);
+    len += write_float(out + len, correction.offset);
+    len += write_float(out + len, correction.gain);
+    len += write_float(out + len, correction.curvature);
+    return len;
+}
+
+size_t InputLogEncoder::auxiliary(uint8_t* out, uint32_t time_ms, uint8_t sensor, float temperature)
+{
+    size_t len = header(out, InputRecordType::Auxiliary, time_ms);
+    out[len++] = sensor;
+    len += write_float(out + len, temperature);
+    return len;
+}
+
+size_t InputLogEncoder::humidity(uint8_t* out, uint32_t time_ms, float humidity)
+{
+    size_t len = header(out, InputRecordType::Humidity, time_ms);
+    len += write_float(out + len, humidity);
+    return len;
+}
+
+size_t InputLogEncoder::weight(uint8_t* out, uint32_t time_ms, float weight)
+{
+    size_t len = header(out, InputRecordType::Weight, time_ms);
+    len += write_float(out + len, weight);
+    return len;
+}
+
+bool InputLogDecoder::read_varint(uint32_t& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (offset_ >= size_) {
+            return false;
+        }
+        const uint8_t byte = data_[offset_++];
+        value |= uint32_t(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool InputLogDecoder::read_float(float& value)
+{
+    if (size_ - offset_ < sizeof(value)) {
+        return false;
+    }
+    memcpy(&value, data_ + offset_, sizeof(value));
+    offset_ += sizeof(value);
+    return true;
+}
+
+bool InputLogDecoder::next(InputRecord& record)
+{
+    if (error_ || offset_ >= size_ || data_[offset_] == 0xff) {
+        return false;
+    }
+    const size_t start = offset_;
+    record = InputRecord{};
+    record.type = static_cast<InputRecordType>(data_[offset_++]);
+
+    uint32_t delta = 0;
+    bool ok = read_varint(delta);
+    record.time_ms = record.type == InputRecordType::Boot ? delta : last_ms_ + delta;
+
+    switch (record.type) {
+    case InputRecordType::Boot:
+        ok = ok && offset_ < size_;
+        if (ok) {
+            record.version = data_[offset_++];
+            ok = record.version == kInputLogVersion;
+        }
+        break;
+    case InputRecordType::Frame:
+        ok = ok && read_varint(record.sample_count) && read_varint(record.sample_sum);
+        break;
+    case InputRecordType::Profile:
+        ok = ok && read_float(record.profile.setpoint) && read_float(record.profile.ramp_rate) &&
+             read_varint(record.profile.soak_s) && read_float(record.profile.soak_band) && offset_ < size_;
+        if (ok) {
+            record.profile.material = static_cast<Material>(data_[offset_++]);
+            ok = record.profile.material < Material::Count;
+        }
+        break;
+    case InputRecordType::Setpoint:
+        ok = ok && read_float(record.setpoint);
+        break;
+    case InputRecordType::SensorTimeout:
+        break;
+    case InputRecordType::Correction:
+        ok = ok && read_float(record.correction.offset) && read_float(record.correction.gain) &&
+             read_float(record.correction.curvature);
+        break;
+    case InputRecordType::Auxiliary:
+        ok = ok && offset_ < size_;
+        if (ok) {
+            record.sensor = data_[offset_++];
+            ok = record.sensor < Dryer::kMaxAuxiliary && read_float(record.temperature);
+        }
+        break;
+    case InputRecordType::Humidity:
+        ok = ok && read_float(record.humidity);
+        break;
+    case InputRecordType::Weight:
+        ok = ok && read_float(record.weight);
+        break;
+    default:
+        ok = false;
+        break;
+    }
+
+    if (!ok) {
+        offset_ = start;
+        error_ = true;
+        return false;
+    }
+    last_ms_ = record.time_ms;
+    return true;
+}
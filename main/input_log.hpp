@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "dryer.hpp"
+
+// Compact log of every external input the firmware acts on, so a field run can be replayed through the same code.
+//
+// Each record is a type byte, the milliseconds since the previous record as a LEB128 varint, then a type-specific
+// payload. In flash the log is split into sectors that each begin with a HistorySectorHeader; the first record of
+// every sector, and every Boot record, carries an absolute time. Unused space stays erased (0xff), which is never a
+// valid record type.
+
+enum class InputRecordType : uint8_t
+{
+    Boot = 1,
+    // Sample count and sum of one ADC conversion frame, from which the firmware's integer average follows exactly.
+    Frame = 2,
+    Profile = 3,
+    Setpoint = 4,
+    // The firmware gave up waiting for a usable ADC frame and switched the heater off.
+    SensorTimeout = 5,
+    // The thermistor correction changed, at boot from stored calibration or refined during a soak.
+    Correction = 6,
+    // A reading of a chamber sensor other than the thermistor, for the next frame.
+    Auxiliary = 7,
+    // Relative humidity of the chamber air, for the next frame.
+    Humidity = 8,
+    // A load cell reading in grams, for the next frame.
+    Weight = 9,
+};
+
+// Version 2 added the material to Profile records.
+constexpr uint8_t kInputLogVersion = 2;
+constexpr size_t kMaxInputRecordSize = 32;
+
+struct InputRecord
+{
+    InputRecordType type = InputRecordType::Boot;
+    uint32_t time_ms = 0;
+    uint8_t version = 0;
+    uint32_t sample_count = 0;
+    uint32_t sample_sum = 0;
+    DryingProfile profile{};
+    float setpoint = 0.0f;
+    TemperatureCorrection correction{};
+    uint8_t sensor = 0;
+    float temperature = 0.0f;
+    float humidity = 0.0f;
+    float weight = 0.0f;
+
+    uint32_t frame_average() const { return sample_count ? sample_sum / sample_count : 0; }
+};
+
+class InputLogEncoder
+{
+public:
+    // Each call writes one record to `out`, which must hold kMaxInputRecordSize bytes, and returns its length.
+    size_t boot(uint8_t* out, uint32_t time_ms);
+    size_t frame(uint8_t* out, uint32_t time_ms, uint32_t sample_count, uint32_t sample_sum);
+    size_t profile(uint8_t* out, uint32_t time_ms, const DryingProfile& profile);
+    size_t setpoint(uint8_t* out, uint32_t time_ms, float setpoint);
+    size_t sensor_timeout(uint8_t* out, uint32_t time_ms);
+    size_t correction(uint8_t* out, uint32_t time_ms, const TemperatureCorrection& correction);
+    size_t auxiliary(uint8_t* out, uint32_t time_ms, uint8_t sensor, float temperature);
+    size_t humidity(uint8_t* out, uint32_t time_ms, float humidity);
+    size_t weight(uint8_t* out, uint32_t time_ms, float weight);
+
+    // Makes the next record carry its absolute time, for the first record of a new sector.
+    void restart() { last_ms_ = 0; }
+
+private:
+    size_t header(uint8_t* out, InputRecordType type, uint32_t time_ms);
+
+    uint32_t last_ms_ = 0;
+};
+
+class InputLogDecoder
+{
+public:
+    InputLogDecoder(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+    // Decodes the next record. Returns false at the end of the data, at erased space or at a malformed record;
+    // error() tells the last case apart.
+    bool next(InputRecord& record);
+    bool error() const { return error_; }
+    size_t offset() const { return offset_; }
+
+private:
+    bool read_varint(uint32_t& value);
+    bool read_float(float& value);
+
+    const uint8_t* data_;
+    size_t size_;
+    size_t offset_ = 0;
+    uint32_t last_ms_ = 0;
+    bool error_ = false;
+};
+
+constexpr uint32_t kHistorySectorMagic = 0x48445259; // "YRDH"
+constexpr size_t kHistorySectorSize = 4096;
+
+struct HistorySectorHeader
+{
+    uint32_t magic;
+    uint32_t sequence;
+};
+
+// Decodes a raw image of the history partition, calling `fn(const InputRecord&)` for every record in write order.
+// Returns the number of records decoded.
+template <typename Fn>
+size_t decode_history_image(const uint8_t* image, size_t size, Fn fn)
+{
+    std::vector<std::pair<uint32_t, size_t>> sectors;
+    for (size_t offset = 0; offset + kHistorySectorSize <= size; offset += kHistorySectorSize) {
+        HistorySectorHeader header;
+        memcpy(&header, image + offset, sizeof(header));
+        if (header.magic == kHistorySectorMagic) {
+            sectors.emplace_back(header.sequence, offset);
+        }
+    }
+    std::sort(sectors.begin(), sectors.end());
+
+    size_t count = 0;
+    for (const auto& [sequence, offset] : sectors) {
+        InputLogDecoder decoder(image + offset + sizeof(HistorySectorHeader),
+                                kHistorySectorSize - sizeof(HistorySectorHeader));
+        InputRecord record;
+        while (decoder.next(record)) {
+            fn(record);
+            ++count;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,57 @@
+#include "keep_dry.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "psychrometrics.hpp"
+
+// The hold temperature stays this far below the drying temperature, leaving bursts room to heat.
+constexpr float kMinBurstBand = 2.0f;
+
+float code_temperature(uint32_t code, const TemperatureCorrection& correction)
+{
+    return correct_temperature(convert_reading(code).temperature, correction);
+}
+
+uint16_t code_below(float temperature, const TemperatureCorrection& correction)
+{
+    // The curve falls with the code over the ADC's range.
+    uint32_t low = 0;
+    uint32_t high = 1u << kAdcResolutionBits;
+    while (low < high) {
+        const uint32_t middle = (low + high) / 2;
+        if (code_temperature(middle, correction) < temperature) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+    return uint16_t(low);
+}
+
+KeepDryThresholds keep_dry_thresholds(Material material, float vapour_pressure,
+                                      const TemperatureCorrection& correction)
+{
+    const auto& kinetics = material_kinetics(material);
+    KeepDryThresholds thresholds;
+    thresholds.humidity = 100.0f * kinetics.target / kinetics.saturation;
+    const float pressure = std::isfinite(vapour_pressure) && vapour_pressure > 0 ? vapour_pressure
+                                                                                 : kRoomVapourPressure;
+    thresholds.hold = std::min(dew_point_from_pressure(pressure * 100.0f / thresholds.humidity),
+                               kinetics.temperature - kMinBurstBand);
+    thresholds.burst_to = std::min(thresholds.hold + kBurstBand, kinetics.temperature);
+    thresholds.wake_code = code_below(thresholds.hold, correction);
+    return thresholds;
+}
+
+float KeepDryStats::average_current_ma() const
+{
+    const double total_ms = double(asleep_ms) + double(awake_ms);
+    if (total_ms <= 0) {
+        return kAwakeCurrentMa;
+    }
+    const double ulp_ms = double(ulp_runs) * kUlpRunUs / 1000.0;
+    const double charge = (double(asleep_ms) - ulp_ms) * kSleepCurrentMa + ulp_ms * kUlpCurrentMa +
+                          double(awake_ms) * kAwakeCurrentMa;
+    return float(charge / total_ms);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+
+#include "conversion.hpp"
+#include "moisture_model.hpp"
+
+// Storage of a dried spool in the closed chamber. A material at its target moisture is in equilibrium with air at
+// 100 target / saturation percent relative humidity (MaterialKinetics); warmer air holding the same water is drier,
+// so keeping the chamber above the temperature at which its air reaches that humidity keeps the spool from taking
+// water back. Between short heater bursts the main CPUs sleep and the ULP coprocessor watches the thermistor,
+// waking them when the chamber cools below that temperature.
+
+// The ULP samples the thermistor this often, averaging kUlpSamples conversions.
+constexpr uint32_t kUlpPeriodMs = 2000;
+constexpr uint32_t kUlpSamples = 8;
+// The CPUs also wake this often to read the humidity, which the ULP can't: the room's may have changed.
+constexpr uint32_t kKeepDryCheckS = 2 * 3600;
+// Bursts heat this far above the hold temperature, and stop after kBurstMaxS whatever the thermistor says.
+constexpr float kBurstBand = 8.0f;
+constexpr uint32_t kBurstMaxS = 20 * 60;
+
+// Supply current of the ESP32, mA, from its datasheet: running with the radio off at 160 MHz, in deep sleep with
+// the RTC timer and memory powered, and while the ULP runs.
+constexpr float kAwakeCurrentMa = 40.0f;
+constexpr float kSleepCurrentMa = 0.01f;
+constexpr float kUlpCurrentMa = 0.15f;
+// One run of the ULP program by the ESP32's instruction timings, which the host's ULP counts.
+constexpr float kUlpRunUs = 100.0f;
+// From a wakeup to app_main.
+constexpr uint32_t kBootMs = 250;
+
+struct KeepDryThresholds
+{
+    // Relative humidity the dried material tolerates, %.
+    float humidity;
+    // Below this temperature, C, the chamber air is more humid than that; bursts heat it to burst_to.
+    float hold;
+    float burst_to;
+    // ADC codes at or above this read below `hold`.
+    uint16_t wake_code;
+};
+
+// For a material and the chamber air's water vapour pressure in kPa. The temperatures are capped at the material's
+// drying temperature.
+KeepDryThresholds keep_dry_thresholds(Material material, float vapour_pressure,
+                                      const TemperatureCorrection& correction);
+
+// The temperature the firmware reads from a thermistor code, and the lowest code that reads below `temperature`.
+float code_temperature(uint32_t code, const TemperatureCorrection& correction);
+uint16_t code_below(float temperature, const TemperatureCorrection& correction);
+
+// Where the time goes while keeping dry, and the average current it comes to.
+struct KeepDryStats
+{
+    uint64_t asleep_ms = 0;
+    uint64_t awake_ms = 0;
+    uint64_t ulp_runs = 0;
+    uint32_t wakes = 0;
+    uint32_t bursts = 0;
+    uint32_t burst_s = 0;
+
+    float average_current_ma() const;
+    // Fraction by which the average current is below staying awake.
+    float reduction() const { return 1.0f - average_current_ma() / kAwakeCurrentMa; }
+};
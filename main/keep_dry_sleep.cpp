@@ -0,0 +1,278 @@
+#include "keep_dry_sleep.hpp"
+
+#include <esp32/ulp.h>
+#include <esp_attr.h>
+#include <esp_log.h>
+#include <esp_sleep.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <sdkconfig.h>
+#include <ulp_adc.h>
+
+#include <cinttypes>
+#include <cmath>
+#include <iterator>
+
+#include "keep_dry.hpp"
+#include "psychrometrics.hpp"
+#include "reference_sensor.hpp"
+
+constexpr const char* TAG = "keep_dry";
+
+constexpr uint32_t kMagic = 0x4b445259;  // "KDRY"
+constexpr uint32_t kMaxCode = (1u << kAdcResolutionBits) - 1;
+// Codes this close to the top rail are an open thermistor, as Dryer has it, not a cold chamber.
+constexpr uint32_t kRailMargin = 2;
+// The SHT3x's first result after begin().
+constexpr uint32_t kReferenceStartMs = 1100;
+
+// The ULP's variables, in the last words of its reserved RTC slow memory; the program loads at word 0.
+constexpr uint32_t kDataWord = CONFIG_ULP_COPROC_RESERVE_MEM / sizeof(uint32_t) - 4;
+constexpr uint32_t kCodeWord = 0;
+constexpr uint32_t kRunsWord = 1;
+constexpr uint32_t kCountdownWord = 2;
+constexpr uint32_t kReasonWord = 3;
+constexpr uint16_t kCheckRuns = kKeepDryCheckS * 1000 / kUlpPeriodMs;
+
+enum class WakeReason : uint16_t
+{
+    None,
+    Cold,
+    Check,
+};
+
+// Survives deep sleep.
+struct KeepDryState
+{
+    uint32_t magic;
+    KeepDryConfig config;
+    KeepDryThresholds thresholds;
+    KeepDryStats stats;
+};
+
+RTC_DATA_ATTR static KeepDryState s_state;
+
+// The ULP's ST puts its own address in the upper half-word.
+static uint16_t ulp_word(uint32_t offset)
+{
+    return RTC_SLOW_MEM[kDataWord + offset] & 0xffff;
+}
+
+static bool railed(uint32_t code)
+{
+    return code >= kMaxCode - kRailMargin;
+}
+
+// Lets go of the heater's pin, which sleep() latches low.
+static void release_heater()
+{
+    gpio_hold_dis(s_state.config.heater_gpio);
+    gpio_deep_sleep_hold_dis();
+}
+
+// Starts the ULP afresh; the countdown to the next humidity check carries on unless `check` restarts it.
+static esp_err_t start_ulp(bool check)
+{
+    const auto& thresholds = s_state.thresholds;
+    const auto pad = s_state.config.thermistor;
+    enum
+    {
+        kLabelCountdown,
+        kLabelWake,
+        kLabelHalt,
+    };
+    // Averages kUlpSamples conversions in R1, counts the run, and wakes with a reason in R1 when cold or when the
+    // countdown runs out. Wakes are only sent once the CPUs are ready for them.
+    const ulp_insn_t program[] = {
+        I_MOVI(R1, 0),
+        I_ADC(R0, 0, pad),
+        I_ADDR(R1, R1, R0),
+        I_ADC(R0, 0, pad),
+        I_ADDR(R1, R1, R0),
+        I_ADC(R0, 0, pad),
+        I_ADDR(R1, R1, R0),
+        I_ADC(R0, 0, pad),
+        I_ADDR(R1, R1, R0),
+        I_ADC(R0, 0, pad),
+        I_ADDR(R1, R1, R0),
+        I_ADC(R0, 0, pad),
+        I_ADDR(R1, R1, R0),
+        I_ADC(R0, 0, pad),
+        I_ADDR(R1, R1, R0),
+        I_ADC(R0, 0, pad),
+        I_ADDR(R1, R1, R0),
+        I_RSHI(R2, R1, 3),
+        I_MOVI(R3, kDataWord),
+        I_ST(R2, R3, kCodeWord),
+        I_LD(R0, R3, kRunsWord),
+        I_ADDI(R0, R0, 1),
+        I_ST(R0, R3, kRunsWord),
+        I_MOVR(R0, R2),
+        M_BGE(kLabelCountdown, kMaxCode - kRailMargin),
+        I_MOVI(R1, uint16_t(WakeReason::Cold)),
+        M_BGE(kLabelWake, thresholds.wake_code),
+        M_LABEL(kLabelCountdown),
+        I_LD(R0, R3, kCountdownWord),
+        I_SUBI(R0, R0, 1),
+        I_ST(R0, R3, kCountdownWord),
+        I_MOVI(R1, uint16_t(WakeReason::Check)),
+        M_BL(kLabelWake, 1),
+        I_HALT(),
+        M_LABEL(kLabelWake),
+        I_ST(R1, R3, kReasonWord),
+        I_RD_REG(RTC_CNTL_LOW_POWER_ST_REG, RTC_CNTL_RDY_FOR_WAKEUP_S, RTC_CNTL_RDY_FOR_WAKEUP_S),
+        I_ANDI(R0, R0, 1),
+        M_BL(kLabelHalt, 1),
+        I_WAKE(),
+        M_LABEL(kLabelHalt),
+        I_HALT(),
+    };
+    static_assert(kUlpSamples == 8, "the program sums eight conversions");
+
+    const ulp_adc_cfg_t adc_config = {
+        .adc_n = ADC_UNIT_1,
+        .channel = pad,
+        .atten = ADC_ATTEN_DB_12,
+        .width = ADC_BITWIDTH_10,
+        .ulp_mode = ADC_ULP_MODE_FSM,
+    };
+    ulp_timer_stop();
+    esp_err_t err = ulp_adc_init(&adc_config);
+    size_t size = std::size(program);
+    if (err == ESP_OK) {
+        err = ulp_process_macros_and_load(0, program, &size);
+    }
+    if (err == ESP_OK && size > kDataWord) {
+        err = ESP_ERR_NO_MEM;
+    }
+    if (err != ESP_OK) {
+        return err;
+    }
+    RTC_SLOW_MEM[kDataWord + kCodeWord] = 0;
+    RTC_SLOW_MEM[kDataWord + kRunsWord] = 0;
+    if (check) {
+        RTC_SLOW_MEM[kDataWord + kCountdownWord] = kCheckRuns;
+    }
+    RTC_SLOW_MEM[kDataWord + kReasonWord] = uint16_t(WakeReason::None);
+    err = ulp_set_wakeup_period(0, kUlpPeriodMs * 1000);
+    if (err == ESP_OK) {
+        err = ulp_run(0);
+    }
+    return err;
+}
+
+[[noreturn]] static void sleep(uint32_t awake_ms, bool check)
+{
+    auto& stats = s_state.stats;
+    stats.awake_ms += awake_ms;
+    const uint64_t total_ms = stats.asleep_ms + stats.awake_ms;
+    ESP_LOGI(TAG, "Kept dry %.1f h: %" PRIu32 " wakes, %" PRIu32 " bursts of %" PRIu32
+             " s in all, average current %.3f mA, %.1f%% below staying awake",
+             total_ms / 3600e3, stats.wakes, stats.bursts, stats.burst_s, stats.average_current_ma(),
+             100 * stats.reduction());
+    gpio_set_level(s_state.config.heater_gpio, 0);
+    esp_err_t err = start_ulp(check);
+    if (err == ESP_OK) {
+        err = esp_sleep_enable_ulp_wakeup();
+    }
+    if (err != ESP_OK) {
+        // Without the ULP nothing would wake the CPUs; staying awake with the heater off at least stores the spool.
+        ESP_LOGE(TAG, "Failed to start the ULP, not keeping dry: %s", esp_err_to_name(err));
+        s_state.magic = 0;
+        release_heater();
+        gpio_set_level(s_state.config.heater_gpio, 0);
+        while (true) {
+            vTaskDelay(portMAX_DELAY);
+        }
+    }
+    // Nothing drives the pad in deep sleep, where the spool may sit for days; latch it low.
+    gpio_hold_en(s_state.config.heater_gpio);
+    gpio_deep_sleep_hold_en();
+    esp_deep_sleep_start();
+}
+
+// Heats until the thermistor, as the ULP goes on sampling it, reads burst_to. Returns the seconds it took.
+static uint32_t burst()
+{
+    const auto& config = s_state.config;
+    release_heater();
+    gpio_set_level(config.heater_gpio, 1);
+    uint32_t seconds = 0;
+    while (seconds < kBurstMaxS) {
+        vTaskDelay(pdMS_TO_TICKS(1000));
+        ++seconds;
+        const uint16_t code = ulp_word(kCodeWord);
+        if (railed(code) || code_temperature(code, config.correction) >= s_state.thresholds.burst_to) {
+            break;
+        }
+    }
+    gpio_set_level(config.heater_gpio, 0);
+    return seconds;
+}
+
+void keep_dry_enter(adc_continuous_handle_t adc, const KeepDryConfig& config)
+{
+    adc_continuous_stop(adc);
+    adc_continuous_deinit(adc);
+    s_state = {};
+    s_state.magic = kMagic;
+    s_state.config = config;
+    s_state.thresholds = keep_dry_thresholds(config.material, config.vapour_pressure, config.correction);
+    const auto& kinetics = material_kinetics(config.material);
+    ESP_LOGI(TAG, "Keeping the %s under %.0f%% relative humidity: holding the chamber above %.1f C", kinetics.name,
+             s_state.thresholds.humidity, s_state.thresholds.hold);
+    sleep(0, true);
+}
+
+void keep_dry_resume()
+{
+    if (esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_ULP || s_state.magic != kMagic) {
+        // Its conversions would share ADC1 with the continuous driver's, and it could go on waking the CPUs.
+        ulp_timer_stop();
+        if (s_state.magic == kMagic) {
+            release_heater();
+        }
+        s_state.magic = 0;
+        return;
+    }
+    const uint32_t woke_ms = pdTICKS_TO_MS(xTaskGetTickCount());
+    auto& config = s_state.config;
+    auto& stats = s_state.stats;
+    const uint16_t runs = ulp_word(kRunsWord);
+    const auto reason = WakeReason(ulp_word(kReasonWord));
+    // The countdown goes on while the CPUs are awake, past zero if nothing wakes them then.
+    const uint16_t countdown = ulp_word(kCountdownWord);
+    const bool check = reason == WakeReason::Check || countdown == 0 || countdown > kCheckRuns;
+    stats.ulp_runs += runs;
+    stats.asleep_ms += uint64_t(runs) * kUlpPeriodMs;
+    ++stats.wakes;
+
+    if (check && config.sda_gpio >= 0) {
+        // The sensor restarts its periodic measurement on begin().
+        ReferenceSensor reference;
+        float temperature;
+        float humidity;
+        if (reference.begin(config.sda_gpio, config.scl_gpio) == ESP_OK) {
+            vTaskDelay(pdMS_TO_TICKS(kReferenceStartMs));
+            if (reference.read(temperature, humidity)) {
+                config.vapour_pressure = vapour_pressure(temperature, humidity);
+                s_state.thresholds = keep_dry_thresholds(config.material, config.vapour_pressure, config.correction);
+                ESP_LOGI(TAG, "Chamber at %.1f C and %.1f%% relative humidity: holding above %.1f C", temperature,
+                         humidity, s_state.thresholds.hold);
+            }
+        }
+    }
+
+    const uint16_t code = ulp_word(kCodeWord);
+    const float temperature = code_temperature(code, config.correction);
+    if (railed(code) || code <= kRailMargin) {
+        ESP_LOGE(TAG, "Thermistor reads code %" PRIu16 ", not heating", code);
+    } else if (temperature < s_state.thresholds.hold) {
+        const uint32_t seconds = burst();
+        ++stats.bursts;
+        stats.burst_s += seconds;
+        ESP_LOGI(TAG, "Heated from %.1f C to %.1f C in %" PRIu32 " s", temperature,
+                 code_temperature(ulp_word(kCodeWord), config.correction), seconds);
+    }
+    sleep(pdTICKS_TO_MS(xTaskGetTickCount()) - woke_ms + kBootMs, check);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <driver/gpio.h>
+#include <esp_adc/adc_continuous.h>
+
+#include "conversion.hpp"
+#include "moisture_model.hpp"
+
+// Deep sleep with the ULP coprocessor watching the thermistor while a dried spool is stored (keep_dry.hpp).
+//
+// The ULP samples the thermistor on ADC1 every kUlpPeriodMs and wakes the CPUs when the chamber reads colder than
+// the hold temperature, or every kKeepDryCheckS for a humidity reading. The CPUs boot, run a heater burst or take
+// the reading, log what keeping dry has cost in supply current so far and go back to sleep; the state that carries
+// over lives in RTC memory. The SHT3x's I2C pins aren't RTC GPIOs, so the humidity can only be read awake.
+struct KeepDryConfig
+{
+    Material material = Material::None;
+    TemperatureCorrection correction{};
+    // Of the chamber air, kPa, or NAN without a humidity reading.
+    float vapour_pressure = NAN;
+    gpio_num_t heater_gpio = GPIO_NUM_NC;
+    adc_channel_t thermistor = ADC_CHANNEL_0;
+    // The reference sensor's I2C pins, or -1 without one.
+    int sda_gpio = -1;
+    int scl_gpio = -1;
+};
+
+// Stops and frees the continuous ADC, which the ULP's conversions take over, switches the heater off and sleeps.
+[[noreturn]] void keep_dry_enter(adc_continuous_handle_t adc, const KeepDryConfig& config);
+
+// To be called early on every boot, before the continuous ADC starts. After a wakeup by the ULP, resumes keeping dry
+// and doesn't return. Any other boot, such as a reset mid-burst, which leaves RTC memory and the ULP running, ends
+// keeping dry: the ULP stops, the heater's pin is let go and the call returns for a normal boot.
+void keep_dry_resume();
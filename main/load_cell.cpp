@@ -0,0 +1,100 @@
+#include "load_cell.hpp"
+
+#include <driver/gpio.h>
+#include <esp_log.h>
+
+#include <algorithm>
+
+constexpr const char* TAG = "load_cell";
+
+constexpr auto kSpiHost = SPI2_HOST;
+// A pulse is high for 1 us, well inside the HX711's 0.2 to 50 us.
+constexpr int kClockHz = 1'000'000;
+// The ends of the range, where the HX711 clips an overload or a broken bridge wire.
+constexpr int32_t kMinCode = -0x800000;
+constexpr int32_t kMaxCode = 0x7fffff;
+
+void hx711_pulses(uint8_t (&tx)[LoadCell::kTransferBytes])
+{
+    for (size_t i = 0; i < LoadCell::kTransferBytes; ++i) {
+        tx[i] = 0;
+    }
+    for (size_t pulse = 0; pulse < LoadCell::kPulses; ++pulse) {
+        tx[pulse / 4] |= 0x80 >> (pulse % 4 * 2);
+    }
+}
+
+int32_t hx711_decode(const uint8_t (&rx)[LoadCell::kTransferBytes])
+{
+    uint32_t value = 0;
+    for (size_t bit = 0; bit < 24; ++bit) {
+        value = value << 1 | ((rx[bit / 4] >> (7 - bit % 4 * 2)) & 1);
+    }
+    return int32_t(value << 8) >> 8;
+}
+
+esp_err_t LoadCell::begin(int dout_gpio, int sck_gpio)
+{
+    spi_bus_config_t bus_config{};
+    bus_config.mosi_io_num = sck_gpio;
+    bus_config.miso_io_num = dout_gpio;
+    bus_config.sclk_io_num = -1;
+    bus_config.quadwp_io_num = -1;
+    bus_config.quadhd_io_num = -1;
+    bus_config.max_transfer_sz = kTransferBytes;
+    esp_err_t err = spi_bus_initialize(kSpiHost, &bus_config, SPI_DMA_DISABLED);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set up SPI for the load cell: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    // Mode 0 samples MISO on the rising SPI clock edge, mid-way through each MOSI bit. Between transfers MOSI holds
+    // the last bit, a 0, which keeps the HX711 powered up.
+    spi_device_interface_config_t device_config{};
+    device_config.mode = 0;
+    device_config.clock_speed_hz = kClockHz;
+    device_config.spics_io_num = -1;
+    device_config.queue_size = 1;
+    err = spi_bus_add_device(kSpiHost, &device_config, &device_);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to add the load cell: %s", esp_err_to_name(err));
+        spi_bus_free(kSpiHost);
+        device_ = nullptr;
+        return err;
+    }
+    // Without an HX711 the pin would float; pulled up it reads as never ready.
+    gpio_set_pull_mode(static_cast<gpio_num_t>(dout_gpio), GPIO_PULLUP_ONLY);
+    dout_gpio_ = dout_gpio;
+    hx711_pulses(tx_);
+    return ESP_OK;
+}
+
+bool LoadCell::read(int32_t& counts)
+{
+    if (device_ == nullptr) {
+        return false;
+    }
+    bool got = false;
+    if (pending_) {
+        spi_transaction_t* done = nullptr;
+        if (spi_device_get_trans_result(device_, &done, 0) != ESP_OK) {
+            return false;
+        }
+        pending_ = false;
+        counts = hx711_decode(rx_);
+        got = counts != kMinCode && counts != kMaxCode;
+    }
+
+    // DOUT goes low when a conversion is ready, and high again as the first pulse clocks it out.
+    if (gpio_get_level(static_cast<gpio_num_t>(dout_gpio_)) != 0) {
+        not_ready_ = std::min(not_ready_ + 1, kMissingAfterPolls);
+        return got;
+    }
+    not_ready_ = 0;
+    transaction_ = {};
+    transaction_.length = kTransferBits;
+    transaction_.tx_buffer = tx_;
+    transaction_.rx_buffer = rx_;
+    pending_ = spi_device_queue_trans(device_, &transaction_, 0) == ESP_OK;
+    return got;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <driver/spi_master.h>
+#include <esp_err.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// HX711 load cell amplifier, clocked by an SPI peripheral so the bit timing never holds up a task.
+//
+// The HX711's PD_SCK is wired to MOSI and its DOUT to MISO. Each PD_SCK pulse is a 1 bit then a 0 bit of MOSI, and
+// MISO is sampled in the middle of the 1 bit, when DOUT has settled after the rising edge: 25 pulses read the 24
+// data bits and select channel A at a gain of 128 for the next conversion. SCLK goes to no pin.
+class LoadCell
+{
+public:
+    static constexpr size_t kPulses = 25;
+    static constexpr size_t kTransferBits = 2 * kPulses;
+    static constexpr size_t kTransferBytes = (kTransferBits + 7) / 8;
+    // Conversions come at 10 per second; a cell not ready for this long is missing or powered down.
+    static constexpr uint32_t kMissingAfterPolls = 10;
+
+    esp_err_t begin(int dout_gpio, int sck_gpio);
+
+    // Collects the conversion started by the previous call, if it's in, and starts the next one if the HX711 has one
+    // ready. Never waits; returns true with a new reading in `counts`.
+    bool read(int32_t& counts);
+    // No conversion was ready for kMissingAfterPolls calls in a row.
+    bool missing() const { return not_ready_ >= kMissingAfterPolls; }
+
+private:
+    spi_device_handle_t device_ = nullptr;
+    int dout_gpio_ = -1;
+    spi_transaction_t transaction_{};
+    bool pending_ = false;
+    uint32_t not_ready_ = 0;
+    uint8_t tx_[kTransferBytes] = {};
+    uint8_t rx_[kTransferBytes] = {};
+};
+
+// The PD_SCK pulse train of one read, as MOSI bits.
+void hx711_pulses(uint8_t (&tx)[LoadCell::kTransferBytes]);
+// The signed 24-bit conversion in the MISO bits of one read.
+int32_t hx711_decode(const uint8_t (&rx)[LoadCell::kTransferBytes]);
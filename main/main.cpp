@@ -1,12 +1,56 @@
+#include <driver/gpio.h>
 #include <esp_adc/adc_continuous.h>
 #include <esp_log.h>
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 
+#include <cinttypes>
+#include <cmath>
 #include <ranges>
 #include <numeric>
+#include <algorithm>
 #include <array>
+#include <span>
+
+#include "dryer.hpp"
+#if CONFIG_DRYER_INPUT_RECORDING
+#include "flash_history.hpp"
+#endif
+#if CONFIG_DRYER_SNAPSHOT
+#include "flash_snapshots.hpp"
+#endif
+#if CONFIG_DRYER_SCOPE
+#include <atomic>
+
+#include "scope.hpp"
+#endif
+#if CONFIG_DRYER_TELEMETRY
+#include <driver/uart.h>
+
+#include "telemetry.hpp"
+#endif
+#if CONFIG_DRYER_REFERENCE_SENSOR
+#include <nvs.h>
+#include <nvs_flash.h>
+
+#include "reference_sensor.hpp"
+#include "self_calibration.hpp"
+#endif
+#if CONFIG_DRYER_LOAD_CELL
+#include "load_cell.hpp"
+#endif
+#if CONFIG_DRYER_MATH_BENCH
+#include "math_bench.hpp"
+#endif
+#if CONFIG_DRYER_VENT
+#include "vent_actuator.hpp"
+#include "vent_controller.hpp"
+#endif
+#if CONFIG_DRYER_KEEP_DRY
+#include "keep_dry_sleep.hpp"
+#include "psychrometrics.hpp"
+#endif
 
 constexpr const char* TAG = "main";
 
@@ -17,6 +61,92 @@ constexpr uint32_t kAdcSampleReadSize = kAdcSamplesToRead * SOC_ADC_DIGI_RESULT_
 constexpr auto kAdcBitWidth = ADC_BITWIDTH_10;
 constexpr auto kAdcUnit = ADC_UNIT_1;
 constexpr auto kAdcChannel = ADC_CHANNEL_6;
+constexpr auto kHeaterGpio = GPIO_NUM_25;
+constexpr uint32_t kAdcMaxCode = (1u << kAdcResolutionBits) - 1;
+// Frames with fewer valid samples than this are discarded as corrupt.
+constexpr uint32_t kAdcMinValidSamples = kAdcSamplesToRead / 2;
+// Without a usable frame for this long the heater is switched off.
+constexpr uint32_t kSensorTimeoutMs = 3000;
+constexpr uint32_t kAdcRetryDelayMs = 1000;
+constexpr auto kMaterial = static_cast<Material>(CONFIG_DRYER_MATERIAL);
+
+#if CONFIG_DRYER_TELEMETRY
+constexpr auto kTelemetryUart = static_cast<uart_port_t>(CONFIG_DRYER_TELEMETRY_UART_NUM);
+// The driver's minimum receive buffer; nothing is received. The transmit buffer holds ten frames, so sending never
+// waits for the wire.
+constexpr int kTelemetryRxBufferSize = 256;
+constexpr int kTelemetryTxBufferSize = 10 * kTelemetryFrameSize;
+#endif
+
+// Chamber sensors in the order Dryer's consistency monitor numbers them.
+constexpr const char* kSensorNames[ConsistencyMonitor::kMaxSensors] = {"thermistor", "reference", "sensor 2",
+                                                                       "sensor 3"};
+
+#if CONFIG_DRYER_REFERENCE_SENSOR
+// Dryer's auxiliary sensor number of the reference sensor.
+constexpr size_t kReferenceSensor = 0;
+constexpr const char* kCalibrationNamespace = "dryer";
+constexpr const char* kCalibrationKey = "calibration";
+// Refinements come every few minutes during a soak; saving at most this often spares the flash.
+constexpr uint32_t kCalibrationSaveIntervalMs = 30 * 60'000;
+#endif
+
+#if CONFIG_DRYER_LOAD_CELL
+constexpr float kLoadCellZero = CONFIG_DRYER_LOAD_CELL_ZERO;
+constexpr float kLoadCellCountsPerGram = CONFIG_DRYER_LOAD_CELL_COUNTS_PER_KG / 1000.0f;
+#endif
+
+#if CONFIG_DRYER_SNAPSHOT
+static_assert(CONFIG_DRYER_SNAPSHOT_PRE_S + CONFIG_DRYER_SNAPSHOT_POST_S < kSnapshotSteps,
+              "a snapshot holds at most kSnapshotSteps steps with the trigger's");
+constexpr uint8_t kSnapshotTriggers = 0
+#if CONFIG_DRYER_SNAPSHOT_FAULT
+                                      | kSnapshotFault
+#endif
+#if CONFIG_DRYER_SNAPSHOT_DOOR
+                                      | kSnapshotDoor
+#endif
+#if CONFIG_DRYER_SNAPSHOT_OSCILLATION
+                                      | kSnapshotOscillation
+#endif
+    ;
+#endif
+
+#if CONFIG_DRYER_SCOPE
+static_assert(CONFIG_DRYER_SCOPE_PRE_SAMPLES < CONFIG_DRYER_SCOPE_SAMPLES, "a capture needs samples after its trigger");
+static_assert(CONFIG_DRYER_SCOPE_SAMPLE_RATE >= SOC_ADC_SAMPLE_FREQ_THRES_LOW &&
+              CONFIG_DRYER_SCOPE_SAMPLE_RATE <= SOC_ADC_SAMPLE_FREQ_THRES_HIGH, "scope sample rate out of range");
+constexpr ScopeConfig kScopeConfig{static_cast<ScopeTrigger>(CONFIG_DRYER_SCOPE_TRIGGER), CONFIG_DRYER_SCOPE_LEVEL,
+                                   CONFIG_DRYER_SCOPE_SAMPLE_RATE, CONFIG_DRYER_SCOPE_PRE_SAMPLES};
+constexpr uint32_t kScopeIntervalMs = CONFIG_DRYER_SCOPE_INTERVAL_S * 1000;
+#if CONFIG_DRYER_SCOPE_ON_RELAY
+constexpr bool kScopeOnRelay = true;
+#else
+constexpr bool kScopeOnRelay = false;
+#endif
+// A capture that hasn't triggered this long after starting is abandoned.
+constexpr uint32_t kScopeTimeoutMs = 200;
+// At 115200 baud each line takes about 10 ms to leave, all of it spent in the control loop.
+constexpr int kScopeLinesPerStep = 4;
+
+// Frames the driver has dropped from a full pool. Only counted during a capture: between control steps the pool
+// overflows all the time, by design.
+static std::atomic<uint32_t> s_pool_overflows;
+#endif
+
+#if CONFIG_DRYER_KEEP_DRY
+constexpr uint32_t kKeepDryDelayMs = CONFIG_DRYER_KEEP_DRY_DELAY_MIN * 60'000;
+#if CONFIG_DRYER_SNAPSHOT
+// Erasing and programming a slot takes well under this; deep sleep would cut the write short.
+constexpr uint32_t kSnapshotSyncTimeoutMs = 5000;
+#endif
+#endif
+
+#if CONFIG_DRYER_VENT
+static_assert(CONFIG_DRYER_VENT_CLOSED_US != CONFIG_DRYER_VENT_OPEN_US, "the vent's ends need different pulse widths");
+#endif
+
+static_assert(kAdcBitWidth == kAdcResolutionBits, "conversion curves are fitted for this ADC resolution");
 
 static_assert(kAdcSampleRate >= SOC_ADC_SAMPLE_FREQ_THRES_LOW && kAdcSampleRate <= SOC_ADC_SAMPLE_FREQ_THRES_HIGH, "ADC sample rate out of range");
 
@@ -29,16 +159,18 @@ static bool continuous_adc_done_callback(adc_continuous_handle_t handle, const a
     return mustYield == pdTRUE;
 }
 
-static adc_continuous_handle_t continuous_adc_init()
+#if CONFIG_DRYER_SCOPE
+static bool continuous_adc_overflow_callback(adc_continuous_handle_t handle, const adc_continuous_evt_data_t* edata,
+                                             void* user_data)
 {
-    adc_continuous_handle_t handle = nullptr;
-
-    adc_continuous_handle_cfg_t adc_config{};
-    adc_config.max_store_buf_size = kAdcBufferSize;
-    adc_config.conv_frame_size = kAdcSampleReadSize;
-    adc_config.flags.flush_pool = 1;
-    ESP_ERROR_CHECK(adc_continuous_new_handle(&adc_config, &handle));
+    s_pool_overflows.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+#endif
 
+// Converts the thermistor channel alone at `sample_rate`; only while the ADC is stopped.
+static esp_err_t continuous_adc_configure(adc_continuous_handle_t handle, uint32_t sample_rate)
+{
     adc_digi_pattern_config_t adc_pattern[SOC_ADC_PATT_LEN_MAX] = {};
     adc_pattern[0].atten = ADC_ATTEN_DB_12;
     adc_pattern[0].channel = kAdcChannel;
@@ -48,30 +180,333 @@ static adc_continuous_handle_t continuous_adc_init()
     adc_continuous_config_t dig_cfg = {
         .pattern_num = 1,
         .adc_pattern = adc_pattern,
-        .sample_freq_hz = kAdcSampleRate,
+        .sample_freq_hz = sample_rate,
         .conv_mode = ADC_CONV_SINGLE_UNIT_1,
         .format = ADC_DIGI_OUTPUT_FORMAT_TYPE1,
     };
+    return adc_continuous_config(handle, &dig_cfg);
+}
+
+static adc_continuous_handle_t continuous_adc_init()
+{
+    adc_continuous_handle_t handle = nullptr;
+
+    adc_continuous_handle_cfg_t adc_config{};
+    adc_config.max_store_buf_size = kAdcBufferSize;
+    adc_config.conv_frame_size = kAdcSampleReadSize;
+    adc_config.flags.flush_pool = 1;
+    esp_err_t err = adc_continuous_new_handle(&adc_config, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create ADC handle: %s", esp_err_to_name(err));
+        return nullptr;
+    }
 
-    ESP_ERROR_CHECK(adc_continuous_config(handle, &dig_cfg));
+    err = continuous_adc_configure(handle, kAdcSampleRate);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to configure ADC: %s", esp_err_to_name(err));
+        adc_continuous_deinit(handle);
+        return nullptr;
+    }
 
     return handle;
 }
 
-extern "C" void app_main()
+#if CONFIG_DRYER_SCOPE
+// Captures the thermistor line at the scope's rate, calling `arm` once the pre-trigger window is full, then puts the
+// ADC back to the control rate. `arm` is called even if the window never fills. Holds the control loop up for the
+// capture and at most kScopeTimeoutMs in all, and sets `held_ms` to how long it did. Returns the error that kept the
+// ADC from running at the control rate again, if any.
+template <typename Arm>
+static esp_err_t run_scope(adc_continuous_handle_t handle, ScopeCapture& scope, Arm&& arm, uint32_t& held_ms)
 {
-    auto adc_handle = continuous_adc_init();
-    assert(adc_handle != nullptr);
+    const TickType_t started = xTaskGetTickCount();
+    bool armed = false;
+    esp_err_t err = adc_continuous_stop(handle);
+    if (err == ESP_OK) {
+        err = continuous_adc_configure(handle, kScopeConfig.sample_rate_hz);
+    }
+    if (err == ESP_OK) {
+        err = adc_continuous_start(handle);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to start a scope capture: %s", esp_err_to_name(err));
+    } else {
+        scope.start();
+        uint32_t overflows = s_pool_overflows.load(std::memory_order_relaxed);
+        while (scope.capturing()) {
+            if (xTaskGetTickCount() - started >= pdMS_TO_TICKS(kScopeTimeoutMs)) {
+                ESP_LOGW(TAG, "No %s scope trigger at %u codes within %" PRIu32 " ms",
+                         scope_trigger_name(kScopeConfig.trigger), unsigned(kScopeConfig.level), kScopeTimeoutMs);
+                scope.cancel();
+                break;
+            }
+            // A frame takes well under a tick at the scope's rate; the timeout only matters if conversions stall.
+            ulTaskNotifyTake(pdTRUE, 1);
 
-    auto main_task = xTaskGetCurrentTaskHandle();
+            static std::array<adc_digi_output_data_t, kAdcSamplesToRead> readings;
+            static std::array<uint16_t, kAdcSamplesToRead> samples;
+            uint32_t ret_bytes = 0;
+            while (scope.capturing() && adc_continuous_read(handle, reinterpret_cast<uint8_t*>(readings.data()),
+                                                            sizeof(readings), &ret_bytes, 0) == ESP_OK) {
+                const uint32_t now_overflows = s_pool_overflows.load(std::memory_order_relaxed);
+                uint32_t lost = (now_overflows - overflows) * kAdcSamplesToRead;
+                overflows = now_overflows;
+                size_t count = 0;
+                for (const auto& reading : std::span(readings.data(), ret_bytes / sizeof(readings[0]))) {
+                    if (reading.type1.channel == kAdcChannel && reading.type1.data <= kAdcMaxCode) {
+                        samples[count++] = reading.type1.data;
+                    } else {
+                        ++lost;
+                    }
+                }
+                scope.feed(std::span(samples.data(), count), lost);
+                if (!armed && scope.armed()) {
+                    arm();
+                    armed = true;
+                }
+            }
+        }
+    }
+    if (!armed) {
+        arm();
+    }
+
+    // Back to the control rate whatever happened; the loop has nothing to go on without it.
+    adc_continuous_stop(handle);
+    err = continuous_adc_configure(handle, kAdcSampleRate);
+    if (err == ESP_OK) {
+        err = adc_continuous_start(handle);
+    }
+    held_ms = pdTICKS_TO_MS(xTaskGetTickCount() - started);
+    return err;
+}
+#endif
+
+// Creates and starts the ADC, with `main_task` to notify of frames. The heater stays off until it is running,
+// however long that takes.
+static adc_continuous_handle_t continuous_adc_start(TaskHandle_t* main_task)
+{
+    adc_continuous_handle_t handle;
+    while ((handle = continuous_adc_init()) == nullptr) {
+        vTaskDelay(pdMS_TO_TICKS(kAdcRetryDelayMs));
+    }
 
     adc_continuous_evt_cbs_t adc_cbs = {
         .on_conv_done = continuous_adc_done_callback,
+#if CONFIG_DRYER_SCOPE
+        .on_pool_ovf = continuous_adc_overflow_callback
+#else
         .on_pool_ovf = nullptr
+#endif
     };
 
-    ESP_ERROR_CHECK(adc_continuous_register_event_callbacks(adc_handle, &adc_cbs, &main_task));
-    ESP_ERROR_CHECK(adc_continuous_start(adc_handle));
+    ESP_ERROR_CHECK(adc_continuous_register_event_callbacks(handle, &adc_cbs, main_task));
+    ESP_ERROR_CHECK(adc_continuous_start(handle));
+    return handle;
+}
+
+static void heater_init()
+{
+    gpio_config_t io_conf{};
+    io_conf.pin_bit_mask = 1ULL << kHeaterGpio;
+    io_conf.mode = GPIO_MODE_OUTPUT;
+    ESP_ERROR_CHECK(gpio_set_level(kHeaterGpio, 0));
+    ESP_ERROR_CHECK(gpio_config(&io_conf));
+}
+
+#if CONFIG_DRYER_TELEMETRY
+static bool telemetry_init()
+{
+    uart_config_t config{};
+    config.baud_rate = CONFIG_DRYER_TELEMETRY_BAUD_RATE;
+    config.data_bits = UART_DATA_8_BITS;
+    config.parity = UART_PARITY_DISABLE;
+    config.stop_bits = UART_STOP_BITS_1;
+    config.flow_ctrl = UART_HW_FLOWCTRL_DISABLE;
+    config.source_clk = UART_SCLK_DEFAULT;
+
+    esp_err_t err = uart_driver_install(kTelemetryUart, kTelemetryRxBufferSize, kTelemetryTxBufferSize, 0, nullptr, 0);
+    if (err == ESP_OK) {
+        err = uart_param_config(kTelemetryUart, &config);
+    }
+    if (err == ESP_OK) {
+        err = uart_set_pin(kTelemetryUart, CONFIG_DRYER_TELEMETRY_TX_GPIO, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE,
+                           UART_PIN_NO_CHANGE);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set up telemetry UART, running without telemetry: %s", esp_err_to_name(err));
+        return false;
+    }
+    return true;
+}
+
+static void send_telemetry(const DryerStatus& status)
+{
+    static const bool ready = telemetry_init();
+    static uint32_t sequence = 0;
+    if (ready) {
+        uint8_t frame[kTelemetryFrameSize];
+        const size_t size = encode_telemetry(frame, CONFIG_DRYER_DEVICE_ID, sequence++, status);
+        uart_write_bytes(kTelemetryUart, frame, size);
+    }
+}
+#endif
+
+static void log_drift(const ConsistencyMonitor& monitor, uint8_t was)
+{
+    for (size_t sensor = 0; sensor < ConsistencyMonitor::kMaxSensors; ++sensor) {
+        if (monitor.drifting(sensor) == bool((was >> sensor) & 1)) {
+            continue;
+        }
+        if (!monitor.drifting(sensor)) {
+            ESP_LOGI(TAG, "The %s agrees with the other sensors again", kSensorNames[sensor]);
+            continue;
+        }
+        for (size_t other = 0; other < ConsistencyMonitor::kMaxSensors; ++other) {
+            const auto& pair = monitor.pair(std::min(sensor, other), std::max(sensor, other));
+            if (other != sensor && pair.inconsistent) {
+                ESP_LOGW(TAG, "The %s is drifting: %.2f C from the %s, down-weighted", kSensorNames[sensor],
+                         sensor < other ? pair.mean : -pair.mean, kSensorNames[other]);
+            }
+        }
+    }
+}
+
+#if CONFIG_DRYER_REFERENCE_SENSOR
+static bool load_calibration(CalibrationRefiner& refiner)
+{
+    esp_err_t err = nvs_flash_init();
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        // The NVS partition is full or from a newer layout; start it afresh.
+        err = nvs_flash_erase();
+        if (err == ESP_OK) {
+            err = nvs_flash_init();
+        }
+    }
+    nvs_handle_t handle;
+    if (err == ESP_OK) {
+        err = nvs_open(kCalibrationNamespace, NVS_READWRITE, &handle);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS, calibration won't persist: %s", esp_err_to_name(err));
+        return false;
+    }
+    CalibrationState state;
+    size_t size = sizeof(state);
+    err = nvs_get_blob(handle, kCalibrationKey, &state, &size);
+    nvs_close(handle);
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        return false;
+    }
+    if (err != ESP_OK || size != sizeof(state) || !refiner.restore(state)) {
+        ESP_LOGW(TAG, "Ignoring stored calibration: %s", err != ESP_OK ? esp_err_to_name(err) : "invalid");
+        return false;
+    }
+    return true;
+}
+
+static void save_calibration(const CalibrationRefiner& refiner)
+{
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(kCalibrationNamespace, NVS_READWRITE, &handle);
+    if (err == ESP_OK) {
+        const CalibrationState state = refiner.state();
+        err = nvs_set_blob(handle, kCalibrationKey, &state, sizeof(state));
+        if (err == ESP_OK) {
+            err = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to save calibration: %s", esp_err_to_name(err));
+    }
+}
+
+static void log_correction(const char* what, const CalibrationRefiner& refiner)
+{
+    const auto& k = refiner.correction();
+    ESP_LOGI(TAG, "%s thermistor correction: offset %.3f, gain %.5f, curvature %.7f (%" PRIu32 " samples)", what,
+             k.offset, k.gain, k.curvature, refiner.samples());
+}
+#endif
+
+extern "C" void app_main()
+{
+    heater_init();
+#if CONFIG_DRYER_KEEP_DRY
+    keep_dry_resume();
+#endif
+#if CONFIG_DRYER_MATH_BENCH
+    run_math_bench();
+#endif
+    static Dryer dryer;
+    if (kMaterial != Material::None) {
+        const auto& kinetics = material_kinetics(kMaterial);
+        DryingProfile profile;
+        profile.setpoint = kinetics.temperature;
+        profile.material = kMaterial;
+        dryer.start(profile);
+        ESP_LOGI(TAG, "Drying %s at %.0f C until it is down to %.2f%% moisture", kinetics.name, kinetics.temperature,
+                 kinetics.target);
+    }
+
+#if CONFIG_DRYER_INPUT_RECORDING
+    static FlashHistory history;
+    history.begin(pdTICKS_TO_MS(xTaskGetTickCount()), dryer.profile());
+#endif
+
+#if CONFIG_DRYER_SNAPSHOT
+    static SnapshotRecorder snapshots({kSnapshotTriggers, CONFIG_DRYER_SNAPSHOT_PRE_S, CONFIG_DRYER_SNAPSHOT_POST_S});
+    static FlashSnapshots snapshot_flash;
+    const bool snapshotting = snapshot_flash.begin(snapshots) == ESP_OK;
+#endif
+
+#if CONFIG_DRYER_SCOPE
+    static std::array<uint16_t, CONFIG_DRYER_SCOPE_SAMPLES> scope_samples;
+    static ScopeCapture scope(kScopeConfig, scope_samples);
+    uint32_t scope_ms = pdTICKS_TO_MS(xTaskGetTickCount());
+#endif
+
+#if CONFIG_DRYER_REFERENCE_SENSOR
+    static CalibrationRefiner refiner;
+    static ReferenceSensor reference;
+    uint32_t calibration_saved_ms = pdTICKS_TO_MS(xTaskGetTickCount());
+    bool calibration_dirty = false;
+    if (load_calibration(refiner)) {
+        dryer.set_correction(refiner.correction());
+#if CONFIG_DRYER_INPUT_RECORDING
+        history.record_correction(calibration_saved_ms, refiner.correction());
+#endif
+        log_correction("Stored", refiner);
+    }
+    reference.begin(CONFIG_DRYER_REFERENCE_SDA_GPIO, CONFIG_DRYER_REFERENCE_SCL_GPIO);
+#endif
+
+#if CONFIG_DRYER_LOAD_CELL
+    static LoadCell load_cell;
+    load_cell.begin(CONFIG_DRYER_LOAD_CELL_DOUT_GPIO, CONFIG_DRYER_LOAD_CELL_SCK_GPIO);
+    bool load_cell_missing = false;
+    uint32_t scale_loads = 0;
+#endif
+
+#if CONFIG_DRYER_VENT
+    // Fully open, like a stock dehydrator's vent, until the controller knows better.
+    static VentActuator vent;
+    static VentController vent_controller({.heater_power = CONFIG_DRYER_HEATER_POWER_W});
+    vent.begin(CONFIG_DRYER_VENT_GPIO, CONFIG_DRYER_VENT_CLOSED_US, CONFIG_DRYER_VENT_OPEN_US,
+               vent_controller.opening());
+    uint32_t vent_step_ms = pdTICKS_TO_MS(xTaskGetTickCount());
+#endif
+
+    auto main_task = xTaskGetCurrentTaskHandle();
+    adc_continuous_handle_t adc_handle = continuous_adc_start(&main_task);
+
+    uint32_t last_valid_ms = pdTICKS_TO_MS(xTaskGetTickCount());
+#if CONFIG_DRYER_KEEP_DRY
+    uint32_t running_ms = last_valid_ms;
+#endif
+    uint32_t corrupt_frames = 0;
+    uint8_t drifting = 0;
 
     while(1) {
         /**
@@ -79,45 +514,269 @@ extern "C" void app_main()
          * This `ulTaskNotifyTake` will block when the data processing in the task is fast.
          * However in this example, the data processing (print) is slow, so you barely block here.
          *
-         * Without using this event callback (to notify this task), you can still just call
-         * `adc_continuous_read()` here in a loop, with/without a certain block timeout.
+         * The timeout keeps the sensor watchdog below running when notifications stop; the pool is read either way.
          */
-        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(kSensorTimeoutMs / 2));
 
+        // Drain the pool and act on the newest valid frame only, so frames left behind when conversions stall are
+        // never mistaken for fresh readings.
+        uint32_t reading_count = 0;
+        uint32_t sum = 0;
+#if CONFIG_DRYER_SNAPSHOT
+        // Every valid frame drained, the newest last.
+        std::array<SnapshotBlock, kSnapshotBlocks> blocks;
+        size_t block_count = 0;
+#endif
         while (1) {
             uint32_t ret_bytes = 0;
             static std::array<adc_digi_output_data_t, kAdcSamplesToRead> readings;
 
             auto ret = adc_continuous_read(adc_handle, reinterpret_cast<uint8_t*>(readings.data()), sizeof(readings), &ret_bytes, 0);
             if (ret == ESP_OK) {
-                auto reading_count = ret_bytes / sizeof(readings[0]);
-                uint32_t avg = std::accumulate(readings.begin(), readings.begin() + reading_count, uint32_t{}, [](uint32_t accum, const adc_digi_output_data_t& reading)
-                {
-                    return accum + reading.type1.data;
-                });
+                // Samples from another channel or out of range for the bit width can only come from a corrupt frame.
+                uint32_t frame_count = 0;
+                uint32_t frame_sum = 0;
+                [[maybe_unused]] uint32_t frame_sum2 = 0;
+                for (const auto& reading : std::span(readings.data(), ret_bytes / sizeof(readings[0]))) {
+                    if (reading.type1.channel == kAdcChannel && reading.type1.data <= kAdcMaxCode) {
+                        frame_sum += reading.type1.data;
+#if CONFIG_DRYER_SNAPSHOT
+                        frame_sum2 += reading.type1.data * reading.type1.data;
+#endif
+                        ++frame_count;
+                    }
+                }
+                if (frame_count < kAdcMinValidSamples) {
+                    ++corrupt_frames;
+                } else {
+                    reading_count = frame_count;
+                    sum = frame_sum;
+#if CONFIG_DRYER_SNAPSHOT
+                    if (block_count == blocks.size()) {
+                        std::shift_left(blocks.begin(), blocks.end(), 1);
+                        --block_count;
+                    }
+                    blocks[block_count++] = snapshot_block(frame_count, frame_sum, frame_sum2);
+#endif
+                }
+            } else {
+                if (ret != ESP_ERR_TIMEOUT) {
+                    ESP_LOGW(TAG, "ADC read failed: %s", esp_err_to_name(ret));
+                    vTaskDelay(pdMS_TO_TICKS(kAdcRetryDelayMs));
+                }
+                break;
+            }
+        }
 
-                avg /= reading_count;
+        if (reading_count != 0) {
+            const uint32_t avg = sum / reading_count;
+            const uint32_t now_ms = pdTICKS_TO_MS(xTaskGetTickCount());
+            last_valid_ms = now_ms;
+            if (corrupt_frames != 0) {
+                ESP_LOGW(TAG, "Discarded %" PRIu32 " corrupt ADC frames", corrupt_frames);
+                corrupt_frames = 0;
+            }
 
-                // Correct for non-lineararity in ESP32 ADC.
-                const float avg2 = avg * avg;
-                const float avg3 = avg2 * avg;
-                const float adc_corr = 40.4597f + 0.976323f*avg + 0.000163748f*avg2 - 1.76614e-7f*avg3;
+#if CONFIG_DRYER_VENT
+            float humidity = NAN;
+#endif
+#if CONFIG_DRYER_REFERENCE_SENSOR
+            float reference_temperature = NAN;
+            float reference_humidity;
+            if (reference.read(reference_temperature, reference_humidity)) {
+                dryer.set_auxiliary(kReferenceSensor, reference_temperature);
+                dryer.set_humidity(reference_humidity);
+#if CONFIG_DRYER_VENT
+                humidity = reference_humidity;
+#endif
+#if CONFIG_DRYER_INPUT_RECORDING
+                history.record_auxiliary(now_ms, kReferenceSensor, reference_temperature);
+                history.record_humidity(now_ms, reference_humidity);
+#endif
+            }
+#endif
 
-                // Calculate temperature based off calibration curve
-                const float adc_corr2 = adc_corr * adc_corr;
-                const float temp = 129.85f - 0.150499*adc_corr + 0.0000343308f*adc_corr2;
+#if CONFIG_DRYER_LOAD_CELL
+            int32_t counts;
+            if (load_cell.read(counts)) {
+                const float weight = (counts - kLoadCellZero) / kLoadCellCountsPerGram;
+                dryer.set_weight(weight);
+#if CONFIG_DRYER_INPUT_RECORDING
+                history.record_weight(now_ms, weight);
+#endif
+            }
+            if (load_cell.missing() != load_cell_missing) {
+                load_cell_missing = load_cell.missing();
+                if (load_cell_missing) {
+                    ESP_LOGW(TAG, "The load cell has stopped converting");
+                } else {
+                    ESP_LOGI(TAG, "The load cell is converting again");
+                }
+            }
+#endif
 
-                const float voltage = adc_corr * 3.3f / (1 << kAdcBitWidth);
+#if CONFIG_DRYER_INPUT_RECORDING
+            history.record_frame(now_ms, reading_count, sum);
+#endif
 
-                ESP_LOGI(TAG, "Avg reading: %lu corrected %lu (%.1f) [%.4fV]", avg, (uint32_t)adc_corr, temp, voltage);
+#if CONFIG_DRYER_SCOPE
+            const bool heater_was = dryer.status().heater_on;
+#endif
+            const auto& status = dryer.step(avg, now_ms);
+#if CONFIG_DRYER_SCOPE
+            // The relay switches once the capture is armed, so its spike lands after the pre-trigger window.
+            uint32_t scope_held_ms = 0;
+            if (!scope.streaming() && now_ms - scope_ms >= kScopeIntervalMs &&
+                (!kScopeOnRelay || status.heater_on != heater_was)) {
+                const esp_err_t err = run_scope(adc_handle, scope, [&] {
+                    ESP_ERROR_CHECK(gpio_set_level(kHeaterGpio, status.heater_on));
+                }, scope_held_ms);
+                scope_ms = now_ms;
+                if (err != ESP_OK) {
+                    // As at boot: the heater stays off until a fresh handle is running.
+                    ESP_LOGE(TAG, "Failed to restart the ADC after a scope capture: %s, heater off",
+                             esp_err_to_name(err));
+                    ESP_ERROR_CHECK(gpio_set_level(kHeaterGpio, 0));
+                    adc_continuous_stop(adc_handle);
+                    adc_continuous_deinit(adc_handle);
+                    adc_handle = continuous_adc_start(&main_task);
+                    continue;
+                }
+            }
+#endif
+            ESP_ERROR_CHECK(gpio_set_level(kHeaterGpio, status.heater_on));
+#if CONFIG_DRYER_SNAPSHOT
+            if (snapshotting && snapshots.record(status, std::span(blocks.data(), block_count))) {
+                snapshot_flash.flush();
+            }
+#endif
 
-                vTaskDelay(1000 / portTICK_PERIOD_MS);
-            } else if (ret == ESP_ERR_TIMEOUT) {
-                break;
+            char line[224];
+            format_status(line, sizeof(line), status);
+            ESP_LOGI(TAG, "%s", line);
+#if CONFIG_DRYER_TELEMETRY
+            send_telemetry(status);
+#endif
+#if CONFIG_DRYER_SCOPE
+            for (int i = 0; i < kScopeLinesPerStep && scope.format_line(line, sizeof(line)); ++i) {
+                ESP_LOGI(TAG, "%s", line);
+            }
+#endif
+
+#if CONFIG_DRYER_LOAD_CELL
+            if (dryer.scale().loaded() && dryer.scale().loads() != scale_loads) {
+                ESP_LOGI(TAG, "Spool on the scale: %.0f g", status.weight);
+                scale_loads = dryer.scale().loads();
+            }
+#endif
+
+#if CONFIG_DRYER_VENT
+            const float was = vent_controller.opening();
+            const float opening = vent_controller.update(dryer.moisture(), status.temperature, humidity, status.duty,
+                                                         status.phase == DryerPhase::Done,
+                                                         (now_ms - vent_step_ms) / 1000.0f);
+            vent_step_ms = now_ms;
+            if (opening != was) {
+                ESP_LOGI(TAG, "Vent %.0f%% open: spool giving off %.1f g/h, heater %.0f W", 100 * opening,
+                         vent_controller.evaporation(), vent_controller.power());
+            }
+            vent.move_to(opening, now_ms);
+#endif
+
+            if (dryer.monitor().drifting_mask() != drifting) {
+                log_drift(dryer.monitor(), drifting);
+                drifting = dryer.monitor().drifting_mask();
+            }
+
+#if CONFIG_DRYER_REFERENCE_SENSOR
+            // A reference that disagrees with everything else would teach the thermistor its error. It takes a third
+            // sensor to outvote it, though: with the thermistor alone, the monitor puts any disagreement on the
+            // thermistor, and a drifting reference pulls the correction along, as far as SelfCalibration's bounds.
+            if (dryer.monitor().drifting(kReferenceSensor + 1)) {
+                reference_temperature = NAN;
+            }
+            if (refiner.update(status, reference_temperature, now_ms)) {
+                dryer.set_correction(refiner.correction());
+#if CONFIG_DRYER_INPUT_RECORDING
+                history.record_correction(now_ms, refiner.correction());
+#endif
+                log_correction("Refined", refiner);
+                calibration_dirty = true;
+            }
+            if (calibration_dirty && now_ms - calibration_saved_ms >= kCalibrationSaveIntervalMs) {
+                save_calibration(refiner);
+                calibration_saved_ms = now_ms;
+                calibration_dirty = false;
+            }
+#endif
+
+#if CONFIG_DRYER_KEEP_DRY
+            // Sleeps only once the run has been over for a while, leaving time to take the spool out awake.
+            if (status.phase != DryerPhase::Done || kMaterial == Material::None) {
+                running_ms = now_ms;
+            } else if (now_ms - running_ms >= kKeepDryDelayMs) {
+#if CONFIG_DRYER_REFERENCE_SENSOR
+                if (calibration_dirty) {
+                    save_calibration(refiner);
+                }
+#endif
+                KeepDryConfig config;
+                config.material = kMaterial;
+                config.correction = dryer.correction();
+                config.vapour_pressure = std::isnan(status.dew_point) ? NAN : saturation_pressure(status.dew_point);
+                config.heater_gpio = kHeaterGpio;
+                config.thermistor = kAdcChannel;
+#if CONFIG_DRYER_REFERENCE_SENSOR
+                config.sda_gpio = CONFIG_DRYER_REFERENCE_SDA_GPIO;
+                config.scl_gpio = CONFIG_DRYER_REFERENCE_SCL_GPIO;
+#endif
+                // RAM doesn't survive deep sleep: the buffered input log and a snapshot being written would be lost.
+#if CONFIG_DRYER_INPUT_RECORDING
+                history.flush();
+#endif
+#if CONFIG_DRYER_SNAPSHOT
+                if (!snapshot_flash.sync(pdMS_TO_TICKS(kSnapshotSyncTimeoutMs))) {
+                    ESP_LOGW(TAG, "Sleeping with a snapshot still being written");
+                }
+#endif
+                keep_dry_enter(adc_handle, config);
+            }
+#endif
+
+#if CONFIG_DRYER_SCOPE
+            // Keeps the step a capture held up to the usual period.
+            vTaskDelay(pdMS_TO_TICKS(1000 - std::min<uint32_t>(scope_held_ms, 1000)));
+#else
+            vTaskDelay(1000 / portTICK_PERIOD_MS);
+#endif
+            continue;
+        }
+
+        const uint32_t now_ms = pdTICKS_TO_MS(xTaskGetTickCount());
+        if (now_ms - last_valid_ms >= kSensorTimeoutMs && !dryer.status().fault) {
+            ESP_LOGE(TAG, "No valid ADC frame for %" PRIu32 " ms, heater off", now_ms - last_valid_ms);
+#if CONFIG_DRYER_INPUT_RECORDING
+            history.record_sensor_timeout(now_ms);
+#endif
+            const auto& status = dryer.sensor_timeout(now_ms);
+            ESP_ERROR_CHECK(gpio_set_level(kHeaterGpio, 0));
+#if CONFIG_DRYER_TELEMETRY
+            send_telemetry(status);
+#endif
+        }
+#if CONFIG_DRYER_SNAPSHOT
+        // Steps go on through an outage, so a snapshot it triggered completes without the sensor.
+        if (snapshotting && now_ms - last_valid_ms >= kSensorTimeoutMs) {
+            DryerStatus status = dryer.status();
+            status.time_ms = now_ms;
+            if (snapshots.record(status, {}, true)) {
+                snapshot_flash.flush();
             }
         }
+#endif
     }
 
+    gpio_set_level(kHeaterGpio, 0);
     ESP_ERROR_CHECK(adc_continuous_stop(adc_handle));
     ESP_ERROR_CHECK(adc_continuous_deinit(adc_handle));
 }
\ No newline at end of file
@@ -0,0 +1,54 @@
+#include "math_bench.hpp"
+
+#include <esp_cpu.h>
+#include <esp_log.h>
+
+#include <cmath>
+
+#include "psychrometrics.hpp"
+
+constexpr const char* TAG = "math_bench";
+
+constexpr int kCalls = 10'000;
+
+// Where each loop's sum goes, so that none of the calls is optimised away.
+static volatile float s_sink;
+
+// Cycles per call of f over arguments spread across [low, high].
+template <typename F>
+static float cycles_per_call(F f, float low, float high)
+{
+    const float step = (high - low) / kCalls;
+    float sum = 0.0f;
+    const esp_cpu_cycle_count_t start = esp_cpu_get_cycle_count();
+    for (int i = 0; i < kCalls; ++i) {
+        sum += f(low + step * float(i));
+    }
+    const esp_cpu_cycle_count_t cycles = esp_cpu_get_cycle_count() - start;
+    s_sink = sum;
+    return float(cycles) / kCalls;
+}
+
+void run_math_bench()
+{
+    // The loop's own cost, subtracted from the rest.
+    const float loop = cycles_per_call([](float x) { return x; }, 0.0f, 100.0f);
+    auto net = [loop](float cycles) { return cycles - loop; };
+    const float log_fast = net(cycles_per_call([](float x) { return fast_log(x); }, 0.01f, 1000.0f));
+    const float log_libm = net(cycles_per_call([](float x) { return logf(x); }, 0.01f, 1000.0f));
+    const float exp_fast = net(cycles_per_call([](float x) { return fast_exp(x); }, -20.0f, 20.0f));
+    const float exp_libm = net(cycles_per_call([](float x) { return expf(x); }, -20.0f, 20.0f));
+    const float pressure_fast = net(cycles_per_call([](float t) { return saturation_pressure(t); }, 0.0f, 100.0f));
+    const float pressure_libm = net(cycles_per_call(
+        [](float t) { return kMagnusPressure * expf(kMagnusA * t / (t + kMagnusB)); }, 0.0f, 100.0f));
+    const float dew_fast = net(cycles_per_call([](float t) { return dew_point(t, 100.0f - 0.9f * t); }, 0.0f, 100.0f));
+    const float dew_libm = net(cycles_per_call(
+        [](float t) {
+            const float gamma = logf(1.0f - 0.009f * t) + kMagnusA * t / (t + kMagnusB);
+            return kMagnusB * gamma / (kMagnusA - gamma);
+        },
+        0.0f, 100.0f));
+    ESP_LOGI(TAG, "Cycles per call, fast / newlib: log %.0f / %.0f, exp %.0f / %.0f, saturation pressure %.0f / %.0f, "
+                  "dew point %.0f / %.0f",
+             log_fast, log_libm, exp_fast, exp_libm, pressure_fast, pressure_libm, dew_fast, dew_libm);
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+// Times fast_log, fast_exp and the psychrometrics against newlib on the running CPU and logs cycles per call, the
+// target side of host/psychrometrics.cpp. Takes some 100 ms at 160 MHz.
+void run_math_bench();
@@ -0,0 +1,144 @@
+#include "moisture_model.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+#include "psychrometrics.hpp"
+#include "spool_scale.hpp"
+
+// Load cell noise and drift over a run, g.
+constexpr float kWeightNoise = 1.0f;
+constexpr float kWeightIntervalS = 60.0f;
+constexpr float kForecastStepS = 120.0f;
+
+static constexpr MaterialKinetics kMaterials[] = {
+    {"none", 0.0f, 0.0f, 0.0f, 0.0f, 0.0f},
+    {"PLA", 50.0f, 0.6f, 0.35f, 0.1f, 0.5f},
+    {"PETG", 65.0f, 0.4f, 0.2f, 0.05f, 0.3f},
+    {"ABS", 65.0f, 1.0f, 0.4f, 0.1f, 0.3f},
+    {"ASA", 65.0f, 0.8f, 0.35f, 0.1f, 0.3f},
+    {"TPU", 50.0f, 1.0f, 0.6f, 0.15f, 0.4f},
+    {"nylon", 70.0f, 3.5f, 2.5f, 0.2f, 0.15f},
+    {"PC", 70.0f, 0.35f, 0.2f, 0.02f, 0.2f},
+    {"PVA", 50.0f, 6.0f, 4.0f, 1.0f, 0.3f},
+};
+static_assert(std::size(kMaterials) == size_t(Material::Count));
+
+const MaterialKinetics& material_kinetics(Material material)
+{
+    return kMaterials[material < Material::Count ? size_t(material) : 0];
+}
+
+// One shell over `dt`: the starting moisture decays and the rest relaxes towards the equilibrium with the air.
+static void dry_shell(const MaterialKinetics& k, float temperature, float vapour_pressure, float dt, float& decay,
+                      float& equilibrium)
+{
+    const float relative = std::min(1.0f, vapour_pressure / saturation_pressure(temperature));
+    const float rate = k.rate / 3600.0f *
+                       fast_exp(kKineticsActivation * (1.0f / (kKineticsReferenceTemperature + kKelvin) -
+                                                       1.0f / (temperature + kKelvin)));
+    const float f = fast_exp(-rate * dt);
+    const float target = k.saturation * relative;
+    decay *= f;
+    equilibrium = target + (equilibrium - target) * f;
+}
+
+void MoistureModel::start(Material material, float initial)
+{
+    *this = MoistureModel();
+    if (material == Material::None || material >= Material::Count) {
+        return;
+    }
+    kinetics_ = &material_kinetics(material);
+    std::fill(std::begin(decay_), std::end(decay_), 1.0f);
+    decay_mean_ = 1.0f;
+    initial_ = std::isnan(initial) ? kinetics_->initial : initial;
+    prior_ = initial_;
+    // A spool may have come out of a sealed bag or sat for months in damp air: the prior is loose.
+    prior_variance_ = initial_ * initial_;
+    variance_ = prior_variance_;
+    vapour_pressure_ = kRoomVapourPressure;
+}
+
+void MoistureModel::reset_weight()
+{
+    prior_ = initial_;
+    prior_variance_ = variance_;
+    first_weight_ = NAN;
+    weight_elapsed_s_ = 0.0f;
+}
+
+float MoistureModel::moisture() const
+{
+    if (!active()) {
+        return NAN;
+    }
+    return initial_ * decay_mean_ + equilibrium_mean_;
+}
+
+void MoistureModel::update(const SpoolModel& spool, float air, float humidity, float weight, float dt)
+{
+    if (!active() || !std::isfinite(air) || !spool.started()) {
+        return;
+    }
+    if (std::isfinite(humidity)) {
+        vapour_pressure_ = vapour_pressure(air, std::clamp(humidity, 0.0f, 100.0f));
+    }
+    decay_mean_ = 0.0f;
+    equilibrium_mean_ = 0.0f;
+    for (size_t i = 0; i < SpoolModel::kNodes; ++i) {
+        dry_shell(*kinetics_, spool.node(i), vapour_pressure_, dt, decay_[i], equilibrium_[i]);
+        decay_mean_ += spool.share(i) * decay_[i];
+        equilibrium_mean_ += spool.share(i) * equilibrium_[i];
+    }
+
+    if (!std::isfinite(weight)) {
+        return;
+    }
+    if (std::isnan(first_weight_)) {
+        first_weight_ = weight;
+        first_decay_ = decay_mean_;
+        first_equilibrium_ = equilibrium_mean_;
+        return;
+    }
+    weight_elapsed_s_ += dt;
+    if (weight_elapsed_s_ < kWeightIntervalS) {
+        return;
+    }
+    weight_elapsed_s_ = 0.0f;
+    // Weight lost since the first reading against what the model says left: both are linear in the starting
+    // moisture.
+    const float filament = std::max(first_weight_ - kEmptySpoolWeight, 100.0f) / 100.0f;
+    const float h = filament * (first_decay_ - decay_mean_);
+    const float z = first_weight_ - weight - filament * (first_equilibrium_ - equilibrium_mean_);
+    const float gain = prior_variance_ * h / (h * h * prior_variance_ + kWeightNoise * kWeightNoise);
+    initial_ = std::max(0.0f, prior_ + gain * (z - h * prior_));
+    variance_ = prior_variance_ * (1.0f - gain * h);
+}
+
+void MoistureModel::forecast(const SpoolModel& spool, float air)
+{
+    if (!active() || !spool.started()) {
+        return;
+    }
+    SpoolModel ahead = spool;
+    float decay[SpoolModel::kNodes];
+    float equilibrium[SpoolModel::kNodes];
+    std::copy(std::begin(decay_), std::end(decay_), decay);
+    std::copy(std::begin(equilibrium_), std::end(equilibrium_), equilibrium);
+
+    eta_s_ = kUnknownEta;
+    for (float t = kForecastStepS; t <= kHorizonS; t += kForecastStepS) {
+        ahead.step(air, kForecastStepS);
+        float moisture = 0.0f;
+        for (size_t i = 0; i < SpoolModel::kNodes; ++i) {
+            dry_shell(*kinetics_, ahead.node(i), vapour_pressure_, kForecastStepS, decay[i], equilibrium[i]);
+            moisture += ahead.share(i) * (initial_ * decay[i] + equilibrium[i]);
+        }
+        if (moisture <= kinetics_->target) {
+            eta_s_ = uint32_t(t);
+            return;
+        }
+    }
+}
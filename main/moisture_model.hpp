@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "spool_model.hpp"
+
+enum class Material : uint8_t
+{
+    // No model: the run ends on its soak timer only.
+    None,
+    Pla,
+    Petg,
+    Abs,
+    Asa,
+    Tpu,
+    Nylon,
+    Pc,
+    Pva,
+    Count,
+};
+
+// Nominal drying behaviour of a filament material, from manufacturers' drying recommendations and published
+// sorption data. Moisture contents are percent of dry mass.
+struct MaterialKinetics
+{
+    const char* name;
+    // Recommended drying temperature, C.
+    float temperature;
+    // Slope of the sorption isotherm at the low humidities of a drying chamber, as the moisture it would give at
+    // 100% relative humidity.
+    float saturation;
+    // Expected moisture of a spool that has stood in open room air, the starting estimate of every run.
+    float initial;
+    // Dry enough to print.
+    float target;
+    // First-order drying rate at kKineticsReferenceTemperature, 1/h.
+    float rate;
+};
+
+// Drying rates follow Arrhenius with this activation temperature (activation energy over the gas constant), K:
+// the rate roughly doubles every 13 degrees around 60 C.
+constexpr float kKineticsActivation = 5000.0f;
+constexpr float kKineticsReferenceTemperature = 50.0f;
+// Water vapour in room air at 22 C and 50% relative humidity, kPa: what a chamber holds without a humidity reading.
+constexpr float kRoomVapourPressure = 1.32f;
+
+const MaterialKinetics& material_kinetics(Material material);
+
+// Estimates the moisture left in a spool and when it will be dry. Each shell of the spool model dries towards the
+// equilibrium moisture of the air at its own temperature at a rate that rises with that temperature, so the cold
+// core dries last. The chamber humidity, when measured, sets the equilibrium; without it the chamber air is taken
+// to carry the moisture of room air.
+//
+// How wet the spool was at the start is the big unknown. Moisture is linear in it, so the model tracks the response
+// to the starting moisture and to the air separately, and a spool weight, when there is one, refines the starting
+// moisture from the weight lost since the first reading. That loss is cumulative, and the scale's errors in it
+// drift slowly rather than average out, so each reading's estimate replaces the last one's, blended with the prior
+// as a single scalar Kalman update, rather than piling up as independent evidence.
+class MoistureModel
+{
+public:
+    static constexpr uint32_t kUnknownEta = UINT32_MAX;
+    // The forecast runs this far ahead at most; a spool that won't be dry by then reports kUnknownEta.
+    static constexpr uint32_t kHorizonS = 48 * 3600;
+
+    // Starts a run with the material's prior, or with a known starting moisture in percent. Material::None
+    // switches the model off.
+    void start(Material material, float initial = NAN);
+    // Advances the model by `dt` seconds. `air` is the chamber temperature, `humidity` its relative humidity in
+    // percent and `weight` the spool's weight in grams; either of the last two may be NAN when not measured. A
+    // non-finite air temperature holds the model.
+    void update(const SpoolModel& spool, float air, float humidity, float weight, float dt);
+    // Projects the model forward with the air held at `air` and its water vapour as it is, and sets eta_s() to when
+    // the spool will be dry. A few thousand float operations per simulated hour; call it every minute or so.
+    void forecast(const SpoolModel& spool, float air);
+    // Forgets the weight readings so far, when the spool on the scale changed. What they taught about the starting
+    // moisture stays.
+    void reset_weight();
+
+    bool active() const { return kinetics_ != nullptr; }
+    // The material's kinetics, nullptr when not active.
+    const MaterialKinetics* kinetics() const { return kinetics_; }
+    // Mean moisture of the winding in percent, NAN when not active.
+    float moisture() const;
+    float initial_moisture() const { return initial_; }
+    bool dry() const { return active() && moisture() <= kinetics_->target; }
+    // Seconds until dry as of the last forecast, 0 once dry.
+    uint32_t eta_s() const { return dry() ? 0 : eta_s_; }
+
+private:
+    // Per shell: decay of the starting moisture (1 at the start), and moisture taken up or given off towards the
+    // air's equilibrium.
+    float decay_[SpoolModel::kNodes] = {};
+    float equilibrium_[SpoolModel::kNodes] = {};
+    // Both averaged over the winding.
+    float decay_mean_ = 0.0f;
+    float equilibrium_mean_ = 0.0f;
+    const MaterialKinetics* kinetics_ = nullptr;
+    float initial_ = 0.0f;
+    // Starting moisture before any weight, and its variance, then the variance after the latest weight.
+    float prior_ = 0.0f;
+    float prior_variance_ = 0.0f;
+    float variance_ = 0.0f;
+    // Water vapour pressure of the chamber air, kPa, held for the forecast.
+    float vapour_pressure_ = 0.0f;
+    // Weight and moisture terms at the first weight reading, and time since the last one used.
+    float first_weight_ = NAN;
+    float first_decay_ = 0.0f;
+    float first_equilibrium_ = 0.0f;
+    float weight_elapsed_s_ = 0.0f;
+    uint32_t eta_s_ = kUnknownEta;
+};
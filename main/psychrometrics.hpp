@@ -0,0 +1,54 @@
+#pragma once
+
+#include "fast_math.hpp"
+
+// Moist air from a temperature in C and a relative humidity in percent, by the Magnus formula over water with the
+// Alduchov-Eskridge constants. Magnus itself is within 0.3% of the IAPWS saturation curve up to 60 C and 2.6% high
+// at 100 C, far more than the 1e-6 the fast log and exp add (host/psychrometrics.cpp measures both).
+
+constexpr float kMagnusPressure = 0.61094f; // kPa
+constexpr float kMagnusA = 17.625f;
+constexpr float kMagnusB = 243.04f;         // C
+// 1e3 Pa/kPa times 1e3 g/kg over water vapour's gas constant, 461.5 J/(kg K).
+constexpr float kVapourDensityFactor = 2166.8f;
+constexpr float kKelvin = 273.15f;
+// Volumetric heat capacity of room air, J/(m^3 K).
+constexpr float kAirHeatCapacity = 1206.0f;
+
+// Saturation vapour pressure, kPa.
+inline float saturation_pressure(float temperature)
+{
+    return kMagnusPressure * fast_exp(kMagnusA * temperature / (temperature + kMagnusB));
+}
+
+// Partial pressure of the water vapour, kPa.
+inline float vapour_pressure(float temperature, float humidity)
+{
+    return humidity / 100.0f * saturation_pressure(temperature);
+}
+
+// Relative humidity in percent of air at `temperature` holding water vapour at `vapour_pressure` kPa.
+inline float relative_humidity(float temperature, float vapour_pressure)
+{
+    return 100.0f * vapour_pressure / saturation_pressure(temperature);
+}
+
+// The temperature at which water vapour at `vapour_pressure` kPa saturates, C.
+inline float dew_point_from_pressure(float vapour_pressure)
+{
+    const float gamma = fast_log(vapour_pressure / kMagnusPressure);
+    return kMagnusB * gamma / (kMagnusA - gamma);
+}
+
+// Dew point, C. Takes the log of the humidity rather than of the vapour pressure, saving the exp.
+inline float dew_point(float temperature, float humidity)
+{
+    const float gamma = fast_log(humidity / 100.0f) + kMagnusA * temperature / (temperature + kMagnusB);
+    return kMagnusB * gamma / (kMagnusA - gamma);
+}
+
+// Mass of water vapour per volume of air, g/m^3.
+inline float absolute_humidity(float temperature, float humidity)
+{
+    return kVapourDensityFactor * vapour_pressure(temperature, humidity) / (temperature + kKelvin);
+}
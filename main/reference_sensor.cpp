@@ -0,0 +1,84 @@
+#include "reference_sensor.hpp"
+
+#include <esp_log.h>
+
+constexpr const char* TAG = "reference";
+
+constexpr uint32_t kBusSpeedHz = 100'000;
+constexpr int kTimeoutMs = 10;
+// Periodic measurement at one per second with high repeatability, and the fetch of the latest result.
+constexpr uint8_t kStartPeriodic[] = {0x21, 0x30};
+constexpr uint8_t kFetchData[] = {0xe0, 0x00};
+constexpr uint32_t kRestartAfterFailures = 10;
+
+uint8_t sht3x_crc8(const uint8_t* data, size_t size)
+{
+    uint8_t crc = 0xff;
+    for (size_t i = 0; i < size; ++i) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = crc & 0x80 ? (crc << 1) ^ 0x31 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+esp_err_t ReferenceSensor::begin(int sda_gpio, int scl_gpio)
+{
+    i2c_master_bus_config_t bus_config{};
+    bus_config.i2c_port = I2C_NUM_0;
+    bus_config.sda_io_num = static_cast<gpio_num_t>(sda_gpio);
+    bus_config.scl_io_num = static_cast<gpio_num_t>(scl_gpio);
+    bus_config.clk_source = I2C_CLK_SRC_DEFAULT;
+    bus_config.glitch_ignore_cnt = 7;
+    bus_config.flags.enable_internal_pullup = true;
+    esp_err_t err = i2c_new_master_bus(&bus_config, &bus_);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create I2C bus: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    i2c_device_config_t device_config{};
+    device_config.dev_addr_length = I2C_ADDR_BIT_LEN_7;
+    device_config.device_address = kAddress;
+    device_config.scl_speed_hz = kBusSpeedHz;
+    err = i2c_master_bus_add_device(bus_, &device_config, &device_);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to add reference sensor: %s", esp_err_to_name(err));
+        i2c_del_master_bus(bus_);
+        bus_ = nullptr;
+        device_ = nullptr;
+        return err;
+    }
+
+    err = start();
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "No reference sensor at 0x%02x: %s", kAddress, esp_err_to_name(err));
+    }
+    return err;
+}
+
+esp_err_t ReferenceSensor::start()
+{
+    return i2c_master_transmit(device_, kStartPeriodic, sizeof(kStartPeriodic), kTimeoutMs);
+}
+
+bool ReferenceSensor::read(float& temperature, float& humidity)
+{
+    if (device_ == nullptr) {
+        return false;
+    }
+    uint8_t data[6];
+    const esp_err_t err = i2c_master_transmit_receive(device_, kFetchData, sizeof(kFetchData), data, sizeof(data),
+                                                      kTimeoutMs);
+    if (err != ESP_OK || sht3x_crc8(data, 2) != data[2] || sht3x_crc8(data + 3, 2) != data[5]) {
+        if (++failures_ % kRestartAfterFailures == 0) {
+            start();
+        }
+        return false;
+    }
+    failures_ = 0;
+    temperature = -45.0f + 175.0f * ((data[0] << 8) | data[1]) / 65535.0f;
+    humidity = 100.0f * ((data[3] << 8) | data[4]) / 65535.0f;
+    return true;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <driver/i2c_master.h>
+#include <esp_err.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// Sensirion SHT3x humidity and temperature sensor on I2C, the chamber reference for field calibration. It measures
+// on its own once a second, so a read fetches the latest result without waiting for a conversion.
+class ReferenceSensor
+{
+public:
+    static constexpr uint16_t kAddress = 0x44;
+
+    esp_err_t begin(int sda_gpio, int scl_gpio);
+
+    // Fetches the latest measurement; false if there is none yet or the transfer or its checksum failed. The
+    // sensor is restarted after a run of failures, in case it browned out and lost its mode.
+    bool read(float& temperature, float& humidity);
+
+private:
+    esp_err_t start();
+
+    i2c_master_bus_handle_t bus_ = nullptr;
+    i2c_master_dev_handle_t device_ = nullptr;
+    uint32_t failures_ = 0;
+};
+
+// CRC-8 of each 16-bit word the sensor sends: polynomial 0x31, initial value 0xff.
+uint8_t sht3x_crc8(const uint8_t* data, size_t size);
@@ -0,0 +1,235 @@
+#include "scope.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+
+#include "telemetry.hpp"
+
+constexpr const char* kTriggerNames[] = {"above", "below", "rising", "falling"};
+static_assert(std::size(kTriggerNames) == size_t(ScopeTrigger::Count));
+
+const char* scope_trigger_name(ScopeTrigger trigger)
+{
+    return trigger < ScopeTrigger::Count ? kTriggerNames[size_t(trigger)] : "none";
+}
+
+ScopeCapture::ScopeCapture(const ScopeConfig& config, std::span<uint16_t> buffer)
+    : config_(config), buffer_(buffer.first(std::min<size_t>(buffer.size(), kScopeMaxSamples)))
+{
+    config_.pre_samples = std::clamp<uint32_t>(config_.pre_samples, 1, std::max<size_t>(buffer_.size(), 2) - 1);
+}
+
+void ScopeCapture::start()
+{
+    state_ = buffer_.size() >= 2 ? State::Filling : State::Idle;
+    head_ = 0;
+    filled_ = 0;
+    sum_ = 0;
+    post_ = 0;
+    lost_ = 0;
+    line_ = 0;
+}
+
+void ScopeCapture::cancel()
+{
+    if (capturing()) {
+        state_ = State::Idle;
+    }
+}
+
+bool ScopeCapture::fires(uint16_t sample) const
+{
+    // Against the window's mean without dividing: sample - sum / n >= level.
+    const int64_t n = config_.pre_samples;
+    switch (config_.trigger) {
+    case ScopeTrigger::Above:
+        return sample * n - int64_t(sum_) >= config_.level * n;
+    case ScopeTrigger::Below:
+        return int64_t(sum_) - sample * n >= config_.level * n;
+    case ScopeTrigger::Rising:
+        return sample >= previous_ + config_.level;
+    case ScopeTrigger::Falling:
+        return previous_ >= sample + config_.level;
+    default:
+        return false;
+    }
+}
+
+void ScopeCapture::feed(std::span<const uint16_t> samples, uint32_t lost)
+{
+    if (!capturing()) {
+        return;
+    }
+    lost_ += lost;
+    const size_t pre = config_.pre_samples;
+    for (const uint16_t sample : samples) {
+        if (state_ == State::Armed && fires(sample)) {
+            // Put the window in order ahead of the trigger, which is then always at pre_samples.
+            std::rotate(buffer_.begin(), buffer_.begin() + head_, buffer_.begin() + pre);
+            state_ = State::Triggered;
+        }
+        if (state_ == State::Triggered) {
+            buffer_[pre + post_++] = sample;
+            if (pre + post_ == buffer_.size()) {
+                state_ = State::Done;
+                ++captures_;
+                return;
+            }
+        } else {
+            if (filled_ == pre) {
+                sum_ -= buffer_[head_];
+            } else if (++filled_ == pre) {
+                state_ = State::Armed;
+            }
+            buffer_[head_] = sample;
+            sum_ += sample;
+            head_ = (head_ + 1) % pre;
+        }
+        previous_ = sample;
+    }
+}
+
+bool ScopeCapture::format_line(char* out, size_t size)
+{
+    if (state_ != State::Done) {
+        return false;
+    }
+    const size_t data_lines = (buffer_.size() + kScopeLineSamples - 1) / kScopeLineSamples;
+    ScopeLine line{};
+    line.capture = captures_ - 1;
+    if (line_ == 0) {
+        line.kind = ScopeLine::Kind::Header;
+        line.sample_count = uint32_t(buffer_.size());
+        line.sample_rate_hz = config_.sample_rate_hz;
+        line.trigger = config_.trigger;
+        line.level = config_.level;
+        line.trigger_index = config_.pre_samples;
+        line.lost = lost_;
+    } else if (line_ <= data_lines) {
+        line.kind = ScopeLine::Kind::Data;
+        line.line = uint32_t(line_ - 1);
+        const auto chunk = buffer_.subspan(line.line * kScopeLineSamples).first(
+            std::min(kScopeLineSamples, buffer_.size() - line.line * kScopeLineSamples));
+        line.count = chunk.size();
+        std::copy(chunk.begin(), chunk.end(), line.samples);
+    } else {
+        line.kind = ScopeLine::Kind::End;
+        // The ESP32 and the hosts reading its logs are little-endian, so the buffer's bytes are the words'.
+        line.crc = telemetry_crc16(reinterpret_cast<const uint8_t*>(buffer_.data()), buffer_.size_bytes());
+        state_ = State::Idle;
+    }
+    ++line_;
+    format_scope_line(line, out, size);
+    return true;
+}
+
+void format_scope_line(const ScopeLine& line, char* out, size_t size)
+{
+    switch (line.kind) {
+    case ScopeLine::Kind::Header:
+        snprintf(out, size,
+                 "Scope capture %" PRIu32 ": %" PRIu32 " samples at %" PRIu32 " Hz, %s %u codes, trigger at %" PRIu32
+                 ", %" PRIu32 " lost",
+                 line.capture, line.sample_count, line.sample_rate_hz, scope_trigger_name(line.trigger),
+                 unsigned(line.level), line.trigger_index, line.lost);
+        break;
+    case ScopeLine::Kind::Data: {
+        static constexpr char kHex[] = "0123456789abcdef";
+        int n = snprintf(out, size, "Scope %" PRIu32 ".%" PRIu32 ": ", line.capture, line.line);
+        size_t used = n < 0 ? size : std::min(size, size_t(n));
+        for (size_t i = 0; i < std::min(line.count, kScopeLineSamples) && used + 4 <= size; ++i) {
+            const uint16_t sample = line.samples[i];
+            out[used++] = kHex[(sample >> 8) & 0xf];
+            out[used++] = kHex[(sample >> 4) & 0xf];
+            out[used++] = kHex[sample & 0xf];
+        }
+        if (used < size) {
+            out[used] = '\0';
+        }
+        break;
+    }
+    case ScopeLine::Kind::End:
+        snprintf(out, size, "Scope %" PRIu32 " end: crc %04x", line.capture, unsigned(line.crc));
+        break;
+    }
+}
+
+static int hex_digit(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+// For the capture number, which sscanf's %u would also take with a sign or leading blanks, as in other text.
+static bool plain_number(const char* text)
+{
+    return *text >= '0' && *text <= '9';
+}
+
+static bool parse_header(const char* text, ScopeLine& line)
+{
+    char trigger[8];
+    unsigned level;
+    int end = 0;
+    if (sscanf(text, "Scope capture %" SCNu32 ": %" SCNu32 " samples at %" SCNu32 " Hz, %7[a-z] %u codes, trigger at %"
+               SCNu32 ", %" SCNu32 " lost%n", &line.capture, &line.sample_count, &line.sample_rate_hz, trigger,
+               &level, &line.trigger_index, &line.lost, &end) != 7 || end == 0) {
+        return false;
+    }
+    line.kind = ScopeLine::Kind::Header;
+    line.trigger = ScopeTrigger::Count;
+    for (size_t i = 0; i < std::size(kTriggerNames); ++i) {
+        if (strcmp(trigger, kTriggerNames[i]) == 0) {
+            line.trigger = ScopeTrigger(i);
+        }
+    }
+    line.level = uint16_t(level);
+    return line.trigger != ScopeTrigger::Count && level <= 0xffff && line.sample_count >= 2 &&
+           line.sample_count <= kScopeMaxSamples && line.trigger_index < line.sample_count;
+}
+
+bool parse_scope_line(const char* text, ScopeLine& line)
+{
+    const char* start = strstr(text, "Scope ");
+    if (start == nullptr) {
+        return false;
+    }
+    line = {};
+    if (strncmp(start, "Scope capture ", 14) == 0) {
+        return plain_number(start + 14) && parse_header(start, line);
+    }
+    if (!plain_number(start + 6)) {
+        return false;
+    }
+
+    unsigned crc;
+    int end = 0;
+    if (sscanf(start, "Scope %" SCNu32 " end: crc %4x%n", &line.capture, &crc, &end) == 2 && end != 0) {
+        line.kind = ScopeLine::Kind::End;
+        line.crc = uint16_t(crc);
+        return true;
+    }
+
+    end = 0;
+    if (sscanf(start, "Scope %" SCNu32 ".%" SCNu32 ": %n", &line.capture, &line.line, &end) != 2 || end == 0 ||
+        line.line >= kScopeMaxSamples / kScopeLineSamples) {
+        return false;
+    }
+    line.kind = ScopeLine::Kind::Data;
+    const char* hex = start + end;
+    while (line.count < kScopeLineSamples && hex_digit(hex[0]) >= 0 && hex_digit(hex[1]) >= 0 &&
+           hex_digit(hex[2]) >= 0) {
+        line.samples[line.count++] = uint16_t(hex_digit(hex[0]) << 8 | hex_digit(hex[1]) << 4 | hex_digit(hex[2]));
+        hex += 3;
+    }
+    // A line cut short mid-sample, or longer than the firmware writes, is damaged.
+    return line.count != 0 && hex_digit(hex[0]) < 0;
+}
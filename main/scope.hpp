@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Oscilloscope mode: the thermistor line captured around a trigger at many times the control sample rate, for
+// transients the frame averages hide, such as the heater relay's switching spikes or pickup from a PWM fan.
+//
+// ScopeCapture is the reducer for the frames read while the ADC runs at the scope's rate. It keeps the last
+// pre_samples samples in a ring until it has that many, then evaluates the trigger on every sample; the sample that
+// fires starts the post-trigger part, which fills the rest of the buffer. The finished capture is streamed out as
+// console lines (format_line), a few per control step so the UART never holds control up for long, and read back
+// on the host from the log by parse_scope_line.
+//
+// Lines, with samples as three hex digits each and the CRC-16 (telemetry_crc16) of all samples as little-endian words:
+//   Scope capture <n>: <samples> samples at <rate> Hz, <trigger> <level> codes, trigger at <index>, <lost> lost
+//   Scope <n>.<line>: <up to kScopeLineSamples samples>
+//   Scope <n> end: crc <crc>
+
+constexpr size_t kScopeLineSamples = 32;
+constexpr size_t kScopeMaxLineSize = 160;
+// Largest capture a header may announce; far more than the firmware has RAM for.
+constexpr uint32_t kScopeMaxSamples = 1u << 16;
+
+enum class ScopeTrigger : uint8_t
+{
+    // A sample this many codes above or below the mean of the pre-trigger window.
+    Above,
+    Below,
+    // A step of this many codes up or down from one sample to the next.
+    Rising,
+    Falling,
+    Count,
+};
+
+const char* scope_trigger_name(ScopeTrigger trigger);
+
+struct ScopeConfig
+{
+    ScopeTrigger trigger = ScopeTrigger::Rising;
+    uint16_t level = 12;
+    uint32_t sample_rate_hz = 200'000;
+    uint32_t pre_samples = 1024;
+};
+
+class ScopeCapture
+{
+public:
+    // `buffer` holds the whole capture, at most kScopeMaxSamples; pre_samples is cut down to leave room for at least
+    // one sample after the trigger.
+    ScopeCapture(const ScopeConfig& config, std::span<uint16_t> buffer);
+
+    // Starts a capture, dropping any capture not yet streamed.
+    void start();
+    // Feeds the valid samples of a frame, in order. `lost` counts samples missing before them, which are recorded
+    // in the header; the samples on either side of a gap are taken as adjacent.
+    void feed(std::span<const uint16_t> samples, uint32_t lost = 0);
+    // Abandons a capture that hasn't triggered.
+    void cancel();
+
+    // The pre-trigger window is full and the trigger is being evaluated.
+    bool armed() const { return state_ == State::Armed; }
+    bool capturing() const { return state_ == State::Filling || state_ == State::Armed || state_ == State::Triggered; }
+    // Captured and not yet streamed completely.
+    bool streaming() const { return state_ == State::Done; }
+
+    // Writes the next line of the finished capture as format_scope_line does. Returns false once every line has
+    // been written; the scope is then idle.
+    bool format_line(char* out, size_t size);
+
+    std::span<const uint16_t> samples() const { return buffer_; }
+    uint32_t trigger_index() const { return config_.pre_samples; }
+    uint32_t captures() const { return captures_; }
+
+private:
+    enum class State : uint8_t
+    {
+        Idle,
+        Filling,
+        Armed,
+        Triggered,
+        Done,
+    };
+
+    bool fires(uint16_t sample) const;
+
+    ScopeConfig config_;
+    std::span<uint16_t> buffer_;
+    State state_ = State::Idle;
+    // Ring position and fill of the pre-trigger window, and the sum of its samples.
+    size_t head_ = 0;
+    size_t filled_ = 0;
+    uint32_t sum_ = 0;
+    uint16_t previous_ = 0;
+    size_t post_ = 0;
+    uint32_t lost_ = 0;
+    uint32_t captures_ = 0;
+    size_t line_ = 0;
+};
+
+// One line of a streamed capture, as parsed back from a console log.
+struct ScopeLine
+{
+    enum class Kind : uint8_t
+    {
+        Header,
+        Data,
+        End,
+    };
+
+    Kind kind;
+    uint32_t capture;
+    // Header.
+    uint32_t sample_count;
+    uint32_t sample_rate_hz;
+    ScopeTrigger trigger;
+    uint16_t level;
+    uint32_t trigger_index;
+    uint32_t lost;
+    // Data: the line number and its samples.
+    uint32_t line;
+    size_t count;
+    uint16_t samples[kScopeLineSamples];
+    // End.
+    uint16_t crc;
+};
+
+// Writes `line` as the firmware logs it, without a newline; `out` must hold kScopeMaxLineSize bytes.
+void format_scope_line(const ScopeLine& line, char* out, size_t size);
+// Finds a scope line anywhere in `text`, such as a console log line with its level and tag prefix. Returns false for
+// text that holds none, or a damaged one.
+bool parse_scope_line(const char* text, ScopeLine& line);
@@ -0,0 +1,177 @@
+#include "self_calibration.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+constexpr float kScale = 10.0f;
+// Prior variances of the offset and the scaled gain and curvature: a couple of degrees of offset, and a gain and
+// curvature worth a few tenths of a degree 20 degrees from the center.
+constexpr float kPrior[3] = {4.0f, 0.04f, 0.01f};
+// Reference accuracy and the sensors' disagreement in still air, as a variance in degrees squared.
+constexpr float kNoiseVariance = 0.04f;
+// Per sample; about 80 minutes of steady soak in memory.
+constexpr float kForgetting = 0.998f;
+// Both sensors are averaged over about a minute, and samples are taken only while neither strays from its average
+// by more than the band, which the heater's time-proportioning ripple stays inside.
+constexpr uint32_t kAverageTauMs = 60'000;
+constexpr float kSteadyBand = 0.5f;
+
+static float shift(const TemperatureCorrection& k, float temperature)
+{
+    return correct_temperature(temperature, k) - temperature;
+}
+
+CalibrationRefiner::CalibrationRefiner()
+{
+    for (int i = 0; i < 3; ++i) {
+        p_[i][i] = kPrior[i];
+    }
+}
+
+bool CalibrationRefiner::restore(const CalibrationState& state)
+{
+    const auto& k = state.correction;
+    const float variance[3] = {state.variance[0], state.variance[1] * kScale * kScale,
+                               state.variance[2] * kScale * kScale * kScale * kScale};
+    bool ok = state.version == CalibrationState::kVersion && std::abs(k.offset) <= kMaxOffset &&
+              std::abs(k.gain) <= kMaxGain && std::abs(k.curvature) <= kMaxCurvature;
+    for (float v : variance) {
+        ok = ok && v > 0.0f && std::isfinite(v);
+    }
+    if (!ok) {
+        return false;
+    }
+
+    *this = CalibrationRefiner();
+    theta_[0] = k.offset;
+    theta_[1] = k.gain * kScale;
+    theta_[2] = k.curvature * kScale * kScale;
+    for (int i = 0; i < 3; ++i) {
+        p_[i][i] = std::min(variance[i], kPrior[i]);
+    }
+    applied_ = k;
+    samples_ = state.samples;
+    return true;
+}
+
+CalibrationState CalibrationRefiner::state() const
+{
+    CalibrationState state;
+    state.correction = applied_;
+    state.variance[0] = p_[0][0];
+    state.variance[1] = p_[1][1] / (kScale * kScale);
+    state.variance[2] = p_[2][2] / (kScale * kScale * kScale * kScale);
+    state.samples = samples_;
+    return state;
+}
+
+bool CalibrationRefiner::update(const DryerStatus& status, float reference, uint32_t now_ms)
+{
+    constexpr uint32_t kMaxCode = (1u << kAdcResolutionBits) - 1;
+    const uint32_t raw = status.reading.raw;
+    const float curve = thermistor_temperature(status.reading.corrected);
+    if (status.phase != DryerPhase::Soaking || status.fault || status.soak_elapsed_s < kSettleS ||
+        raw <= kAdcRailMargin || raw >= kMaxCode - kAdcRailMargin || !std::isfinite(reference)) {
+        tracking_ = false;
+        return false;
+    }
+    if (!tracking_) {
+        tracking_ = true;
+        last_ms_ = now_ms;
+        steady_ms_ = 0;
+        next_sample_ms_ = now_ms;
+        curve_average_ = curve;
+        reference_average_ = reference;
+        return false;
+    }
+
+    const uint32_t elapsed_ms = now_ms - last_ms_;
+    last_ms_ = now_ms;
+    const float alpha = std::min(1.0f, float(elapsed_ms) / kAverageTauMs);
+    curve_average_ += alpha * (curve - curve_average_);
+    reference_average_ += alpha * (reference - reference_average_);
+    const bool steady = std::abs(curve - curve_average_) <= kSteadyBand &&
+                        std::abs(reference - reference_average_) <= kSteadyBand;
+    steady_ms_ = steady ? steady_ms_ + elapsed_ms : 0;
+
+    // The averages take a few time constants to forget the last disturbance.
+    if (steady_ms_ < 3 * kAverageTauMs || int32_t(now_ms - next_sample_ms_) < 0) {
+        return false;
+    }
+    next_sample_ms_ = now_ms + kSampleIntervalMs;
+    fit(curve_average_, reference_average_ - curve_average_);
+    return apply(curve_average_);
+}
+
+// One step of exponentially weighted recursive least squares, with the covariance never allowed to grow past the
+// prior: directions the samples don't excite, such as gain during soaks at a single setpoint, would otherwise wind
+// up under forgetting until one odd sample threw the estimate.
+void CalibrationRefiner::fit(float temperature, float error)
+{
+    const float u = (temperature - kCorrectionCenter) / kScale;
+    const float phi[3] = {1.0f, u, u * u};
+
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            p_[i][j] /= kForgetting;
+        }
+    }
+    for (int i = 0; i < 3; ++i) {
+        if (p_[i][i] > kPrior[i]) {
+            const float s = std::sqrt(kPrior[i] / p_[i][i]);
+            for (int j = 0; j < 3; ++j) {
+                p_[i][j] *= s;
+                p_[j][i] *= s;
+            }
+        }
+    }
+
+    float p_phi[3];
+    float residual = error;
+    float s = kNoiseVariance;
+    for (int i = 0; i < 3; ++i) {
+        p_phi[i] = p_[i][0] * phi[0] + p_[i][1] * phi[1] + p_[i][2] * phi[2];
+        residual -= theta_[i] * phi[i];
+        s += phi[i] * p_phi[i];
+    }
+    for (int i = 0; i < 3; ++i) {
+        theta_[i] += p_phi[i] / s * residual;
+    }
+    for (int i = 0; i < 3; ++i) {
+        for (int j = i; j < 3; ++j) {
+            p_[i][j] -= p_phi[i] * p_phi[j] / s;
+            p_[j][i] = p_[i][j];
+        }
+    }
+    ++samples_;
+}
+
+bool CalibrationRefiner::apply(float temperature)
+{
+    const float u = (temperature - kCorrectionCenter) / kScale;
+    const float phi[3] = {1.0f, u, u * u};
+    float variance = 0.0f;
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            variance += phi[i] * p_[i][j] * phi[j];
+        }
+    }
+    if (!(variance <= kConfidence * kConfidence)) {
+        return false;
+    }
+    TemperatureCorrection target{std::clamp(theta_[0], -kMaxOffset, kMaxOffset),
+                                 std::clamp(theta_[1] / kScale, -kMaxGain, kMaxGain),
+                                 std::clamp(theta_[2] / (kScale * kScale), -kMaxCurvature, kMaxCurvature)};
+    const float change = shift(target, temperature) - shift(applied_, temperature);
+    if (std::abs(change) < kMinStep) {
+        return false;
+    }
+    if (std::abs(change) > kMaxStep) {
+        const float f = kMaxStep / std::abs(change);
+        target.offset = applied_.offset + f * (target.offset - applied_.offset);
+        target.gain = applied_.gain + f * (target.gain - applied_.gain);
+        target.curvature = applied_.curvature + f * (target.curvature - applied_.curvature);
+    }
+    applied_ = target;
+    return true;
+}
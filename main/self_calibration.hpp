@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+
+#include "dryer.hpp"
+
+// What a refiner needs to resume after a reboot. Stored as a blob; the version changes with the layout.
+struct CalibrationState
+{
+    static constexpr uint32_t kVersion = 1;
+
+    uint32_t version = kVersion;
+    TemperatureCorrection correction{};
+    // Variances of the offset, gain and curvature estimates.
+    float variance[3] = {};
+    uint32_t samples = 0;
+};
+
+// Refines the thermistor curve in the field against a reference sensor in the chamber, such as the precision
+// temperature sensor of a humidity sensor. Recursive least squares fits the reference minus the curve's
+// temperature as an offset, gain and curvature (TemperatureCorrection), only from samples taken while a soak holds
+// both sensors steady, where the chamber air they sit in is at one temperature.
+//
+// The estimate starts from a prior of no correction, so a unit that only ever soaks at one setpoint learns an
+// offset and leaves gain and curvature alone; soaks at other setpoints pin those down as they come. Old samples
+// are slowly forgotten so the fit follows thermistor ageing. The applied correction stays within fixed bounds and
+// moves in limited steps, and only once the correction at the current temperature is known well enough.
+class CalibrationRefiner
+{
+public:
+    // Largest correction ever applied: the curve is good to a degree or two, so more than this means a failed or
+    // misplaced sensor rather than drift.
+    static constexpr float kMaxOffset = 3.0f;
+    static constexpr float kMaxGain = 0.05f;
+    static constexpr float kMaxCurvature = 0.002f;
+    // Largest change of the applied correction at the current temperature in one step.
+    static constexpr float kMaxStep = 0.5f;
+    // Smaller refinements aren't worth a disturbance of the control loop or a flash write.
+    static constexpr float kMinStep = 0.05f;
+    // The correction at the current temperature must be this certain (one standard deviation) to be applied.
+    static constexpr float kConfidence = 0.1f;
+
+    // Time into a soak before sampling starts, as the chamber walls and trays settle.
+    static constexpr uint32_t kSettleS = 300;
+    static constexpr uint32_t kSampleIntervalMs = 10'000;
+
+    CalibrationRefiner();
+
+    // Resumes from a stored state, whose correction is taken to be the one in effect. Returns false and keeps the
+    // prior if the state is invalid or out of bounds.
+    bool restore(const CalibrationState& state);
+    CalibrationState state() const;
+
+    // Feeds one control step and the reference temperature read with it, NAN if the reference failed. Returns true
+    // when correction() changed.
+    bool update(const DryerStatus& status, float reference, uint32_t now_ms);
+
+    const TemperatureCorrection& correction() const { return applied_; }
+    uint32_t samples() const { return samples_; }
+
+private:
+    void fit(float temperature, float error);
+    bool apply(float temperature);
+
+    // Offset, and gain and curvature scaled to 10 degrees, which keeps the regressors of a similar size.
+    float theta_[3] = {};
+    float p_[3][3] = {};
+    TemperatureCorrection applied_{};
+    uint32_t samples_ = 0;
+
+    bool tracking_ = false;
+    uint32_t last_ms_ = 0;
+    uint32_t steady_ms_ = 0;
+    uint32_t next_sample_ms_ = 0;
+    float curve_average_ = 0.0f;
+    float reference_average_ = 0.0f;
+};
@@ -0,0 +1,171 @@
+#include "snapshot.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "telemetry.hpp"
+
+SnapshotBlock snapshot_block(uint32_t count, uint32_t sum, uint32_t sum2)
+{
+    if (count == 0) {
+        return {0, 0};
+    }
+    // n sum2 - sum^2 is n^2 times the variance, exact in 64 bits for any frame of 10-bit samples.
+    const uint64_t n = count;
+    const uint64_t spread = n * sum2 - uint64_t(sum) * sum;
+    const uint64_t variance = (16 * spread + n * n / 2) / (n * n);
+    return {uint16_t((16 * uint64_t(sum) + n / 2) / n), uint16_t(std::min<uint64_t>(variance, 0xffff))};
+}
+
+SnapshotRecorder::SnapshotRecorder(const SnapshotConfig& config) : config_(config)
+{
+    config_.post_steps = std::min<uint16_t>(config_.post_steps, kSnapshotSteps - 1);
+    config_.pre_steps = std::min<uint16_t>(config_.pre_steps, kSnapshotSteps - 1 - config_.post_steps);
+}
+
+bool SnapshotRecorder::record(const DryerStatus& status, std::span<const SnapshotBlock> blocks, bool timeout)
+{
+    SnapshotStep step;
+    step.time_ms = status.time_ms;
+    step.temperature = status.temperature;
+    step.setpoint = status.setpoint;
+    step.duty = status.duty;
+    step.raw = uint16_t(status.reading.raw);
+    step.flags = (status.heater_on ? kSnapshotHeaterOn : 0) | (status.fault ? kSnapshotFaulted : 0) |
+                 (status.sensor_drift ? kSnapshotDrift : 0) | (timeout ? kSnapshotTimeout : 0) |
+                 uint8_t(uint8_t(status.phase) << 4);
+    const size_t n = std::min(blocks.size(), kSnapshotBlocks);
+    step.block_count = uint8_t(n);
+    std::copy(blocks.end() - n, blocks.end(), step.blocks);
+    std::fill(step.blocks + n, step.blocks + kSnapshotBlocks, SnapshotBlock{0, 0});
+
+    const uint8_t fired = check(step) & config_.triggers;
+    const State state = state_.load(std::memory_order_acquire);
+    if (state == State::Frozen) {
+        if (fired != 0) {
+            missed_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return false;
+    }
+
+    ring_[head_] = step;
+    head_ = (head_ + 1) % kSnapshotSteps;
+    count_ = std::min<uint16_t>(count_ + 1, kSnapshotSteps);
+    if (state == State::Armed) {
+        if (fired == 0) {
+            return false;
+        }
+        trigger_ = fired;
+        trigger_ms_ = step.time_ms;
+        post_left_ = config_.post_steps;
+        if (post_left_ != 0) {
+            state_.store(State::Triggered, std::memory_order_relaxed);
+            return false;
+        }
+    } else {
+        trigger_ |= fired;
+        if (--post_left_ != 0) {
+            return false;
+        }
+    }
+    // Less lead-in than configured when the trigger came soon after boot or the last release.
+    count_ = std::min<uint16_t>(count_, config_.pre_steps + 1 + config_.post_steps);
+    state_.store(State::Frozen, std::memory_order_release);
+    return true;
+}
+
+uint8_t SnapshotRecorder::check(const SnapshotStep& step)
+{
+    constexpr uint8_t kFaultFlags = kSnapshotFaulted | kSnapshotDrift | kSnapshotTimeout;
+    uint8_t fired = (step.flags & ~last_flags_ & kFaultFlags) != 0 ? kSnapshotFault : 0;
+    last_flags_ = step.flags;
+    if ((step.flags & kFaultFlags) != 0) {
+        // The temperature of a faulted step means nothing; the door and oscillation detectors start over.
+        temperature_count_ = 0;
+        side_ = 0;
+        crossings_ = 0;
+        return fired;
+    }
+
+    const size_t slot = temperature_count_ % kDoorWindow;
+    if (temperature_count_ >= kDoorWindow && temperatures_[slot] - step.temperature >= kDoorDrop) {
+        fired |= kSnapshotDoor;
+        temperature_count_ = 0;
+    } else {
+        temperatures_[slot] = step.temperature;
+        ++temperature_count_;
+    }
+
+    const float error = step.temperature - step.setpoint;
+    const int8_t side = error > kOscillationBand ? 1 : error < -kOscillationBand ? -1 : 0;
+    if (step.phase() == DryerPhase::Heating) {
+        side_ = 0;
+        crossings_ = 0;
+    } else if (side != 0 && side != side_) {
+        if (side_ != 0) {
+            crossings_ms_[crossings_ % kOscillationCrossings] = step.time_ms;
+            ++crossings_;
+            const uint32_t first_ms = crossings_ms_[crossings_ % kOscillationCrossings];
+            if (crossings_ >= kOscillationCrossings && step.time_ms - first_ms <= kOscillationWindowMs) {
+                fired |= kSnapshotOscillation;
+                crossings_ = 0;
+            }
+        }
+        side_ = side;
+    }
+    return fired;
+}
+
+std::pair<std::span<const SnapshotStep>, std::span<const SnapshotStep>> SnapshotRecorder::steps() const
+{
+    const size_t start = (head_ + kSnapshotSteps - count_) % kSnapshotSteps;
+    const size_t first = std::min<size_t>(count_, kSnapshotSteps - start);
+    return {std::span(ring_.data() + start, first), std::span(ring_.data(), count_ - first)};
+}
+
+void SnapshotRecorder::release()
+{
+    count_ = 0;
+    trigger_ = 0;
+    missed_.store(0, std::memory_order_relaxed);
+    state_.store(State::Armed, std::memory_order_release);
+}
+
+bool decode_snapshot(const uint8_t* slot, size_t size, SnapshotHeader& header, SnapshotStep* steps)
+{
+    if (size < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, slot, sizeof(header));
+    if (header.magic != kSnapshotMagic || header.version != kSnapshotVersion || header.step_count == 0 ||
+        header.step_count > kSnapshotSteps || header.trigger_index >= header.step_count ||
+        size < sizeof(header) + header.step_count * sizeof(SnapshotStep)) {
+        return false;
+    }
+    const uint8_t* data = slot + sizeof(header);
+    const size_t data_size = header.step_count * sizeof(SnapshotStep);
+    if (telemetry_crc16(data, data_size) != header.crc) {
+        return false;
+    }
+    memcpy(steps, data, data_size);
+    for (size_t i = 0; i < header.step_count; ++i) {
+        if (steps[i].block_count > kSnapshotBlocks || steps[i].phase() > DryerPhase::Done) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const char* snapshot_trigger_name(uint8_t trigger)
+{
+    if (trigger & kSnapshotFault) {
+        return "fault";
+    }
+    if (trigger & kSnapshotDoor) {
+        return "door";
+    }
+    if (trigger & kSnapshotOscillation) {
+        return "oscillation";
+    }
+    return "none";
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "dryer.hpp"
+
+// Full-resolution context around anomalies. The input log keeps one averaged frame per control step; when something
+// goes wrong, the frames behind that average and what control made of them matter as well. SnapshotRecorder keeps
+// the last kSnapshotSteps control steps in RAM, each with the mean and variance of every ADC frame (block) drained
+// for it. A trigger lets the configured number of further steps in and then freezes the ring, so the snapshot holds
+// the steps before the trigger and after it, until the writer task has stored it in the "snapshot" partition and
+// re-arms the recorder. Steps recorded while frozen are lost; triggers then only count as missed.
+//
+// Untriggered, a step costs a 40-byte copy and a few comparisons. The snapshot partition holds as many
+// kSnapshotSlotSize slots as fit, reused oldest first; snapshot_dump reads them on the host.
+
+constexpr size_t kSnapshotSteps = 256;
+// As many blocks as the ADC pool holds frames; a step that drained more keeps the newest.
+constexpr size_t kSnapshotBlocks = 5;
+
+// Bits of the trigger mask.
+constexpr uint8_t kSnapshotFault = 0x01;         // the sensor railed or timed out, or a sensor started drifting
+constexpr uint8_t kSnapshotDoor = 0x02;          // the chamber cooled faster than the heater off could make it
+constexpr uint8_t kSnapshotOscillation = 0x04;   // the temperature kept crossing the setpoint
+constexpr uint8_t kSnapshotAllTriggers = kSnapshotFault | kSnapshotDoor | kSnapshotOscillation;
+
+// Bits of SnapshotStep::flags; the phase is in the top nibble.
+constexpr uint8_t kSnapshotHeaterOn = 0x01;
+constexpr uint8_t kSnapshotFaulted = 0x02;
+constexpr uint8_t kSnapshotDrift = 0x04;
+constexpr uint8_t kSnapshotTimeout = 0x08;
+
+// One ADC frame in sixteenths of a code: its mean, and the variance of its samples about it, saturating at 0xffff
+// (64 codes standard deviation; a healthy frame is around 2).
+struct SnapshotBlock
+{
+    uint16_t mean;
+    uint16_t variance;
+};
+
+struct SnapshotStep
+{
+    uint32_t time_ms;
+    float temperature;
+    float setpoint;
+    float duty;
+    uint16_t raw;
+    uint8_t flags;
+    uint8_t block_count;
+    SnapshotBlock blocks[kSnapshotBlocks];
+
+    DryerPhase phase() const { return DryerPhase(flags >> 4); }
+};
+static_assert(sizeof(SnapshotStep) == 40, "snapshots are stored as raw steps");
+
+// The block for a frame of `count` valid samples summing to `sum`, their squares to `sum2`.
+SnapshotBlock snapshot_block(uint32_t count, uint32_t sum, uint32_t sum2);
+
+struct SnapshotConfig
+{
+    uint8_t triggers = kSnapshotAllTriggers;
+    // Steps kept before the trigger's and recorded after it; together at most kSnapshotSteps - 1.
+    uint16_t pre_steps = 191;
+    uint16_t post_steps = 64;
+};
+
+class SnapshotRecorder
+{
+public:
+    // A drop of the temperature by this much within kDoorWindow steps. With the door shut, the chamber cools at
+    // most 0.3 C in that time.
+    static constexpr float kDoorDrop = 1.5f;
+    static constexpr size_t kDoorWindow = 10;
+    // kOscillationCrossings crossings of the setpoint within kOscillationWindowMs, each leaving a band of
+    // kOscillationBand on the other side, outside heat-up.
+    static constexpr float kOscillationBand = 0.5f;
+    static constexpr size_t kOscillationCrossings = 6;
+    static constexpr uint32_t kOscillationWindowMs = 15 * 60'000;
+
+    explicit SnapshotRecorder(const SnapshotConfig& config = {});
+
+    // Records a control step with the blocks drained for it; a step without a frame, such as a sensor timeout, has
+    // none. Returns true when this step froze the recorder, and the snapshot should be written.
+    bool record(const DryerStatus& status, std::span<const SnapshotBlock> blocks, bool timeout = false);
+
+    bool frozen() const { return state_.load(std::memory_order_acquire) == State::Frozen; }
+    // The frozen snapshot, oldest step first, in two pieces as the ring wraps. Only while frozen.
+    std::pair<std::span<const SnapshotStep>, std::span<const SnapshotStep>> steps() const;
+    uint16_t step_count() const { return count_; }
+    // Index in steps() of the step that triggered.
+    uint16_t trigger_index() const { return count_ - 1 - config_.post_steps; }
+    // Mask of the triggers that fired from the trigger's step to the freeze.
+    uint8_t trigger() const { return trigger_; }
+    uint32_t trigger_ms() const { return trigger_ms_; }
+    // Triggers that fired while frozen since the last release.
+    uint32_t missed() const { return missed_.load(std::memory_order_relaxed); }
+
+    // Hands the ring back once the snapshot is stored; from the writer task. Recording restarts empty.
+    void release();
+
+private:
+    enum class State : uint8_t
+    {
+        Armed,
+        Triggered,
+        Frozen,
+    };
+
+    uint8_t check(const SnapshotStep& step);
+
+    SnapshotConfig config_;
+    std::atomic<State> state_{State::Armed};
+    std::array<SnapshotStep, kSnapshotSteps> ring_{};
+    size_t head_ = 0;
+    uint16_t count_ = 0;
+    uint16_t post_left_ = 0;
+    uint8_t trigger_ = 0;
+    uint32_t trigger_ms_ = 0;
+    std::atomic<uint32_t> missed_{0};
+    // The detectors run on every step, frozen or not, with their own history.
+    uint8_t last_flags_ = 0;
+    std::array<float, kDoorWindow> temperatures_{};
+    size_t temperature_count_ = 0;
+    // Side of the setpoint the temperature last left the band on, and when it crossed.
+    int8_t side_ = 0;
+    std::array<uint32_t, kOscillationCrossings> crossings_ms_{};
+    size_t crossings_ = 0;
+};
+
+// A slot of the snapshot partition: the header, then the steps. The writer programs the steps first and the header
+// last, so a slot whose write was cut short reads as empty. All fields are little-endian, as both ends are.
+constexpr uint32_t kSnapshotMagic = 0x50414e53;   // "SNAP"
+constexpr uint8_t kSnapshotVersion = 1;
+constexpr size_t kSnapshotSectorSize = 4096;
+constexpr size_t kSnapshotSlotSize = 3 * kSnapshotSectorSize;
+
+struct SnapshotHeader
+{
+    uint32_t magic;
+    uint32_t sequence;
+    uint32_t trigger_ms;
+    uint32_t missed;
+    uint16_t step_count;
+    uint16_t trigger_index;
+    uint8_t version;
+    uint8_t trigger;
+    // CRC-16/CCITT-FALSE of the steps.
+    uint16_t crc;
+};
+static_assert(sizeof(SnapshotHeader) == 24);
+static_assert(sizeof(SnapshotHeader) + kSnapshotSteps * sizeof(SnapshotStep) <= kSnapshotSlotSize);
+
+// Reads the snapshot in a slot of `size` bytes. Returns false for an empty, partly written or corrupt slot, or one
+// with steps no writer could have recorded; on success `steps` receives header.step_count steps.
+bool decode_snapshot(const uint8_t* slot, size_t size, SnapshotHeader& header, SnapshotStep* steps);
+
+// Decodes a raw image of the snapshot partition, calling `fn(const SnapshotHeader&, std::span<const SnapshotStep>)`
+// for every snapshot in write order. Returns the number of snapshots decoded.
+template <typename Fn>
+size_t decode_snapshot_image(const uint8_t* image, size_t size, Fn fn)
+{
+    std::vector<std::pair<uint32_t, size_t>> slots;
+    for (size_t offset = 0; offset + kSnapshotSlotSize <= size; offset += kSnapshotSlotSize) {
+        SnapshotHeader header;
+        memcpy(&header, image + offset, sizeof(header));
+        if (header.magic == kSnapshotMagic) {
+            slots.emplace_back(header.sequence, offset);
+        }
+    }
+    std::sort(slots.begin(), slots.end());
+
+    size_t count = 0;
+    std::vector<SnapshotStep> steps(kSnapshotSteps);
+    for (const auto& [sequence, offset] : slots) {
+        SnapshotHeader header;
+        if (decode_snapshot(image + offset, kSnapshotSlotSize, header, steps.data())) {
+            fn(header, std::span<const SnapshotStep>(steps.data(), header.step_count));
+            ++count;
+        }
+    }
+    return count;
+}
+
+// Name of a trigger mask's lowest bit, for logs.
+const char* snapshot_trigger_name(uint8_t trigger);
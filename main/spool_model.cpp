@@ -0,0 +1,64 @@
+#include "spool_model.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <numbers>
+
+SpoolModel::SpoolModel(const SpoolParams& params)
+{
+    constexpr float kPi = std::numbers::pi_v<float>;
+    const float thickness = (params.outer_radius - params.hub_radius) / kNodes;
+    auto center = [&](size_t i) { return params.hub_radius + (i + 0.5f) * thickness; };
+    for (size_t i = 0; i < kNodes; ++i) {
+        const float inner = params.hub_radius + i * thickness;
+        const float outer = inner + thickness;
+        capacity_[i] = params.volumetric_heat_capacity * kPi * (outer * outer - inner * inner);
+        if (i + 1 < kNodes) {
+            conductance_[i] = 2 * kPi * params.conductivity / std::log(center(i + 1) / center(i));
+        } else {
+            const float conduction = std::log(params.outer_radius / center(i)) / (2 * kPi * params.conductivity);
+            const float convection = 1.0f / (params.surface_coefficient * 2 * kPi * params.outer_radius);
+            conductance_[i] = 1.0f / (conduction + convection);
+        }
+    }
+    const float total = kPi * (params.outer_radius * params.outer_radius - params.hub_radius * params.hub_radius);
+    for (size_t i = 0; i < kNodes; ++i) {
+        share_[i] = capacity_[i] / (params.volumetric_heat_capacity * total);
+    }
+    // Half the stability limit of the stiffest shell.
+    max_step_ = INFINITY;
+    for (size_t i = 0; i < kNodes; ++i) {
+        const float coupling = conductance_[i] + (i > 0 ? conductance_[i - 1] : 0.0f);
+        max_step_ = std::min(max_step_, 0.5f * capacity_[i] / coupling);
+    }
+}
+
+void SpoolModel::reset(float temperature)
+{
+    std::fill(std::begin(nodes_), std::end(nodes_), temperature);
+    started_ = true;
+}
+
+void SpoolModel::step(float air, float dt)
+{
+    if (!std::isfinite(air)) {
+        return;
+    }
+    if (!started_) {
+        reset(air);
+        return;
+    }
+    const int steps = std::max(1, int(std::ceil(dt / max_step_)));
+    const float h = dt / steps;
+    for (int s = 0; s < steps; ++s) {
+        float flow[kNodes];
+        for (size_t i = 0; i < kNodes; ++i) {
+            const float outside = i + 1 < kNodes ? nodes_[i + 1] : air;
+            flow[i] = conductance_[i] * (outside - nodes_[i]);
+        }
+        for (size_t i = 0; i < kNodes; ++i) {
+            nodes_[i] += h * (flow[i] - (i > 0 ? flow[i - 1] : 0.0f)) / capacity_[i];
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Winding of a filament spool as a conducting cylinder shell, heated by the chamber air at its outside and
+// insulated by the hub at its inside. Effective values for a 1 kg spool: the winding's air gaps make it a poor
+// conductor, and the flanges' share of the heating is folded into the conductivity.
+struct SpoolParams
+{
+    float hub_radius = 0.028f;                 // m
+    float outer_radius = 0.1f;                 // m
+    float conductivity = 0.6f;                 // W/(m K)
+    float volumetric_heat_capacity = 1.1e6f;   // J/(m^3 K), plastic packed with air
+    float surface_coefficient = 15.0f;         // W/(m^2 K), natural convection and radiation at the outside
+};
+
+// Estimates the temperature at the core of the spool from the history of the air around it, which is what actually
+// dries the filament: the core lags the air by hours. A few radial shells of equal thickness exchange heat by
+// conduction, stepped explicitly at the control rate; a step costs a couple of dozen float operations.
+//
+// The model starts at the first air temperature it is given, as a spool that has stood in the dryer since boot.
+class SpoolModel
+{
+public:
+    static constexpr size_t kNodes = 4;
+
+    explicit SpoolModel(const SpoolParams& params = {});
+
+    // Advances the model by `dt` seconds with the air at `air`. A non-finite air temperature holds the model.
+    void step(float air, float dt);
+    void reset(float temperature);
+
+    float core() const { return nodes_[0]; }
+    float surface() const { return nodes_[kNodes - 1]; }
+    float node(size_t i) const { return nodes_[i]; }
+    // Fraction of the winding in shell i.
+    float share(size_t i) const { return share_[i]; }
+    bool started() const { return started_; }
+    // Longest step that keeps the explicit scheme stable; longer steps are split.
+    float max_step() const { return max_step_; }
+
+private:
+    // Per unit length of the spool: capacity of each shell, conductance to the next shell out, and of the last
+    // shell to the air.
+    float capacity_[kNodes];
+    float conductance_[kNodes];
+    float share_[kNodes];
+    float max_step_;
+    float nodes_[kNodes] = {};
+    bool started_ = false;
+};
@@ -0,0 +1,103 @@
+#include "spool_scale.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// Fraction of the reading the zero moves by per reading while the scale is empty.
+constexpr float kZeroTracking = 0.01f;
+
+SpoolScale::SpoolScale(const ScaleParams& params)
+    : params_(params), cell_temperature_(params.reference_temperature)
+{
+}
+
+void SpoolScale::restart(float weight)
+{
+    loaded_ = weight >= kEmptyBelow;
+    load_ = loaded_ ? weight : 0.0f;
+    since_load_s_ = 0.0f;
+    jumps_ = 0;
+    ++loads_;
+    base_ = weight;
+    s0_ = st_ = stt_ = sw_ = stw_ = 0.0f;
+}
+
+float SpoolScale::slope() const
+{
+    const float det = s0_ * stt_ - st_ * st_;
+    return det > 0.0f ? (s0_ * stw_ - st_ * sw_) / det : 0.0f;
+}
+
+float SpoolScale::fitted() const
+{
+    return s0_ > 0.0f ? base_ + (sw_ - slope() * st_) / s0_ : base_;
+}
+
+float SpoolScale::weight() const
+{
+    return loaded() ? fitted() : NAN;
+}
+
+float SpoolScale::loss_rate() const
+{
+    if (!loaded() || since_load_s_ < kRateWindowS) {
+        return NAN;
+    }
+    return -slope();
+}
+
+void SpoolScale::tare()
+{
+    if (std::isfinite(last_)) {
+        zero_ += last_;
+        restart(0.0f);
+    }
+}
+
+void SpoolScale::update(float reading, float chamber, float dt)
+{
+    if (std::isfinite(chamber)) {
+        const float target = params_.reference_temperature +
+                             params_.thermal_coupling * (chamber - params_.reference_temperature);
+        cell_temperature_ += (target - cell_temperature_) * (1.0f - std::exp(-dt / params_.thermal_tau_s));
+    }
+    if (loaded_) {
+        since_load_s_ += dt;
+    }
+    // Age the fit: every reading moves dt further into the past and loses weight.
+    const float hours = dt / 3600.0f;
+    const float decay = std::exp(-dt / kRateWindowS);
+    stt_ = decay * (stt_ - 2.0f * hours * st_ + hours * hours * s0_);
+    st_ = decay * (st_ - hours * s0_);
+    stw_ = decay * (stw_ - hours * sw_);
+    sw_ *= decay;
+    s0_ *= decay;
+    if (!std::isfinite(reading)) {
+        return;
+    }
+
+    const float rise = cell_temperature_ - params_.reference_temperature;
+    float weight = (reading - zero_ - params_.zero_tempco * rise) / (1.0f + params_.span_tempco * rise);
+    last_ = weight;
+    if (loaded_) {
+        weight -= load_ * params_.creep * (1.0f - std::exp(-since_load_s_ / params_.creep_tau_s));
+    }
+    if (!started_) {
+        started_ = true;
+        restart(weight);
+    } else if (std::abs(weight - (loaded_ ? fitted() : 0.0f)) > kLoadStep) {
+        if (++jumps_ < kLoadReadings) {
+            return;
+        }
+        restart(weight);
+    }
+    jumps_ = 0;
+    if (!loaded_) {
+        zero_ += kZeroTracking * weight;
+        return;
+    }
+    const float w = weight - base_;
+    s0_ += 1.0f;
+    sw_ += w;
+    // The reading is at time 0, so adds nothing to the time sums.
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+// Spools weigh 200 to 300 g empty; the scale weighs the spool with its filament.
+constexpr float kEmptySpoolWeight = 250.0f;
+
+// What a load cell does beyond its static calibration, for a 5 kg bar cell under the chamber floor. Data sheet
+// figures for the cell; the thermal coupling depends on how it is mounted.
+struct ScaleParams
+{
+    float zero_tempco = 0.1f;              // g/C, zero shift
+    float span_tempco = 1.5e-5f;           // 1/C, gain change
+    float reference_temperature = 22.0f;   // C, the temperature of the cell at calibration
+    // The cell warms with the chamber floor: it follows this fraction of the chamber's rise over the reference
+    // temperature, with this time constant.
+    float thermal_coupling = 0.5f;
+    float thermal_tau_s = 1800.0f;
+    // Under a constant load the output creeps up by this fraction of the load, with this time constant.
+    float creep = 2e-4f;
+    float creep_tau_s = 1200.0f;
+};
+
+// Turns load cell readings, in grams from the cell's static calibration, into the weight of the spool and the rate
+// it is losing water.
+//
+// Readings are corrected for the cell's temperature, estimated from the chamber's, and for creep since the spool
+// was put on. A reading that jumps by more than kLoadStep from the fitted weight is taken as a knock and ignored,
+// unless kLoadReadings in a row agree, which means a spool was put on or taken off and the fit starts over. While
+// the scale is empty its zero follows the readings, so the zero drift of the cell doesn't build up between spools.
+//
+// The weight and its rate come from a straight line fitted by least squares to the readings, weighted to forget
+// them with a time constant of kRateWindowS: at 1 g of reading noise and a reading a second the rate is good to
+// about 0.1 g/h.
+class SpoolScale
+{
+public:
+    static constexpr float kLoadStep = 20.0f;
+    static constexpr uint32_t kLoadReadings = 3;
+    // Below this the scale is taken to be empty; an empty spool alone is several times heavier.
+    static constexpr float kEmptyBelow = 50.0f;
+    // A spool just put on rocks for a few seconds.
+    static constexpr float kSettleS = 30.0f;
+    static constexpr float kRateWindowS = 3600.0f;
+
+    explicit SpoolScale(const ScaleParams& params = {});
+
+    // Advances the scale by `dt` seconds with a new reading in grams, or NAN for none this time. `chamber` is the
+    // chamber temperature, NAN when unknown.
+    void update(float reading, float chamber, float dt);
+    // Takes the last reading as the empty scale.
+    void tare();
+
+    // A spool is on the scale and has settled.
+    bool loaded() const { return loaded_ && since_load_s_ >= kSettleS; }
+    // Fitted weight of the spool, NAN unless loaded.
+    float weight() const;
+    // Grams per hour the spool is losing, NAN until it has been loaded for a full window.
+    float loss_rate() const;
+    float cell_temperature() const { return cell_temperature_; }
+    float zero() const { return zero_; }
+    // Counts the times a spool was put on or taken off, the first reading included.
+    uint32_t loads() const { return loads_; }
+
+private:
+    void restart(float weight);
+    float slope() const;
+    float fitted() const;
+
+    ScaleParams params_;
+    float cell_temperature_;
+    // In grams of the static calibration.
+    float zero_ = 0.0f;
+    // The last reading corrected for temperature, for tare().
+    float last_ = NAN;
+    bool started_ = false;
+    bool loaded_ = false;
+    float load_ = 0.0f;
+    float since_load_s_ = 0.0f;
+    uint32_t jumps_ = 0;
+    uint32_t loads_ = 0;
+    // Weighted sums over the fit, time in hours before the latest reading and weight relative to base_.
+    float base_ = 0.0f;
+    float s0_ = 0.0f;
+    float st_ = 0.0f;
+    float stt_ = 0.0f;
+    float sw_ = 0.0f;
+    float stw_ = 0.0f;
+};
@@ -0,0 +1,121 @@
+#include "telemetry.hpp"
+
+#include <array>
+
+static constexpr std::array<uint16_t, 256> make_crc16_table()
+{
+    std::array<uint16_t, 256> table{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint16_t crc = i << 8;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x8000) != 0 ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+static constexpr auto kCrc16Table = make_crc16_table();
+
+uint16_t telemetry_crc16(const uint8_t* data, size_t size, uint16_t crc)
+{
+    for (size_t i = 0; i < size; ++i) {
+        crc = (crc << 8) ^ kCrc16Table[(crc >> 8) ^ data[i]];
+    }
+    return crc;
+}
+
+template <typename T>
+static void store(uint8_t* payload, size_t offset, T value)
+{
+    memcpy(payload + offset, &value, sizeof(value));
+}
+
+size_t encode_telemetry(uint8_t* out, uint32_t device_id, uint32_t sequence, const DryerStatus& status)
+{
+    out[0] = kTelemetrySync0;
+    out[1] = kTelemetrySync1;
+    out[2] = kTelemetryPayloadSize;
+    out[3] = kTelemetryVersion;
+    uint8_t* payload = out + kTelemetryHeaderSize;
+    store<uint32_t>(payload, 0, device_id);
+    store<uint32_t>(payload, 4, sequence);
+    store<uint32_t>(payload, 8, status.time_ms);
+    store<uint16_t>(payload, 12, status.reading.raw);
+    payload[14] = (status.heater_on ? kTelemetryHeaterOn : 0) | (status.fault ? kTelemetryFault : 0) |
+                  (status.sensor_drift ? kTelemetrySensorDrift : 0);
+    payload[15] = static_cast<uint8_t>(status.phase);
+    store<float>(payload, 16, status.reading.corrected);
+    store<float>(payload, 20, status.reading.temperature);
+    store<float>(payload, 24, status.reading.voltage);
+    store<float>(payload, 28, status.setpoint);
+    store<float>(payload, 32, status.duty);
+    store<uint32_t>(payload, 36, status.soak_elapsed_s);
+    store<float>(payload, 40, status.core_temperature);
+    store<float>(payload, 44, status.moisture);
+    store<uint32_t>(payload, 48, status.eta_s);
+    store<float>(payload, 52, status.temperature);
+    const uint16_t crc = telemetry_crc16(out + 2, kTelemetryHeaderSize - 2 + kTelemetryPayloadSize);
+    store<uint16_t>(payload, kTelemetryPayloadSize, crc);
+    return kTelemetryFrameSize;
+}
+
+DryerStatus TelemetryView::status() const
+{
+    DryerStatus status;
+    status.time_ms = time_ms();
+    status.reading = {raw(), corrected(), temperature(), voltage()};
+    status.temperature = control_temperature();
+    status.setpoint = setpoint();
+    status.duty = duty();
+    status.heater_on = heater_on();
+    status.fault = fault();
+    status.sensor_drift = sensor_drift();
+    status.phase = static_cast<DryerPhase>(phase());
+    status.soak_elapsed_s = soak_elapsed_s();
+    status.core_temperature = core_temperature();
+    status.moisture = moisture();
+    status.eta_s = eta_s();
+    return status;
+}
+
+bool TelemetryScanner::next(TelemetryView& frame)
+{
+    while (offset_ < size_) {
+        const auto* sync = static_cast<const uint8_t*>(memchr(data_ + offset_, kTelemetrySync0, size_ - offset_));
+        if (sync == nullptr) {
+            offset_ = size_;
+            return false;
+        }
+        offset_ = sync - data_;
+        if (size_ - offset_ < kTelemetryHeaderSize) {
+            if (complete_) {
+                offset_ = size_;
+            }
+            return false;
+        }
+        const size_t length = sync[2];
+        if (sync[1] != kTelemetrySync1 || length < kTelemetryMinPayloadSize || sync[3] == 0) {
+            ++offset_;
+            continue;
+        }
+        const size_t frame_size = kTelemetryHeaderSize + length + kTelemetryCrcSize;
+        if (size_ - offset_ < frame_size) {
+            if (complete_) {
+                ++offset_;
+                continue;
+            }
+            return false;
+        }
+        uint16_t crc;
+        memcpy(&crc, sync + kTelemetryHeaderSize + length, sizeof(crc));
+        if (telemetry_crc16(sync + 2, kTelemetryHeaderSize - 2 + length) != crc) {
+            ++offset_;
+            continue;
+        }
+        frame = TelemetryView(sync);
+        offset_ += frame_size;
+        return true;
+    }
+    return false;
+}
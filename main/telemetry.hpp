@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "dryer.hpp"
+
+// Binary status frames the firmware streams to a gateway once per control step, for fleet ingestion.
+//
+// A frame is two sync bytes, the payload length, a version byte, the payload and a CRC-16/CCITT-FALSE of length,
+// version and payload. All fields are little-endian. Later versions only append to the payload, so readers take the
+// fields they know from any frame with a payload long enough to hold them, and frames shorter than version 1's are
+// invalid. Version 2 appended the spool core temperature, moisture and time to dry, and version 3 the control
+// temperature, the thermistor's blended with any auxiliary sensors'. The sync bytes are not ASCII, so a receiver that
+// joins mid-stream or loses bytes resynchronises at the next frame without matching log text.
+
+constexpr uint8_t kTelemetrySync0 = 0xa5;
+constexpr uint8_t kTelemetrySync1 = 0x5a;
+constexpr uint8_t kTelemetryVersion = 3;
+constexpr size_t kTelemetryHeaderSize = 4;
+constexpr size_t kTelemetryMinPayloadSize = 40;
+constexpr size_t kTelemetryPayloadSize = 56;
+constexpr size_t kTelemetryCrcSize = 2;
+constexpr size_t kTelemetryFrameSize = kTelemetryHeaderSize + kTelemetryPayloadSize + kTelemetryCrcSize;
+constexpr size_t kTelemetryMinFrameSize = kTelemetryHeaderSize + kTelemetryMinPayloadSize + kTelemetryCrcSize;
+constexpr size_t kTelemetryMaxFrameSize = kTelemetryHeaderSize + 255 + kTelemetryCrcSize;
+
+// Bits of the flags byte.
+constexpr uint8_t kTelemetryHeaterOn = 0x01;
+constexpr uint8_t kTelemetryFault = 0x02;
+constexpr uint8_t kTelemetrySensorDrift = 0x04;
+
+uint16_t telemetry_crc16(const uint8_t* data, size_t size, uint16_t crc = 0xffff);
+
+// Writes the frame for one status to `out`, which must hold kTelemetryFrameSize bytes, and returns its length.
+// `sequence` counts frames since boot, so receivers can tell lost frames from a restart.
+size_t encode_telemetry(uint8_t* out, uint32_t device_id, uint32_t sequence, const DryerStatus& status);
+
+// Fields of a frame, read in place from the buffer holding it. The frame must have passed TelemetryScanner.
+class TelemetryView
+{
+public:
+    TelemetryView() = default;
+    explicit TelemetryView(const uint8_t* frame) : frame_(frame) {}
+
+    const uint8_t* data() const { return frame_; }
+    size_t size() const { return kTelemetryHeaderSize + frame_[2] + kTelemetryCrcSize; }
+    uint8_t version() const { return frame_[3]; }
+
+    uint32_t device_id() const { return load<uint32_t>(0); }
+    uint32_t sequence() const { return load<uint32_t>(4); }
+    uint32_t time_ms() const { return load<uint32_t>(8); }
+    uint16_t raw() const { return load<uint16_t>(12); }
+    uint8_t flags() const { return frame_[kTelemetryHeaderSize + 14]; }
+    // A DryerPhase, or a newer phase this reader doesn't know.
+    uint8_t phase() const { return frame_[kTelemetryHeaderSize + 15]; }
+    float corrected() const { return load<float>(16); }
+    // The thermistor's.
+    float temperature() const { return load<float>(20); }
+    float voltage() const { return load<float>(24); }
+    float setpoint() const { return load<float>(28); }
+    float duty() const { return load<float>(32); }
+    uint32_t soak_elapsed_s() const { return load<uint32_t>(36); }
+    // Version 2 fields: NAN or MoistureModel::kUnknownEta in older frames.
+    float core_temperature() const { return has(44) ? load<float>(40) : NAN; }
+    float moisture() const { return has(48) ? load<float>(44) : NAN; }
+    uint32_t eta_s() const { return has(52) ? load<uint32_t>(48) : MoistureModel::kUnknownEta; }
+    // Version 3: the thermistor's in older frames, which controlled on it alone.
+    float control_temperature() const { return has(56) ? load<float>(52) : temperature(); }
+
+    bool heater_on() const { return (flags() & kTelemetryHeaterOn) != 0; }
+    bool fault() const { return (flags() & kTelemetryFault) != 0; }
+    bool sensor_drift() const { return (flags() & kTelemetrySensorDrift) != 0; }
+
+    DryerStatus status() const;
+
+private:
+    bool has(size_t end) const { return frame_[2] >= end; }
+
+    template <typename T>
+    T load(size_t offset) const
+    {
+        T value;
+        memcpy(&value, frame_ + kTelemetryHeaderSize + offset, sizeof(value));
+        return value;
+    }
+
+    const uint8_t* frame_ = nullptr;
+};
+
+// Finds the frames in a byte stream, skipping whatever isn't one: log text, line noise, frames with a bad CRC.
+class TelemetryScanner
+{
+public:
+    TelemetryScanner(const uint8_t* data, size_t size, size_t offset = 0) : data_(data), size_(size), offset_(offset)
+    {
+    }
+
+    // Finds the next valid frame at or after offset(). Returns false when none is complete in the data; offset() is
+    // then where one may begin, so a streaming reader keeps the bytes from there and scans again with more.
+    bool next(TelemetryView& frame);
+    // Declares the data complete: a frame cut short by its end is then skipped like any other bad frame, so a real
+    // one after a false sync byte near the end is still found.
+    void set_complete() { complete_ = true; }
+    // Position of the scan: just past the last frame found, or where next() stopped.
+    size_t offset() const { return offset_; }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t offset_;
+    bool complete_ = false;
+};
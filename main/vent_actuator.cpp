@@ -0,0 +1,75 @@
+#include "vent_actuator.hpp"
+
+#include <esp_log.h>
+
+#include <algorithm>
+#include <cmath>
+
+constexpr const char* TAG = "vent";
+
+constexpr auto kSpeedMode = LEDC_LOW_SPEED_MODE;
+constexpr auto kTimer = LEDC_TIMER_0;
+constexpr auto kChannel = LEDC_CHANNEL_0;
+constexpr uint32_t kFrequencyHz = 50;
+// 20 ms in 16384 steps: 1.2 us a step, a few hundredths of a degree of servo travel.
+constexpr auto kResolution = LEDC_TIMER_14_BIT;
+constexpr uint32_t kPeriodUs = 1'000'000 / kFrequencyHz;
+
+esp_err_t VentActuator::begin(int gpio, uint32_t closed_us, uint32_t open_us, float opening)
+{
+    closed_us_ = closed_us;
+    open_us_ = open_us;
+    target_ = std::clamp(opening, 0.0f, 1.0f);
+
+    ledc_timer_config_t timer_config{};
+    timer_config.speed_mode = kSpeedMode;
+    timer_config.duty_resolution = kResolution;
+    timer_config.timer_num = kTimer;
+    timer_config.freq_hz = kFrequencyHz;
+    timer_config.clk_cfg = LEDC_AUTO_CLK;
+    esp_err_t err = ledc_timer_config(&timer_config);
+    if (err == ESP_OK) {
+        ledc_channel_config_t channel_config{};
+        channel_config.gpio_num = gpio;
+        channel_config.speed_mode = kSpeedMode;
+        channel_config.channel = kChannel;
+        channel_config.intr_type = LEDC_INTR_DISABLE;
+        channel_config.timer_sel = kTimer;
+        channel_config.duty = duty_for(target_);
+        err = ledc_channel_config(&channel_config);
+    }
+    if (err == ESP_OK) {
+        err = ledc_fade_func_install(0);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set up the vent servo: %s", esp_err_to_name(err));
+        return err;
+    }
+    ready_ = true;
+    return ESP_OK;
+}
+
+void VentActuator::move_to(float opening, uint32_t now_ms)
+{
+    opening = std::clamp(opening, 0.0f, 1.0f);
+    if (!ready_ || opening == target_ || int32_t(now_ms - moving_until_ms_) < 0) {
+        return;
+    }
+    const uint32_t fade_ms = uint32_t(std::lround(std::abs(opening - target_) * kStrokeMs));
+    esp_err_t err = ledc_set_fade_with_time(kSpeedMode, kChannel, duty_for(opening), int(fade_ms));
+    if (err == ESP_OK) {
+        err = ledc_fade_start(kSpeedMode, kChannel, LEDC_FADE_NO_WAIT);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to move the vent: %s", esp_err_to_name(err));
+        return;
+    }
+    target_ = opening;
+    moving_until_ms_ = now_ms + fade_ms;
+}
+
+uint32_t VentActuator::duty_for(float opening) const
+{
+    const float pulse_us = closed_us_ + opening * (float(open_us_) - float(closed_us_));
+    return uint32_t(std::lround(pulse_us / kPeriodUs * (1u << kResolution)));
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <driver/ledc.h>
+#include <esp_err.h>
+
+#include <cstdint>
+
+// Hobby servo on the exhaust vent, driven at 50 Hz by an LEDC channel. Moves are LEDC hardware fades of the pulse
+// width, so the vent swings at a steady kStrokeMs per full stroke without a task stepping it or waiting on it.
+class VentActuator
+{
+public:
+    static constexpr uint32_t kStrokeMs = 3000;
+
+    // Starts the servo at `opening`, from 0 closed to 1 fully open; `closed_us` and `open_us` are the pulse widths
+    // of the two ends of the vent's travel.
+    esp_err_t begin(int gpio, uint32_t closed_us, uint32_t open_us, float opening);
+
+    // Swings towards `opening` unless the vent is still moving, in which case a later call picks the target up once
+    // the move in progress has finished. Never waits.
+    void move_to(float opening, uint32_t now_ms);
+
+    bool ready() const { return ready_; }
+    // Where the vent is headed, or stands.
+    float target() const { return target_; }
+
+private:
+    uint32_t duty_for(float opening) const;
+
+    bool ready_ = false;
+    uint32_t closed_us_ = 0;
+    uint32_t open_us_ = 0;
+    float target_ = 0.0f;
+    uint32_t moving_until_ms_ = 0;
+};
@@ -0,0 +1,91 @@
+#include "vent_controller.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+#include "psychrometrics.hpp"
+
+VentController::VentController(const VentParams& params)
+    : params_(params), ambient_vapour_pressure_(vapour_pressure(params.ambient, params.ambient_humidity))
+{
+}
+
+float VentController::update(const MoistureModel& moisture, float air, float humidity, float duty, bool done,
+                             float dt)
+{
+    if (std::isfinite(humidity) && std::isfinite(air)) {
+        vapour_pressure_ = vapour_pressure(air, std::clamp(humidity, 0.0f, 100.0f));
+    }
+    if (std::isfinite(duty)) {
+        duty_ = std::isnan(duty_) ? duty : duty_ + (duty - duty_) * dt / (kDutyTauS + dt);
+    }
+    if (done) {
+        opening_ = 0.0f;
+        return opening_;
+    }
+    elapsed_s_ += dt;
+    if (elapsed_s_ < kIntervalS) {
+        return opening_;
+    }
+    if (!moisture.active() || std::isnan(vapour_pressure_) || !std::isfinite(air) || std::isnan(duty_)) {
+        elapsed_s_ = 0.0f;
+        opening_ = 1.0f;
+        return opening_;
+    }
+    choose(moisture, air);
+    return opening_;
+}
+
+void VentController::choose(const MoistureModel& moisture, float air)
+{
+    const float interval_s = elapsed_s_;
+    elapsed_s_ = 0.0f;
+
+    // What leaves with the air at the present opening, plus what stays behind in the chamber air. Room air coming
+    // in keeps its vapour pressure as it warms.
+    const float kelvin = air + kKelvin;
+    const float density = kVapourDensityFactor * vapour_pressure_ / kelvin;
+    const float incoming = kVapourDensityFactor * ambient_vapour_pressure_ / kelvin;
+    float evaporation = flow(opening_) * (density - incoming);
+    if (std::isfinite(density_)) {
+        evaporation += params_.chamber_volume * (density - density_) / interval_s;
+    }
+    density_ = density;
+    evaporation_ = std::max(0.0f, evaporation);
+
+    // The spool gives off water in proportion to how far its moisture m is above the equilibrium moisture of the
+    // chamber air, E = k (m - equilibrium), and the equilibrium rises with the vapour the air holds on to: at
+    // opening v it is a + b(v) E, from room air's a. Together E(v) = k (m - a) / (1 + k b(v)), with k from the
+    // present rate.
+    const float sorption = moisture.kinetics()->saturation / saturation_pressure(air);
+    const float current = moisture.moisture();
+    const float excess = current - sorption * vapour_pressure_;
+    const float k = excess > 0.0f ? evaporation_ / excess : 0.0f;
+
+    // Heater power is what the walls and seams lose plus the vent's share, which is linear in the opening. The
+    // choice minimises energy per gram, P(v) / E(v), in proportion P(v) (1 + k b(v)).
+    const float vent_power = kAirHeatCapacity * params_.full_flow * (air - params_.ambient);
+    const float base_power = std::max(0.0f, duty_ * params_.heater_power - opening_ * vent_power);
+    float cost[std::size(kOpenings)];
+    size_t best = 0;
+    size_t present = std::size(kOpenings);
+    for (size_t i = 0; i < std::size(kOpenings); ++i) {
+        const float power = base_power + kOpenings[i] * vent_power;
+        const float b = sorption * kelvin / (kVapourDensityFactor * flow(kOpenings[i]));
+        cost[i] = power * (1.0f + k * b);
+        if (kOpenings[i] == opening_) {
+            present = i;
+        }
+        // Closed is always possible; an opening the heater can't keep up with is not.
+        if (i != 0 && power > kDutyLimit * params_.heater_power) {
+            cost[i] = INFINITY;
+        }
+        if (cost[i] < cost[best]) {
+            best = i;
+        }
+    }
+    if (present == std::size(kOpenings) || !(cost[best] >= (1.0f - kHysteresis) * cost[present])) {
+        opening_ = kOpenings[best];
+    }
+    power_ = base_power + opening_ * vent_power;
+}
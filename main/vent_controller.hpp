@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cmath>
+
+#include "moisture_model.hpp"
+
+// Airflow of the exhaust vent and what it costs. Nominal values for a five-tray dehydrator with a 40 mm vent.
+struct VentParams
+{
+    float full_flow = 1.2e-3f;       // m^3/s of room air through the fully open vent
+    float leak_flow = 1e-4f;         // m^3/s through the seams with the vent closed
+    float chamber_volume = 0.04f;    // m^3
+    float heater_power = 250.0f;     // W
+    // Room air, which the moisture model also assumes.
+    float ambient = 22.0f;           // C
+    float ambient_humidity = 50.0f;  // %
+};
+
+// Opens the exhaust vent as far as drying the spool needs and no further, for the most water removed per kWh.
+//
+// Air through the vent carries off the water the spool gives off, and the heat of warming the room air that
+// replaces it. A wide open vent wastes heat once the spool gives off little; a closed one lets the chamber air grow
+// humid, which raises the spool's equilibrium moisture and slows its drying while the walls go on losing heat. Every
+// kIntervalS the controller estimates from the chamber humidity how much water the spool is giving off, predicts for
+// each candidate opening the humidity the chamber would settle at and how fast the spool would dry in it, and takes
+// the opening with the least heater energy per gram. Openings the heater couldn't keep up with (kDutyLimit) are ruled
+// out.
+//
+// Without a humidity reading or a material it vents like a stock dehydrator, fully open. Once the run is over it
+// closes, keeping the room's humidity away from the dry spool.
+class VentController
+{
+public:
+    static constexpr float kOpenings[] = {0.0f, 0.05f, 0.1f, 0.15f, 0.25f, 0.4f, 0.6f, 1.0f};
+    static constexpr float kIntervalS = 60.0f;
+    static constexpr float kDutyLimit = 0.85f;
+    // The PID's duty swings from step to step; the heater power comes from its average over this long.
+    static constexpr float kDutyTauS = 600.0f;
+    // A new opening must promise this much less energy to replace the current one.
+    static constexpr float kHysteresis = 0.02f;
+
+    explicit VentController(const VentParams& params = {});
+
+    // Advances by `dt` seconds and returns the vent opening, from 0 closed to 1 fully open. `air` is the chamber
+    // temperature, `humidity` its relative humidity in percent or NAN without a new reading, `duty` the heater's,
+    // and `done` whether the run is over.
+    float update(const MoistureModel& moisture, float air, float humidity, float duty, bool done, float dt);
+
+    float opening() const { return opening_; }
+    // Water the spool is giving off, g/h; NAN before the first estimate.
+    float evaporation() const { return evaporation_ * 3600.0f; }
+    // Heater power expected at the chosen opening, W; NAN before the first choice.
+    float power() const { return power_; }
+
+private:
+    float flow(float opening) const { return params_.leak_flow + opening * params_.full_flow; }
+    void choose(const MoistureModel& moisture, float air);
+
+    VentParams params_;
+    float ambient_vapour_pressure_;
+    float opening_ = 1.0f;
+    float elapsed_s_ = 0.0f;
+    float duty_ = NAN;
+    // Of the chamber air: the last reading, kPa, and the water vapour at the last choice, g/m^3.
+    float vapour_pressure_ = NAN;
+    float density_ = NAN;
+    // g/s
+    float evaporation_ = NAN;
+    float power_ = NAN;
+};